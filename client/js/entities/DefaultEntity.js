@@ -15,11 +15,21 @@ class DefaultEntity {
         this.entity = entity;
 
         try {
-            var dot = new THREE.Mesh(new THREE.BoxBufferGeometry(
-                1,
-                1,
-                1
-            ), new THREE.MeshPhongMaterial({
+            var geometry = new THREE.BoxBufferGeometry(1, 1, 1);
+
+            /* Size of the bounding box, if the server sends it */
+            if (entity.scale) {
+                geometry = new THREE.BoxBufferGeometry(
+                    entity.scale.x * scale,
+                    entity.scale.y * scale,
+                    entity.scale.z * scale
+                );
+
+                /* Bring above ground */
+                geometry.translate(0, 0, entity.scale.z * scale * 0.5);
+            }
+
+            var dot = new THREE.Mesh(geometry, new THREE.MeshPhongMaterial({
                 color: 0xffa23f,
                 flatShading: false
             }));
@@ -119,62 +119,49 @@ class Footbot {
                 }
             }
 
+            /* None in lean broadcasts, which hides them */
+            var decodedPoints = Rays.decode(entity.points);
+            var decodedRays = Rays.decode(entity.rays);
+
             var pointMesh = this.mesh.children[13];
 
-            if (entity.points.length > 0) {
+            if (decodedPoints.count > 0) {
                 var points = pointMesh.geometry.getAttribute('position').array
+                var values = decodedPoints.values;
 
-                for (let i = 0; i < entity.points.length; i++) {
-                    var pointVals = entity.points[i].split(",")
-                    points[3 * i] = pointVals[0] * scale
-                    points[3 * i + 1] = pointVals[1] * scale
-                    points[3 * i + 2] = pointVals[2] * scale
+                for (let i = 0; i < 3 * decodedPoints.count && i < points.length; i++) {
+                    points[i] = values[i] * scale
                 }
                 pointMesh.geometry.getAttribute('position').needsUpdate = true;
             }
 
             /* Only draw given points, and hide all previous points */
-            pointMesh.geometry.setDrawRange(0, entity.points.length);
-
-            if (entity.rays.length > 0) {
-                for (let i = 0; i < entity.rays.length; i++) {
-                    /*
-                        For each ray as a string,
-                        format -> "BoolIsChecked:Vec3StartPoint:Vec3EndPoint"
-                        For example -> "true:1,2,3:1,2,4"
-                    */
-
-                    var rayArr = entity.rays[i].split(":")
-                    var start = rayArr[1].split(",")
-                    var end = rayArr[2].split(",")
-
-                    var line = this.mesh.children[14 + i];
-                    if (line) {
-                        if (rayArr[0] == "true") {
-                            line.material.color.setHex(0xff00ff);
-                        } else {
-                            line.material.color.setHex(0x00ffff);
-                        }
-
-                        var positions = line.geometry.getAttribute('position').array
-
-                        positions[0] = start[0] * scale
-                        positions[1] = start[1] * scale
-                        positions[2] = start[2] * scale
-
-                        positions[3] = end[0] * scale
-                        positions[4] = end[1] * scale
-                        positions[5] = end[2] * scale
-
-                        line.geometry.getAttribute('position').needsUpdate = true;
-                        line.geometry.setDrawRange(0, 2);
+            pointMesh.geometry.setDrawRange(0, decodedPoints.count);
+
+            for (let i = 0; i < decodedRays.count; i++) {
+                /* 6 values per ray, start x,y,z then end x,y,z */
+                var line = this.mesh.children[14 + i];
+                if (line) {
+                    if (Rays.isChecked(decodedRays, i)) {
+                        line.material.color.setHex(0xff00ff);
+                    } else {
+                        line.material.color.setHex(0x00ffff);
                     }
+
+                    var positions = line.geometry.getAttribute('position').array
+
+                    for (let j = 0; j < 6; j++) {
+                        positions[j] = decodedRays.values[6 * i + j] * scale
+                    }
+
+                    line.geometry.getAttribute('position').needsUpdate = true;
+                    line.geometry.setDrawRange(0, 2);
                 }
             }
 
             /* Hide all the previous lines */
             /* 14 are the number of objects in meshParent before rays */
-            for (let i = 14 + entity.rays.length; i < this.mesh.children.length; i++) {
+            for (let i = 14 + decodedRays.count; i < this.mesh.children.length; i++) {
                 this.mesh.children[i].geometry.setDrawRange(0, 0);
             }
         }
@@ -0,0 +1,76 @@
+/**
+ * @file <client/js/entities/Rays.js>
+ * 
+ * @author Prajankya Sonar - <prajankya@gmail.com>
+ * 
+ * @project ARGoS3-Webviz <https://github.com/NESTlab/argos3-webviz>
+ * 
+ * MIT License
+ * Copyright (c) 2020 NEST Lab
+ */
+
+/*
+    Decodes the "rays" and "points" of the robots, sent as
+    {count, format, data, checked} where data is the base64 of
+    little-endian floats ("float32" or "float16"), 6 per ray
+    (start x,y,z, end x,y,z) or 3 per point, relative to the body,
+    and checked the base64 of a bitmask, bit i for ray i
+*/
+class Rays {
+    static decodeBytes(base64) {
+        var binary = atob(base64 || "");
+        var bytes = new Uint8Array(binary.length);
+        for (let i = 0; i < binary.length; i++) {
+            bytes[i] = binary.charCodeAt(i);
+        }
+        return bytes;
+    }
+
+    static halfToFloat(half) {
+        var sign = (half & 0x8000) ? -1 : 1;
+        var exponent = (half >> 10) & 0x1f;
+        var mantissa = half & 0x3ff;
+
+        if (exponent == 0) {
+            return sign * Math.pow(2, -14) * (mantissa / 1024);
+        }
+        if (exponent == 0x1f) {
+            return mantissa ? NaN : sign * Infinity;
+        }
+        return sign * Math.pow(2, exponent - 15) * (1 + mantissa / 1024);
+    }
+
+    /* Returns {count, values, checked}, count is 0 if nothing was sent */
+    static decode(encoded) {
+        if (!encoded || !encoded.count) {
+            return { count: 0, values: new Float32Array(0), checked: null };
+        }
+
+        var bytes = Rays.decodeBytes(encoded.data);
+        var view = new DataView(bytes.buffer);
+        var values;
+
+        if (encoded.format == "float16") {
+            values = new Float32Array(bytes.length / 2);
+            for (let i = 0; i < values.length; i++) {
+                values[i] = Rays.halfToFloat(view.getUint16(2 * i, true));
+            }
+        } else {
+            values = new Float32Array(bytes.length / 4);
+            for (let i = 0; i < values.length; i++) {
+                values[i] = view.getFloat32(4 * i, true);
+            }
+        }
+
+        return {
+            count: encoded.count,
+            values: values,
+            checked: encoded.checked ? Rays.decodeBytes(encoded.checked) : null
+        };
+    }
+
+    static isChecked(decoded, i) {
+        return decoded.checked != null &&
+            (decoded.checked[i >> 3] & (1 << (i & 7))) != 0;
+    }
+}
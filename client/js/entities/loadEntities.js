@@ -13,6 +13,7 @@
 loadJS("/js/entities/DefaultEntity.js")
 loadJS("/js/entities/Light.js")
 loadJS("/js/entities/Floor.js")
+loadJS("/js/entities/Rays.js")
 
 loadJS("/js/entities/Box.js")
 loadJS("/js/entities/Cylinder.js")
@@ -21,6 +21,7 @@ var scene = new THREE.Scene();
 
 window.isInitialized = false;
 window.isLoadingModels = false;
+window.isSceneLoaded = false;
 
 /* Initialize Three.js scene */
 THREE.Object3D.DefaultUp.set(0, 0, 1);
@@ -28,7 +29,7 @@ scene.background = new THREE.Color(0x007f7f);
 
 
 /* ----------------------- */
-var sceneEntities = [];
+var sceneEntities = {};
 
 var IntializeThreejs = function (threejs_panel) {
   var _width = threejs_panel.width();
@@ -142,23 +143,94 @@ function initSceneWithScale(_scale) {
   }
 }
 
+/* Entities whose models are being loaded, by id */
+var loadingEntities = {};
+
+function addSceneEntity(entity, callback) {
+  loadingEntities[entity.id] = true;
+
+  GetEntity(entity, scale, function (entityObject) {
+    delete loadingEntities[entity.id];
+
+    if (entityObject) {
+      var mesh = entityObject.getMesh()
+
+      if (mesh) {
+        entityObject.uuid = mesh.uuid
+
+        /* Copy basic properties from Argos entities to threejs objects */
+        entityObject.id = entity.id;
+        entityObject.type_description = entity.type;
+
+        /* UUID to ID map */
+        uuid2idMap[mesh.uuid] = entity.id;
+
+        sceneEntities[entity.id] = entityObject;
+
+        /* Its not an object with "is_movable", so considering it movable(robots) */
+        if (typeof entity.is_movable === 'undefined' || entity.is_movable === null) {
+          /* Hardcoded floor entity in non-selectable entity */
+          if (entity.type == "floor") {
+            /* Non selectable */
+            mesh.layers.set(0);
+          } else {
+            /* Add to selectable layer */
+            mesh.layers.set(1);
+            mesh.traverse(function (child) { child.layers.set(1) })
+          }
+        } else {
+          /* If "is_movable" is true */
+          if (entity.is_movable && entity.is_movable === true) {
+            /* Add to selectable layer */
+            mesh.layers.set(1);
+          } else {
+            /* Non selectable */
+            mesh.layers.set(0);
+          }
+        }
+
+        scene.add(mesh);
+      }
+    }
+
+    if (callback) {
+      callback();
+    }
+  });
+}
+
+function removeSceneEntity(id) {
+  if (!sceneEntities.hasOwnProperty(id)) {
+    return;
+  }
+  var uuid = sceneEntities[id].uuid;
+  deselectObjectByUUID(uuid);
+
+  const object = scene.getObjectByProperty('uuid', uuid);
+  if (object) {
+    if (object.geometry) {
+      object.geometry.dispose();
+    }
+    if (object.material) {
+      object.material.dispose();
+    }
+    scene.remove(object);
+  }
+
+  delete uuid2idMap[uuid];
+  delete sceneEntities[id];
+}
+
 function cleanUpdateScene() {
   window.isLoadingModels = true;
   /* Remove all meshes */
-
   for (const key in sceneEntities) {
     if (sceneEntities.hasOwnProperty(key)) {
-
-      const object = scene.getObjectByProperty('uuid', sceneEntities[key].uuid);
-
-      if (object) {
-        object.geometry.dispose();
-        object.material.dispose();
-        scene.remove(object);
-      }
+      removeSceneEntity(key);
     }
   }
-  /* reset Map */
+  /* reset Maps */
+  sceneEntities = {};
   uuid2idMap = {};
   selectedEntities = {}
 
@@ -166,48 +238,7 @@ function cleanUpdateScene() {
   window.experiment.data.entities.map((entity) => {
 
     if (entity) { //Neglect Null Entities
-      GetEntity(entity, scale, function (entityObject) {
-        if (entityObject) {
-          var mesh = entityObject.getMesh()
-
-          if (mesh) {
-            entityObject.uuid = mesh.uuid
-
-            /* Copy basic properties from Argos entities to threejs objects */
-            entityObject.id = entity.id;
-            entityObject.type_description = entity.type;
-
-            /* UUID to ID map */
-            uuid2idMap[mesh.uuid] = entity.id;
-
-            sceneEntities[entity.id] = entityObject;
-
-            /* Its not an object with "is_movable", so considering it movable(robots) */
-            if (typeof entity.is_movable === 'undefined' || entity.is_movable === null) {
-              /* Hardcoded floor entity in non-selectable entity */
-              if (entity.type == "floor") {
-                /* Non selectable */
-                mesh.layers.set(0);
-              } else {
-                /* Add to selectable layer */
-                mesh.layers.set(1);
-                mesh.traverse(function (child) { child.layers.set(1) })
-              }
-            } else {
-              /* If "is_movable" is true */
-              if (entity.is_movable && entity.is_movable === true) {
-                /* Add to selectable layer */
-                mesh.layers.set(1);
-              } else {
-                /* Non selectable */
-                mesh.layers.set(0);
-              }
-            }
-
-            scene.add(mesh);
-          }
-        }
-
+      addSceneEntity(entity, function () {
         count--;
 
         if (count == 0) { // Finished loading all models
@@ -524,17 +555,36 @@ function render() {
     window.experiment.data.entities &&
     window.isLoadingModels == false) {
 
-    /* Entities count changed, clean and render again */
-    if (window.experiment.data.entities.length != Object.keys(sceneEntities).length) {
+    /* First frame, load all the models */
+    if (!window.isSceneLoaded) {
+      window.isSceneLoaded = true;
       cleanUpdateScene();
       return; // Go to load models, do not update
     }
 
-    /* Call update of each entity */
+    /* Entities removed, as announced by the server on "events" */
+    var removed = window.experiment.removedEntities;
+    if (removed && removed.length > 0) {
+      window.experiment.removedEntities = [];
+      removed.map(removeSceneEntity);
+    }
+
+    /* Entities added are loaded alone, the others are updated */
     window.experiment.data.entities.map((entity) => {
-      sceneEntities[entity.id].update(entity, scale);
+      if (sceneEntities[entity.id]) {
+        sceneEntities[entity.id].update(entity, scale);
+      } else if (!loadingEntities[entity.id]) {
+        addSceneEntity(entity);
+      }
     });
 
+    /* Entities removed without event (e.g. the server did not send them),
+     * clean and render again */
+    if (Object.keys(sceneEntities).length > window.experiment.data.entities.length) {
+      cleanUpdateScene();
+      return;
+    }
+
     /* Update all bounding boxes */
     for (const uuid in selectedEntities) {
       if (selectedEntities.hasOwnProperty(uuid)) {
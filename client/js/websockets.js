@@ -10,8 +10,33 @@
  */
 
 (function (w) {
+  /* Entities of the last manifest, as [id, type] (or [id, type, static])
+   * at the index of their handle */
+  var manifestEntities = [];
+
+  /* Entities sent with their handle "h" get back their id and type, which
+   * are only sent in the manifest. The ones not in it are left out */
+  var resolveHandles = function (entities) {
+    if (!entities) {
+      return entities;
+    }
+    return entities.filter(entity => {
+      if (entity.h === undefined) {
+        return true;
+      }
+      var manifestEntity = manifestEntities[entity.h];
+      if (!manifestEntity) {
+        return false;
+      }
+      entity.id = manifestEntity[0];
+      entity.type = manifestEntity[1];
+      delete entity.h;
+      return true;
+    });
+  }
+
   var ConnectWebSockets = function () {
-    var sockets_api = server + "?broadcasts,logs";
+    var sockets_api = server + "?broadcasts,events,logs";
 
     /* use wss:// for SSL supported */
     if (window.location.protocol == 'https:') {
@@ -57,8 +82,16 @@
 
 
     wsp.onUnpackedMessage.addListener(data => {
+      /* The manifest comes with the first frame after a change, or alone
+       * when subscribing */
+      if (data.manifest && data.manifest.entities) {
+        manifestEntities = data.manifest.entities;
+      }
+
       /* Only if the message is a broadcast message */
       if (data.type == "broadcast") {
+        data.entities = resolveHandles(data.entities);
+
         /* Update experiment */
         window.experiment.data = data;
         window.experiment.state = data.state
@@ -117,6 +150,17 @@
 
         window.experiment.counter = data.steps;
 
+        /* Echo the latency stamps back once in a while, the server records
+         * the end-to-end latency (available at /latency) */
+        if (data.stamps && Date.now() - (window.experiment.lastPing || 0) > 2000) {
+          window.experiment.lastPing = Date.now();
+          wsp.sendPacked({
+            command: "ping",
+            stamps: data.stamps,
+            published: data.published
+          });
+        }
+
 
         if (!window.isInitialized) {
           window.isInitialized = true;
@@ -130,6 +174,11 @@
           /* Start Animation */
           animate();
         }
+      } else if (data.type == "entities") {
+        /* Entities removed, their models are removed at the next render */
+        window.experiment.removedEntities =
+          (window.experiment.removedEntities || []).concat(
+            data.removed.map(entity => entity[1]));
       } else if (data.type == "log") {
         if (data.messages) {
           var log_ = [], logerr_ = [];
@@ -11,9 +11,9 @@
 
 #include <argos3/plugins/simulator/entities/box_entity.h>
 #include <argos3/plugins/simulator/entities/led_equipped_entity.h>
+#include <argos3/plugins/simulator/visualizations/webviz/utility/EntityFields.h>
 #include <argos3/plugins/simulator/visualizations/webviz/webviz.h>
 
-#include <iomanip>
 #include <nlohmann/json.hpp>
 
 namespace argos {
@@ -22,73 +22,34 @@ namespace argos {
     /****************************************/
     /****************************************/
 
+    /** Fields of the box, see utility/EntityFields.h */
+    constexpr auto BOX_FIELDS = MakeEntityFields<CBoxEntity>(
+      Fields::Scalar(
+        "is_movable",
+        [](CBoxEntity& c_entity) {
+          return c_entity.GetEmbodiedEntity().IsMovable();
+        }),
+      Fields::Vector(
+        "scale",
+        [](CBoxEntity& c_entity) -> const CVector3& {
+          return c_entity.GetSize();
+        }),
+      Fields::Pose([](CBoxEntity& c_entity) -> const SAnchor& {
+        return c_entity.GetEmbodiedEntity().GetOriginAnchor();
+      }),
+      Fields::LEDs("leds", [](CBoxEntity& c_entity) -> CLEDEquippedEntity& {
+        return c_entity.GetLEDEquippedEntity();
+      }));
+
+    /****************************************/
+    /****************************************/
+
     class CWebvizOperationGenerateBoxJSON
         : public CWebvizOperationGenerateJSON {
      public:
       /* cppcheck-suppress unusedFunction */
       nlohmann::json ApplyTo(CWebviz& c_webviz, CBoxEntity& c_entity) {
-        nlohmann::json cJson;
-
-        cJson["type"] = c_entity.GetTypeDescription();
-        cJson["id"] = c_entity.GetId();
-
-        cJson["is_movable"] = c_entity.GetEmbodiedEntity().IsMovable();
-
-        /* Get Scale of the box */
-        const argos::CVector3& cScale = c_entity.GetSize();
-        cJson["scale"]["x"] = cScale.GetX();
-        cJson["scale"]["y"] = cScale.GetY();
-        cJson["scale"]["z"] = cScale.GetZ();
-
-        /* Get the position of the box */
-        const argos::CVector3& cPosition =
-          c_entity.GetEmbodiedEntity().GetOriginAnchor().Position;
-
-        /* Add it to json as => position:{x, y, z} */
-        cJson["position"]["x"] = cPosition.GetX();
-        cJson["position"]["y"] = cPosition.GetY();
-        cJson["position"]["z"] = cPosition.GetZ();
-
-        /* Get the orientation of the box */
-        const argos::CQuaternion& cOrientation =
-          c_entity.GetEmbodiedEntity().GetOriginAnchor().Orientation;
-
-        cJson["orientation"]["x"] = cOrientation.GetX();
-        cJson["orientation"]["y"] = cOrientation.GetY();
-        cJson["orientation"]["z"] = cOrientation.GetZ();
-        cJson["orientation"]["w"] = cOrientation.GetW();
-
-        CLEDEquippedEntity& cLEDEquippedEntity =
-          c_entity.GetLEDEquippedEntity();
-
-        if (cLEDEquippedEntity.GetLEDs().size() > 0) {
-          /* Building a string of all led colors */
-
-          for (UInt32 i = 0; i < cLEDEquippedEntity.GetLEDs().size(); i++) {
-            nlohmann::json cLedJson;
-
-            std::stringstream strLEDStream;
-            const CColor& cColor = cLEDEquippedEntity.GetLED(i).GetColor();
-
-            strLEDStream << "#" << std::setfill('0') << std::setw(6) << std::hex
-                         << (cColor.GetRed() << 16 | cColor.GetGreen() << 8 |
-                             cColor.GetBlue());
-            cLedJson["color"] = strLEDStream.str();
-
-            /* Get the position of the box */
-            const argos::CVector3& cLedPosition =
-              cLEDEquippedEntity.GetLED(i).GetPosition();
-
-            /* Add it to json as => position:{x, y, z} */
-            cLedJson["position"]["x"] = cLedPosition.GetX();
-            cLedJson["position"]["y"] = cLedPosition.GetY();
-            cLedJson["position"]["z"] = cLedPosition.GetZ();
-
-            cJson["leds"].push_back(cLedJson);
-          }
-        }
-
-        return cJson;
+        return BOX_FIELDS.ToJSON(c_entity);
       }
     };
 
@@ -97,5 +58,21 @@ namespace argos {
       CWebvizOperationGenerateBoxJSON,
       CBoxEntity);
 
+    /****************************************/
+    /****************************************/
+
+    /** Unchanged entities reuse their JSON, see CWebvizOperationFingerprint */
+    class CWebvizOperationFingerprintBox
+        : public CWebvizOperationFingerprint {
+     public:
+      /* cppcheck-suppress unusedFunction */
+      uint64_t ApplyTo(CWebviz& c_webviz, CBoxEntity& c_entity) {
+        return BOX_FIELDS.Fingerprint(c_entity);
+      }
+    };
+
+    REGISTER_WEBVIZ_ENTITY_FINGERPRINT(
+      CWebvizOperationFingerprintBox, CBoxEntity);
+
   }  // namespace Webviz
 }  // namespace argos
\ No newline at end of file
@@ -12,9 +12,10 @@
 
 #include <argos3/plugins/robots/foot-bot/simulator/footbot_entity.h>
 #include <argos3/plugins/simulator/entities/led_equipped_entity.h>
+#include <argos3/plugins/simulator/visualizations/webviz/utility/EntityFields.h>
+#include <argos3/plugins/simulator/visualizations/webviz/utility/RayEncoding.h>
 #include <argos3/plugins/simulator/visualizations/webviz/webviz.h>
 
-#include <iomanip>
 #include <nlohmann/json.hpp>
 
 namespace argos {
@@ -23,118 +24,62 @@ namespace argos {
     /****************************************/
     /****************************************/
 
+    /**
+     * @brief Writes the rays and intersection points of the foot-bot, relative
+     * to its body
+     */
+    static void WriteFootbotRays(
+      nlohmann::json& c_json, CFootBotEntity& c_entity) {
+      const SAnchor& sAnchor = c_entity.GetEmbodiedEntity().GetOriginAnchor();
+
+      /*
+       * To make rays relative, negate the rotation of body along Z axis
+       */
+      CQuaternion cInvZRotation = sAnchor.Orientation;
+      cInvZRotation.SetZ(-sAnchor.Orientation.GetZ());
+      const Rays::STransform sToBody =
+        Rays::MakeTransform(sAnchor.Position, cInvZRotation);
+
+      c_json["rays"] = Rays::EncodeRays(
+        c_entity.GetControllableEntity().GetCheckedRays(), sToBody);
+      c_json["points"] = Rays::EncodePoints(
+        c_entity.GetControllableEntity().GetIntersectionPoints(), sToBody);
+    }
+
+    /****************************************/
+    /****************************************/
+
+    /** Appends a hash of the rays and points, for the fingerprint */
+    static void PackFootbotRays(
+      std::string& str_buffer, CFootBotEntity& c_entity) {
+      Rays::PackState(
+        str_buffer,
+        c_entity.GetControllableEntity().GetCheckedRays(),
+        c_entity.GetControllableEntity().GetIntersectionPoints());
+    }
+
+    /****************************************/
+    /****************************************/
+
+    /** Fields of the foot-bot, see utility/EntityFields.h */
+    constexpr auto FOOTBOT_FIELDS = MakeEntityFields<CFootBotEntity>(
+      Fields::Pose([](CFootBotEntity& c_entity) -> const SAnchor& {
+        return c_entity.GetEmbodiedEntity().GetOriginAnchor();
+      }),
+      Fields::LEDs(
+        "leds", [](CFootBotEntity& c_entity) -> CLEDEquippedEntity& {
+          return c_entity.GetLEDEquippedEntity();
+        }),
+      Fields::Custom("rays,points", &WriteFootbotRays, &PackFootbotRays));
+
+    /****************************************/
+    /****************************************/
+
     class CWebvizOperationGenerateFootbotJSON
         : public CWebvizOperationGenerateJSON {
      public:
       nlohmann::json ApplyTo(CWebviz& c_webviz, CFootBotEntity& c_entity) {
-        nlohmann::json cJson;
-
-        cJson["type"] = c_entity.GetTypeDescription();
-        cJson["id"] = c_entity.GetId();
-
-        /* Get the position of the foot-bot */
-        const argos::CVector3& cPosition =
-          c_entity.GetEmbodiedEntity().GetOriginAnchor().Position;
-
-        /* Add it to json as => position:{x, y, z} */
-        cJson["position"]["x"] = cPosition.GetX();
-        cJson["position"]["y"] = cPosition.GetY();
-        cJson["position"]["z"] = cPosition.GetZ();
-
-        /* Get the orientation of the foot-bot */
-        const argos::CQuaternion& cOrientation =
-          c_entity.GetEmbodiedEntity().GetOriginAnchor().Orientation;
-
-        cJson["orientation"]["x"] = cOrientation.GetX();
-        cJson["orientation"]["y"] = cOrientation.GetY();
-        cJson["orientation"]["z"] = cOrientation.GetZ();
-        cJson["orientation"]["w"] = cOrientation.GetW();
-
-        CLEDEquippedEntity& cLEDEquippedEntity =
-          c_entity.GetLEDEquippedEntity();
-
-        if (cLEDEquippedEntity.GetLEDs().size() > 0) {
-          /* Building a string of all led colors */
-          for (UInt32 i = 0; i < 12; i++) {
-            std::stringstream strLEDsStream;
-
-            const CColor& cColor = cLEDEquippedEntity.GetLED(i).GetColor();
-            /* Convert to hex color*/
-            strLEDsStream << "0x" << std::setfill('0') << std::setw(6)
-                          << std::hex
-                          << (cColor.GetRed() << 16 | cColor.GetGreen() << 8 |
-                              cColor.GetBlue());
-
-            cJson["leds"].push_back(strLEDsStream.str());
-          }
-        }
-
-        /* Rays */
-        std::vector<std::pair<bool, CRay3>>& vecRays =
-          c_entity.GetControllableEntity().GetCheckedRays();
-
-        cJson["rays"] = json::array();  // Empty array
-
-        /*
-         * To make rays relative, negate the rotation of body along Z axis
-         */
-        CQuaternion cInvZRotation = cOrientation;
-        cInvZRotation.SetZ(-cOrientation.GetZ());
-
-        /*
-          For each ray as a string,
-          Output format -> "BoolIsChecked:Vec3StartPoint:Vec3EndPoint"
-          For example -> "true:1,2,3:1,2,4"
-        */
-        for (UInt32 i = 0; i < vecRays.size(); ++i) {
-          std::stringstream strRayStream;
-          if (vecRays[i].first) {
-            strRayStream << "true";
-          } else {
-            strRayStream << "false";
-          }
-
-          /* Substract the body position, to get relative position of ray */
-          CVector3 cStartVec = vecRays[i].second.GetStart();
-          cStartVec -= cPosition;
-          CVector3 cEndVec = vecRays[i].second.GetEnd();
-          cEndVec -= cPosition;
-
-          cStartVec.Rotate(cInvZRotation);
-          cEndVec.Rotate(cInvZRotation);
-
-          /* append vectors to string */
-          strRayStream << ":";
-          strRayStream << cStartVec;
-          strRayStream << ":";
-          strRayStream << cEndVec;
-
-          cJson["rays"].push_back(strRayStream.str());
-        }
-
-        std::vector<argos::CVector3>& vecPoints =
-          c_entity.GetControllableEntity().GetIntersectionPoints();
-
-        cJson["points"] = json::array();  // Empty array
-
-        for (UInt32 i = 0; i < vecPoints.size(); ++i) {
-          // NO NOT TAKE IT BY REFERENCE HERE, we are updating them below
-          CVector3 cPoint = vecPoints[i];
-
-          cPoint -= cPosition;
-          cPoint.Rotate(cInvZRotation);
-
-          std::stringstream strPointStream;
-          strPointStream << cPoint.GetX();
-          strPointStream << ",";
-          strPointStream << cPoint.GetY();
-          strPointStream << ",";
-          strPointStream << cPoint.GetZ();
-
-          cJson["points"].push_back(strPointStream.str());
-        }
-
-        return cJson;
+        return FOOTBOT_FIELDS.ToJSON(c_entity);
       }
     };
 
@@ -143,5 +88,20 @@ namespace argos {
       CWebvizOperationGenerateFootbotJSON,
       CFootBotEntity);
 
+    /****************************************/
+    /****************************************/
+
+    /** Unchanged entities reuse their JSON, see CWebvizOperationFingerprint */
+    class CWebvizOperationFingerprintFootbot
+        : public CWebvizOperationFingerprint {
+     public:
+      uint64_t ApplyTo(CWebviz& c_webviz, CFootBotEntity& c_entity) {
+        return FOOTBOT_FIELDS.Fingerprint(c_entity);
+      }
+    };
+
+    REGISTER_WEBVIZ_ENTITY_FINGERPRINT(
+      CWebvizOperationFingerprintFootbot, CFootBotEntity);
+
   }  // namespace Webviz
 }  // namespace argos
\ No newline at end of file
@@ -11,6 +11,7 @@
  */
 
 #include <argos3/plugins/simulator/entities/light_entity.h>
+#include <argos3/plugins/simulator/visualizations/webviz/utility/EntityFields.h>
 #include <argos3/plugins/simulator/visualizations/webviz/webviz.h>
 
 #include <nlohmann/json.hpp>
@@ -21,42 +22,30 @@ namespace argos {
     /****************************************/
     /****************************************/
 
+    /** Fields of the light, see utility/EntityFields.h */
+    constexpr auto LIGHT_FIELDS = MakeEntityFields<CLightEntity>(
+      Fields::Vector(
+        "position",
+        [](CLightEntity& c_entity) -> const CVector3& {
+          return c_entity.GetPosition();
+        }),
+      Fields::Quaternion(
+        "orientation",
+        [](CLightEntity& c_entity) -> const CQuaternion& {
+          return c_entity.GetOrientation();
+        }),
+      Fields::Color("color", [](CLightEntity& c_entity) -> const CColor& {
+        return c_entity.GetColor();
+      }));
+
+    /****************************************/
+    /****************************************/
+
     class CWebvizOperationGenerateLightJSON
         : public CWebvizOperationGenerateJSON {
      public:
       nlohmann::json ApplyTo(CWebviz& c_webviz, CLightEntity& c_entity) {
-        nlohmann::json cJson;
-
-        cJson["type"] = c_entity.GetTypeDescription();
-        cJson["id"] = c_entity.GetId();
-
-        /* Get the position of the box */
-        const argos::CVector3& cPosition = c_entity.GetPosition();
-
-        /* Add it to json as => position:{x, y, z} */
-        cJson["position"]["x"] = cPosition.GetX();
-        cJson["position"]["y"] = cPosition.GetY();
-        cJson["position"]["z"] = cPosition.GetZ();
-
-        /* Get the orientation of the box */
-        const argos::CQuaternion& cOrientation = c_entity.GetOrientation();
-
-        cJson["orientation"]["x"] = cOrientation.GetX();
-        cJson["orientation"]["y"] = cOrientation.GetY();
-        cJson["orientation"]["z"] = cOrientation.GetZ();
-        cJson["orientation"]["w"] = cOrientation.GetW();
-
-        std::stringstream strColorStream;
-
-        const CColor& cColor = c_entity.GetColor();
-        /* Convert to hex color*/
-        strColorStream << "0x" << std::setfill('0') << std::setw(6) << std::hex
-                       << (cColor.GetRed() << 16 | cColor.GetGreen() << 8 |
-                           cColor.GetBlue());
-
-        cJson["color"] = strColorStream.str();
-
-        return cJson;
+        return LIGHT_FIELDS.ToJSON(c_entity);
       }
     };
 
@@ -65,5 +54,20 @@ namespace argos {
       CWebvizOperationGenerateLightJSON,
       CLightEntity);
 
+    /****************************************/
+    /****************************************/
+
+    /** Unchanged entities reuse their JSON, see CWebvizOperationFingerprint */
+    class CWebvizOperationFingerprintLight
+        : public CWebvizOperationFingerprint {
+     public:
+      uint64_t ApplyTo(CWebviz& c_webviz, CLightEntity& c_entity) {
+        return LIGHT_FIELDS.Fingerprint(c_entity);
+      }
+    };
+
+    REGISTER_WEBVIZ_ENTITY_FINGERPRINT(
+      CWebvizOperationFingerprintLight, CLightEntity);
+
   }  // namespace Webviz
 }  // namespace argos
\ No newline at end of file
@@ -0,0 +1,438 @@
+/**
+ * @file <argos3/plugins/simulator/visualizations/webviz/utility/ArrowIPC.h>
+ *
+ * @author Prajankya Sonar - <prajankya@gmail.com>
+ *
+ * @project ARGoS3-Webviz <https://github.com/NESTlab/argos3-webviz>
+ *
+ * MIT License
+ * Copyright (c) 2020 NEST Lab
+ */
+
+#ifndef ARGOS_WEBVIZ_ARROW_IPC_H
+#define ARGOS_WEBVIZ_ARROW_IPC_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace argos {
+  namespace Webviz {
+
+    /**
+     * @brief Minimal FlatBuffers table writer, enough to encode the Arrow IPC
+     * metadata without depending on the FlatBuffers and Arrow libraries.
+     *
+     * Unlike the FlatBuffers builder, the buffer is written front to back:
+     * each table is preceded by its vtable and followed by the objects it
+     * points to.
+     */
+    class CFlatTable {
+     public:
+      template <typename T>
+      CFlatTable& AddScalar(uint16_t un_slot, T t_value) {
+        SField sField(un_slot, EKind::SCALAR);
+        sField.Data.assign(
+          reinterpret_cast<const char*>(&t_value), sizeof(T));
+        m_vecFields.push_back(std::move(sField));
+        return *this;
+      }
+
+      CFlatTable& AddString(uint16_t un_slot, const std::string& str_value) {
+        SField sField(un_slot, EKind::STRING);
+        sField.Data = str_value;
+        m_vecFields.push_back(std::move(sField));
+        return *this;
+      }
+
+      CFlatTable& AddTable(uint16_t un_slot, const CFlatTable& c_table) {
+        SField sField(un_slot, EKind::TABLE);
+        sField.Tables.push_back(c_table);
+        m_vecFields.push_back(std::move(sField));
+        return *this;
+      }
+
+      CFlatTable& AddTables(
+        uint16_t un_slot, const std::vector<CFlatTable>& vec_tables) {
+        SField sField(un_slot, EKind::TABLES);
+        sField.Tables = vec_tables;
+        m_vecFields.push_back(std::move(sField));
+        return *this;
+      }
+
+      /**
+       * @brief Adds a vector of structs, given as their raw bytes. The
+       * elements are aligned on 8 bytes
+       */
+      CFlatTable& AddStructs(
+        uint16_t un_slot, const std::string& str_bytes, uint32_t un_count) {
+        SField sField(un_slot, EKind::STRUCTS);
+        sField.Data = str_bytes;
+        sField.Count = un_count;
+        m_vecFields.push_back(std::move(sField));
+        return *this;
+      }
+
+      /****************************************/
+      /****************************************/
+
+      /**
+       * @brief Serializes the table as the root of a buffer, padded to a
+       * multiple of 8 bytes
+       */
+      std::string Finish() const {
+        std::string strBuffer(4, '\0');
+        size_t unRoot = Write(strBuffer);
+        PutAt<uint32_t>(strBuffer, 0, static_cast<uint32_t>(unRoot));
+        Align(strBuffer, 8);
+        return strBuffer;
+      }
+
+      /****************************************/
+      /****************************************/
+
+      template <typename T>
+      static void PutAt(std::string& str_buffer, size_t un_pos, T t_value) {
+        std::memcpy(&str_buffer[un_pos], &t_value, sizeof(T));
+      }
+
+      template <typename T>
+      static void Append(std::string& str_buffer, T t_value) {
+        str_buffer.append(reinterpret_cast<const char*>(&t_value), sizeof(T));
+      }
+
+      static void Align(std::string& str_buffer, size_t un_alignment) {
+        while (str_buffer.size() % un_alignment != 0) {
+          str_buffer.push_back('\0');
+        }
+      }
+
+     private:
+      enum class EKind { SCALAR, STRING, TABLE, TABLES, STRUCTS };
+
+      struct SField {
+        SField(uint16_t un_slot, EKind e_kind)
+            : Slot(un_slot), Kind(e_kind), Count(0) {}
+
+        uint16_t Slot;
+        EKind Kind;
+        /** Scalar value, string or raw struct bytes */
+        std::string Data;
+        uint32_t Count;
+        std::vector<CFlatTable> Tables;
+      };
+
+      /****************************************/
+      /****************************************/
+
+      /** Writes the vtable, the table, then its children. Returns the
+       * position of the table */
+      size_t Write(std::string& str_buffer) const {
+        uint16_t unSlots = 0;
+        for (const auto& sField : m_vecFields) {
+          unSlots = std::max<uint16_t>(unSlots, sField.Slot + 1);
+        }
+
+        Align(str_buffer, 2);
+        size_t unVTable = str_buffer.size();
+        str_buffer.append(4 + 2 * unSlots, '\0');
+
+        Align(str_buffer, 8);
+        size_t unTable = str_buffer.size();
+        str_buffer.append(4, '\0');
+
+        /* Inline fields, each aligned on its own size */
+        std::vector<size_t> vecPositions;
+        for (const auto& sField : m_vecFields) {
+          size_t unSize =
+            sField.Kind == EKind::SCALAR ? sField.Data.size() : 4;
+          Align(str_buffer, unSize);
+          vecPositions.push_back(str_buffer.size());
+          PutAt<uint16_t>(
+            str_buffer,
+            unVTable + 4 + 2 * sField.Slot,
+            static_cast<uint16_t>(str_buffer.size() - unTable));
+          if (sField.Kind == EKind::SCALAR) {
+            str_buffer.append(sField.Data);
+          } else {
+            str_buffer.append(4, '\0');
+          }
+        }
+
+        PutAt<uint16_t>(str_buffer, unVTable, 4 + 2 * unSlots);
+        PutAt<uint16_t>(
+          str_buffer,
+          unVTable + 2,
+          static_cast<uint16_t>(str_buffer.size() - unTable));
+        PutAt<int32_t>(
+          str_buffer, unTable, static_cast<int32_t>(unTable - unVTable));
+
+        /* Objects pointed to, always after the offsets to them */
+        for (size_t i = 0; i < m_vecFields.size(); ++i) {
+          if (m_vecFields[i].Kind == EKind::SCALAR) {
+            continue;
+          }
+          size_t unChild = WriteChild(str_buffer, m_vecFields[i]);
+          PutAt<uint32_t>(
+            str_buffer,
+            vecPositions[i],
+            static_cast<uint32_t>(unChild - vecPositions[i]));
+        }
+        return unTable;
+      }
+
+      /****************************************/
+      /****************************************/
+
+      static size_t WriteChild(std::string& str_buffer, const SField& s_field) {
+        size_t unPos;
+        switch (s_field.Kind) {
+          case EKind::STRING:
+            Align(str_buffer, 4);
+            unPos = str_buffer.size();
+            Append<uint32_t>(
+              str_buffer, static_cast<uint32_t>(s_field.Data.size()));
+            str_buffer.append(s_field.Data);
+            str_buffer.push_back('\0');
+            return unPos;
+
+          case EKind::STRUCTS:
+            /* Length on 4 bytes, then elements aligned on 8 */
+            while ((str_buffer.size() + 4) % 8 != 0) {
+              str_buffer.push_back('\0');
+            }
+            unPos = str_buffer.size();
+            Append<uint32_t>(str_buffer, s_field.Count);
+            str_buffer.append(s_field.Data);
+            return unPos;
+
+          case EKind::TABLE:
+            return s_field.Tables[0].Write(str_buffer);
+
+          case EKind::TABLES:
+          default:
+            Align(str_buffer, 4);
+            unPos = str_buffer.size();
+            Append<uint32_t>(
+              str_buffer, static_cast<uint32_t>(s_field.Tables.size()));
+            str_buffer.append(4 * s_field.Tables.size(), '\0');
+            for (size_t i = 0; i < s_field.Tables.size(); ++i) {
+              size_t unOffset = unPos + 4 + 4 * i;
+              size_t unChild = s_field.Tables[i].Write(str_buffer);
+              PutAt<uint32_t>(
+                str_buffer,
+                unOffset,
+                static_cast<uint32_t>(unChild - unOffset));
+            }
+            return unPos;
+        }
+      }
+
+     private:
+      std::vector<SField> m_vecFields;
+    };
+
+    /****************************************/
+    /****************************************/
+
+    /** Column types supported by the Arrow encoder */
+    enum class EArrowType { UINT64, FLOAT64, UTF8 };
+
+    /**
+     * @brief A column of an Arrow record batch, without nulls
+     */
+    class CArrowColumn {
+     public:
+      CArrowColumn(const std::string& str_name, EArrowType e_type)
+          : m_strName(str_name), m_eType(e_type), m_vecOffsets{0} {}
+
+      const std::string& GetName() const { return m_strName; }
+
+      EArrowType GetType() const { return m_eType; }
+
+      size_t GetLength() const {
+        return m_eType == EArrowType::UTF8 ? m_vecOffsets.size() - 1
+                                           : m_strData.size() / 8;
+      }
+
+      /****************************************/
+      /****************************************/
+
+      void Append(uint64_t un_value) {
+        CFlatTable::Append<uint64_t>(m_strData, un_value);
+      }
+
+      void Append(double f_value) {
+        CFlatTable::Append<double>(m_strData, f_value);
+      }
+
+      void Append(const std::string& str_value) {
+        m_strData.append(str_value);
+        m_vecOffsets.push_back(static_cast<int32_t>(m_strData.size()));
+      }
+
+      void Clear() {
+        m_strData.clear();
+        m_vecOffsets.assign(1, 0);
+      }
+
+      /****************************************/
+      /****************************************/
+
+      /** Values, or characters for UTF8 */
+      const std::string& GetData() const { return m_strData; }
+
+      /** Offsets of the strings in the characters, for UTF8 */
+      const std::vector<int32_t>& GetOffsets() const { return m_vecOffsets; }
+
+     private:
+      std::string m_strName;
+      EArrowType m_eType;
+      std::string m_strData;
+      std::vector<int32_t> m_vecOffsets;
+    };
+
+    /****************************************/
+    /****************************************/
+
+    /**
+     * @brief Encoder of the Arrow IPC streaming format: a schema message,
+     * record batch messages, then an end-of-stream marker. The output reads
+     * with pyarrow.ipc.open_stream() or polars.read_ipc_stream().
+     */
+    class CArrowStreamEncoder {
+     public:
+      /** Schema message of the columns */
+      static std::string EncodeSchema(
+        const std::vector<CArrowColumn>& vec_columns) {
+        std::vector<CFlatTable> vecFields;
+        for (const auto& cColumn : vec_columns) {
+          CFlatTable cType;
+          uint8_t unTypeType;
+          switch (cColumn.GetType()) {
+            case EArrowType::UINT64:
+              unTypeType = TYPE_INT;
+              cType.AddScalar<int32_t>(0, 64).AddScalar<uint8_t>(1, 0);
+              break;
+            case EArrowType::FLOAT64:
+              unTypeType = TYPE_FLOATING_POINT;
+              cType.AddScalar<int16_t>(0, PRECISION_DOUBLE);
+              break;
+            case EArrowType::UTF8:
+            default:
+              unTypeType = TYPE_UTF8;
+              break;
+          }
+
+          CFlatTable cField;
+          cField.AddString(0, cColumn.GetName())
+            .AddScalar<uint8_t>(1, 0)  // Not nullable
+            .AddScalar<uint8_t>(2, unTypeType)
+            .AddTable(3, cType)
+            .AddTables(5, {});  // No children, but required by readers
+          vecFields.push_back(std::move(cField));
+        }
+
+        CFlatTable cSchema;
+        cSchema.AddScalar<int16_t>(0, 0)  // Little endian
+          .AddTables(1, vecFields);
+
+        return EncodeMessage(HEADER_SCHEMA, cSchema, std::string());
+      }
+
+      /****************************************/
+      /****************************************/
+
+      /** Record batch message with the current content of the columns */
+      static std::string EncodeRecordBatch(
+        const std::vector<CArrowColumn>& vec_columns) {
+        uint64_t unRows = vec_columns.empty() ? 0 : vec_columns[0].GetLength();
+
+        std::string strNodes;
+        std::string strBuffers;
+        uint32_t unBuffers = 0;
+        std::string strBody;
+
+        auto fnAddBuffer = [&](const char* pc_data, size_t un_size) {
+          CFlatTable::Append<int64_t>(strBuffers, strBody.size());
+          CFlatTable::Append<int64_t>(strBuffers, un_size);
+          strBody.append(pc_data, un_size);
+          CFlatTable::Align(strBody, 8);
+          ++unBuffers;
+        };
+
+        for (const auto& cColumn : vec_columns) {
+          CFlatTable::Append<int64_t>(strNodes, cColumn.GetLength());
+          CFlatTable::Append<int64_t>(strNodes, 0);  // No nulls
+
+          /* Validity bitmap, empty without nulls */
+          fnAddBuffer(nullptr, 0);
+          if (cColumn.GetType() == EArrowType::UTF8) {
+            fnAddBuffer(
+              reinterpret_cast<const char*>(cColumn.GetOffsets().data()),
+              cColumn.GetOffsets().size() * sizeof(int32_t));
+          }
+          fnAddBuffer(cColumn.GetData().data(), cColumn.GetData().size());
+        }
+
+        CFlatTable cRecordBatch;
+        cRecordBatch.AddScalar<int64_t>(0, unRows)
+          .AddStructs(
+            1, strNodes, static_cast<uint32_t>(vec_columns.size()))
+          .AddStructs(2, strBuffers, unBuffers);
+
+        return EncodeMessage(HEADER_RECORD_BATCH, cRecordBatch, strBody);
+      }
+
+      /****************************************/
+      /****************************************/
+
+      /** Marker closing the stream */
+      static std::string EncodeEndOfStream() {
+        std::string strEnd;
+        CFlatTable::Append<uint32_t>(strEnd, CONTINUATION);
+        CFlatTable::Append<int32_t>(strEnd, 0);
+        return strEnd;
+      }
+
+     private:
+      /** Encapsulated message: continuation marker, metadata length,
+       * metadata (padded to 8 bytes), then body */
+      static std::string EncodeMessage(
+        uint8_t un_header_type,
+        const CFlatTable& c_header,
+        const std::string& str_body) {
+        CFlatTable cMessage;
+        cMessage.AddScalar<int16_t>(0, METADATA_V5)
+          .AddScalar<uint8_t>(1, un_header_type)
+          .AddTable(2, c_header)
+          .AddScalar<int64_t>(3, str_body.size());
+        std::string strMetadata = cMessage.Finish();
+
+        std::string strMessage;
+        CFlatTable::Append<uint32_t>(strMessage, CONTINUATION);
+        CFlatTable::Append<int32_t>(
+          strMessage, static_cast<int32_t>(strMetadata.size()));
+        strMessage.append(strMetadata);
+        strMessage.append(str_body);
+        return strMessage;
+      }
+
+     private:
+      /* Values from the Arrow format definitions (Schema.fbs, Message.fbs) */
+      static constexpr uint32_t CONTINUATION = 0xFFFFFFFF;
+      static constexpr int16_t METADATA_V5 = 4;
+      static constexpr uint8_t HEADER_SCHEMA = 1;
+      static constexpr uint8_t HEADER_RECORD_BATCH = 3;
+      static constexpr uint8_t TYPE_INT = 2;
+      static constexpr uint8_t TYPE_FLOATING_POINT = 3;
+      static constexpr uint8_t TYPE_UTF8 = 5;
+      static constexpr int16_t PRECISION_DOUBLE = 2;
+    };
+  }  // namespace Webviz
+}  // namespace argos
+
+#endif
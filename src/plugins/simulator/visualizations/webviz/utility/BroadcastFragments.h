@@ -0,0 +1,163 @@
+/**
+ * @file
+ * <argos3/plugins/simulator/visualizations/webviz/utility/BroadcastFragments.h>
+ *
+ * @author Prajankya Sonar - <prajankya@gmail.com>
+ *
+ * @project ARGoS3-Webviz <https://github.com/NESTlab/argos3-webviz>
+ *
+ * MIT License
+ * Copyright (c) 2020 NEST Lab
+ */
+
+#ifndef ARGOS_WEBVIZ_BROADCAST_FRAGMENTS_H
+#define ARGOS_WEBVIZ_BROADCAST_FRAGMENTS_H
+
+#include <cstdint>
+#include <nlohmann/json.hpp>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "BroadcastSettings.h"
+#include "FragmentCache.h"
+#include "LEDChanges.h"
+
+namespace argos {
+  namespace Webviz {
+
+    /**
+     * @brief Entity of a frame reused from a fragment cache, handed to the
+     * broadcaster with the frame instead of being copied in it. The frame
+     * has null at its place
+     */
+    struct SSharedFragment {
+      /** Index of the entity in the "entities" of the frame */
+      size_t Index;
+
+      /** Fingerprint of the state of the entity, see CFragmentCache */
+      uint64_t Fingerprint;
+
+      CFragmentCache::TFragment JSON;
+    };
+
+    typedef std::vector<SSharedFragment> TSharedFragments;
+
+    /****************************************/
+    /****************************************/
+
+    /**
+     * @brief Entities of the broadcasts as sent, once the broadcast
+     * settings were applied, serialized once and reused while their
+     * fingerprint and the settings are the same.
+     *
+     * Entities which stay still are then neither copied, processed nor
+     * serialized again: their text is spliced in the frames. Entities with
+     * LEDs are kept with and without their colors, so CLEDChanges still
+     * decides which ones carry them. Only used by the broadcaster thread.
+     */
+    class CBroadcastFragments {
+     public:
+      /** Entity as sent */
+      struct SFragment {
+        uint64_t Fingerprint = 0;
+
+        /** Settings it was processed with */
+        SBroadcastSettings Settings;
+
+        /** False if it has no "leds", WithoutLEDs is then empty */
+        bool HasLEDs = false;
+
+        /** CLEDChanges::Hash() of its "leds" */
+        uint64_t LEDHash = 0;
+
+        std::string WithLEDs;
+
+        std::string WithoutLEDs;
+      };
+
+      /****************************************/
+      /****************************************/
+
+      /**
+       * @brief Forgets all the entities, e.g. when their handles changed
+       */
+      void Clear() { m_mapFragments.clear(); }
+
+      /****************************************/
+      /****************************************/
+
+      /**
+       * @brief Returns an entity as sent, processed and serialized if it
+       * was not with the same fingerprint and settings
+       *
+       * @param str_id id of the entity
+       * @param un_fingerprint fingerprint of its state
+       * @param s_settings broadcast settings
+       * @param c_entity entity, as serialized by the simulation
+       * @param fn_process applies the settings to a copy of the entity,
+       * but for the LED colors
+       * @return the entity, valid until the next Clear()
+       */
+      template <typename PROCESS_FUNCTION>
+      const SFragment& Get(
+        const std::string& str_id,
+        uint64_t un_fingerprint,
+        const SBroadcastSettings& s_settings,
+        const nlohmann::json& c_entity,
+        PROCESS_FUNCTION fn_process) {
+        SFragment& sFragment = m_mapFragments[str_id];
+        if (
+          !sFragment.WithLEDs.empty() &&
+          sFragment.Fingerprint == un_fingerprint &&
+          IsSameProcessing(sFragment.Settings, s_settings)) {
+          ++m_unHits;
+          return sFragment;
+        }
+        ++m_unMisses;
+
+        nlohmann::json cEntity = c_entity;
+        fn_process(cEntity);
+        sFragment.Fingerprint = un_fingerprint;
+        sFragment.Settings = s_settings;
+        sFragment.WithLEDs = cEntity.dump();
+        auto itLEDs = cEntity.find("leds");
+        sFragment.HasLEDs = itLEDs != cEntity.end();
+        if (sFragment.HasLEDs) {
+          sFragment.LEDHash = CLEDChanges::Hash(*itLEDs);
+          cEntity.erase(itLEDs);
+          sFragment.WithoutLEDs = cEntity.dump();
+        } else {
+          sFragment.WithoutLEDs.clear();
+        }
+        return sFragment;
+      }
+
+      /****************************************/
+      /****************************************/
+
+      /** Entities whose text was reused */
+      uint64_t GetHits() const { return m_unHits; }
+
+      /** Entities which were processed and serialized */
+      uint64_t GetMisses() const { return m_unMisses; }
+
+     private:
+      /** True if the settings change nothing to the entities sent */
+      static bool IsSameProcessing(
+        const SBroadcastSettings& s_a, const SBroadcastSettings& s_b) {
+        return s_a.Detail == s_b.Detail && s_a.Precision == s_b.Precision &&
+               s_a.Handles == s_b.Handles && s_a.HalfRays == s_b.HalfRays;
+      }
+
+      /** Entities per id */
+      std::unordered_map<std::string, SFragment> m_mapFragments;
+
+      uint64_t m_unHits = 0;
+
+      uint64_t m_unMisses = 0;
+    };
+  }  // namespace Webviz
+}  // namespace argos
+
+#endif
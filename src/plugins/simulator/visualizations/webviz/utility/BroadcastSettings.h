@@ -0,0 +1,249 @@
+/**
+ * @file
+ * <argos3/plugins/simulator/visualizations/webviz/utility/BroadcastSettings.h>
+ *
+ * @author Prajankya Sonar - <prajankya@gmail.com>
+ *
+ * @project ARGoS3-Webviz <https://github.com/NESTlab/argos3-webviz>
+ *
+ * MIT License
+ * Copyright (c) 2020 NEST Lab
+ */
+
+#ifndef ARGOS_WEBVIZ_BROADCAST_SETTINGS_H
+#define ARGOS_WEBVIZ_BROADCAST_SETTINGS_H
+
+#include <cmath>
+#include <cstdint>
+#include <mutex>
+#include <nlohmann/json.hpp>
+#include <string>
+
+namespace argos {
+  namespace Webviz {
+
+    /** Fields of the entities sent to the clients */
+    enum class EBroadcastDetail {
+      /** Everything the entity serializers produce */
+      FULL = 0,
+      /** Without the rays, intersection points and debug values */
+      LEAN,
+      /** Only the id, type, position and orientation */
+      POSE
+    };
+
+    inline std::string EBroadcastDetailToStr(EBroadcastDetail e_detail) {
+      switch (e_detail) {
+        case EBroadcastDetail::FULL:
+          return "full";
+        case EBroadcastDetail::LEAN:
+          return "lean";
+        case EBroadcastDetail::POSE:
+          return "pose";
+        default:
+          return "unknown";
+      }
+    }
+
+    /****************************************/
+    /****************************************/
+
+    /** Parameters of the broadcasts which can change while running */
+    struct SBroadcastSettings {
+      /** Broadcast cycles per second, in [1,1000] */
+      uint16_t Frequency = 10;
+
+      /** Steps between frames in fast-forward, in [1,1000] */
+      uint16_t DrawFramesEvery = 2;
+
+      /** Compress the broadcasts (permessage-deflate) */
+      bool Compress = true;
+
+      EBroadcastDetail Detail = EBroadcastDetail::FULL;
+
+      /** Decimals of the numbers of the entities, -1 for all */
+      int Precision = -1;
+
+      /** Entities referenced by their handle "h" instead of "id" and
+       * "type", which are sent in the manifest */
+      bool Handles = false;
+
+      /** Rays and intersection points sent as float16 instead of float32 */
+      bool HalfRays = false;
+    };
+
+    /****************************************/
+    /****************************************/
+
+    /**
+     * @brief Removes the fields of an entity which are not part of the
+     * detail level
+     */
+    inline void ApplyBroadcastDetail(
+      nlohmann::json& c_entity, EBroadcastDetail e_detail) {
+      if (e_detail == EBroadcastDetail::LEAN) {
+        c_entity.erase("rays");
+        c_entity.erase("points");
+        c_entity.erase("debug");
+      } else if (e_detail == EBroadcastDetail::POSE) {
+        nlohmann::json cPose;
+        for (const char* pchKey : {"type", "id", "position", "orientation"}) {
+          if (c_entity.contains(pchKey)) {
+            cPose[pchKey] = std::move(c_entity[pchKey]);
+          }
+        }
+        c_entity = std::move(cPose);
+      }
+    }
+
+    /****************************************/
+    /****************************************/
+
+    /**
+     * @brief Rounds all the floating point numbers of a JSON value, so they
+     * are serialized with fewer digits
+     *
+     * @param c_json value, rounded in place
+     * @param n_precision number of decimals, nothing is done if negative
+     */
+    inline void RoundNumbers(nlohmann::json& c_json, int n_precision) {
+      if (n_precision < 0) {
+        return;
+      }
+      if (c_json.is_number_float()) {
+        const double fScale = std::pow(10.0, n_precision);
+        c_json = std::round(c_json.get<double>() * fScale) / fScale;
+      } else if (c_json.is_structured()) {
+        for (auto& cChild : c_json) {
+          RoundNumbers(cChild, n_precision);
+        }
+      }
+    }
+
+    /****************************************/
+    /****************************************/
+
+    /**
+     * @brief Thread-safe broadcast settings, changed by the clients with the
+     * "configure" command and read by the simulation and broadcaster threads
+     */
+    class CBroadcastSettings {
+     public:
+      SBroadcastSettings Get() const {
+        std::lock_guard<std::mutex> guard(m_mutex4Settings);
+        return m_sSettings;
+      }
+
+      void Set(const SBroadcastSettings& s_settings) {
+        std::lock_guard<std::mutex> guard(m_mutex4Settings);
+        m_sSettings = s_settings;
+      }
+
+      /****************************************/
+      /****************************************/
+
+      nlohmann::json ToJSON() const {
+        SBroadcastSettings sSettings = Get();
+        nlohmann::json cJson;
+        cJson["broadcast_frequency"] = sSettings.Frequency;
+        cJson["ff_draw_frames_every"] = sSettings.DrawFramesEvery;
+        cJson["compression"] = sSettings.Compress;
+        cJson["detail"] = EBroadcastDetailToStr(sSettings.Detail);
+        cJson["precision"] = sSettings.Precision;
+        cJson["handles"] = sSettings.Handles;
+        cJson["ray_format"] = sSettings.HalfRays ? "float16" : "float32";
+        return cJson;
+      }
+
+      /****************************************/
+      /****************************************/
+
+      /**
+       * @brief Validates and applies the settings present in c_changes,
+       * named as ToJSON() names them. Nothing is changed if any is invalid
+       *
+       * @return std::string error message, empty on success
+       */
+      std::string Update(const nlohmann::json& c_changes) {
+        if (!c_changes.is_object()) {
+          return "Settings must be a JSON object";
+        }
+
+        std::lock_guard<std::mutex> guard(m_mutex4Settings);
+        SBroadcastSettings sSettings = m_sSettings;
+
+        for (auto it = c_changes.begin(); it != c_changes.end(); ++it) {
+          const std::string& strKey = it.key();
+          const nlohmann::json& cValue = it.value();
+
+          if (strKey == "broadcast_frequency") {
+            if (
+              !cValue.is_number_integer() || cValue.get<int64_t>() < 1 ||
+              cValue.get<int64_t>() > 1000) {
+              return "\"broadcast_frequency\" is out of range [1,1000]";
+            }
+            sSettings.Frequency = cValue.get<uint16_t>();
+          } else if (strKey == "ff_draw_frames_every") {
+            if (
+              !cValue.is_number_integer() || cValue.get<int64_t>() < 1 ||
+              cValue.get<int64_t>() > 1000) {
+              return "\"ff_draw_frames_every\" is out of range [1,1000]";
+            }
+            sSettings.DrawFramesEvery = cValue.get<uint16_t>();
+          } else if (strKey == "compression") {
+            if (!cValue.is_boolean()) {
+              return "\"compression\" must be true or false";
+            }
+            sSettings.Compress = cValue.get<bool>();
+          } else if (strKey == "detail") {
+            const std::string strDetail =
+              cValue.is_string() ? cValue.get<std::string>() : "";
+            if (strDetail == "full") {
+              sSettings.Detail = EBroadcastDetail::FULL;
+            } else if (strDetail == "lean") {
+              sSettings.Detail = EBroadcastDetail::LEAN;
+            } else if (strDetail == "pose") {
+              sSettings.Detail = EBroadcastDetail::POSE;
+            } else {
+              return "\"detail\" must be \"full\", \"lean\" or \"pose\"";
+            }
+          } else if (strKey == "precision") {
+            if (
+              !cValue.is_number_integer() || cValue.get<int64_t>() < -1 ||
+              cValue.get<int64_t>() > 15) {
+              return "\"precision\" is out of range [-1,15]";
+            }
+            sSettings.Precision = cValue.get<int>();
+          } else if (strKey == "handles") {
+            if (!cValue.is_boolean()) {
+              return "\"handles\" must be true or false";
+            }
+            sSettings.Handles = cValue.get<bool>();
+          } else if (strKey == "ray_format") {
+            const std::string strFormat =
+              cValue.is_string() ? cValue.get<std::string>() : "";
+            if (strFormat != "float32" && strFormat != "float16") {
+              return "\"ray_format\" must be \"float32\" or \"float16\"";
+            }
+            sSettings.HalfRays = (strFormat == "float16");
+          } else if (
+            strKey == "port" || strKey.compare(0, 4, "ssl_") == 0) {
+            return "\"" + strKey + "\" can not be changed without a restart";
+          } else {
+            return "Unknown setting \"" + strKey + "\"";
+          }
+        }
+
+        m_sSettings = sSettings;
+        return "";
+      }
+
+     private:
+      SBroadcastSettings m_sSettings;
+
+      mutable std::mutex m_mutex4Settings;
+    };
+  }  // namespace Webviz
+}  // namespace argos
+
+#endif
@@ -0,0 +1,284 @@
+/**
+ * @file
+ * <argos3/plugins/simulator/visualizations/webviz/utility/BroadcastTopics.h>
+ *
+ * @author Prajankya Sonar - <prajankya@gmail.com>
+ *
+ * @project ARGoS3-Webviz <https://github.com/NESTlab/argos3-webviz>
+ *
+ * MIT License
+ * Copyright (c) 2020 NEST Lab
+ */
+
+#ifndef ARGOS_WEBVIZ_BROADCAST_TOPICS_H
+#define ARGOS_WEBVIZ_BROADCAST_TOPICS_H
+
+#include <map>
+#include <mutex>
+#include <set>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace argos {
+  namespace Webviz {
+
+    /** Topic carrying the state of all the entities */
+    inline const std::string BROADCAST_TOPIC = "broadcasts";
+
+    /** Prefix of the topics carrying one entity type, e.g. broadcasts/box */
+    inline const std::string BROADCAST_TYPE_TOPIC_PREFIX = "broadcasts/";
+
+    /** Prefix of the topics carrying one user-defined group of entities */
+    inline const std::string BROADCAST_GROUP_TOPIC_PREFIX =
+      "broadcasts/groups/";
+
+    /** True for "broadcasts" and all the type and group broadcast topics */
+    inline bool IsBroadcastTopic(const std::string& str_topic) {
+      return str_topic == BROADCAST_TOPIC ||
+             str_topic.compare(
+               0,
+               BROADCAST_TYPE_TOPIC_PREFIX.size(),
+               BROADCAST_TYPE_TOPIC_PREFIX) == 0;
+    }
+
+    /****************************************/
+    /****************************************/
+
+    /**
+     * @brief A set of entities selected by type and/or by id prefix, as
+     * defined by the user in the configuration file
+     */
+    struct SEntityGroup {
+      /** Name of the group, used in the topic name */
+      std::string Name;
+
+      /** Entity types in the group, all types if empty */
+      std::set<std::string> Types;
+
+      /** Prefix of the entity ids in the group, all ids if empty */
+      std::string IdPrefix;
+
+      /**
+       * @brief Returns true if the entity belongs to the group
+       *
+       * @param str_type entity type description, e.g. "foot-bot"
+       * @param str_id entity id
+       */
+      bool Contains(const std::string& str_type, const std::string& str_id)
+        const {
+        if (!Types.empty() && Types.count(str_type) == 0) {
+          return false;
+        }
+        return str_id.compare(0, IdPrefix.size(), IdPrefix) == 0;
+      }
+
+      /**
+       * @brief Parses a comma separated list of types, e.g. "foot-bot,box"
+       */
+      static std::set<std::string> ParseTypes(const std::string& str_types) {
+        std::set<std::string> setTypes;
+        std::stringstream strStream(str_types);
+        std::string strToken;
+        while (std::getline(strStream, strToken, ',')) {
+          if (!strToken.empty()) {
+            setTypes.insert(strToken);
+          }
+        }
+        return setTypes;
+      }
+    };
+
+    /****************************************/
+    /****************************************/
+
+    /**
+     * @brief Thread-safe count of the live subscribers of each topic
+     */
+    class CTopicSubscriptions {
+     public:
+      void Subscribe(const std::string& str_topic) {
+        std::lock_guard<std::mutex> guard(m_mutex4Subscribers);
+        ++m_mapSubscribers[str_topic];
+      }
+
+      /****************************************/
+      /****************************************/
+
+      void Unsubscribe(const std::string& str_topic) {
+        std::lock_guard<std::mutex> guard(m_mutex4Subscribers);
+        auto itTopic = m_mapSubscribers.find(str_topic);
+        if (itTopic != m_mapSubscribers.end() && --itTopic->second == 0) {
+          m_mapSubscribers.erase(itTopic);
+        }
+      }
+
+      /****************************************/
+      /****************************************/
+
+      size_t GetSubscribers(const std::string& str_topic) const {
+        std::lock_guard<std::mutex> guard(m_mutex4Subscribers);
+        auto itTopic = m_mapSubscribers.find(str_topic);
+        return itTopic != m_mapSubscribers.end() ? itTopic->second : 0;
+      }
+
+      /****************************************/
+      /****************************************/
+
+      /** Copy of the counts, only topics with subscribers are present */
+      std::map<std::string, size_t> GetSnapshot() const {
+        std::lock_guard<std::mutex> guard(m_mutex4Subscribers);
+        return m_mapSubscribers;
+      }
+
+     private:
+      std::map<std::string, size_t> m_mapSubscribers;
+
+      mutable std::mutex m_mutex4Subscribers;
+    };
+
+    /****************************************/
+    /****************************************/
+
+    /**
+     * @brief Decides which entities have to be serialized, and on which
+     * broadcast topics they are published, from a snapshot of the
+     * subscriptions.
+     *
+     * Type topics ("broadcasts/<type>") need no configuration, group topics
+     * ("broadcasts/groups/<name>") must match a configured group.
+     */
+    class CBroadcastFilter {
+     public:
+      CBroadcastFilter() : m_bAllEntities(false) {}
+
+      CBroadcastFilter(
+        const std::map<std::string, size_t>& map_subscribers,
+        const std::vector<SEntityGroup>& vec_groups)
+          : m_bAllEntities(map_subscribers.count(BROADCAST_TOPIC) > 0) {
+        for (const auto& cSubscribed : map_subscribers) {
+          const std::string& strTopic = cSubscribed.first;
+
+          if (
+            strTopic.compare(
+              0,
+              BROADCAST_GROUP_TOPIC_PREFIX.size(),
+              BROADCAST_GROUP_TOPIC_PREFIX) == 0) {
+            /* Group topic, only if such a group was configured */
+            std::string strName =
+              strTopic.substr(BROADCAST_GROUP_TOPIC_PREFIX.size());
+            for (const auto& sGroup : vec_groups) {
+              if (sGroup.Name == strName) {
+                m_vecTopics.emplace_back(strTopic, sGroup);
+                break;
+              }
+            }
+          } else if (
+            strTopic.size() > BROADCAST_TYPE_TOPIC_PREFIX.size() &&
+            strTopic.compare(
+              0,
+              BROADCAST_TYPE_TOPIC_PREFIX.size(),
+              BROADCAST_TYPE_TOPIC_PREFIX) == 0) {
+            /* Type topic, seen as a group of a single type */
+            SEntityGroup sTypeGroup;
+            sTypeGroup.Name =
+              strTopic.substr(BROADCAST_TYPE_TOPIC_PREFIX.size());
+            sTypeGroup.Types.insert(sTypeGroup.Name);
+            m_vecTopics.emplace_back(strTopic, sTypeGroup);
+          }
+        }
+      }
+
+      /****************************************/
+      /****************************************/
+
+      /** True if the whole state is subscribed ("broadcasts" topic) */
+      bool IsAllRequested() const { return m_bAllEntities; }
+
+      /** True if any broadcast topic is subscribed */
+      bool IsAnyRequested() const {
+        return m_bAllEntities || !m_vecTopics.empty();
+      }
+
+      /****************************************/
+      /****************************************/
+
+      /**
+       * @brief Returns true if at least one subscriber wants the entity, so
+       * entities nobody asked for are not serialized at all
+       */
+      bool IsEntityRequested(
+        const std::string& str_type, const std::string& str_id) const {
+        if (m_bAllEntities) {
+          return true;
+        }
+        for (const auto& cTopic : m_vecTopics) {
+          if (cTopic.second.Contains(str_type, str_id)) {
+            return true;
+          }
+        }
+        return false;
+      }
+
+      /****************************************/
+      /****************************************/
+
+      /**
+       * @brief Returns true if any entity of the type may be requested, so
+       * types nobody subscribed to are skipped as a whole
+       *
+       * @param str_type entity type description, e.g. "foot-bot"
+       */
+      bool IsTypeRequested(const std::string& str_type) const {
+        if (m_bAllEntities) {
+          return true;
+        }
+        for (const auto& cTopic : m_vecTopics) {
+          const SEntityGroup& sGroup = cTopic.second;
+          if (sGroup.Types.empty() || sGroup.Types.count(str_type) > 0) {
+            return true;
+          }
+        }
+        return false;
+      }
+
+      /**
+       * @brief Returns true if all the entities of the type are requested,
+       * whatever their ids, so they need no check one by one
+       *
+       * @param str_type entity type description, e.g. "foot-bot"
+       */
+      bool IsWholeTypeRequested(const std::string& str_type) const {
+        if (m_bAllEntities) {
+          return true;
+        }
+        for (const auto& cTopic : m_vecTopics) {
+          const SEntityGroup& sGroup = cTopic.second;
+          if (
+            sGroup.IdPrefix.empty() &&
+            (sGroup.Types.empty() || sGroup.Types.count(str_type) > 0)) {
+            return true;
+          }
+        }
+        return false;
+      }
+
+      /****************************************/
+      /****************************************/
+
+      /** Subscribed type and group topics, with the group they carry */
+      const std::vector<std::pair<std::string, SEntityGroup>>& GetTopics()
+        const {
+        return m_vecTopics;
+      }
+
+     private:
+      bool m_bAllEntities;
+
+      std::vector<std::pair<std::string, SEntityGroup>> m_vecTopics;
+    };
+  }  // namespace Webviz
+}  // namespace argos
+
+#endif
@@ -0,0 +1,140 @@
+/**
+ * @file <argos3/plugins/simulator/visualizations/webviz/utility/DebugSlot.h>
+ *
+ * @author Prajankya Sonar - <prajankya@gmail.com>
+ *
+ * @project ARGoS3-Webviz <https://github.com/NESTlab/argos3-webviz>
+ *
+ * MIT License
+ * Copyright (c) 2020 NEST Lab
+ */
+
+#ifndef ARGOS_WEBVIZ_DEBUG_SLOT_H
+#define ARGOS_WEBVIZ_DEBUG_SLOT_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstring>
+
+namespace argos {
+  namespace Webviz {
+
+    /**
+     * @brief Debug values of one robot, written by its controller at each
+     * step and read by Webviz when it builds a frame.
+     *
+     * The keys and values are stored in place: writing never allocates nor
+     * locks, so it can be done in ControlStep() whatever the number of
+     * threads of the simulation. A single writer (the controller) is
+     * expected; readers see every key with its value from the current or
+     * the previous write. After Clear(), a reader still going through the
+     * previous keys may see the ones written since instead, never a torn
+     * pointer.
+     */
+    class CDebugSlot {
+     public:
+      /** Maximum number of keys of a slot */
+      static constexpr size_t MAX_VALUES = 16;
+
+      /****************************************/
+      /****************************************/
+
+      /**
+       * @brief Sets the value of a key, adding the key the first time
+       *
+       * @param pch_key name of the value. It is not copied, so it must
+       * outlive the slot, e.g. a string literal
+       * @param f_value value
+       * @return false if the slot is full, the value is dropped then
+       */
+      bool Set(const char* pch_key, double f_value) {
+        const size_t unSize = m_unSize.load(std::memory_order_relaxed);
+        for (size_t i = 0; i < unSize; ++i) {
+          /* Same literal first, then same text */
+          const char* pchKey = m_pchKeys[i].load(std::memory_order_relaxed);
+          if (pchKey == pch_key || std::strcmp(pchKey, pch_key) == 0) {
+            m_fValues[i].store(f_value, std::memory_order_relaxed);
+            return true;
+          }
+        }
+        if (unSize >= MAX_VALUES) {
+          return false;
+        }
+        m_pchKeys[unSize].store(pch_key, std::memory_order_relaxed);
+        m_fValues[unSize].store(f_value, std::memory_order_relaxed);
+        /* Readers only see the new key once it is complete */
+        m_unSize.store(unSize + 1, std::memory_order_release);
+        return true;
+      }
+
+      /** Removes all the keys, e.g. when the controller is reset */
+      void Clear() { m_unSize.store(0, std::memory_order_release); }
+
+      /****************************************/
+      /****************************************/
+
+      size_t GetSize() const {
+        return m_unSize.load(std::memory_order_acquire);
+      }
+
+      bool IsEmpty() const { return GetSize() == 0; }
+
+      /**
+       * @brief Calls a function with each key and its value, in the order
+       * they were added
+       *
+       * @param fn_visit called as fn_visit(const char*, double)
+       */
+      template <typename VISIT>
+      void ForEach(VISIT fn_visit) const {
+        const size_t unSize = GetSize();
+        for (size_t i = 0; i < unSize; ++i) {
+          fn_visit(
+            m_pchKeys[i].load(std::memory_order_relaxed),
+            m_fValues[i].load(std::memory_order_relaxed));
+        }
+      }
+
+     private:
+      /** Atomic, as they are written again after Clear() while a reader
+       * may still go through them */
+      std::atomic<const char*> m_pchKeys[MAX_VALUES] = {};
+
+      std::atomic<double> m_fValues[MAX_VALUES] = {};
+
+      std::atomic<size_t> m_unSize{0};
+    };
+
+    /****************************************/
+    /****************************************/
+
+    /**
+     * @brief Base of the controllers exposing debug values to Webviz.
+     *
+     * Webviz finds the slot of each robot once, when the entities are
+     * grouped, and sends its values with the entity.
+     *
+     * @code
+     * class CFootBotDiffusion : public CCI_Controller,
+     *                           public Webviz::CDebugSlotOwner {
+     *   ...
+     *   void ControlStep() {
+     *     ...
+     *     m_cDebugSlot.Set("left_speed", fLeftSpeed);
+     *   }
+     * };
+     * @endcode
+     */
+    class CDebugSlotOwner {
+     public:
+      virtual ~CDebugSlotOwner() = default;
+
+      const CDebugSlot& GetDebugSlot() const { return m_cDebugSlot; }
+
+     protected:
+      CDebugSlot m_cDebugSlot;
+    };
+  }  // namespace Webviz
+}  // namespace argos
+
+#endif
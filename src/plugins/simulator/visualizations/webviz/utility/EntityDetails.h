@@ -0,0 +1,126 @@
+/**
+ * @file
+ * <argos3/plugins/simulator/visualizations/webviz/utility/EntityDetails.h>
+ *
+ * @author Prajankya Sonar - <prajankya@gmail.com>
+ *
+ * @project ARGoS3-Webviz <https://github.com/NESTlab/argos3-webviz>
+ *
+ * MIT License
+ * Copyright (c) 2020 NEST Lab
+ */
+
+#ifndef ARGOS_WEBVIZ_ENTITY_DETAILS_H
+#define ARGOS_WEBVIZ_ENTITY_DETAILS_H
+
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <nlohmann/json.hpp>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace argos {
+  namespace Webviz {
+
+    /**
+     * @brief Pending requests for the full detail of single entities.
+     *
+     * Clients add requests from the webserver threads without waiting; the
+     * simulation thread serves them all at its next frame, building the
+     * detail of each requested entity once, however many clients asked.
+     */
+    class CEntityDetailRequests {
+     public:
+      /** Receives the detail, null if there is no such entity. Called from
+       * the simulation thread, so it must only hand the reply over */
+      typedef std::function<void(const nlohmann::json&)> TReply;
+
+      /** Builds the detail of an entity, null if there is no such entity */
+      typedef std::function<nlohmann::json(const std::string&)> TBuilder;
+
+      /**
+       * @param un_max_pending maximum number of requests waiting, further
+       * ones are refused
+       */
+      explicit CEntityDetailRequests(size_t un_max_pending = 256)
+          : m_unMaxPending(un_max_pending), m_unPending(0), m_bPending(false) {}
+
+      /****************************************/
+      /****************************************/
+
+      /**
+       * @brief Adds a request
+       *
+       * @param str_id id of the entity
+       * @param fn_reply callback receiving the detail
+       * @return false if too many requests are waiting
+       */
+      bool Add(const std::string& str_id, TReply fn_reply) {
+        std::lock_guard<std::mutex> guard(m_mutex4Requests);
+        if (m_unPending >= m_unMaxPending) {
+          return false;
+        }
+        m_mapRequests[str_id].push_back(std::move(fn_reply));
+        ++m_unPending;
+        m_bPending = true;
+        return true;
+      }
+
+      /****************************************/
+      /****************************************/
+
+      /** Lock-free check, so idle frames cost nothing */
+      bool HasPending() const { return m_bPending; }
+
+      /****************************************/
+      /****************************************/
+
+      /**
+       * @brief Builds the detail of the requested entities and replies to
+       * all the requests waiting
+       *
+       * @param fn_builder called once per requested entity
+       * @return size_t number of entities built
+       */
+      size_t Serve(const TBuilder& fn_builder) {
+        if (!m_bPending) {
+          return 0;
+        }
+
+        /* Taken out, so new requests are not blocked while building */
+        std::unordered_map<std::string, std::vector<TReply>> mapRequests;
+        {
+          std::lock_guard<std::mutex> guard(m_mutex4Requests);
+          mapRequests.swap(m_mapRequests);
+          m_unPending = 0;
+          m_bPending = false;
+        }
+
+        for (const auto& cRequest : mapRequests) {
+          const nlohmann::json cDetail = fn_builder(cRequest.first);
+          for (const auto& fnReply : cRequest.second) {
+            fnReply(cDetail);
+          }
+        }
+        return mapRequests.size();
+      }
+
+     private:
+      size_t m_unMaxPending;
+
+      /** Replies waiting, by entity id */
+      std::unordered_map<std::string, std::vector<TReply>> m_mapRequests;
+
+      size_t m_unPending;
+
+      std::atomic<bool> m_bPending;
+
+      std::mutex m_mutex4Requests;
+    };
+  }  // namespace Webviz
+}  // namespace argos
+
+#endif
@@ -0,0 +1,529 @@
+/**
+ * @file
+ * <argos3/plugins/simulator/visualizations/webviz/utility/EntityFields.h>
+ *
+ * @author Prajankya Sonar - <prajankya@gmail.com>
+ *
+ * @project ARGoS3-Webviz <https://github.com/NESTlab/argos3-webviz>
+ *
+ * MIT License
+ * Copyright (c) 2020 NEST Lab
+ */
+
+#ifndef ARGOS_WEBVIZ_ENTITY_FIELDS_H
+#define ARGOS_WEBVIZ_ENTITY_FIELDS_H
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <nlohmann/json.hpp>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace argos {
+  namespace Webviz {
+
+    /**
+     * @brief Field descriptors of the entity serializers.
+     *
+     * An entity serializer declares its fields once, as a constexpr list of
+     * descriptors, each with a key and a getter (usually a lambda). The
+     * JSON writer, the binary packer, the change detection and the schema
+     * all come from that single list, see CEntityFields.
+     *
+     * Getters take the entity by reference, and return types are only used
+     * through their methods (GetX(), GetRed(), GetLEDs(), ...), so this
+     * works with the ARGoS types without depending on them.
+     */
+    namespace Fields {
+
+      /** Appends the bytes of a value, in the byte order of the host */
+      template <typename T>
+      void PackBytes(std::string& str_buffer, const T& t_value) {
+        char pchBytes[sizeof(T)];
+        std::memcpy(pchBytes, &t_value, sizeof(T));
+        str_buffer.append(pchBytes, sizeof(T));
+      }
+
+      /**
+       * @brief Packs a scalar: bools as uint8, numbers as float64 and
+       * strings as their uint32 length and bytes
+       */
+      template <typename T>
+      void PackScalar(std::string& str_buffer, const T& t_value) {
+        if constexpr (std::is_same<T, bool>::value) {
+          PackBytes(str_buffer, static_cast<uint8_t>(t_value));
+        } else if constexpr (std::is_arithmetic<T>::value) {
+          PackBytes(str_buffer, static_cast<double>(t_value));
+        } else {
+          const std::string strValue(t_value);
+          PackBytes(str_buffer, static_cast<uint32_t>(strValue.size()));
+          str_buffer.append(strValue);
+        }
+      }
+
+      /** Packed RGB of a color, as 0xRRGGBB */
+      template <typename COLOR>
+      uint32_t ToRGB(const COLOR& c_color) {
+        return uint32_t(c_color.GetRed()) << 16 |
+               uint32_t(c_color.GetGreen()) << 8 | uint32_t(c_color.GetBlue());
+      }
+
+      /** Hex string of a color, e.g. "0x00ff00" or "#00ff00" */
+      template <typename COLOR>
+      std::string ToHex(const char* pch_prefix, const COLOR& c_color) {
+        char pchHex[16];
+        std::snprintf(
+          pchHex, sizeof(pchHex), "%s%06x", pch_prefix, ToRGB(c_color));
+        return pchHex;
+      }
+
+      template <typename VECTOR>
+      nlohmann::json VectorToJSON(const VECTOR& c_vector) {
+        return {
+          {"x", c_vector.GetX()},
+          {"y", c_vector.GetY()},
+          {"z", c_vector.GetZ()}};
+      }
+
+      template <typename QUATERNION>
+      nlohmann::json QuaternionToJSON(const QUATERNION& c_quaternion) {
+        return {
+          {"x", c_quaternion.GetX()},
+          {"y", c_quaternion.GetY()},
+          {"z", c_quaternion.GetZ()},
+          {"w", c_quaternion.GetW()}};
+      }
+
+      template <typename VECTOR>
+      void PackVector(std::string& str_buffer, const VECTOR& c_vector) {
+        PackBytes(str_buffer, static_cast<double>(c_vector.GetX()));
+        PackBytes(str_buffer, static_cast<double>(c_vector.GetY()));
+        PackBytes(str_buffer, static_cast<double>(c_vector.GetZ()));
+      }
+
+      template <typename QUATERNION>
+      void PackQuaternion(std::string& str_buffer, const QUATERNION& c_quat) {
+        PackBytes(str_buffer, static_cast<double>(c_quat.GetX()));
+        PackBytes(str_buffer, static_cast<double>(c_quat.GetY()));
+        PackBytes(str_buffer, static_cast<double>(c_quat.GetZ()));
+        PackBytes(str_buffer, static_cast<double>(c_quat.GetW()));
+      }
+
+      /****************************************/
+      /****************************************/
+
+      /**
+       * @brief Scalar field (number, bool or string)
+       */
+      template <typename GETTER>
+      struct SScalar {
+        const char* Key;
+        GETTER Get;
+
+        template <typename ENTITY>
+        void Write(nlohmann::json& c_json, ENTITY& c_entity) const {
+          c_json[Key] = Get(c_entity);
+        }
+
+        template <typename ENTITY>
+        void Pack(std::string& str_buffer, ENTITY& c_entity) const {
+          PackScalar(str_buffer, Get(c_entity));
+        }
+
+        nlohmann::json Describe() const {
+          return {{"key", Key}, {"kind", "scalar"}};
+        }
+      };
+
+      /**
+       * @brief Pose, written as "position" {x,y,z} and "orientation"
+       * {x,y,z,w}. The getter returns an anchor, with Position and
+       * Orientation members
+       */
+      template <typename GETTER>
+      struct SPose {
+        GETTER Get;
+
+        template <typename ENTITY>
+        void Write(nlohmann::json& c_json, ENTITY& c_entity) const {
+          const auto& sAnchor = Get(c_entity);
+          c_json["position"] = VectorToJSON(sAnchor.Position);
+          c_json["orientation"] = QuaternionToJSON(sAnchor.Orientation);
+        }
+
+        template <typename ENTITY>
+        void Pack(std::string& str_buffer, ENTITY& c_entity) const {
+          const auto& sAnchor = Get(c_entity);
+          PackVector(str_buffer, sAnchor.Position);
+          PackQuaternion(str_buffer, sAnchor.Orientation);
+        }
+
+        nlohmann::json Describe() const {
+          return {{"key", "position,orientation"}, {"kind", "pose"}};
+        }
+      };
+
+      /**
+       * @brief Vector field, written as {x,y,z}
+       */
+      template <typename GETTER>
+      struct SVector {
+        const char* Key;
+        GETTER Get;
+
+        template <typename ENTITY>
+        void Write(nlohmann::json& c_json, ENTITY& c_entity) const {
+          c_json[Key] = VectorToJSON(Get(c_entity));
+        }
+
+        template <typename ENTITY>
+        void Pack(std::string& str_buffer, ENTITY& c_entity) const {
+          PackVector(str_buffer, Get(c_entity));
+        }
+
+        nlohmann::json Describe() const {
+          return {{"key", Key}, {"kind", "vector"}};
+        }
+      };
+
+      /**
+       * @brief Quaternion field, written as {x,y,z,w}
+       */
+      template <typename GETTER>
+      struct SQuaternion {
+        const char* Key;
+        GETTER Get;
+
+        template <typename ENTITY>
+        void Write(nlohmann::json& c_json, ENTITY& c_entity) const {
+          c_json[Key] = QuaternionToJSON(Get(c_entity));
+        }
+
+        template <typename ENTITY>
+        void Pack(std::string& str_buffer, ENTITY& c_entity) const {
+          PackQuaternion(str_buffer, Get(c_entity));
+        }
+
+        nlohmann::json Describe() const {
+          return {{"key", Key}, {"kind", "quaternion"}};
+        }
+      };
+
+      /**
+       * @brief Color field, written as "0xRRGGBB"
+       */
+      template <typename GETTER>
+      struct SColor {
+        const char* Key;
+        GETTER Get;
+
+        template <typename ENTITY>
+        void Write(nlohmann::json& c_json, ENTITY& c_entity) const {
+          c_json[Key] = ToHex("0x", Get(c_entity));
+        }
+
+        template <typename ENTITY>
+        void Pack(std::string& str_buffer, ENTITY& c_entity) const {
+          PackBytes(str_buffer, ToRGB(Get(c_entity)));
+        }
+
+        nlohmann::json Describe() const {
+          return {{"key", Key}, {"kind", "color"}};
+        }
+      };
+
+      /**
+       * @brief Colors of the LEDs, written as an array of packed 0xRRGGBB
+       * integers, left out if there are no LEDs. Their positions do not
+       * change with the colors, they are sent in the manifest of the
+       * handles. The getter returns the LED equipped entity
+       */
+      template <typename GETTER>
+      struct SLEDs {
+        const char* Key;
+        GETTER Get;
+
+        template <typename ENTITY>
+        void Write(nlohmann::json& c_json, ENTITY& c_entity) const {
+          auto& cLEDs = Get(c_entity);
+          const size_t unLEDs = cLEDs.GetLEDs().size();
+          if (unLEDs == 0) {
+            return;
+          }
+          nlohmann::json cColors = nlohmann::json::array();
+          cColors.get_ref<nlohmann::json::array_t&>().reserve(unLEDs);
+          for (size_t i = 0; i < unLEDs; ++i) {
+            cColors.push_back(ToRGB(cLEDs.GetLED(i).GetColor()));
+          }
+          c_json[Key] = std::move(cColors);
+        }
+
+        template <typename ENTITY>
+        void Pack(std::string& str_buffer, ENTITY& c_entity) const {
+          auto& cLEDs = Get(c_entity);
+          PackBytes(str_buffer, static_cast<uint32_t>(cLEDs.GetLEDs().size()));
+          for (size_t i = 0; i < cLEDs.GetLEDs().size(); ++i) {
+            PackBytes(str_buffer, ToRGB(cLEDs.GetLED(i).GetColor()));
+          }
+        }
+
+        nlohmann::json Describe() const {
+          return {{"key", Key}, {"kind", "leds"}};
+        }
+      };
+
+      /**
+       * @brief Field written by a function of the entity JSON and the
+       * entity, for what does not fit the other kinds (e.g. rays). It is
+       * only part of the JSON, not of the binary form.
+       *
+       * The optional state function appends the bytes of what the writer
+       * reads, so the fingerprint of the entity covers the field. Without
+       * one, the entity has no fingerprint
+       */
+      template <typename WRITER, typename STATE = std::nullptr_t>
+      struct SCustom {
+        const char* Key;
+        WRITER Writer;
+        STATE State;
+
+        template <typename ENTITY>
+        void Write(nlohmann::json& c_json, ENTITY& c_entity) const {
+          Writer(c_json, c_entity);
+        }
+
+        template <typename ENTITY>
+        void Pack(std::string&, ENTITY&) const {}
+
+        template <typename ENTITY>
+        void PackState(std::string& str_buffer, ENTITY& c_entity) const {
+          if constexpr (!std::is_same<STATE, std::nullptr_t>::value) {
+            State(str_buffer, c_entity);
+          }
+        }
+
+        nlohmann::json Describe() const {
+          return {{"key", Key}, {"kind", "custom"}};
+        }
+      };
+
+      /****************************************/
+      /****************************************/
+
+      /** Appends what the JSON of a field depends on beyond its binary form,
+       * nothing but for the custom fields */
+      template <typename FIELD, typename ENTITY>
+      void PackState(std::string&, const FIELD&, ENTITY&) {}
+
+      template <typename WRITER, typename STATE, typename ENTITY>
+      void PackState(
+        std::string& str_buffer,
+        const SCustom<WRITER, STATE>& s_field,
+        ENTITY& c_entity) {
+        s_field.PackState(str_buffer, c_entity);
+      }
+
+      /** True if the fingerprint of an entity covers the field */
+      template <typename FIELD>
+      struct SHasState : std::true_type {};
+
+      template <typename WRITER>
+      struct SHasState<SCustom<WRITER, std::nullptr_t>> : std::false_type {};
+
+      /** FNV-1a hash of bytes */
+      inline uint64_t Hash(const std::string& str_bytes) {
+        uint64_t unHash = 14695981039346656037ull;
+        for (unsigned char unByte : str_bytes) {
+          unHash ^= unByte;
+          unHash *= 1099511628211ull;
+        }
+        return unHash;
+      }
+
+      /****************************************/
+      /****************************************/
+
+      template <typename GETTER>
+      constexpr SScalar<GETTER> Scalar(const char* pch_key, GETTER t_get) {
+        return {pch_key, t_get};
+      }
+
+      template <typename GETTER>
+      constexpr SPose<GETTER> Pose(GETTER t_get) {
+        return {t_get};
+      }
+
+      template <typename GETTER>
+      constexpr SVector<GETTER> Vector(const char* pch_key, GETTER t_get) {
+        return {pch_key, t_get};
+      }
+
+      template <typename GETTER>
+      constexpr SQuaternion<GETTER> Quaternion(
+        const char* pch_key, GETTER t_get) {
+        return {pch_key, t_get};
+      }
+
+      template <typename GETTER>
+      constexpr SColor<GETTER> Color(const char* pch_key, GETTER t_get) {
+        return {pch_key, t_get};
+      }
+
+      template <typename GETTER>
+      constexpr SLEDs<GETTER> LEDs(const char* pch_key, GETTER t_get) {
+        return {pch_key, t_get};
+      }
+
+      template <typename WRITER>
+      constexpr SCustom<WRITER> Custom(const char* pch_key, WRITER t_writer) {
+        return {pch_key, t_writer, nullptr};
+      }
+
+      template <typename WRITER, typename STATE>
+      constexpr SCustom<WRITER, STATE> Custom(
+        const char* pch_key, WRITER t_writer, STATE t_state) {
+        return {pch_key, t_writer, t_state};
+      }
+    }  // namespace Fields
+
+    /****************************************/
+    /****************************************/
+
+    /**
+     * @brief Serializer of an entity type, generated from its fields.
+     *
+     * The "type" and "id" of the entity always come first, from its
+     * GetTypeDescription() and GetId().
+     *
+     * @tparam ENTITY entity class
+     * @tparam FIELDS field descriptors, see the Fields namespace
+     */
+    template <typename ENTITY, typename... FIELDS>
+    class CEntityFields {
+     public:
+      constexpr explicit CEntityFields(FIELDS... t_fields)
+          : m_tFields(t_fields...) {}
+
+      /****************************************/
+      /****************************************/
+
+      /** JSON of the entity, as sent to the clients */
+      nlohmann::json ToJSON(ENTITY& c_entity) const {
+        nlohmann::json cJson;
+        cJson["type"] = c_entity.GetTypeDescription();
+        cJson["id"] = c_entity.GetId();
+        std::apply(
+          [&](const FIELDS&... t_field) {
+            (t_field.Write(cJson, c_entity), ...);
+          },
+          m_tFields);
+        return cJson;
+      }
+
+      /****************************************/
+      /****************************************/
+
+      /**
+       * @brief Appends the binary form of the entity: its id (uint32 length
+       * and bytes), then each field in order
+       */
+      void Pack(ENTITY& c_entity, std::string& str_buffer) const {
+        Fields::PackScalar(str_buffer, c_entity.GetId());
+        std::apply(
+          [&](const FIELDS&... t_field) {
+            (t_field.Pack(str_buffer, c_entity), ...);
+          },
+          m_tFields);
+      }
+
+      /****************************************/
+      /****************************************/
+
+      /**
+       * @brief Returns true if the binary form of the entity differs from
+       * the previous one, which is then replaced
+       *
+       * @param c_entity entity
+       * @param str_previous binary form at the previous call, empty if none
+       */
+      bool HasChanged(ENTITY& c_entity, std::string& str_previous) const {
+        std::string strCurrent;
+        strCurrent.reserve(str_previous.size());
+        Pack(c_entity, strCurrent);
+        if (strCurrent == str_previous) {
+          return false;
+        }
+        str_previous.swap(strCurrent);
+        return true;
+      }
+
+      /****************************************/
+      /****************************************/
+
+      /** True if all the fields are covered by Fingerprint() */
+      static constexpr bool HAS_FINGERPRINT =
+        (Fields::SHasState<FIELDS>::value && ...);
+
+      /**
+       * @brief Hash of everything the JSON of the entity is written from:
+       * its binary form, and the state of its custom fields. Entities with
+       * the same fingerprint as before can reuse their previous JSON
+       */
+      uint64_t Fingerprint(ENTITY& c_entity) const {
+        static_assert(
+          HAS_FINGERPRINT, "Custom fields need a state function");
+        thread_local std::string strBuffer;
+        strBuffer.clear();
+        Pack(c_entity, strBuffer);
+        std::apply(
+          [&](const FIELDS&... t_field) {
+            (Fields::PackState(strBuffer, t_field, c_entity), ...);
+          },
+          m_tFields);
+        return Fields::Hash(strBuffer);
+      }
+
+      /****************************************/
+      /****************************************/
+
+      /** Description of the fields, in their order */
+      nlohmann::json Schema() const {
+        nlohmann::json cSchema = nlohmann::json::array();
+        std::apply(
+          [&](const FIELDS&... t_field) {
+            (cSchema.push_back(t_field.Describe()), ...);
+          },
+          m_tFields);
+        return cSchema;
+      }
+
+     private:
+      std::tuple<FIELDS...> m_tFields;
+    };
+
+    /****************************************/
+    /****************************************/
+
+    /**
+     * @brief Declares the fields of an entity type, e.g.
+     *
+     *   constexpr auto BOX_FIELDS = MakeEntityFields<CBoxEntity>(
+     *     Fields::Pose([](CBoxEntity& c_box) -> const SAnchor& {
+     *       return c_box.GetEmbodiedEntity().GetOriginAnchor();
+     *     }),
+     *     Fields::Vector("scale", [](CBoxEntity& c_box) -> const CVector3& {
+     *       return c_box.GetSize();
+     *     }));
+     */
+    template <typename ENTITY, typename... FIELDS>
+    constexpr CEntityFields<ENTITY, FIELDS...> MakeEntityFields(
+      FIELDS... t_fields) {
+      return CEntityFields<ENTITY, FIELDS...>(t_fields...);
+    }
+  }  // namespace Webviz
+}  // namespace argos
+
+#endif
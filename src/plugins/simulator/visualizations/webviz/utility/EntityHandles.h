@@ -0,0 +1,339 @@
+/**
+ * @file
+ * <argos3/plugins/simulator/visualizations/webviz/utility/EntityHandles.h>
+ *
+ * @author Prajankya Sonar - <prajankya@gmail.com>
+ *
+ * @project ARGoS3-Webviz <https://github.com/NESTlab/argos3-webviz>
+ *
+ * MIT License
+ * Copyright (c) 2020 NEST Lab
+ */
+
+#ifndef ARGOS_WEBVIZ_ENTITY_HANDLES_H
+#define ARGOS_WEBVIZ_ENTITY_HANDLES_H
+
+#include <cstdint>
+#include <mutex>
+#include <nlohmann/json.hpp>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace argos {
+  namespace Webviz {
+
+    /**
+     * @brief Dense numeric handles of the entities, so frames can reference
+     * them without repeating their id and type strings.
+     *
+     * The handle of an entity is its index in the manifest, the table of
+     * (id, type) sent to the clients once and again only when entities are
+     * added or removed. Entities keep their handle while they exist; the
+     * handles of removed ones are reused, lowest first, so the manifest
+     * stays dense. Each change increments the version of the manifest.
+     * Data which does not change while the entity exists (e.g. the
+     * positions of its LEDs) is sent in the manifest too, and not in every
+     * frame. Thread-safe.
+     */
+    class CEntityHandles {
+     public:
+      /** Returned by Find() for entities without handle */
+      static constexpr int64_t NO_HANDLE = -1;
+
+      /** Entity of the manifest */
+      struct SEntity {
+        std::string Id;
+
+        std::string Type;
+
+        /** Static data of the entity, null if none */
+        nlohmann::json Static;
+      };
+
+      /** Entities added and removed by an Update() */
+      struct SChanges {
+        /** Handle and entity of the ones added, or replaced */
+        std::vector<std::pair<size_t, SEntity>> Added;
+
+        /** Handle and id of the ones removed, or replaced */
+        std::vector<std::pair<size_t, std::string>> Removed;
+
+        bool IsEmpty() const { return Added.empty() && Removed.empty(); }
+      };
+
+      /****************************************/
+      /****************************************/
+
+      /**
+       * @brief Assigns the handles of the current entities
+       *
+       * @param vec_entities all the entities
+       * @param ps_changes if not null, set to the entities added and
+       * removed. An entity whose type or static data changed is both
+       * @return true if the manifest changed
+       */
+      bool Update(
+        const std::vector<SEntity>& vec_entities,
+        SChanges* ps_changes = nullptr) {
+        std::lock_guard<std::mutex> guard(m_mutex4Handles);
+        if (ps_changes != nullptr) {
+          *ps_changes = SChanges();
+        }
+
+        /* Entities which are gone free their handle */
+        std::unordered_set<std::string> setCurrent;
+        for (const auto& cEntity : vec_entities) {
+          setCurrent.insert(cEntity.Id);
+        }
+        bool bChanged = false;
+        for (size_t i = 0; i < m_vecEntries.size(); ++i) {
+          SEntry& sEntry = m_vecEntries[i];
+          if (sEntry.Used && setCurrent.count(sEntry.Entity.Id) == 0) {
+            if (ps_changes != nullptr) {
+              ps_changes->Removed.emplace_back(i, sEntry.Entity.Id);
+            }
+            m_mapHandles.erase(sEntry.Entity.Id);
+            sEntry = SEntry();
+            bChanged = true;
+          }
+        }
+
+        /* New entities take the lowest free handles */
+        size_t unFree = 0;
+        for (const auto& cEntity : vec_entities) {
+          auto itHandle = m_mapHandles.find(cEntity.Id);
+          if (itHandle != m_mapHandles.end()) {
+            /* The type of an id can only change if it was replaced, and
+             * the static data if it was reset */
+            SEntity& sEntity = m_vecEntries[itHandle->second].Entity;
+            if (
+              sEntity.Type != cEntity.Type ||
+              sEntity.Static != cEntity.Static) {
+              if (ps_changes != nullptr) {
+                ps_changes->Removed.emplace_back(itHandle->second, sEntity.Id);
+                ps_changes->Added.emplace_back(itHandle->second, cEntity);
+              }
+              sEntity = cEntity;
+              bChanged = true;
+            }
+            continue;
+          }
+          while (unFree < m_vecEntries.size() && m_vecEntries[unFree].Used) {
+            ++unFree;
+          }
+          if (unFree == m_vecEntries.size()) {
+            m_vecEntries.emplace_back();
+          }
+          m_vecEntries[unFree] = {true, cEntity};
+          m_mapHandles[cEntity.Id] = unFree;
+          if (ps_changes != nullptr) {
+            ps_changes->Added.emplace_back(unFree, cEntity);
+          }
+          bChanged = true;
+        }
+
+        /* Free handles at the end are dropped */
+        while (!m_vecEntries.empty() && !m_vecEntries.back().Used) {
+          m_vecEntries.pop_back();
+        }
+
+        if (bChanged) {
+          ++m_unVersion;
+        }
+        return bChanged;
+      }
+
+      /****************************************/
+      /****************************************/
+
+      /** Returns the handle of an entity, NO_HANDLE if it has none */
+      int64_t Find(const std::string& str_id) const {
+        std::lock_guard<std::mutex> guard(m_mutex4Handles);
+        auto itHandle = m_mapHandles.find(str_id);
+        return itHandle != m_mapHandles.end()
+                 ? static_cast<int64_t>(itHandle->second)
+                 : NO_HANDLE;
+      }
+
+      /****************************************/
+      /****************************************/
+
+      /**
+       * @brief Returns the id of the entity with a handle
+       *
+       * @param n_handle handle, as received from a client
+       * @param str_id set to the id of the entity
+       * @return false if no entity has this handle
+       */
+      bool Resolve(int64_t n_handle, std::string& str_id) const {
+        std::lock_guard<std::mutex> guard(m_mutex4Handles);
+        if (
+          n_handle < 0 ||
+          static_cast<uint64_t>(n_handle) >= m_vecEntries.size() ||
+          !m_vecEntries[n_handle].Used) {
+          return false;
+        }
+        str_id = m_vecEntries[n_handle].Entity.Id;
+        return true;
+      }
+
+      /****************************************/
+      /****************************************/
+
+      /**
+       * @brief Replaces the "id" and "type" of a serialized entity by its
+       * handle "h". Entities without handle are left as they are
+       *
+       * @param c_entity entity, changed in place
+       */
+      void Compact(nlohmann::json& c_entity) const {
+        if (!c_entity.is_object() || !c_entity.contains("id")) {
+          return;
+        }
+        const int64_t nHandle = Find(c_entity["id"].get<std::string>());
+        if (nHandle == NO_HANDLE) {
+          return;
+        }
+        c_entity.erase("id");
+        c_entity.erase("type");
+        c_entity["h"] = nHandle;
+      }
+
+      /****************************************/
+      /****************************************/
+
+      /** Version of the manifest, incremented by each change */
+      uint64_t GetVersion() const {
+        std::lock_guard<std::mutex> guard(m_mutex4Handles);
+        return m_unVersion;
+      }
+
+      /****************************************/
+      /****************************************/
+
+      /**
+       * @brief Returns the manifest, as {"version": v, "entities": [...]}
+       * where each entity is [id, type] (or [id, type, static] if it has
+       * static data) at the index of its handle, or null for a free handle
+       */
+      nlohmann::json ToJSON() const {
+        std::lock_guard<std::mutex> guard(m_mutex4Handles);
+        nlohmann::json cEntities = nlohmann::json::array();
+        for (const SEntry& sEntry : m_vecEntries) {
+          if (!sEntry.Used) {
+            cEntities.push_back(nullptr);
+          } else if (sEntry.Entity.Static.is_null()) {
+            cEntities.push_back({sEntry.Entity.Id, sEntry.Entity.Type});
+          } else {
+            cEntities.push_back(
+              {sEntry.Entity.Id, sEntry.Entity.Type, sEntry.Entity.Static});
+          }
+        }
+        return {{"version", m_unVersion}, {"entities", std::move(cEntities)}};
+      }
+
+      /****************************************/
+      /****************************************/
+
+      /**
+       * @brief Returns changes as {"version": v, "added": [...], "removed":
+       * [...]}, where each entity added is [handle, id, type] (or [handle,
+       * id, type, static]) and each entity removed is [handle, id]
+       *
+       * @param s_changes changes of an Update()
+       * @param un_version version of the manifest after the changes
+       */
+      static nlohmann::json ChangesToJSON(
+        const SChanges& s_changes, uint64_t un_version) {
+        nlohmann::json cAdded = nlohmann::json::array();
+        for (const auto& cAdd : s_changes.Added) {
+          const SEntity& sEntity = cAdd.second;
+          if (sEntity.Static.is_null()) {
+            cAdded.push_back({cAdd.first, sEntity.Id, sEntity.Type});
+          } else {
+            cAdded.push_back(
+              {cAdd.first, sEntity.Id, sEntity.Type, sEntity.Static});
+          }
+        }
+        nlohmann::json cRemoved = nlohmann::json::array();
+        for (const auto& cRemove : s_changes.Removed) {
+          cRemoved.push_back({cRemove.first, cRemove.second});
+        }
+        return {
+          {"version", un_version},
+          {"added", std::move(cAdded)},
+          {"removed", std::move(cRemoved)}};
+      }
+
+      /****************************************/
+      /****************************************/
+
+      /**
+       * @brief Replaces the handles by those of a manifest made by
+       * ToJSON(), e.g. to resolve the handles the clients received
+       *
+       * @return false if the manifest is invalid, nothing is changed then
+       */
+      bool FromJSON(const nlohmann::json& c_manifest) {
+        if (
+          !c_manifest.is_object() || !c_manifest.contains("version") ||
+          !c_manifest["version"].is_number_unsigned() ||
+          !c_manifest.contains("entities") ||
+          !c_manifest["entities"].is_array()) {
+          return false;
+        }
+
+        std::vector<SEntry> vecEntries;
+        std::unordered_map<std::string, size_t> mapHandles;
+        for (const auto& cEntity : c_manifest["entities"]) {
+          vecEntries.emplace_back();
+          if (cEntity.is_null()) {
+            continue;
+          }
+          if (
+            !cEntity.is_array() || cEntity.size() < 2 || cEntity.size() > 3 ||
+            !cEntity[0].is_string() || !cEntity[1].is_string()) {
+            return false;
+          }
+          SEntry& sEntry = vecEntries.back();
+          sEntry.Used = true;
+          sEntry.Entity.Id = cEntity[0].get<std::string>();
+          sEntry.Entity.Type = cEntity[1].get<std::string>();
+          if (cEntity.size() == 3) {
+            sEntry.Entity.Static = cEntity[2];
+          }
+          mapHandles[sEntry.Entity.Id] = vecEntries.size() - 1;
+        }
+
+        std::lock_guard<std::mutex> guard(m_mutex4Handles);
+        m_vecEntries = std::move(vecEntries);
+        m_mapHandles = std::move(mapHandles);
+        m_unVersion = c_manifest["version"].get<uint64_t>();
+        return true;
+      }
+
+     private:
+      struct SEntry {
+        /** False if the handle is free */
+        bool Used = false;
+
+        SEntity Entity;
+      };
+
+      /** Entities, at the index of their handle */
+      std::vector<SEntry> m_vecEntries;
+
+      /** Handle of each entity id */
+      std::unordered_map<std::string, size_t> m_mapHandles;
+
+      uint64_t m_unVersion = 0;
+
+      mutable std::mutex m_mutex4Handles;
+    };
+  }  // namespace Webviz
+}  // namespace argos
+
+#endif
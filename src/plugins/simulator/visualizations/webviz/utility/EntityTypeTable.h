@@ -0,0 +1,178 @@
+/**
+ * @file
+ * <argos3/plugins/simulator/visualizations/webviz/utility/EntityTypeTable.h>
+ *
+ * @author Prajankya Sonar - <prajankya@gmail.com>
+ *
+ * @project ARGoS3-Webviz <https://github.com/NESTlab/argos3-webviz>
+ *
+ * MIT License
+ * Copyright (c) 2020 NEST Lab
+ */
+
+#ifndef ARGOS_WEBVIZ_ENTITY_TYPE_TABLE_H
+#define ARGOS_WEBVIZ_ENTITY_TYPE_TABLE_H
+
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace argos {
+  namespace Webviz {
+
+    /**
+     * @brief Entities grouped by type, with what serializes each type
+     * resolved once when the table is built.
+     *
+     * The table is built from the root entities and only rebuilt when they
+     * change, so frames iterate contiguous per-type lists without any
+     * lookup per entity. Types are kept in order of first appearance. Not
+     * thread-safe.
+     *
+     * Entities are told apart by a key, e.g. their id, as well as by their
+     * address: an entity removed and another one added at the same address
+     * would otherwise be taken for the former.
+     *
+     * @tparam ENTITY entity class, e.g. CEntity
+     * @tparam SERIALIZER what serializes a type, resolved once per type
+     * @tparam KEY what identifies an entity besides its address
+     */
+    template <
+      typename ENTITY,
+      typename SERIALIZER,
+      typename KEY = std::string>
+    class CEntityTypeTable {
+     public:
+      /** Entities of one type */
+      struct SType {
+        /** Type description, e.g. "foot-bot" */
+        std::string Name;
+
+        /** False if nothing can serialize the type */
+        bool Known = false;
+
+        SERIALIZER Serializer;
+
+        std::vector<ENTITY*> Entities;
+      };
+
+      /****************************************/
+      /****************************************/
+
+      /**
+       * @brief Returns true if the entities changed since the table was
+       * built, or if it was never built
+       *
+       * @param vec_entities entities, in their order
+       * @param fn_key returns the key of an entity, as given to Build()
+       */
+      template <typename KEY_FUNCTION>
+      bool IsStale(
+        const std::vector<ENTITY*>& vec_entities, KEY_FUNCTION fn_key) const {
+        if (!m_bBuilt || vec_entities != m_vecEntities) {
+          return true;
+        }
+        for (size_t i = 0; i < vec_entities.size(); ++i) {
+          if (!(fn_key(*vec_entities[i]) == m_vecKeys[i])) {
+            return true;
+          }
+        }
+        return false;
+      }
+
+      /****************************************/
+      /****************************************/
+
+      /**
+       * @brief Groups the entities by type, resolving the serializer of
+       * each new type
+       *
+       * @param vec_entities entities, in their order
+       * @param fn_type returns the type description of an entity
+       * @param fn_resolve fills the serializer of the type of an entity,
+       * returns false if there is none
+       * @param fn_key returns the key of an entity
+       * @return std::vector<std::string> types without serializer which
+       * were never returned before, to be reported once
+       */
+      template <
+        typename TYPE_FUNCTION,
+        typename RESOLVE_FUNCTION,
+        typename KEY_FUNCTION>
+      std::vector<std::string> Build(
+        const std::vector<ENTITY*>& vec_entities,
+        TYPE_FUNCTION fn_type,
+        RESOLVE_FUNCTION fn_resolve,
+        KEY_FUNCTION fn_key) {
+        /* Serializers already resolved are kept across builds */
+        std::unordered_map<std::string, size_t> mapIndices;
+        for (size_t i = 0; i < m_vecTypes.size(); ++i) {
+          m_vecTypes[i].Entities.clear();
+          mapIndices[m_vecTypes[i].Name] = i;
+        }
+
+        std::vector<std::string> vecUnknown;
+        for (ENTITY* pcEntity : vec_entities) {
+          const std::string strType = fn_type(*pcEntity);
+          auto itIndex = mapIndices.find(strType);
+          if (itIndex == mapIndices.end()) {
+            itIndex = mapIndices.emplace(strType, m_vecTypes.size()).first;
+            m_vecTypes.emplace_back();
+            SType& sType = m_vecTypes.back();
+            sType.Name = strType;
+            sType.Known = fn_resolve(*pcEntity, sType.Serializer);
+            if (!sType.Known && m_setReported.insert(strType).second) {
+              vecUnknown.push_back(strType);
+            }
+          }
+          m_vecTypes[itIndex->second].Entities.push_back(pcEntity);
+        }
+
+        /* Types which have no entities anymore */
+        for (auto it = m_vecTypes.begin(); it != m_vecTypes.end();) {
+          it = it->Entities.empty() ? m_vecTypes.erase(it) : it + 1;
+        }
+
+        m_vecEntities = vec_entities;
+        m_vecKeys.clear();
+        m_vecKeys.reserve(vec_entities.size());
+        for (ENTITY* pcEntity : vec_entities) {
+          m_vecKeys.push_back(fn_key(*pcEntity));
+        }
+        m_bBuilt = true;
+        return vecUnknown;
+      }
+
+      /****************************************/
+      /****************************************/
+
+      const std::vector<SType>& GetTypes() const { return m_vecTypes; }
+
+      /** Serializers can be completed after a build, e.g. per entity */
+      std::vector<SType>& GetTypes() { return m_vecTypes; }
+
+      /**
+       * Forces the next IsStale() to be true, e.g. after entities were
+       * added, removed or reset
+       */
+      void Invalidate() { m_bBuilt = false; }
+
+     private:
+      std::vector<SType> m_vecTypes;
+
+      /** Entities the table was built from */
+      std::vector<ENTITY*> m_vecEntities;
+
+      /** Keys of the entities the table was built from */
+      std::vector<KEY> m_vecKeys;
+
+      /** Unknown types already reported */
+      std::set<std::string> m_setReported;
+
+      bool m_bBuilt = false;
+    };
+  }  // namespace Webviz
+}  // namespace argos
+
+#endif
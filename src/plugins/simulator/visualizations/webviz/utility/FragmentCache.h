@@ -0,0 +1,137 @@
+/**
+ * @file
+ * <argos3/plugins/simulator/visualizations/webviz/utility/FragmentCache.h>
+ *
+ * @author Prajankya Sonar - <prajankya@gmail.com>
+ *
+ * @project ARGoS3-Webviz <https://github.com/NESTlab/argos3-webviz>
+ *
+ * MIT License
+ * Copyright (c) 2020 NEST Lab
+ */
+
+#ifndef ARGOS_WEBVIZ_FRAGMENT_CACHE_H
+#define ARGOS_WEBVIZ_FRAGMENT_CACHE_H
+
+#include <cstdint>
+#include <memory>
+#include <nlohmann/json.hpp>
+#include <vector>
+
+namespace argos {
+  namespace Webviz {
+
+    /**
+     * @brief Last JSON of the entities of a type, reused while the
+     * fingerprint of their state does not change, so that entities which
+     * stay still (walls, lights, idle robots) are not serialized at every
+     * frame.
+     *
+     * An entity is only cached once its fingerprint was the same at two
+     * frames in a row, so those changing at every frame do not pay for a
+     * copy. The cached JSON is shared and never changed, so it can be
+     * handed to other threads (e.g. the broadcaster) without a copy.
+     * Entries follow the order of the entities of the type. Not
+     * thread-safe: it must only be used by the thread which builds the
+     * frames, and reset by it when the entities change.
+     */
+    class CFragmentCache {
+     public:
+      /** JSON of an entity, shared with the frames which carry it */
+      typedef std::shared_ptr<const nlohmann::json> TFragment;
+
+      /** Forgets all the entries, e.g. when entities were added or removed */
+      void Reset(size_t un_entities) {
+        m_vecFragments.assign(un_entities, SFragment());
+      }
+
+      /****************************************/
+      /****************************************/
+
+      /**
+       * @brief Returns the JSON of an entity, if cached with the same
+       * fingerprint
+       *
+       * @param un_index index of the entity in its type
+       * @param un_fingerprint fingerprint of its current state
+       * @return nullptr if the entity has to be serialized, and passed to
+       * Store()
+       */
+      TFragment Find(size_t un_index, uint64_t un_fingerprint) {
+        if (un_index >= m_vecFragments.size()) {
+          return nullptr;
+        }
+        SFragment& sFragment = m_vecFragments[un_index];
+        const bool bSame =
+          sFragment.Valid && sFragment.Fingerprint == un_fingerprint;
+        if (bSame && sFragment.Cached) {
+          ++m_unHits;
+          return sFragment.JSON;
+        }
+        ++m_unMisses;
+
+        /* Kept by Store() if unchanged since the last frame */
+        sFragment.Valid = true;
+        sFragment.Fingerprint = un_fingerprint;
+        sFragment.Keep = bSame;
+        if (!bSame && sFragment.Cached) {
+          sFragment.Cached = false;
+          sFragment.JSON.reset();
+        }
+        return nullptr;
+      }
+
+      /****************************************/
+      /****************************************/
+
+      /**
+       * @brief Caches the JSON of an entity serialized after Find(), if its
+       * fingerprint was the same at the previous frame
+       */
+      void Store(size_t un_index, const nlohmann::json& c_fragment) {
+        if (un_index >= m_vecFragments.size()) {
+          return;
+        }
+        SFragment& sFragment = m_vecFragments[un_index];
+        if (sFragment.Keep) {
+          sFragment.JSON = std::make_shared<const nlohmann::json>(c_fragment);
+          sFragment.Cached = true;
+          sFragment.Keep = false;
+        }
+      }
+
+      /****************************************/
+      /****************************************/
+
+      /** Entities whose JSON was reused */
+      uint64_t GetHits() const { return m_unHits; }
+
+      /** Entities which were serialized */
+      uint64_t GetMisses() const { return m_unMisses; }
+
+     private:
+      struct SFragment {
+        /** False until a fingerprint was seen */
+        bool Valid = false;
+
+        /** True if JSON holds the entity as written from Fingerprint */
+        bool Cached = false;
+
+        /** True if the next Store() caches the JSON */
+        bool Keep = false;
+
+        uint64_t Fingerprint = 0;
+
+        TFragment JSON;
+      };
+
+      std::vector<SFragment> m_vecFragments;
+
+      uint64_t m_unHits = 0;
+
+      uint64_t m_unMisses = 0;
+    };
+  }  // namespace Webviz
+}  // namespace argos
+
+#endif
@@ -0,0 +1,407 @@
+/**
+ * @file
+ * <argos3/plugins/simulator/visualizations/webviz/utility/FrameHistory.h>
+ *
+ * @author Prajankya Sonar - <prajankya@gmail.com>
+ *
+ * @project ARGoS3-Webviz <https://github.com/NESTlab/argos3-webviz>
+ *
+ * MIT License
+ * Copyright (c) 2020 NEST Lab
+ */
+
+#ifndef ARGOS_WEBVIZ_FRAME_HISTORY_H
+#define ARGOS_WEBVIZ_FRAME_HISTORY_H
+
+#include <algorithm>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <nlohmann/json.hpp>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace argos {
+  namespace Webviz {
+
+    /**
+     * @brief Bounded in-memory history of the recent frames.
+     *
+     * Frames are stored in groups, each starting with a keyframe (the whole
+     * frame) followed by deltas holding only the entities which changed since
+     * the previous frame. The oldest groups are dropped when they are out of
+     * the time window, or when the memory limit is reached.
+     *
+     * Frames are JSON objects with an "entities" array, each entity with an
+     * "id". All the other fields are kept as they are.
+     */
+    class CFrameHistory {
+     public:
+      CFrameHistory(
+        uint64_t un_max_steps = 0,
+        size_t un_max_bytes = 64 * 1024 * 1024,
+        size_t un_keyframe_every = 50) {
+        Configure(un_max_steps, un_max_bytes, un_keyframe_every);
+      }
+
+      /****************************************/
+      /****************************************/
+
+      /**
+       * @brief Sets the limits of the history, and clears it
+       *
+       * @param un_max_steps time window in simulation steps, 0 disables it
+       * @param un_max_bytes memory limit of the stored frames
+       * @param un_keyframe_every number of frames in each group
+       */
+      void Configure(
+        uint64_t un_max_steps, size_t un_max_bytes, size_t un_keyframe_every) {
+        std::lock_guard<std::mutex> guard(m_mutex4History);
+        m_unMaxSteps = un_max_steps;
+        m_unMaxBytes = un_max_bytes;
+        m_unKeyframeEvery = un_keyframe_every > 0 ? un_keyframe_every : 1;
+        ClearUnlocked();
+      }
+
+      /****************************************/
+      /****************************************/
+
+      bool IsEnabled() const {
+        std::lock_guard<std::mutex> guard(m_mutex4History);
+        return m_unMaxSteps > 0;
+      }
+
+      /****************************************/
+      /****************************************/
+
+      /**
+       * @brief Returns true if a frame of this step would be stored, so
+       * unchanged frames (e.g. while paused) are not serialized for nothing
+       */
+      bool NeedsFrame(uint64_t un_step) const {
+        std::lock_guard<std::mutex> guard(m_mutex4History);
+        return m_unMaxSteps > 0 &&
+               (m_deqGroups.empty() || un_step != m_unLastStep);
+      }
+
+      /****************************************/
+      /****************************************/
+
+      void Clear() {
+        std::lock_guard<std::mutex> guard(m_mutex4History);
+        ClearUnlocked();
+      }
+
+      /****************************************/
+      /****************************************/
+
+      /**
+       * @brief Adds a frame. Frames of the same step as the last one are
+       * ignored, frames of an earlier step (experiment reset) clear the
+       * history
+       *
+       * @param un_step simulation step of the frame
+       * @param c_frame the frame
+       */
+      void Push(uint64_t un_step, const nlohmann::json& c_frame) {
+        std::lock_guard<std::mutex> guard(m_mutex4History);
+        if (m_unMaxSteps == 0) {
+          return;
+        }
+
+        if (!m_deqGroups.empty()) {
+          if (un_step == m_unLastStep) {
+            return;
+          }
+          if (un_step < m_unLastStep) {
+            ClearUnlocked();
+          }
+        }
+
+        /* Entities of this frame, by id */
+        std::unordered_map<std::string, const nlohmann::json*> mapEntities;
+        if (c_frame.contains("entities") && c_frame["entities"].is_array()) {
+          for (const auto& cEntity : c_frame["entities"]) {
+            mapEntities[cEntity.value("id", "")] = &cEntity;
+          }
+        }
+
+        SEntry sEntry;
+        sEntry.Step = un_step;
+
+        if (
+          m_deqGroups.empty() ||
+          m_deqGroups.back().Frames.size() >= m_unKeyframeEvery) {
+          /* Keyframe, starting a new group */
+          m_deqGroups.emplace_back();
+          m_deqGroups.back().FirstStep = un_step;
+          sEntry.Data = c_frame.dump();
+        } else {
+          /* Delta from the previous frame */
+          nlohmann::json cDelta;
+          cDelta["header"] = nlohmann::json::object();
+          for (auto it = c_frame.begin(); it != c_frame.end(); ++it) {
+            if (it.key() != "entities") {
+              cDelta["header"][it.key()] = it.value();
+            }
+          }
+
+          cDelta["changed"] = nlohmann::json::array();
+          for (const auto& cEntity : mapEntities) {
+            auto itLast = m_mapLastEntities.find(cEntity.first);
+            if (
+              itLast == m_mapLastEntities.end() ||
+              itLast->second != *cEntity.second) {
+              cDelta["changed"].push_back(*cEntity.second);
+            }
+          }
+
+          cDelta["removed"] = nlohmann::json::array();
+          for (const auto& cLastEntity : m_mapLastEntities) {
+            if (mapEntities.count(cLastEntity.first) == 0) {
+              cDelta["removed"].push_back(cLastEntity.first);
+            }
+          }
+          sEntry.Data = cDelta.dump();
+        }
+
+        m_unBytes += sEntry.Data.size();
+        m_deqGroups.back().Bytes += sEntry.Data.size();
+        m_deqGroups.back().Frames.push_back(std::move(sEntry));
+        m_unLastStep = un_step;
+
+        /* Kept to compute the next delta */
+        m_mapLastEntities.clear();
+        for (const auto& cEntity : mapEntities) {
+          m_mapLastEntities[cEntity.first] = *cEntity.second;
+        }
+
+        /* Drop whole groups, out of the time window or over the memory
+         * limit. The latest group is always kept */
+        while (m_deqGroups.size() > 1 &&
+               (m_deqGroups[1].FirstStep + m_unMaxSteps <= un_step ||
+                m_unBytes > m_unMaxBytes)) {
+          m_unBytes -= m_deqGroups.front().Bytes;
+          m_deqGroups.pop_front();
+        }
+      }
+
+      /****************************************/
+      /****************************************/
+
+      size_t GetFrameCount() const {
+        std::lock_guard<std::mutex> guard(m_mutex4History);
+        size_t unCount = 0;
+        for (const auto& sGroup : m_deqGroups) {
+          unCount += sGroup.Frames.size();
+        }
+        return unCount;
+      }
+
+      size_t GetBytes() const {
+        std::lock_guard<std::mutex> guard(m_mutex4History);
+        return m_unBytes;
+      }
+
+      /****************************************/
+      /****************************************/
+
+      /**
+       * @brief Steps of the oldest and of the latest frames
+       *
+       * @return false if the history is empty
+       */
+      bool GetRange(uint64_t& un_first, uint64_t& un_last) const {
+        std::lock_guard<std::mutex> guard(m_mutex4History);
+        if (m_deqGroups.empty()) {
+          return false;
+        }
+        un_first = m_deqGroups.front().FirstStep;
+        un_last = m_unLastStep;
+        return true;
+      }
+
+      /****************************************/
+      /****************************************/
+
+      /**
+       * @brief Rebuilds the last frame at or before the given step
+       *
+       * @return false if the step is before the oldest frame
+       */
+      bool GetFrame(uint64_t un_step, nlohmann::json& c_frame) const {
+        nlohmann::json cFrames = GetFrames(0, un_step, 1, true);
+        if (cFrames.empty()) {
+          return false;
+        }
+        c_frame = std::move(cFrames[0]);
+        return true;
+      }
+
+      /****************************************/
+      /****************************************/
+
+      /**
+       * @brief Rebuilds the frames between two steps (included)
+       *
+       * @param un_from first step
+       * @param un_to last step
+       * @param un_max maximum number of frames returned
+       * @param b_latest_first return the frames from un_to backwards
+       * @return nlohmann::json array of frames
+       */
+      nlohmann::json GetFrames(
+        uint64_t un_from,
+        uint64_t un_to,
+        size_t un_max,
+        bool b_latest_first = false) const {
+        std::lock_guard<std::mutex> guard(m_mutex4History);
+        nlohmann::json cFrames = nlohmann::json::array();
+        if (un_max == 0) {
+          return cFrames;
+        }
+
+        /* Frames in the range, latest first. The limit keeps the latest ones
+         * if b_latest_first is set, the oldest ones otherwise */
+        std::vector<const SEntry*> vecSelected;
+        for (auto itGroup = m_deqGroups.rbegin(); itGroup != m_deqGroups.rend();
+             ++itGroup) {
+          for (auto it = itGroup->Frames.rbegin(); it != itGroup->Frames.rend();
+               ++it) {
+            if (it->Step >= un_from && it->Step <= un_to) {
+              vecSelected.push_back(&*it);
+            }
+          }
+        }
+        if (vecSelected.empty()) {
+          return cFrames;
+        }
+        if (b_latest_first) {
+          if (vecSelected.size() > un_max) {
+            vecSelected.resize(un_max);
+          }
+        } else if (vecSelected.size() > un_max) {
+          vecSelected.erase(vecSelected.begin(), vecSelected.end() - un_max);
+        }
+        uint64_t unOldest = vecSelected.back()->Step;
+        uint64_t unNewest = vecSelected.front()->Step;
+
+        /* Rebuild from the keyframe of the group of the oldest frame */
+        for (const auto& sGroup : m_deqGroups) {
+          if (sGroup.Frames.back().Step < unOldest) {
+            continue;
+          }
+          if (sGroup.FirstStep > unNewest) {
+            break;
+          }
+
+          nlohmann::json cFrame;
+          for (const auto& sEntry : sGroup.Frames) {
+            if (sEntry.Step > unNewest) {
+              break;
+            }
+            if (&sEntry == &sGroup.Frames.front()) {
+              cFrame = nlohmann::json::parse(sEntry.Data);
+            } else {
+              ApplyDelta(cFrame, nlohmann::json::parse(sEntry.Data));
+            }
+            if (sEntry.Step >= unOldest) {
+              cFrames.push_back(cFrame);
+            }
+          }
+        }
+
+        if (b_latest_first) {
+          std::reverse(cFrames.begin(), cFrames.end());
+        }
+        return cFrames;
+      }
+
+     private:
+      struct SEntry {
+        uint64_t Step;
+        /** Serialized keyframe or delta */
+        std::string Data;
+      };
+
+      struct SGroup {
+        uint64_t FirstStep = 0;
+        size_t Bytes = 0;
+        /** Keyframe first, then deltas */
+        std::vector<SEntry> Frames;
+      };
+
+      /****************************************/
+      /****************************************/
+
+      static void ApplyDelta(
+        nlohmann::json& c_frame, const nlohmann::json& c_delta) {
+        for (auto it = c_delta["header"].begin(); it != c_delta["header"].end();
+             ++it) {
+          c_frame[it.key()] = it.value();
+        }
+
+        nlohmann::json& cEntities = c_frame["entities"];
+        if (!cEntities.is_array()) {
+          cEntities = nlohmann::json::array();
+        }
+
+        std::unordered_map<std::string, size_t> mapIndex;
+        for (size_t i = 0; i < cEntities.size(); ++i) {
+          mapIndex[cEntities[i].value("id", "")] = i;
+        }
+
+        for (const auto& cEntity : c_delta["changed"]) {
+          auto itIndex = mapIndex.find(cEntity.value("id", ""));
+          if (itIndex != mapIndex.end()) {
+            cEntities[itIndex->second] = cEntity;
+          } else {
+            cEntities.push_back(cEntity);
+          }
+        }
+
+        if (!c_delta["removed"].empty()) {
+          std::unordered_set<std::string> setRemoved;
+          for (const auto& cId : c_delta["removed"]) {
+            setRemoved.insert(cId.get<std::string>());
+          }
+          nlohmann::json cKept = nlohmann::json::array();
+          for (auto& cEntity : cEntities) {
+            if (setRemoved.count(cEntity.value("id", "")) == 0) {
+              cKept.push_back(std::move(cEntity));
+            }
+          }
+          cEntities = std::move(cKept);
+        }
+      }
+
+      /****************************************/
+      /****************************************/
+
+      void ClearUnlocked() {
+        m_deqGroups.clear();
+        m_mapLastEntities.clear();
+        m_unBytes = 0;
+        m_unLastStep = 0;
+      }
+
+     private:
+      uint64_t m_unMaxSteps;
+      size_t m_unMaxBytes;
+      size_t m_unKeyframeEvery;
+
+      std::deque<SGroup> m_deqGroups;
+      size_t m_unBytes;
+      uint64_t m_unLastStep;
+
+      /** Entities of the latest frame, by id */
+      std::unordered_map<std::string, nlohmann::json> m_mapLastEntities;
+
+      mutable std::mutex m_mutex4History;
+    };
+  }  // namespace Webviz
+}  // namespace argos
+
+#endif
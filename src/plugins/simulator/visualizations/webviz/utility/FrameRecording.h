@@ -0,0 +1,554 @@
+/**
+ * @file
+ * <argos3/plugins/simulator/visualizations/webviz/utility/FrameRecording.h>
+ *
+ * @author Prajankya Sonar - <prajankya@gmail.com>
+ *
+ * @project ARGoS3-Webviz <https://github.com/NESTlab/argos3-webviz>
+ *
+ * MIT License
+ * Copyright (c) 2020 NEST Lab
+ */
+
+#ifndef ARGOS_WEBVIZ_FRAME_RECORDING_H
+#define ARGOS_WEBVIZ_FRAME_RECORDING_H
+
+#include <fcntl.h>    /* open() */
+#include <sys/mman.h> /* mmap() */
+#include <sys/stat.h> /* fstat() */
+#include <unistd.h>   /* pread(), close() */
+#include <zlib.h>
+
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+/*
+ * A recording is made of two files:
+ *
+ * - the data file (e.g. "run.wvz"), starting with FRAME_RECORD_MAGIC, then one
+ *   record per frame: a SFrameRecordHeader followed by the frame compressed
+ *   with zlib. Each frame is compressed on its own, so any of them can be
+ *   read without the others.
+ *
+ * - the index file (data file name + ".idx"), starting with
+ *   FRAME_INDEX_MAGIC, then one SFrameIndexEntry per frame. Entries are
+ *   only written once the frame is in the data file, so the recording can be
+ *   read while it is being written.
+ */
+
+namespace argos {
+  namespace Webviz {
+
+    static const char FRAME_RECORD_MAGIC[8] = {
+      'W', 'V', 'R', 'E', 'C', '0', '0', '1'};
+    static const char FRAME_INDEX_MAGIC[8] = {
+      'W', 'V', 'I', 'D', 'X', '0', '0', '1'};
+
+    /** Largest frame read back, bigger sizes are taken as a corruption */
+    static const uint32_t FRAME_RECORD_MAX_SIZE = 1u << 30;
+
+    /** Best ratio of zlib, a frame cannot be expanded more than this */
+    static const uint64_t FRAME_RECORD_MAX_RATIO = 1032;
+
+    /** Header of each frame in the data file */
+    struct SFrameRecordHeader {
+      uint64_t Step;
+      uint32_t Size;
+      uint32_t CompressedSize;
+    };
+
+    /** Entry of the index file, one per frame */
+    struct SFrameIndexEntry {
+      uint64_t Step;
+      uint64_t Offset;
+    };
+
+    /****************************************/
+    /****************************************/
+
+    /**
+     * @brief Appends frames to a recording from a background thread, so the
+     * caller never blocks on compression or I/O.
+     *
+     * If the writer falls behind by more than the queue limit, new frames are
+     * dropped (and counted) instead of growing the memory without bounds, or
+     * the caller waits if SetBlockWhenFull(true) was called.
+     */
+    class CFrameRecordWriter {
+     public:
+      CFrameRecordWriter(size_t un_max_queued_bytes = 256 * 1024 * 1024)
+          : m_pfData(nullptr),
+            m_pfIndex(nullptr),
+            m_unMaxQueuedBytes(un_max_queued_bytes),
+            m_unQueuedBytes(0),
+            m_unWrittenFrames(0),
+            m_unDroppedFrames(0),
+            m_bBlockWhenFull(false),
+            m_bStop(false) {}
+
+      ~CFrameRecordWriter() { Close(); }
+
+      /****************************************/
+      /****************************************/
+
+      /**
+       * @brief Creates (or truncates) the recording and starts the writer
+       * thread
+       *
+       * @param str_path path of the data file, the index is str_path + ".idx"
+       * @return false if the files could not be created
+       */
+      bool Open(const std::string& str_path) {
+        Close();
+
+        m_pfData = std::fopen(str_path.c_str(), "wb");
+        m_pfIndex = std::fopen((str_path + ".idx").c_str(), "wb");
+
+        if (
+          m_pfData == nullptr || m_pfIndex == nullptr ||
+          std::fwrite(FRAME_RECORD_MAGIC, 8, 1, m_pfData) != 1 ||
+          std::fwrite(FRAME_INDEX_MAGIC, 8, 1, m_pfIndex) != 1) {
+          CloseFiles();
+          return false;
+        }
+        std::fflush(m_pfData);
+        std::fflush(m_pfIndex);
+
+        m_unWrittenFrames = 0;
+        m_unDroppedFrames = 0;
+        m_bStop = false;
+        m_cWriterThread =
+          std::thread(&CFrameRecordWriter::WriterThreadFunction, this);
+        return true;
+      }
+
+      /****************************************/
+      /****************************************/
+
+      bool IsOpen() const { return m_cWriterThread.joinable(); }
+
+      /****************************************/
+      /****************************************/
+
+      /**
+       * @brief Wait for the writer instead of dropping frames when the queue
+       * is full, when no frame may be lost (e.g. headless recording)
+       */
+      void SetBlockWhenFull(bool b_block) {
+        std::lock_guard<std::mutex> guard(m_mutex4Queue);
+        m_bBlockWhenFull = b_block;
+      }
+
+      /****************************************/
+      /****************************************/
+
+      /**
+       * @brief Queues a frame to be written, never blocks on I/O
+       *
+       * @param un_step simulation step of the frame
+       * @param str_frame serialized frame
+       */
+      void Write(uint64_t un_step, std::string str_frame) {
+        {
+          std::unique_lock<std::mutex> cLock(m_mutex4Queue);
+          if (!IsOpen()) {
+            return;
+          }
+          if (m_bBlockWhenFull) {
+            /* An empty queue always accepts a frame, even a huge one */
+            m_cSpaceCondition.wait(cLock, [this, &str_frame] {
+              return m_deqFrames.empty() ||
+                     m_unQueuedBytes + str_frame.size() <= m_unMaxQueuedBytes;
+            });
+          } else if (m_unQueuedBytes + str_frame.size() > m_unMaxQueuedBytes) {
+            ++m_unDroppedFrames;
+            return;
+          }
+          m_unQueuedBytes += str_frame.size();
+          m_deqFrames.emplace_back(un_step, std::move(str_frame));
+        }
+        m_cQueueCondition.notify_one();
+      }
+
+      /****************************************/
+      /****************************************/
+
+      /**
+       * @brief Writes all the queued frames, stops the thread and closes the
+       * files
+       */
+      void Close() {
+        if (m_cWriterThread.joinable()) {
+          {
+            std::lock_guard<std::mutex> guard(m_mutex4Queue);
+            m_bStop = true;
+          }
+          m_cQueueCondition.notify_one();
+          m_cWriterThread.join();
+        }
+        CloseFiles();
+      }
+
+      /****************************************/
+      /****************************************/
+
+      uint64_t GetWrittenFrames() const {
+        std::lock_guard<std::mutex> guard(m_mutex4Queue);
+        return m_unWrittenFrames;
+      }
+
+      uint64_t GetDroppedFrames() const {
+        std::lock_guard<std::mutex> guard(m_mutex4Queue);
+        return m_unDroppedFrames;
+      }
+
+     private:
+      void WriterThreadFunction() {
+        std::deque<std::pair<uint64_t, std::string>> deqBatch;
+        std::string strCompressed;
+
+        while (true) {
+          /* Take all the queued frames at once */
+          {
+            std::unique_lock<std::mutex> cLock(m_mutex4Queue);
+            m_cQueueCondition.wait(
+              cLock, [this] { return m_bStop || !m_deqFrames.empty(); });
+            if (m_deqFrames.empty()) {
+              /* Stopped, and nothing left to write */
+              return;
+            }
+            deqBatch.swap(m_deqFrames);
+            m_unQueuedBytes = 0;
+          }
+          m_cSpaceCondition.notify_all();
+
+          /* Data first, the index entries only once the data is flushed */
+          std::vector<SFrameIndexEntry> vecEntries;
+          for (const auto& cFrame : deqBatch) {
+            uLongf unCompressedSize = compressBound(cFrame.second.size());
+            strCompressed.resize(unCompressedSize);
+            if (
+              compress2(
+                reinterpret_cast<Bytef*>(&strCompressed[0]),
+                &unCompressedSize,
+                reinterpret_cast<const Bytef*>(cFrame.second.data()),
+                cFrame.second.size(),
+                Z_DEFAULT_COMPRESSION) != Z_OK) {
+              continue;
+            }
+
+            /* Taken from the file, in case a previous write failed halfway */
+            uint64_t unOffset = static_cast<uint64_t>(ftello(m_pfData));
+
+            SFrameRecordHeader sHeader;
+            sHeader.Step = cFrame.first;
+            sHeader.Size = static_cast<uint32_t>(cFrame.second.size());
+            sHeader.CompressedSize = static_cast<uint32_t>(unCompressedSize);
+
+            if (
+              std::fwrite(&sHeader, sizeof(sHeader), 1, m_pfData) != 1 ||
+              std::fwrite(
+                strCompressed.data(), unCompressedSize, 1, m_pfData) != 1) {
+              continue;
+            }
+
+            vecEntries.push_back({cFrame.first, unOffset});
+          }
+          deqBatch.clear();
+          std::fflush(m_pfData);
+
+          if (!vecEntries.empty()) {
+            std::fwrite(
+              vecEntries.data(),
+              sizeof(SFrameIndexEntry),
+              vecEntries.size(),
+              m_pfIndex);
+            std::fflush(m_pfIndex);
+          }
+
+          std::lock_guard<std::mutex> guard(m_mutex4Queue);
+          m_unWrittenFrames += vecEntries.size();
+        }
+      }
+
+      /****************************************/
+      /****************************************/
+
+      void CloseFiles() {
+        if (m_pfData != nullptr) {
+          std::fclose(m_pfData);
+          m_pfData = nullptr;
+        }
+        if (m_pfIndex != nullptr) {
+          std::fclose(m_pfIndex);
+          m_pfIndex = nullptr;
+        }
+      }
+
+     private:
+      FILE* m_pfData;
+      FILE* m_pfIndex;
+
+      size_t m_unMaxQueuedBytes;
+      size_t m_unQueuedBytes;
+      uint64_t m_unWrittenFrames;
+      uint64_t m_unDroppedFrames;
+      bool m_bBlockWhenFull;
+      bool m_bStop;
+
+      std::deque<std::pair<uint64_t, std::string>> m_deqFrames;
+
+      mutable std::mutex m_mutex4Queue;
+      std::condition_variable m_cQueueCondition;
+      std::condition_variable m_cSpaceCondition;
+      std::thread m_cWriterThread;
+    };
+
+    /****************************************/
+    /****************************************/
+
+    /**
+     * @brief Random access to the frames of a recording, which can still be
+     * being written. The index is memory-mapped, and mapped again when it
+     * grows.
+     */
+    class CFrameRecordReader {
+     public:
+      CFrameRecordReader()
+          : m_nDataFd(-1),
+            m_nIndexFd(-1),
+            m_pcMapping(nullptr),
+            m_unMappedBytes(0),
+            m_unFrames(0),
+            m_unSegmentStart(0) {}
+
+      ~CFrameRecordReader() { Close(); }
+
+      CFrameRecordReader(const CFrameRecordReader&) = delete;
+      CFrameRecordReader& operator=(const CFrameRecordReader&) = delete;
+
+      /****************************************/
+      /****************************************/
+
+      /**
+       * @brief Opens a recording
+       *
+       * @param str_path path of the data file
+       * @return false if the files are missing or not recordings
+       */
+      bool Open(const std::string& str_path) {
+        Close();
+
+        m_nDataFd = ::open(str_path.c_str(), O_RDONLY);
+        m_nIndexFd = ::open((str_path + ".idx").c_str(), O_RDONLY);
+
+        char pchMagic[8];
+        if (
+          m_nDataFd < 0 || m_nIndexFd < 0 ||
+          ::pread(m_nDataFd, pchMagic, 8, 0) != 8 ||
+          std::memcmp(pchMagic, FRAME_RECORD_MAGIC, 8) != 0 ||
+          ::pread(m_nIndexFd, pchMagic, 8, 0) != 8 ||
+          std::memcmp(pchMagic, FRAME_INDEX_MAGIC, 8) != 0) {
+          Close();
+          return false;
+        }
+
+        Refresh();
+        return true;
+      }
+
+      /****************************************/
+      /****************************************/
+
+      void Close() {
+        if (m_pcMapping != nullptr) {
+          ::munmap(m_pcMapping, m_unMappedBytes);
+          m_pcMapping = nullptr;
+        }
+        if (m_nDataFd >= 0) {
+          ::close(m_nDataFd);
+          m_nDataFd = -1;
+        }
+        if (m_nIndexFd >= 0) {
+          ::close(m_nIndexFd);
+          m_nIndexFd = -1;
+        }
+        m_unMappedBytes = 0;
+        m_unFrames = 0;
+        m_unSegmentStart = 0;
+      }
+
+      /****************************************/
+      /****************************************/
+
+      bool IsOpen() const { return m_nIndexFd >= 0; }
+
+      /****************************************/
+      /****************************************/
+
+      /**
+       * @brief Maps the frames written since the last call
+       *
+       * @return size_t number of frames available
+       */
+      size_t Refresh() {
+        struct stat sStat;
+        if (m_nIndexFd < 0 || ::fstat(m_nIndexFd, &sStat) != 0) {
+          return m_unFrames;
+        }
+
+        size_t unBytes = static_cast<size_t>(sStat.st_size);
+        if (unBytes <= m_unMappedBytes) {
+          return m_unFrames;
+        }
+
+        void* pcMapping =
+          ::mmap(nullptr, unBytes, PROT_READ, MAP_SHARED, m_nIndexFd, 0);
+        if (pcMapping == MAP_FAILED) {
+          return m_unFrames;
+        }
+        if (m_pcMapping != nullptr) {
+          ::munmap(m_pcMapping, m_unMappedBytes);
+        }
+        m_pcMapping = pcMapping;
+        m_unMappedBytes = unBytes;
+
+        /* Only complete entries, the writer could be halfway */
+        size_t unFrames =
+          (unBytes - sizeof(FRAME_INDEX_MAGIC)) / sizeof(SFrameIndexEntry);
+
+        /* Steps go back to 0 when the experiment is reset, seeking by step
+         * is done in the latest run */
+        for (size_t i = (m_unFrames > 0 ? m_unFrames : 1); i < unFrames; ++i) {
+          if (GetEntries()[i].Step < GetEntries()[i - 1].Step) {
+            m_unSegmentStart = i;
+          }
+        }
+        m_unFrames = unFrames;
+        return m_unFrames;
+      }
+
+      /****************************************/
+      /****************************************/
+
+      size_t GetFrameCount() const { return m_unFrames; }
+
+      /** Entry of a frame, un_index must be < GetFrameCount() */
+      const SFrameIndexEntry& GetEntry(size_t un_index) const {
+        return GetEntries()[un_index];
+      }
+
+      /** Index of the first frame of the latest run */
+      size_t GetLatestRunStart() const { return m_unSegmentStart; }
+
+      /****************************************/
+      /****************************************/
+
+      /**
+       * @brief Finds the last frame at or before the given step, in the
+       * latest run
+       *
+       * @return size_t index of the frame, or the first frame of the run if
+       * the step is before it. GetFrameCount() if the recording is empty.
+       */
+      size_t FindFrame(uint64_t un_step) const {
+        if (m_unFrames == 0) {
+          return 0;
+        }
+        size_t unLow = m_unSegmentStart;
+        size_t unHigh = m_unFrames;
+        /* First entry with a step > un_step */
+        while (unLow < unHigh) {
+          size_t unMid = unLow + (unHigh - unLow) / 2;
+          if (GetEntries()[unMid].Step <= un_step) {
+            unLow = unMid + 1;
+          } else {
+            unHigh = unMid;
+          }
+        }
+        return unLow > m_unSegmentStart ? unLow - 1 : m_unSegmentStart;
+      }
+
+      /****************************************/
+      /****************************************/
+
+      /**
+       * @brief Reads and decompresses a frame
+       *
+       * @param un_index index of the frame
+       * @param str_frame filled with the frame
+       * @return false if the index is out of range or the file is corrupted
+       */
+      bool ReadFrame(size_t un_index, std::string& str_frame) const {
+        if (un_index >= m_unFrames) {
+          return false;
+        }
+        uint64_t unOffset = GetEntries()[un_index].Offset;
+
+        SFrameRecordHeader sHeader;
+        if (
+          ::pread(m_nDataFd, &sHeader, sizeof(sHeader), unOffset) !=
+          sizeof(sHeader)) {
+          return false;
+        }
+
+        /* Checked before allocating, the header could be garbage */
+        struct stat sStat;
+        if (
+          ::fstat(m_nDataFd, &sStat) != 0 ||
+          sHeader.CompressedSize == 0 ||
+          sHeader.Size > FRAME_RECORD_MAX_SIZE ||
+          sHeader.Size >
+            uint64_t(sHeader.CompressedSize) * FRAME_RECORD_MAX_RATIO ||
+          unOffset + sizeof(sHeader) + sHeader.CompressedSize >
+            static_cast<uint64_t>(sStat.st_size)) {
+          return false;
+        }
+
+        std::string strCompressed(sHeader.CompressedSize, '\0');
+        if (
+          ::pread(
+            m_nDataFd,
+            &strCompressed[0],
+            sHeader.CompressedSize,
+            unOffset + sizeof(sHeader)) !=
+          static_cast<ssize_t>(sHeader.CompressedSize)) {
+          return false;
+        }
+
+        str_frame.resize(sHeader.Size);
+        uLongf unSize = sHeader.Size;
+        return uncompress(
+                 reinterpret_cast<Bytef*>(&str_frame[0]),
+                 &unSize,
+                 reinterpret_cast<const Bytef*>(strCompressed.data()),
+                 sHeader.CompressedSize) == Z_OK &&
+               unSize == sHeader.Size;
+      }
+
+     private:
+      const SFrameIndexEntry* GetEntries() const {
+        return reinterpret_cast<const SFrameIndexEntry*>(
+          static_cast<const char*>(m_pcMapping) + sizeof(FRAME_INDEX_MAGIC));
+      }
+
+     private:
+      int m_nDataFd;
+      int m_nIndexFd;
+      void* m_pcMapping;
+      size_t m_unMappedBytes;
+      size_t m_unFrames;
+      size_t m_unSegmentStart;
+    };
+  }  // namespace Webviz
+}  // namespace argos
+
+#endif
@@ -0,0 +1,159 @@
+/**
+ * @file <argos3/plugins/simulator/visualizations/webviz/utility/LEDChanges.h>
+ *
+ * @author Prajankya Sonar - <prajankya@gmail.com>
+ *
+ * @project ARGoS3-Webviz <https://github.com/NESTlab/argos3-webviz>
+ *
+ * MIT License
+ * Copyright (c) 2020 NEST Lab
+ */
+
+#ifndef ARGOS_WEBVIZ_LED_CHANGES_H
+#define ARGOS_WEBVIZ_LED_CHANGES_H
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <nlohmann/json.hpp>
+#include <string>
+#include <unordered_map>
+
+namespace argos {
+  namespace Webviz {
+
+    /**
+     * @brief Leaves the LED colors of the entities out of the frames when
+     * they did not change since the entity was last sent.
+     *
+     * LED colors rarely change, so most frames can go without them; the
+     * clients keep the colors they last received. A hash of the colors is
+     * kept per entity id. Keyframes carry all the colors, periodically and
+     * on request (e.g. when a client subscribes), so clients which missed
+     * a change catch up. Only used by the broadcaster thread, except for
+     * RequestKeyframe()
+     */
+    class CLEDChanges {
+     public:
+      /**
+       * @brief Starts a frame
+       *
+       * @param un_keyframe_period frames between keyframes, 0 for none
+       * except the requested ones
+       */
+      void BeginFrame(size_t un_keyframe_period) {
+        ++m_unFrames;
+        m_bKeyframe = m_bKeyframeRequested.exchange(false) ||
+                      (un_keyframe_period > 0 &&
+                       m_unFrames >= un_keyframe_period);
+        if (m_bKeyframe) {
+          /* Entities which are gone are forgotten */
+          m_mapHashes.clear();
+          m_unFrames = 0;
+        }
+      }
+
+      /****************************************/
+      /****************************************/
+
+      /** The next frame carries all the colors. Thread-safe */
+      void RequestKeyframe() { m_bKeyframeRequested = true; }
+
+      /** True if the current frame carries all the colors */
+      bool IsKeyframe() const { return m_bKeyframe; }
+
+      /****************************************/
+      /****************************************/
+
+      /**
+       * @brief Removes the "leds" of an entity if they are the same as when
+       * it was last sent
+       *
+       * @param c_entity entity with its "id", changed in place
+       */
+      void Filter(nlohmann::json& c_entity) {
+        if (!c_entity.is_object() || !c_entity.contains("leds")) {
+          return;
+        }
+        auto itId = c_entity.find("id");
+        if (itId == c_entity.end() || !itId->is_string()) {
+          return;
+        }
+
+        if (!IsToSend(
+              itId->get_ref<const std::string&>(), Hash(c_entity["leds"]))) {
+          c_entity.erase("leds");
+        }
+      }
+
+      /****************************************/
+      /****************************************/
+
+      /**
+       * @brief Returns true if LED colors have to be sent with an entity,
+       * as Filter() does, for entities already serialized with and without
+       * their colors
+       *
+       * @param str_id id of the entity
+       * @param un_hash Hash() of its colors
+       */
+      bool IsToSend(const std::string& str_id, uint64_t un_hash) {
+        auto itHash = m_mapHashes.find(str_id);
+        if (itHash == m_mapHashes.end()) {
+          m_mapHashes.emplace(str_id, un_hash);
+          return true;
+        }
+        if (itHash->second != un_hash) {
+          itHash->second = un_hash;
+          return true;
+        }
+        return m_bKeyframe;
+      }
+
+      /****************************************/
+      /****************************************/
+
+      /**
+       * @brief FNV-1a hash of LED colors, packed integers or, from custom
+       * serializers, any other JSON
+       */
+      static uint64_t Hash(const nlohmann::json& c_leds) {
+        uint64_t unHash = 14695981039346656037ull;
+        auto fnMix = [&unHash](uint64_t un_value) {
+          for (size_t i = 0; i < sizeof(un_value); ++i) {
+            unHash ^= (un_value >> (8 * i)) & 0xff;
+            unHash *= 1099511628211ull;
+          }
+        };
+
+        if (!c_leds.is_array()) {
+          fnMix(std::hash<std::string>()(c_leds.dump()));
+          return unHash;
+        }
+        fnMix(c_leds.size());
+        for (const auto& cLED : c_leds) {
+          if (cLED.is_number_unsigned()) {
+            fnMix(cLED.get<uint64_t>());
+          } else {
+            fnMix(std::hash<std::string>()(cLED.dump()));
+          }
+        }
+        return unHash;
+      }
+
+     private:
+      /** Hash of the colors last sent, per entity id */
+      std::unordered_map<std::string, uint64_t> m_mapHashes;
+
+      /** Frames since the last keyframe */
+      size_t m_unFrames = 0;
+
+      bool m_bKeyframe = true;
+
+      /** The first frame is a keyframe */
+      std::atomic<bool> m_bKeyframeRequested{true};
+    };
+  }  // namespace Webviz
+}  // namespace argos
+
+#endif
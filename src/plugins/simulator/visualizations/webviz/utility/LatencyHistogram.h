@@ -0,0 +1,157 @@
+/**
+ * @file
+ * <argos3/plugins/simulator/visualizations/webviz/utility/LatencyHistogram.h>
+ *
+ * @author Prajankya Sonar - <prajankya@gmail.com>
+ *
+ * @project ARGoS3-Webviz <https://github.com/NESTlab/argos3-webviz>
+ *
+ * MIT License
+ * Copyright (c) 2020 NEST Lab
+ */
+
+#ifndef ARGOS_WEBVIZ_LATENCY_HISTOGRAM_H
+#define ARGOS_WEBVIZ_LATENCY_HISTOGRAM_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace argos {
+  namespace Webviz {
+
+    /**
+     * @brief Monotonic time in microseconds, used to stamp frames.
+     *
+     * Values are only meaningful relative to each other (within the same
+     * process), they are not related to the wall clock.
+     */
+    inline int64_t GetMonotonicMicros() {
+      return std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+    }
+
+    /****************************************/
+    /****************************************/
+
+    /**
+     * @brief Lock-free histogram of latencies in microseconds.
+     *
+     * Buckets are logarithmic with 4 sub-buckets per power of two, so the
+     * error on any reported percentile is below 25%, from 1 microsecond up to
+     * a few hours.
+     */
+    class CLatencyHistogram {
+     public:
+      static const size_t SUB_BUCKETS = 4;
+      static const size_t BUCKETS = 33 * SUB_BUCKETS;
+
+      CLatencyHistogram() { Reset(); }
+
+      /****************************************/
+      /****************************************/
+
+      void Record(int64_t n_micros) {
+        if (n_micros < 0) {
+          n_micros = 0;
+        }
+        m_arrBuckets[GetBucketIndex(n_micros)].fetch_add(
+          1, std::memory_order_relaxed);
+        m_unCount.fetch_add(1, std::memory_order_relaxed);
+
+        /* Keep the maximum */
+        int64_t nMax = m_nMax.load(std::memory_order_relaxed);
+        while (n_micros > nMax &&
+               !m_nMax.compare_exchange_weak(nMax, n_micros)) {
+        }
+      }
+
+      /****************************************/
+      /****************************************/
+
+      void Reset() {
+        for (auto& unBucket : m_arrBuckets) {
+          unBucket.store(0, std::memory_order_relaxed);
+        }
+        m_unCount.store(0);
+        m_nMax.store(0);
+      }
+
+      /****************************************/
+      /****************************************/
+
+      uint64_t GetCount() const { return m_unCount.load(); }
+
+      int64_t GetMax() const { return m_nMax.load(); }
+
+      /****************************************/
+      /****************************************/
+
+      /**
+       * @brief Returns the upper bound (in microseconds) of the bucket
+       * containing the given percentile
+       *
+       * @param f_percentile in range [0,100]
+       * @return int64_t 0 if nothing was recorded
+       */
+      int64_t GetPercentile(double f_percentile) const {
+        uint64_t unCount = GetCount();
+        if (unCount == 0) {
+          return 0;
+        }
+        uint64_t unRank = static_cast<uint64_t>(f_percentile / 100.0 * unCount);
+        if (unRank >= unCount) {
+          unRank = unCount - 1;
+        }
+
+        uint64_t unSeen = 0;
+        for (size_t i = 0; i < BUCKETS; ++i) {
+          unSeen += m_arrBuckets[i].load(std::memory_order_relaxed);
+          if (unSeen > unRank) {
+            /* Never report more than what was actually recorded */
+            int64_t nUpper = GetBucketUpperBound(i);
+            return nUpper < GetMax() ? nUpper : GetMax();
+          }
+        }
+        return GetMax();
+      }
+
+      /****************************************/
+      /****************************************/
+
+      static size_t GetBucketIndex(int64_t n_micros) {
+        uint64_t unValue = static_cast<uint64_t>(n_micros);
+        if (unValue < SUB_BUCKETS) {
+          return unValue;
+        }
+        /* Position of the highest bit */
+        size_t unExponent = 63 - __builtin_clzll(unValue);
+        /* Two bits right below the highest one select the sub-bucket */
+        size_t unSub = (unValue >> (unExponent - 2)) & (SUB_BUCKETS - 1);
+        size_t unIdx = (unExponent - 1) * SUB_BUCKETS + unSub;
+        return unIdx < BUCKETS ? unIdx : BUCKETS - 1;
+      }
+
+      /****************************************/
+      /****************************************/
+
+      static int64_t GetBucketUpperBound(size_t un_index) {
+        if (un_index < SUB_BUCKETS) {
+          return un_index;
+        }
+        size_t unExponent = un_index / SUB_BUCKETS + 1;
+        size_t unSub = un_index % SUB_BUCKETS;
+        return ((int64_t(SUB_BUCKETS + unSub + 1)) << (unExponent - 2)) - 1;
+      }
+
+     private:
+      std::array<std::atomic<uint64_t>, BUCKETS> m_arrBuckets;
+      std::atomic<uint64_t> m_unCount;
+      std::atomic<int64_t> m_nMax;
+    };
+  }  // namespace Webviz
+}  // namespace argos
+
+#endif
@@ -0,0 +1,183 @@
+/**
+ * @file
+ * <argos3/plugins/simulator/visualizations/webviz/utility/OccupancyGrid.h>
+ *
+ * @author Prajankya Sonar - <prajankya@gmail.com>
+ *
+ * @project ARGoS3-Webviz <https://github.com/NESTlab/argos3-webviz>
+ *
+ * MIT License
+ * Copyright (c) 2020 NEST Lab
+ */
+
+#ifndef ARGOS_WEBVIZ_OCCUPANCY_GRID_H
+#define ARGOS_WEBVIZ_OCCUPANCY_GRID_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <nlohmann/json.hpp>
+#include <string>
+#include <vector>
+
+#include "base64.h"
+
+namespace argos {
+  namespace Webviz {
+
+    /**
+     * @brief Counts how many times the entities were in each cell of a 2D
+     * grid over the arena, to show as a heatmap.
+     *
+     * Not thread-safe, it is only used by the simulation thread.
+     */
+    class COccupancyGrid {
+     public:
+      COccupancyGrid()
+          : m_unWidth(0),
+            m_unHeight(0),
+            m_fMinX(0),
+            m_fMinY(0),
+            m_fCellSize(1),
+            m_unSamples(0) {}
+
+      /****************************************/
+      /****************************************/
+
+      /**
+       * @brief Sets the grid over a rectangle, and clears it
+       *
+       * @param f_min_x lowest corner of the rectangle
+       * @param f_min_y lowest corner of the rectangle
+       * @param f_size_x size of the rectangle
+       * @param f_size_y size of the rectangle
+       * @param f_cell_size size of the (square) cells
+       */
+      void Configure(
+        double f_min_x,
+        double f_min_y,
+        double f_size_x,
+        double f_size_y,
+        double f_cell_size) {
+        m_fMinX = f_min_x;
+        m_fMinY = f_min_y;
+        m_fCellSize = f_cell_size;
+        m_unWidth = std::max<size_t>(
+          1, static_cast<size_t>(std::ceil(f_size_x / f_cell_size)));
+        m_unHeight = std::max<size_t>(
+          1, static_cast<size_t>(std::ceil(f_size_y / f_cell_size)));
+        m_vecCounts.assign(m_unWidth * m_unHeight, 0);
+        m_unSamples = 0;
+      }
+
+      bool IsEnabled() const { return !m_vecCounts.empty(); }
+
+      size_t GetWidth() const { return m_unWidth; }
+
+      size_t GetHeight() const { return m_unHeight; }
+
+      uint32_t GetCount(size_t un_x, size_t un_y) const {
+        return m_vecCounts[un_y * m_unWidth + un_x];
+      }
+
+      /****************************************/
+      /****************************************/
+
+      void Clear() {
+        std::fill(m_vecCounts.begin(), m_vecCounts.end(), 0);
+        m_unSamples = 0;
+      }
+
+      /****************************************/
+      /****************************************/
+
+      /**
+       * @brief Adds one sample per position. Positions out of the grid are
+       * counted in the border cells
+       *
+       * @param pf_x x coordinates, contiguous
+       * @param pf_y y coordinates, contiguous
+       * @param un_count number of positions
+       */
+      void Accumulate(const double* pf_x, const double* pf_y, size_t un_count) {
+        if (m_vecCounts.empty()) {
+          return;
+        }
+
+        /* Cell indices first, a branch-free loop the compiler vectorizes,
+         * then the (scattered) increments */
+        m_vecCells.resize(un_count);
+        const double fInvCell = 1.0 / m_fCellSize;
+        const double fMaxX = static_cast<double>(m_unWidth - 1);
+        const double fMaxY = static_cast<double>(m_unHeight - 1);
+        const int64_t nWidth = static_cast<int64_t>(m_unWidth);
+        for (size_t i = 0; i < un_count; ++i) {
+          double fCellX = std::floor((pf_x[i] - m_fMinX) * fInvCell);
+          double fCellY = std::floor((pf_y[i] - m_fMinY) * fInvCell);
+          fCellX = std::min(std::max(fCellX, 0.0), fMaxX);
+          fCellY = std::min(std::max(fCellY, 0.0), fMaxY);
+          m_vecCells[i] = static_cast<int64_t>(fCellY) * nWidth +
+                          static_cast<int64_t>(fCellX);
+        }
+        for (size_t i = 0; i < un_count; ++i) {
+          ++m_vecCounts[m_vecCells[i]];
+        }
+        m_unSamples += un_count;
+      }
+
+      /****************************************/
+      /****************************************/
+
+      /**
+       * @brief Returns the grid as JSON, with the counts quantized to one
+       * byte (0-255, relative to the highest count) and base64 encoded, row
+       * by row from the lowest y
+       */
+      nlohmann::json ToJSON() const {
+        uint32_t unMax = 0;
+        for (uint32_t unCount : m_vecCounts) {
+          unMax = std::max(unMax, unCount);
+        }
+
+        std::string strQuantized(m_vecCounts.size(), '\0');
+        if (unMax > 0) {
+          const double fScale = 255.0 / unMax;
+          for (size_t i = 0; i < m_vecCounts.size(); ++i) {
+            strQuantized[i] = static_cast<char>(
+              static_cast<uint8_t>(std::lround(m_vecCounts[i] * fScale)));
+          }
+        }
+        std::string strEncoded;
+        Base64::Encode(strQuantized, &strEncoded);
+
+        nlohmann::json cJson;
+        cJson["width"] = m_unWidth;
+        cJson["height"] = m_unHeight;
+        cJson["origin"]["x"] = m_fMinX;
+        cJson["origin"]["y"] = m_fMinY;
+        cJson["cell_size"] = m_fCellSize;
+        cJson["max"] = unMax;
+        cJson["samples"] = m_unSamples;
+        cJson["data"] = strEncoded;
+        return cJson;
+      }
+
+     private:
+      size_t m_unWidth;
+      size_t m_unHeight;
+      double m_fMinX;
+      double m_fMinY;
+      double m_fCellSize;
+
+      /** Counts, row by row from the lowest y */
+      std::vector<uint32_t> m_vecCounts;
+
+      /** Cells of the positions being accumulated */
+      std::vector<int64_t> m_vecCells;
+
+      uint64_t m_unSamples;
+    };
+  }  // namespace Webviz
+}  // namespace argos
+
+#endif
@@ -0,0 +1,61 @@
+/**
+ * @file <argos3/plugins/simulator/visualizations/webviz/utility/PoseSnapshot.h>
+ *
+ * @author Prajankya Sonar - <prajankya@gmail.com>
+ *
+ * @project ARGoS3-Webviz <https://github.com/NESTlab/argos3-webviz>
+ *
+ * MIT License
+ * Copyright (c) 2020 NEST Lab
+ */
+
+#ifndef ARGOS_WEBVIZ_POSE_SNAPSHOT_H
+#define ARGOS_WEBVIZ_POSE_SNAPSHOT_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace argos {
+  namespace Webviz {
+
+    /**
+     * @brief Poses of the movable embodied entities at one step, as
+     * contiguous arrays (one per coordinate) so the aggregates computed from
+     * them run as plain loops over memory
+     */
+    struct SPoseSnapshot {
+      uint64_t Step = 0;
+
+      std::vector<std::string> Ids;
+      std::vector<std::string> Types;
+
+      std::vector<double> X;
+      std::vector<double> Y;
+      std::vector<double> Z;
+
+      /** Orientations, as quaternions */
+      std::vector<double> QX;
+      std::vector<double> QY;
+      std::vector<double> QZ;
+      std::vector<double> QW;
+
+      size_t Size() const { return Ids.size(); }
+
+      /** Empties the arrays, keeping their memory for the next step */
+      void Clear() {
+        Ids.clear();
+        Types.clear();
+        X.clear();
+        Y.clear();
+        Z.clear();
+        QX.clear();
+        QY.clear();
+        QZ.clear();
+        QW.clear();
+      }
+    };
+  }  // namespace Webviz
+}  // namespace argos
+
+#endif
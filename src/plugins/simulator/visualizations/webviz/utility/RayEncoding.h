@@ -0,0 +1,405 @@
+/**
+ * @file
+ * <argos3/plugins/simulator/visualizations/webviz/utility/RayEncoding.h>
+ *
+ * @author Prajankya Sonar - <prajankya@gmail.com>
+ *
+ * @project ARGoS3-Webviz <https://github.com/NESTlab/argos3-webviz>
+ *
+ * MIT License
+ * Copyright (c) 2020 NEST Lab
+ */
+
+#ifndef ARGOS_WEBVIZ_RAY_ENCODING_H
+#define ARGOS_WEBVIZ_RAY_ENCODING_H
+
+#include <cstdint>
+#include <cstring>
+#include <nlohmann/json.hpp>
+#include <string>
+#include <vector>
+
+#include "base64.h"
+
+namespace argos {
+  namespace Webviz {
+
+    /**
+     * @brief Packed encoding of the rays and intersection points of the
+     * robots.
+     *
+     * The points are transformed to the body frame in one pass over
+     * contiguous float arrays (one per axis), which the compiler can
+     * vectorize, then sent as base64 encoded arrays of floats, in the byte
+     * order of the host (little-endian on all supported platforms):
+     *
+     *   "rays": {"count": n, "format": "float32", "checked": <n bits>,
+     *            "data": <n * [sx, sy, sz, ex, ey, ez]>}
+     *   "points": {"count": m, "format": "float32", "data": <m * [x, y, z]>}
+     *
+     * "checked" has the bit i % 8 of byte i / 8 set if ray i intersected
+     * something. With "format": "float16", the floats are IEEE half floats,
+     * half the size, precise to about a millimeter at a few meters.
+     */
+    namespace Rays {
+
+      /** Translation and rotation to the body frame */
+      struct STransform {
+        /** Position subtracted from the points */
+        float Origin[3];
+
+        /** Rotation matrix, row by row */
+        float Matrix[9];
+      };
+
+      /**
+       * @brief Transform subtracting a position, then rotating by a unit
+       * quaternion (as CVector3::Rotate() does)
+       */
+      template <typename VECTOR, typename QUATERNION>
+      STransform MakeTransform(
+        const VECTOR& c_position, const QUATERNION& c_rotation) {
+        const float fW = c_rotation.GetW();
+        const float fX = c_rotation.GetX();
+        const float fY = c_rotation.GetY();
+        const float fZ = c_rotation.GetZ();
+        return {
+          {static_cast<float>(c_position.GetX()),
+           static_cast<float>(c_position.GetY()),
+           static_cast<float>(c_position.GetZ())},
+          {1 - 2 * (fY * fY + fZ * fZ),
+           2 * (fX * fY - fW * fZ),
+           2 * (fX * fZ + fW * fY),
+           2 * (fX * fY + fW * fZ),
+           1 - 2 * (fX * fX + fZ * fZ),
+           2 * (fY * fZ - fW * fX),
+           2 * (fX * fZ - fW * fY),
+           2 * (fY * fZ + fW * fX),
+           1 - 2 * (fX * fX + fY * fY)}};
+      }
+
+      /****************************************/
+      /****************************************/
+
+      /**
+       * @brief Transforms points in place, given as one array per axis
+       */
+      inline void TransformPoints(
+        const STransform& s_transform,
+        float* __restrict pf_x,
+        float* __restrict pf_y,
+        float* __restrict pf_z,
+        size_t un_count) {
+        const float* pfM = s_transform.Matrix;
+        const float fOX = s_transform.Origin[0];
+        const float fOY = s_transform.Origin[1];
+        const float fOZ = s_transform.Origin[2];
+        for (size_t i = 0; i < un_count; ++i) {
+          const float fX = pf_x[i] - fOX;
+          const float fY = pf_y[i] - fOY;
+          const float fZ = pf_z[i] - fOZ;
+          pf_x[i] = pfM[0] * fX + pfM[1] * fY + pfM[2] * fZ;
+          pf_y[i] = pfM[3] * fX + pfM[4] * fY + pfM[5] * fZ;
+          pf_z[i] = pfM[6] * fX + pfM[7] * fY + pfM[8] * fZ;
+        }
+      }
+
+      /****************************************/
+      /****************************************/
+
+      /** IEEE half float of a float, rounded to the nearest */
+      inline uint16_t FloatToHalf(float f_value) {
+        uint32_t unBits;
+        std::memcpy(&unBits, &f_value, sizeof(unBits));
+        const uint16_t unSign = (unBits >> 16) & 0x8000;
+        const int32_t nExponent = int32_t((unBits >> 23) & 0xff) - 127 + 15;
+        uint32_t unMantissa = unBits & 0x7fffff;
+
+        if (((unBits >> 23) & 0xff) == 0xff) {
+          /* Infinity or NaN */
+          return unSign | 0x7c00 | (unMantissa != 0 ? 0x200 : 0);
+        } else if (nExponent >= 31) {
+          /* Too large, infinity */
+          return unSign | 0x7c00;
+        } else if (nExponent <= 0) {
+          /* Subnormal, or too small */
+          if (nExponent < -10) {
+            return unSign;
+          }
+          unMantissa |= 0x800000;
+          const uint32_t unShift = 14 - nExponent;
+          uint16_t unHalf = unMantissa >> unShift;
+          if ((unMantissa >> (unShift - 1)) & 1) {
+            ++unHalf;
+          }
+          return unSign | unHalf;
+        }
+
+        uint16_t unHalf = unSign | (nExponent << 10) | (unMantissa >> 13);
+        /* A carry into the exponent is still the right rounding */
+        if (unMantissa & 0x1000) {
+          ++unHalf;
+        }
+        return unHalf;
+      }
+
+      /** Float of an IEEE half float */
+      inline float HalfToFloat(uint16_t un_half) {
+        const uint32_t unSign = uint32_t(un_half & 0x8000) << 16;
+        uint32_t unExponent = (un_half >> 10) & 0x1f;
+        uint32_t unMantissa = un_half & 0x3ff;
+        uint32_t unBits;
+        if (unExponent == 0x1f) {
+          unBits = unSign | 0x7f800000 | (unMantissa << 13);
+        } else if (unExponent != 0) {
+          unBits =
+            unSign | ((unExponent + 127 - 15) << 23) | (unMantissa << 13);
+        } else if (unMantissa == 0) {
+          unBits = unSign;
+        } else {
+          /* Subnormal, normalized as a float */
+          unExponent = 127 - 15 + 1;
+          while ((unMantissa & 0x400) == 0) {
+            unMantissa <<= 1;
+            --unExponent;
+          }
+          unBits = unSign | (unExponent << 23) | ((unMantissa & 0x3ff) << 13);
+        }
+        float fValue;
+        std::memcpy(&fValue, &unBits, sizeof(fValue));
+        return fValue;
+      }
+
+      /****************************************/
+      /****************************************/
+
+      /** Base64 of the bytes of floats, as float32 or float16 */
+      inline std::string EncodeFloats(
+        const float* pf_values, size_t un_count, bool b_half) {
+        std::string strBytes;
+        if (b_half) {
+          strBytes.resize(un_count * sizeof(uint16_t));
+          for (size_t i = 0; i < un_count; ++i) {
+            const uint16_t unHalf = FloatToHalf(pf_values[i]);
+            std::memcpy(&strBytes[i * sizeof(uint16_t)], &unHalf, 2);
+          }
+        } else {
+          strBytes.assign(
+            reinterpret_cast<const char*>(pf_values), un_count * sizeof(float));
+        }
+        std::string strEncoded;
+        Base64::Encode(strBytes, &strEncoded);
+        return strEncoded;
+      }
+
+      /**
+       * @brief Floats of an encoded array
+       *
+       * @return false if the data is not valid
+       */
+      inline bool DecodeFloats(
+        const std::string& str_encoded,
+        bool b_half,
+        std::vector<float>& vec_values) {
+        std::string strBytes;
+        if (!Base64::Decode(str_encoded, &strBytes)) {
+          return false;
+        }
+        const size_t unSize = b_half ? sizeof(uint16_t) : sizeof(float);
+        if (strBytes.size() % unSize != 0) {
+          return false;
+        }
+        vec_values.resize(strBytes.size() / unSize);
+        for (size_t i = 0; i < vec_values.size(); ++i) {
+          if (b_half) {
+            uint16_t unHalf;
+            std::memcpy(&unHalf, &strBytes[i * unSize], unSize);
+            vec_values[i] = HalfToFloat(unHalf);
+          } else {
+            std::memcpy(&vec_values[i], &strBytes[i * unSize], unSize);
+          }
+        }
+        return true;
+      }
+
+      /****************************************/
+      /****************************************/
+
+      /**
+       * @brief Encodes the checked rays of a robot, in the body frame
+       *
+       * @param vec_rays rays, as (checked, ray) with GetStart() and GetEnd()
+       * @param s_transform transform to the body frame
+       */
+      template <typename RAYS>
+      nlohmann::json EncodeRays(
+        const RAYS& vec_rays, const STransform& s_transform) {
+        const size_t unCount = vec_rays.size();
+
+        /* Starts, then ends, one array per axis, reused between calls */
+        thread_local std::vector<float> vecX, vecY, vecZ, vecData;
+        vecX.resize(2 * unCount);
+        vecY.resize(2 * unCount);
+        vecZ.resize(2 * unCount);
+        std::string strChecked((unCount + 7) / 8, '\0');
+        for (size_t i = 0; i < unCount; ++i) {
+          const auto& cStart = vec_rays[i].second.GetStart();
+          const auto& cEnd = vec_rays[i].second.GetEnd();
+          vecX[i] = cStart.GetX();
+          vecY[i] = cStart.GetY();
+          vecZ[i] = cStart.GetZ();
+          vecX[unCount + i] = cEnd.GetX();
+          vecY[unCount + i] = cEnd.GetY();
+          vecZ[unCount + i] = cEnd.GetZ();
+          if (vec_rays[i].first) {
+            strChecked[i / 8] |= char(1 << (i % 8));
+          }
+        }
+
+        TransformPoints(
+          s_transform, vecX.data(), vecY.data(), vecZ.data(), 2 * unCount);
+
+        vecData.resize(6 * unCount);
+        for (size_t i = 0; i < unCount; ++i) {
+          vecData[6 * i + 0] = vecX[i];
+          vecData[6 * i + 1] = vecY[i];
+          vecData[6 * i + 2] = vecZ[i];
+          vecData[6 * i + 3] = vecX[unCount + i];
+          vecData[6 * i + 4] = vecY[unCount + i];
+          vecData[6 * i + 5] = vecZ[unCount + i];
+        }
+
+        std::string strCheckedEncoded;
+        Base64::Encode(strChecked, &strCheckedEncoded);
+
+        nlohmann::json cJson;
+        cJson["count"] = unCount;
+        cJson["format"] = "float32";
+        cJson["checked"] = std::move(strCheckedEncoded);
+        cJson["data"] = EncodeFloats(vecData.data(), vecData.size(), false);
+        return cJson;
+      }
+
+      /****************************************/
+      /****************************************/
+
+      /**
+       * @brief Encodes the intersection points of a robot, in the body frame
+       *
+       * @param vec_points points, with GetX(), GetY() and GetZ()
+       * @param s_transform transform to the body frame
+       */
+      template <typename POINTS>
+      nlohmann::json EncodePoints(
+        const POINTS& vec_points, const STransform& s_transform) {
+        const size_t unCount = vec_points.size();
+
+        thread_local std::vector<float> vecX, vecY, vecZ, vecData;
+        vecX.resize(unCount);
+        vecY.resize(unCount);
+        vecZ.resize(unCount);
+        for (size_t i = 0; i < unCount; ++i) {
+          vecX[i] = vec_points[i].GetX();
+          vecY[i] = vec_points[i].GetY();
+          vecZ[i] = vec_points[i].GetZ();
+        }
+
+        TransformPoints(
+          s_transform, vecX.data(), vecY.data(), vecZ.data(), unCount);
+
+        vecData.resize(3 * unCount);
+        for (size_t i = 0; i < unCount; ++i) {
+          vecData[3 * i + 0] = vecX[i];
+          vecData[3 * i + 1] = vecY[i];
+          vecData[3 * i + 2] = vecZ[i];
+        }
+
+        nlohmann::json cJson;
+        cJson["count"] = unCount;
+        cJson["format"] = "float32";
+        cJson["data"] = EncodeFloats(vecData.data(), vecData.size(), false);
+        return cJson;
+      }
+
+      /****************************************/
+      /****************************************/
+
+      /**
+       * @brief Appends the counts of rays and points and a running hash of
+       * their values as they are in the simulation, so the fingerprint of a
+       * robot changes when they do (see Fields::Custom()). The values are
+       * hashed as they are read, 16 bytes are appended whatever the number
+       * of rays. Their transform only depends on the pose
+       */
+      template <typename RAYS, typename POINTS>
+      void PackState(
+        std::string& str_buffer,
+        const RAYS& vec_rays,
+        const POINTS& vec_points) {
+        /* FNV-1a over 32-bit words rather than bytes */
+        uint64_t unHash = 14695981039346656037ull;
+        auto fnMix = [&unHash](uint32_t un_word) {
+          unHash ^= un_word;
+          unHash *= 1099511628211ull;
+        };
+        auto fnMixVector = [&fnMix](const auto& c_vector) {
+          for (const float fValue :
+               {static_cast<float>(c_vector.GetX()),
+                static_cast<float>(c_vector.GetY()),
+                static_cast<float>(c_vector.GetZ())}) {
+            uint32_t unBits;
+            std::memcpy(&unBits, &fValue, sizeof(unBits));
+            fnMix(unBits);
+          }
+        };
+        for (const auto& cRay : vec_rays) {
+          fnMix(cRay.first ? 1 : 0);
+          fnMixVector(cRay.second.GetStart());
+          fnMixVector(cRay.second.GetEnd());
+        }
+        for (const auto& cPoint : vec_points) {
+          fnMixVector(cPoint);
+        }
+        const uint32_t pnCounts[2] = {
+          static_cast<uint32_t>(vec_rays.size()),
+          static_cast<uint32_t>(vec_points.size())};
+        str_buffer.append(
+          reinterpret_cast<const char*>(pnCounts), sizeof(pnCounts));
+        str_buffer.append(
+          reinterpret_cast<const char*>(&unHash), sizeof(unHash));
+      }
+
+      /****************************************/
+      /****************************************/
+
+      /**
+       * @brief Converts the "rays" and "points" of an entity from float32 to
+       * float16, e.g. for the broadcasts. Others are left as they are
+       *
+       * @param c_entity entity, changed in place
+       */
+      inline void QuantizeToHalf(nlohmann::json& c_entity) {
+        thread_local std::vector<float> vecValues;
+        for (const char* pchKey : {"rays", "points"}) {
+          auto itEncoded = c_entity.find(pchKey);
+          if (
+            itEncoded == c_entity.end() || !itEncoded->is_object() ||
+            itEncoded->value("format", "") != "float32" ||
+            !itEncoded->contains("data") ||
+            !(*itEncoded)["data"].is_string()) {
+            continue;
+          }
+          nlohmann::json& cData = (*itEncoded)["data"];
+          if (!DecodeFloats(
+                cData.get_ref<const std::string&>(), false, vecValues)) {
+            continue;
+          }
+          cData = EncodeFloats(vecValues.data(), vecValues.size(), true);
+          (*itEncoded)["format"] = "float16";
+        }
+      }
+    }  // namespace Rays
+  }  // namespace Webviz
+}  // namespace argos
+
+#endif
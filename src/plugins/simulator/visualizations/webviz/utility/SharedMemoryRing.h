@@ -0,0 +1,429 @@
+/**
+ * @file
+ * <argos3/plugins/simulator/visualizations/webviz/utility/SharedMemoryRing.h>
+ *
+ * @author Prajankya Sonar - <prajankya@gmail.com>
+ *
+ * @project ARGoS3-Webviz <https://github.com/NESTlab/argos3-webviz>
+ *
+ * MIT License
+ * Copyright (c) 2020 NEST Lab
+ */
+
+#ifndef ARGOS_WEBVIZ_SHARED_MEMORY_RING_H
+#define ARGOS_WEBVIZ_SHARED_MEMORY_RING_H
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+namespace argos {
+  namespace Webviz {
+
+    /**
+     * @brief Layout of the shared-memory ring of frames.
+     *
+     * A header, then SlotCount slots of SlotSize bytes each, a slot being
+     * an SSlot followed by the frame. Frame n (from 0) is written in slot
+     * n % SlotCount. Each slot is a seqlock: its sequence is 2n+1 while
+     * frame n is written, and 2n+2 once it is complete, so readers can
+     * check that a frame was not overwritten while they read it.
+     */
+    namespace Shm {
+      static constexpr char MAGIC[8] = {'W', 'V', 'Z', 'R', 'I', 'N', 'G', '1'};
+
+      struct SHeader {
+        char Magic[8];
+        uint32_t SlotCount;
+        uint32_t Reserved;
+        uint64_t SlotSize;
+        /** Number of frames written so far */
+        std::atomic<uint64_t> Written;
+      };
+
+      struct SSlot {
+        std::atomic<uint64_t> Sequence;
+        uint64_t Step;
+        uint64_t Size;
+      };
+
+      static_assert(
+        std::atomic<uint64_t>::is_always_lock_free,
+        "The ring needs lock-free 64 bits atomics");
+
+      /** Rounded so the slots stay aligned */
+      inline uint64_t HeaderSize() {
+        return (sizeof(SHeader) + 63) / 64 * 64;
+      }
+    }  // namespace Shm
+
+    /****************************************/
+    /****************************************/
+
+    /**
+     * @brief Writes frames in a POSIX shared-memory ring. A single writer
+     * per ring, no locks nor syscalls per frame
+     */
+    class CSharedMemoryRingWriter {
+     public:
+      CSharedMemoryRingWriter()
+          : m_pcMemory(nullptr), m_unBytes(0), m_unSkipped(0) {}
+
+      ~CSharedMemoryRingWriter() { Close(); }
+
+      /****************************************/
+      /****************************************/
+
+      /**
+       * @brief Creates (or replaces) the ring
+       *
+       * @param str_name name of the shared-memory object, e.g. "/webviz"
+       * @param un_slots number of frames kept
+       * @param un_max_frame_bytes size of the largest frame
+       * @return false if the shared memory can not be created
+       */
+      bool Open(
+        const std::string& str_name,
+        uint32_t un_slots,
+        uint64_t un_max_frame_bytes) {
+        Close();
+        if (un_slots == 0) {
+          return false;
+        }
+
+        const uint64_t unSlotSize =
+          (sizeof(Shm::SSlot) + un_max_frame_bytes + 63) / 64 * 64;
+        const uint64_t unBytes = Shm::HeaderSize() + un_slots * unSlotSize;
+
+        /* Readers of a previous run keep their own mapping */
+        shm_unlink(str_name.c_str());
+        int nFd = shm_open(str_name.c_str(), O_CREAT | O_RDWR | O_EXCL, 0644);
+        if (nFd < 0) {
+          return false;
+        }
+        if (ftruncate(nFd, static_cast<off_t>(unBytes)) != 0) {
+          close(nFd);
+          shm_unlink(str_name.c_str());
+          return false;
+        }
+        void* pMemory =
+          mmap(nullptr, unBytes, PROT_READ | PROT_WRITE, MAP_SHARED, nFd, 0);
+        close(nFd);
+        if (pMemory == MAP_FAILED) {
+          shm_unlink(str_name.c_str());
+          return false;
+        }
+
+        /* New memory is zeroed, so all the sequences are 0 (empty) */
+        m_pcMemory = static_cast<char*>(pMemory);
+        m_unBytes = unBytes;
+        m_strName = str_name;
+
+        Shm::SHeader* psHeader = Header();
+        psHeader->SlotCount = un_slots;
+        psHeader->SlotSize = unSlotSize;
+        psHeader->Written.store(0, std::memory_order_relaxed);
+        /* Magic last, readers wait for it */
+        std::atomic_thread_fence(std::memory_order_release);
+        std::memcpy(psHeader->Magic, Shm::MAGIC, sizeof(Shm::MAGIC));
+        return true;
+      }
+
+      /****************************************/
+      /****************************************/
+
+      bool IsOpen() const { return m_pcMemory != nullptr; }
+
+      /** Frames too large for a slot, not written */
+      uint64_t GetSkipped() const { return m_unSkipped; }
+
+      /****************************************/
+      /****************************************/
+
+      /**
+       * @brief Writes a frame in the next slot, overwriting the oldest one
+       *
+       * @return false if the frame does not fit in a slot
+       */
+      bool Write(uint64_t un_step, const std::string& str_frame) {
+        if (m_pcMemory == nullptr) {
+          return false;
+        }
+        Shm::SHeader* psHeader = Header();
+        if (str_frame.size() > psHeader->SlotSize - sizeof(Shm::SSlot)) {
+          ++m_unSkipped;
+          return false;
+        }
+
+        const uint64_t unFrame =
+          psHeader->Written.load(std::memory_order_relaxed);
+        Shm::SSlot* psSlot = Slot(unFrame % psHeader->SlotCount);
+
+        /* Odd while writing */
+        psSlot->Sequence.store(2 * unFrame + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        psSlot->Step = un_step;
+        psSlot->Size = str_frame.size();
+        std::memcpy(
+          reinterpret_cast<char*>(psSlot + 1),
+          str_frame.data(),
+          str_frame.size());
+
+        psSlot->Sequence.store(2 * unFrame + 2, std::memory_order_release);
+        psHeader->Written.store(unFrame + 1, std::memory_order_release);
+        return true;
+      }
+
+      /****************************************/
+      /****************************************/
+
+      /** Unmaps and removes the ring, readers keep their mapping */
+      void Close() {
+        if (m_pcMemory != nullptr) {
+          munmap(m_pcMemory, m_unBytes);
+          shm_unlink(m_strName.c_str());
+          m_pcMemory = nullptr;
+        }
+      }
+
+     private:
+      Shm::SHeader* Header() {
+        return reinterpret_cast<Shm::SHeader*>(m_pcMemory);
+      }
+
+      Shm::SSlot* Slot(uint64_t un_slot) {
+        return reinterpret_cast<Shm::SSlot*>(
+          m_pcMemory + Shm::HeaderSize() + un_slot * Header()->SlotSize);
+      }
+
+     private:
+      char* m_pcMemory;
+      uint64_t m_unBytes;
+      std::string m_strName;
+      uint64_t m_unSkipped;
+    };
+
+    /****************************************/
+    /****************************************/
+
+    /**
+     * @brief Reads frames from a shared-memory ring, any number of readers
+     * per ring. Frames are read in place, without copies nor syscalls
+     */
+    class CSharedMemoryRingReader {
+     public:
+      /** Outcome of reading a frame */
+      enum class EStatus {
+        /** The frame is available */
+        OK = 0,
+        /** The frame is not written yet */
+        NOT_YET,
+        /** The frame was overwritten, the reader is too slow */
+        LOST
+      };
+
+      /** A frame read in place. Only valid until its slot is reused: check
+       * it with IsValid() after using the data */
+      struct SFrame {
+        uint64_t Index;
+        uint64_t Step;
+        const char* Data;
+        uint64_t Size;
+      };
+
+      CSharedMemoryRingReader()
+          : m_pcMemory(nullptr), m_unBytes(0), m_unNext(0) {}
+
+      ~CSharedMemoryRingReader() { Close(); }
+
+      /****************************************/
+      /****************************************/
+
+      /**
+       * @brief Maps an existing ring, starting at its latest frame
+       *
+       * @param str_name name of the shared-memory object, e.g. "/webviz"
+       * @return false if there is no such ring (yet)
+       */
+      bool Open(const std::string& str_name) {
+        Close();
+        int nFd = shm_open(str_name.c_str(), O_RDONLY, 0);
+        if (nFd < 0) {
+          return false;
+        }
+        struct stat sStat;
+        if (
+          fstat(nFd, &sStat) != 0 ||
+          static_cast<uint64_t>(sStat.st_size) < Shm::HeaderSize()) {
+          close(nFd);
+          return false;
+        }
+        void* pMemory =
+          mmap(nullptr, sStat.st_size, PROT_READ, MAP_SHARED, nFd, 0);
+        close(nFd);
+        if (pMemory == MAP_FAILED) {
+          return false;
+        }
+        m_pcMemory = static_cast<const char*>(pMemory);
+        m_unBytes = sStat.st_size;
+
+        /* Not initialized yet, or not a ring */
+        const Shm::SHeader* psHeader = Header();
+        if (
+          std::memcmp(psHeader->Magic, Shm::MAGIC, sizeof(Shm::MAGIC)) != 0 ||
+          Shm::HeaderSize() + psHeader->SlotCount * psHeader->SlotSize >
+            m_unBytes) {
+          Close();
+          return false;
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+
+        const uint64_t unWritten = GetWritten();
+        m_unNext = unWritten > 0 ? unWritten - 1 : 0;
+        return true;
+      }
+
+      /****************************************/
+      /****************************************/
+
+      bool IsOpen() const { return m_pcMemory != nullptr; }
+
+      /** Number of frames written so far */
+      uint64_t GetWritten() const {
+        return Header()->Written.load(std::memory_order_acquire);
+      }
+
+      uint32_t GetSlotCount() const { return Header()->SlotCount; }
+
+      /****************************************/
+      /****************************************/
+
+      /**
+       * @brief Reads one frame in place
+       *
+       * @param un_index index of the frame, from 0
+       * @param s_frame the frame, if OK
+       */
+      EStatus Peek(uint64_t un_index, SFrame& s_frame) const {
+        const Shm::SSlot* psSlot = Slot(un_index % Header()->SlotCount);
+        const uint64_t unSequence =
+          psSlot->Sequence.load(std::memory_order_acquire);
+        if (unSequence < 2 * un_index + 2) {
+          return EStatus::NOT_YET;
+        } else if (unSequence > 2 * un_index + 2) {
+          return EStatus::LOST;
+        }
+
+        s_frame.Index = un_index;
+        s_frame.Step = psSlot->Step;
+        s_frame.Size = psSlot->Size;
+        s_frame.Data = reinterpret_cast<const char*>(psSlot + 1);
+
+        /* Checked again, the slot might have been reused meanwhile */
+        return IsValid(s_frame) ? EStatus::OK : EStatus::LOST;
+      }
+
+      /****************************************/
+      /****************************************/
+
+      /**
+       * @brief Returns true if the frame was not overwritten since it was
+       * peeked, i.e. if what was read from its data is consistent
+       */
+      bool IsValid(const SFrame& s_frame) const {
+        std::atomic_thread_fence(std::memory_order_acquire);
+        const Shm::SSlot* psSlot = Slot(s_frame.Index % Header()->SlotCount);
+        return psSlot->Sequence.load(std::memory_order_relaxed) ==
+               2 * s_frame.Index + 2;
+      }
+
+      /****************************************/
+      /****************************************/
+
+      /**
+       * @brief Reads the next frame in place, skipping the lost ones
+       *
+       * @param s_frame the frame, if OK
+       * @param un_lost incremented by the number of frames lost
+       * @return EStatus OK or NOT_YET
+       */
+      EStatus Next(SFrame& s_frame, uint64_t& un_lost) {
+        while (true) {
+          EStatus eStatus = Peek(m_unNext, s_frame);
+          if (eStatus == EStatus::OK) {
+            ++m_unNext;
+            return EStatus::OK;
+          } else if (eStatus == EStatus::NOT_YET) {
+            return EStatus::NOT_YET;
+          }
+          /* Lapped by the writer, skip to the oldest frame still there */
+          uint64_t unWritten = GetWritten();
+          uint64_t unOldest = unWritten > GetSlotCount()
+                                ? unWritten - GetSlotCount() + 1
+                                : 0;
+          uint64_t unFirst = std::max(unOldest, m_unNext + 1);
+          un_lost += unFirst - m_unNext;
+          m_unNext = unFirst;
+        }
+      }
+
+      /****************************************/
+      /****************************************/
+
+      /**
+       * @brief Copies the next frame
+       *
+       * @return EStatus OK or NOT_YET
+       */
+      EStatus Next(
+        std::string& str_frame, uint64_t& un_step, uint64_t& un_lost) {
+        SFrame sFrame;
+        while (Next(sFrame, un_lost) == EStatus::OK) {
+          str_frame.assign(sFrame.Data, sFrame.Size);
+          if (IsValid(sFrame)) {
+            un_step = sFrame.Step;
+            return EStatus::OK;
+          }
+          ++un_lost;
+        }
+        return EStatus::NOT_YET;
+      }
+
+      /****************************************/
+      /****************************************/
+
+      void Close() {
+        if (m_pcMemory != nullptr) {
+          munmap(const_cast<char*>(m_pcMemory), m_unBytes);
+          m_pcMemory = nullptr;
+        }
+      }
+
+     private:
+      const Shm::SHeader* Header() const {
+        return reinterpret_cast<const Shm::SHeader*>(m_pcMemory);
+      }
+
+      const Shm::SSlot* Slot(uint64_t un_slot) const {
+        return reinterpret_cast<const Shm::SSlot*>(
+          m_pcMemory + Shm::HeaderSize() + un_slot * Header()->SlotSize);
+      }
+
+     private:
+      const char* m_pcMemory;
+      uint64_t m_unBytes;
+      /** Index of the next frame to read */
+      uint64_t m_unNext;
+    };
+  }  // namespace Webviz
+}  // namespace argos
+
+#endif
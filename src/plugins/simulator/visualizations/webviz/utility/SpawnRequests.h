@@ -0,0 +1,229 @@
+/**
+ * @file
+ * <argos3/plugins/simulator/visualizations/webviz/utility/SpawnRequests.h>
+ *
+ * @author Prajankya Sonar - <prajankya@gmail.com>
+ *
+ * @project ARGoS3-Webviz <https://github.com/NESTlab/argos3-webviz>
+ *
+ * MIT License
+ * Copyright (c) 2020 NEST Lab
+ */
+
+#ifndef ARGOS_WEBVIZ_SPAWN_REQUESTS_H
+#define ARGOS_WEBVIZ_SPAWN_REQUESTS_H
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <nlohmann/json.hpp>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace argos {
+  namespace Webviz {
+
+    /** Entities to add, at random poses in a region */
+    struct SSpawnRequest {
+      /** Type of the entities, as in the configuration file */
+      std::string Type;
+
+      /** Number of entities, in [1,100000] */
+      size_t Count = 0;
+
+      /** Id of the controller configuration, empty for none */
+      std::string Controller;
+
+      /** Prefix of the ids, followed by a number */
+      std::string IdPrefix;
+
+      /** Corners of the region, as {x, y, z} */
+      double Min[3] = {0, 0, 0};
+      double Max[3] = {0, 0, 0};
+
+      /** Poses tried per entity before giving up on it, in [1,10000] */
+      size_t MaxTrials = 100;
+
+      /** Other attributes of the entities (e.g. "size" of boxes) */
+      std::map<std::string, std::string> Attributes;
+
+      /****************************************/
+      /****************************************/
+
+      /**
+       * @brief Reads a request from a "spawnEntities" command:
+       * {"type": "foot-bot", "count": 100, "controller": "fdc", "region":
+       * {"min": {"x": -1, "y": -1}, "max": {"x": 1, "y": 1}}}, and
+       * optionally "id_prefix", "max_trials" and "attributes"
+       *
+       * @return std::string error message, empty on success
+       */
+      std::string FromJSON(const nlohmann::json& c_command) {
+        if (!c_command.is_object()) {
+          return "The command must be a JSON object";
+        }
+
+        auto itType = c_command.find("type");
+        if (
+          itType == c_command.end() || !itType->is_string() ||
+          itType->get_ref<const std::string&>().empty()) {
+          return "\"type\" must be the type of the entities";
+        }
+        auto itCount = c_command.find("count");
+        if (
+          itCount == c_command.end() || !itCount->is_number_integer() ||
+          itCount->get<int64_t>() < 1 || itCount->get<int64_t>() > 100000) {
+          return "\"count\" is out of range [1,100000]";
+        }
+
+        SSpawnRequest sRequest;
+        sRequest.Type = itType->get<std::string>();
+        sRequest.Count = itCount->get<size_t>();
+        sRequest.IdPrefix = "spawn_" + sRequest.Type + "_";
+
+        for (auto it = c_command.begin(); it != c_command.end(); ++it) {
+          const std::string& strKey = it.key();
+          const nlohmann::json& cValue = it.value();
+
+          if (strKey == "controller") {
+            if (!cValue.is_string()) {
+              return "\"controller\" must be the id of a controller";
+            }
+            sRequest.Controller = cValue.get<std::string>();
+          } else if (strKey == "id_prefix") {
+            if (
+              !cValue.is_string() ||
+              cValue.get_ref<const std::string&>().empty()) {
+              return "\"id_prefix\" must be a non-empty string";
+            }
+            sRequest.IdPrefix = cValue.get<std::string>();
+          } else if (strKey == "max_trials") {
+            if (
+              !cValue.is_number_integer() || cValue.get<int64_t>() < 1 ||
+              cValue.get<int64_t>() > 10000) {
+              return "\"max_trials\" is out of range [1,10000]";
+            }
+            sRequest.MaxTrials = cValue.get<size_t>();
+          } else if (strKey == "attributes") {
+            if (!cValue.is_object()) {
+              return "\"attributes\" must be a JSON object";
+            }
+            for (auto itAttr = cValue.begin(); itAttr != cValue.end();
+                 ++itAttr) {
+              if (itAttr.key() == "id" || !itAttr.value().is_string()) {
+                return "\"attributes\" must be strings, other than \"id\"";
+              }
+              sRequest.Attributes[itAttr.key()] =
+                itAttr.value().get<std::string>();
+            }
+          }
+        }
+
+        auto itRegion = c_command.find("region");
+        if (
+          itRegion == c_command.end() || !itRegion->is_object() ||
+          !ReadCorner(*itRegion, "min", sRequest.Min) ||
+          !ReadCorner(*itRegion, "max", sRequest.Max)) {
+          return "\"region\" must be {\"min\": {\"x\", \"y\"}, "
+                 "\"max\": {\"x\", \"y\"}}, \"z\" being optional";
+        }
+        for (size_t i = 0; i < 3; ++i) {
+          if (sRequest.Min[i] > sRequest.Max[i]) {
+            return "\"region\" must have its \"min\" below its \"max\"";
+          }
+        }
+
+        *this = std::move(sRequest);
+        return "";
+      }
+
+     private:
+      /** Reads {"x", "y"} and an optional "z" */
+      static bool ReadCorner(
+        const nlohmann::json& c_region, const char* pch_key, double* pf_xyz) {
+        auto itCorner = c_region.find(pch_key);
+        if (itCorner == c_region.end() || !itCorner->is_object()) {
+          return false;
+        }
+        const char* pchAxes[] = {"x", "y", "z"};
+        for (size_t i = 0; i < 3; ++i) {
+          auto itAxis = itCorner->find(pchAxes[i]);
+          if (itAxis == itCorner->end()) {
+            if (i < 2) {
+              return false;
+            }
+            continue;
+          }
+          if (!itAxis->is_number()) {
+            return false;
+          }
+          pf_xyz[i] = itAxis->get<double>();
+        }
+        return true;
+      }
+    };
+
+    /****************************************/
+    /****************************************/
+
+    /**
+     * @brief Pending "spawnEntities" commands.
+     *
+     * Clients add requests from the webserver threads; the simulation
+     * thread takes them all at its next frame, between two steps, and adds
+     * the entities of each in one batch.
+     */
+    class CSpawnRequests {
+     public:
+      /**
+       * @param un_max_pending maximum number of requests waiting, further
+       * ones are refused
+       */
+      explicit CSpawnRequests(size_t un_max_pending = 16)
+          : m_unMaxPending(un_max_pending), m_bPending(false) {}
+
+      /**
+       * @brief Adds a request
+       *
+       * @return false if too many requests are waiting
+       */
+      bool Add(SSpawnRequest s_request) {
+        std::lock_guard<std::mutex> guard(m_mutex4Requests);
+        if (m_vecRequests.size() >= m_unMaxPending) {
+          return false;
+        }
+        m_vecRequests.push_back(std::move(s_request));
+        m_bPending = true;
+        return true;
+      }
+
+      /** Lock-free check, so idle frames cost nothing */
+      bool HasPending() const { return m_bPending; }
+
+      /** Takes the requests waiting, in their order */
+      std::vector<SSpawnRequest> Take() {
+        std::vector<SSpawnRequest> vecRequests;
+        if (!m_bPending) {
+          return vecRequests;
+        }
+        std::lock_guard<std::mutex> guard(m_mutex4Requests);
+        vecRequests.swap(m_vecRequests);
+        m_bPending = false;
+        return vecRequests;
+      }
+
+     private:
+      size_t m_unMaxPending;
+
+      std::vector<SSpawnRequest> m_vecRequests;
+
+      std::atomic<bool> m_bPending;
+
+      std::mutex m_mutex4Requests;
+    };
+  }  // namespace Webviz
+}  // namespace argos
+
+#endif
@@ -0,0 +1,228 @@
+/**
+ * @file
+ * <argos3/plugins/simulator/visualizations/webviz/utility/SwarmStatistics.h>
+ *
+ * @author Prajankya Sonar - <prajankya@gmail.com>
+ *
+ * @project ARGoS3-Webviz <https://github.com/NESTlab/argos3-webviz>
+ *
+ * MIT License
+ * Copyright (c) 2020 NEST Lab
+ */
+
+#ifndef ARGOS_WEBVIZ_SWARM_STATISTICS_H
+#define ARGOS_WEBVIZ_SWARM_STATISTICS_H
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <nlohmann/json.hpp>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "PoseSnapshot.h"
+
+namespace argos {
+  namespace Webviz {
+
+    /**
+     * @brief Swarm-level statistics of each entity type: count, centroid,
+     * bounding box, dispersion, mean speed and polarization.
+     *
+     * Poses are split per type into contiguous arrays, and each statistic is
+     * a plain loop over them. Speeds come from the previous call, so it must
+     * be called with consecutive snapshots. Not thread-safe.
+     */
+    class CSwarmStatistics {
+     public:
+      CSwarmStatistics() : m_unPreviousStep(0) {}
+
+      /****************************************/
+      /****************************************/
+
+      /**
+       * @brief Computes the statistics of the snapshot
+       *
+       * @param s_poses poses of the entities
+       * @param f_seconds_per_step length of a simulation step, for speeds
+       * @return nlohmann::json statistics, by entity type
+       */
+      nlohmann::json Compute(
+        const SPoseSnapshot& s_poses, double f_seconds_per_step) {
+        /* Split per type, keeping the arrays between calls */
+        for (auto& cType : m_mapTypes) {
+          cType.second.Clear();
+        }
+        for (size_t i = 0; i < s_poses.Size(); ++i) {
+          STypePoses& sType = m_mapTypes[s_poses.Types[i]];
+          sType.X.push_back(s_poses.X[i]);
+          sType.Y.push_back(s_poses.Y[i]);
+          sType.Z.push_back(s_poses.Z[i]);
+          sType.Heading.push_back(Yaw(
+            s_poses.QX[i], s_poses.QY[i], s_poses.QZ[i], s_poses.QW[i]));
+
+          /* Previous position, NaN for new entities */
+          auto itPrevious = m_mapPrevious.find(s_poses.Ids[i]);
+          bool bKnown = itPrevious != m_mapPrevious.end();
+          const double fNaN = std::numeric_limits<double>::quiet_NaN();
+          sType.PreviousX.push_back(bKnown ? itPrevious->second[0] : fNaN);
+          sType.PreviousY.push_back(bKnown ? itPrevious->second[1] : fNaN);
+          sType.PreviousZ.push_back(bKnown ? itPrevious->second[2] : fNaN);
+        }
+
+        /* Elapsed time since the previous snapshot, none after a reset */
+        double fElapsed = 0;
+        if (!m_mapPrevious.empty() && s_poses.Step > m_unPreviousStep) {
+          fElapsed = (s_poses.Step - m_unPreviousStep) * f_seconds_per_step;
+        }
+
+        nlohmann::json cStats = nlohmann::json::object();
+        for (const auto& cType : m_mapTypes) {
+          if (!cType.second.X.empty()) {
+            cStats[cType.first] = ComputeType(cType.second, fElapsed);
+          }
+        }
+
+        m_mapPrevious.clear();
+        for (size_t i = 0; i < s_poses.Size(); ++i) {
+          m_mapPrevious[s_poses.Ids[i]] = {
+            {s_poses.X[i], s_poses.Y[i], s_poses.Z[i]}};
+        }
+        m_unPreviousStep = s_poses.Step;
+        return cStats;
+      }
+
+      /****************************************/
+      /****************************************/
+
+      /** Forgets the previous snapshot, e.g. after a reset */
+      void Clear() {
+        m_mapPrevious.clear();
+        m_unPreviousStep = 0;
+      }
+
+     private:
+      /** Poses of the entities of one type */
+      struct STypePoses {
+        std::vector<double> X;
+        std::vector<double> Y;
+        std::vector<double> Z;
+        std::vector<double> Heading;
+        std::vector<double> PreviousX;
+        std::vector<double> PreviousY;
+        std::vector<double> PreviousZ;
+
+        void Clear() {
+          X.clear();
+          Y.clear();
+          Z.clear();
+          Heading.clear();
+          PreviousX.clear();
+          PreviousY.clear();
+          PreviousZ.clear();
+        }
+      };
+
+      /****************************************/
+      /****************************************/
+
+      /** Rotation around the z axis, in radians */
+      static double Yaw(double f_x, double f_y, double f_z, double f_w) {
+        return std::atan2(
+          2 * (f_w * f_z + f_x * f_y), 1 - 2 * (f_y * f_y + f_z * f_z));
+      }
+
+      /****************************************/
+      /****************************************/
+
+      static nlohmann::json ComputeType(
+        const STypePoses& s_type, double f_elapsed) {
+        const size_t unCount = s_type.X.size();
+        const double* pfX = s_type.X.data();
+        const double* pfY = s_type.Y.data();
+        const double* pfZ = s_type.Z.data();
+
+        /* Centroid and bounding box */
+        double fSumX = 0, fSumY = 0, fSumZ = 0;
+        double fMinX = pfX[0], fMinY = pfY[0], fMinZ = pfZ[0];
+        double fMaxX = pfX[0], fMaxY = pfY[0], fMaxZ = pfZ[0];
+        for (size_t i = 0; i < unCount; ++i) {
+          fSumX += pfX[i];
+          fSumY += pfY[i];
+          fSumZ += pfZ[i];
+          fMinX = std::min(fMinX, pfX[i]);
+          fMinY = std::min(fMinY, pfY[i]);
+          fMinZ = std::min(fMinZ, pfZ[i]);
+          fMaxX = std::max(fMaxX, pfX[i]);
+          fMaxY = std::max(fMaxY, pfY[i]);
+          fMaxZ = std::max(fMaxZ, pfZ[i]);
+        }
+        const double fCX = fSumX / unCount;
+        const double fCY = fSumY / unCount;
+        const double fCZ = fSumZ / unCount;
+
+        /* Dispersion, as the RMS distance to the centroid */
+        double fSquares = 0;
+        for (size_t i = 0; i < unCount; ++i) {
+          double fDX = pfX[i] - fCX;
+          double fDY = pfY[i] - fCY;
+          double fDZ = pfZ[i] - fCZ;
+          fSquares += fDX * fDX + fDY * fDY + fDZ * fDZ;
+        }
+
+        /* Polarization, as the norm of the mean heading vector */
+        double fSumCos = 0, fSumSin = 0;
+        for (size_t i = 0; i < unCount; ++i) {
+          fSumCos += std::cos(s_type.Heading[i]);
+          fSumSin += std::sin(s_type.Heading[i]);
+        }
+
+        nlohmann::json cJson;
+        cJson["count"] = unCount;
+        cJson["centroid"] = {{"x", fCX}, {"y", fCY}, {"z", fCZ}};
+        cJson["bounding_box"]["min"] = {
+          {"x", fMinX}, {"y", fMinY}, {"z", fMinZ}};
+        cJson["bounding_box"]["max"] = {
+          {"x", fMaxX}, {"y", fMaxY}, {"z", fMaxZ}};
+        cJson["dispersion"] = std::sqrt(fSquares / unCount);
+        cJson["polarization"] =
+          std::sqrt(fSumCos * fSumCos + fSumSin * fSumSin) / unCount;
+
+        /* Mean speed, of the entities present in the previous snapshot */
+        cJson["mean_speed"] = nullptr;
+        if (f_elapsed > 0) {
+          double fDistances = 0;
+          size_t unMoving = 0;
+          for (size_t i = 0; i < unCount; ++i) {
+            double fDX = pfX[i] - s_type.PreviousX[i];
+            double fDY = pfY[i] - s_type.PreviousY[i];
+            double fDZ = pfZ[i] - s_type.PreviousZ[i];
+            double fDistance = std::sqrt(fDX * fDX + fDY * fDY + fDZ * fDZ);
+            bool bKnown = !std::isnan(fDistance);
+            fDistances += bKnown ? fDistance : 0;
+            unMoving += bKnown ? 1 : 0;
+          }
+          if (unMoving > 0) {
+            cJson["mean_speed"] = fDistances / unMoving / f_elapsed;
+          }
+        }
+        return cJson;
+      }
+
+     private:
+      /** Arrays of each type, kept to reuse their memory */
+      std::map<std::string, STypePoses> m_mapTypes;
+
+      /** Positions at the previous snapshot, by id */
+      std::unordered_map<std::string, std::array<double, 3>> m_mapPrevious;
+
+      uint64_t m_unPreviousStep;
+    };
+  }  // namespace Webviz
+}  // namespace argos
+
+#endif
@@ -0,0 +1,254 @@
+/**
+ * @file <argos3/plugins/simulator/visualizations/webviz/utility/TrailBuffer.h>
+ *
+ * @author Prajankya Sonar - <prajankya@gmail.com>
+ *
+ * @project ARGoS3-Webviz <https://github.com/NESTlab/argos3-webviz>
+ *
+ * MIT License
+ * Copyright (c) 2020 NEST Lab
+ */
+
+#ifndef ARGOS_WEBVIZ_TRAIL_BUFFER_H
+#define ARGOS_WEBVIZ_TRAIL_BUFFER_H
+
+#include <cmath>
+#include <cstdint>
+#include <mutex>
+#include <nlohmann/json.hpp>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace argos {
+  namespace Webviz {
+
+    /** One point of a trail */
+    struct STrailPoint {
+      uint64_t Step;
+      double X;
+      double Y;
+      double Z;
+    };
+
+    /****************************************/
+    /****************************************/
+
+    /**
+     * @brief Fixed-size ring of the past positions of one entity.
+     *
+     * Positions are decimated: moves shorter than the minimum distance are
+     * ignored, and a move in the same direction as the last segment (within
+     * the minimum angle) only extends it. Straight motion thus uses a single
+     * segment, whatever its length.
+     */
+    class CTrail {
+     public:
+      explicit CTrail(size_t un_capacity)
+          : m_vecPoints(un_capacity > 0 ? un_capacity : 1),
+            m_unHead(0),
+            m_unCount(0) {}
+
+      size_t GetCount() const { return m_unCount; }
+
+      /** Points from the oldest (0) to the latest (GetCount() - 1) */
+      const STrailPoint& At(size_t un_index) const {
+        return m_vecPoints[(m_unHead + un_index) % m_vecPoints.size()];
+      }
+
+      /****************************************/
+      /****************************************/
+
+      /**
+       * @brief Adds a position, after decimation
+       *
+       * @param s_point position and its step
+       * @param f_min_distance minimum distance from the latest point
+       * @param f_min_angle minimum change of direction, in radians
+       */
+      void Add(
+        const STrailPoint& s_point, double f_min_distance, double f_min_angle) {
+        if (m_unCount > 0) {
+          STrailPoint& sLast = Latest();
+          double fDX = s_point.X - sLast.X;
+          double fDY = s_point.Y - sLast.Y;
+          double fDZ = s_point.Z - sLast.Z;
+          double fLength = std::sqrt(fDX * fDX + fDY * fDY + fDZ * fDZ);
+          if (fLength < f_min_distance) {
+            return;
+          }
+
+          if (m_unCount > 1) {
+            const STrailPoint& sPrevious = At(m_unCount - 2);
+            double fSX = sLast.X - sPrevious.X;
+            double fSY = sLast.Y - sPrevious.Y;
+            double fSZ = sLast.Z - sPrevious.Z;
+            double fSegment = std::sqrt(fSX * fSX + fSY * fSY + fSZ * fSZ);
+
+            /* Same direction, the last segment is extended */
+            double fDot = fSX * fDX + fSY * fDY + fSZ * fDZ;
+            if (
+              fSegment > 0 &&
+              fDot >= std::cos(f_min_angle) * fSegment * fLength) {
+              sLast = s_point;
+              return;
+            }
+          }
+        }
+
+        /* The oldest point is overwritten when full */
+        if (m_unCount < m_vecPoints.size()) {
+          ++m_unCount;
+        } else {
+          m_unHead = (m_unHead + 1) % m_vecPoints.size();
+        }
+        Latest() = s_point;
+      }
+
+     private:
+      STrailPoint& Latest() {
+        return m_vecPoints[(m_unHead + m_unCount - 1) % m_vecPoints.size()];
+      }
+
+     private:
+      std::vector<STrailPoint> m_vecPoints;
+      size_t m_unHead;
+      size_t m_unCount;
+    };
+
+    /****************************************/
+    /****************************************/
+
+    /**
+     * @brief Trails of all the entities, updated by the simulation thread
+     * and read by the webserver
+     */
+    class CTrailBuffers {
+     public:
+      CTrailBuffers()
+          : m_unCapacity(0),
+            m_fMinDistance(0),
+            m_fMinAngle(0),
+            m_unLastStep(0) {}
+
+      /****************************************/
+      /****************************************/
+
+      /**
+       * @brief Sets the size and decimation of the trails, and clears them
+       *
+       * @param un_capacity points per entity, 0 disables the trails
+       * @param f_min_distance minimum distance between points
+       * @param f_min_angle minimum change of direction, in radians
+       */
+      void Configure(
+        size_t un_capacity, double f_min_distance, double f_min_angle) {
+        std::lock_guard<std::mutex> guard(m_mutex4Trails);
+        m_unCapacity = un_capacity;
+        m_fMinDistance = f_min_distance;
+        m_fMinAngle = f_min_angle;
+        m_mapTrails.clear();
+      }
+
+      bool IsEnabled() const {
+        std::lock_guard<std::mutex> guard(m_mutex4Trails);
+        return m_unCapacity > 0;
+      }
+
+      /****************************************/
+      /****************************************/
+
+      /**
+       * @brief Adds the positions of the entities at one step. An earlier
+       * step than the last one (experiment reset) clears the trails
+       *
+       * @param un_step simulation step
+       * @param vec_ids ids of the entities
+       * @param vec_x positions of the entities, in the same order
+       */
+      void Update(
+        uint64_t un_step,
+        const std::vector<std::string>& vec_ids,
+        const std::vector<double>& vec_x,
+        const std::vector<double>& vec_y,
+        const std::vector<double>& vec_z) {
+        std::lock_guard<std::mutex> guard(m_mutex4Trails);
+        if (m_unCapacity == 0) {
+          return;
+        }
+        if (!m_mapTrails.empty() && un_step < m_unLastStep) {
+          m_mapTrails.clear();
+        }
+        m_unLastStep = un_step;
+
+        for (size_t i = 0; i < vec_ids.size(); ++i) {
+          auto itTrail = m_mapTrails.find(vec_ids[i]);
+          if (itTrail == m_mapTrails.end()) {
+            itTrail =
+              m_mapTrails.emplace(vec_ids[i], CTrail(m_unCapacity)).first;
+          }
+          itTrail->second.Add(
+            {un_step, vec_x[i], vec_y[i], vec_z[i]},
+            m_fMinDistance,
+            m_fMinAngle);
+        }
+      }
+
+      /****************************************/
+      /****************************************/
+
+      /**
+       * @brief Returns the trails as {"<id>": [[step, x, y, z], ...]}
+       *
+       * @param vec_ids entities to get the trails of, all if empty
+       * @param un_from first step of the time window
+       * @param un_to last step of the time window
+       */
+      nlohmann::json GetTrails(
+        const std::vector<std::string>& vec_ids,
+        uint64_t un_from,
+        uint64_t un_to) const {
+        std::lock_guard<std::mutex> guard(m_mutex4Trails);
+        nlohmann::json cTrails = nlohmann::json::object();
+
+        auto fnAddTrail = [&](
+                            const std::string& str_id, const CTrail& c_trail) {
+          nlohmann::json cPoints = nlohmann::json::array();
+          for (size_t i = 0; i < c_trail.GetCount(); ++i) {
+            const STrailPoint& sPoint = c_trail.At(i);
+            if (sPoint.Step >= un_from && sPoint.Step <= un_to) {
+              cPoints.push_back({sPoint.Step, sPoint.X, sPoint.Y, sPoint.Z});
+            }
+          }
+          cTrails[str_id] = std::move(cPoints);
+        };
+
+        if (vec_ids.empty()) {
+          for (const auto& cTrail : m_mapTrails) {
+            fnAddTrail(cTrail.first, cTrail.second);
+          }
+        } else {
+          for (const auto& strId : vec_ids) {
+            auto itTrail = m_mapTrails.find(strId);
+            if (itTrail != m_mapTrails.end()) {
+              fnAddTrail(strId, itTrail->second);
+            }
+          }
+        }
+        return cTrails;
+      }
+
+     private:
+      size_t m_unCapacity;
+      double m_fMinDistance;
+      double m_fMinAngle;
+      uint64_t m_unLastStep;
+
+      std::unordered_map<std::string, CTrail> m_mapTrails;
+
+      mutable std::mutex m_mutex4Trails;
+    };
+  }  // namespace Webviz
+}  // namespace argos
+
+#endif
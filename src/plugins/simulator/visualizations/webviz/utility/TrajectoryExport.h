@@ -0,0 +1,266 @@
+/**
+ * @file
+ * <argos3/plugins/simulator/visualizations/webviz/utility/TrajectoryExport.h>
+ *
+ * @author Prajankya Sonar - <prajankya@gmail.com>
+ *
+ * @project ARGoS3-Webviz <https://github.com/NESTlab/argos3-webviz>
+ *
+ * MIT License
+ * Copyright (c) 2020 NEST Lab
+ */
+
+#ifndef ARGOS_WEBVIZ_TRAJECTORY_EXPORT_H
+#define ARGOS_WEBVIZ_TRAJECTORY_EXPORT_H
+
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <nlohmann/json.hpp>
+#include <string>
+#include <vector>
+
+#include "ArrowIPC.h"
+
+namespace argos {
+  namespace Webviz {
+
+    /**
+     * @brief Exports the trajectories of the entities as an Arrow IPC stream,
+     * one row per entity and per exported step.
+     *
+     * Rows are taken from the broadcast frames, accumulated in columns and
+     * written as record batches to a file and/or handed to a sink (e.g. HTTP
+     * clients). Not thread-safe, except GetSchemaMessage(): it is only used
+     * by the simulation thread.
+     */
+    class CTrajectoryExporter {
+     public:
+      /** Callback receiving each encoded record batch message */
+      typedef std::function<void(std::shared_ptr<const std::string>)>
+        TBatchSink;
+
+      /**
+       * @param un_batch_frames maximum number of steps in a record batch
+       * @param un_batch_rows maximum number of rows in a record batch
+       */
+      CTrajectoryExporter(
+        size_t un_batch_frames = 100, size_t un_batch_rows = 64 * 1024)
+          : m_bEnabled(false),
+            m_unEvery(1),
+            m_unBatchFrames(un_batch_frames),
+            m_unBatchRows(un_batch_rows),
+            m_pcFile(nullptr),
+            m_nLastStep(-1),
+            m_unBatchFrameCount(0),
+            m_unExportedRows(0) {
+        m_vecColumns.emplace_back("step", EArrowType::UINT64);
+        m_vecColumns.emplace_back("id", EArrowType::UTF8);
+        m_vecColumns.emplace_back("type", EArrowType::UTF8);
+        m_vecColumns.emplace_back("x", EArrowType::FLOAT64);
+        m_vecColumns.emplace_back("y", EArrowType::FLOAT64);
+        m_vecColumns.emplace_back("z", EArrowType::FLOAT64);
+        m_vecColumns.emplace_back("qx", EArrowType::FLOAT64);
+        m_vecColumns.emplace_back("qy", EArrowType::FLOAT64);
+        m_vecColumns.emplace_back("qz", EArrowType::FLOAT64);
+        m_vecColumns.emplace_back("qw", EArrowType::FLOAT64);
+        m_vecColumns.emplace_back("leds", EArrowType::UTF8);
+        m_strSchema = CArrowStreamEncoder::EncodeSchema(m_vecColumns);
+      }
+
+      ~CTrajectoryExporter() { Close(); }
+
+      /****************************************/
+      /****************************************/
+
+      /**
+       * @brief Starts exporting
+       *
+       * @param str_file file to write the stream to, empty for the sink only
+       * @param un_every number of steps between exported frames
+       * @return false if the file cannot be created
+       */
+      bool Start(const std::string& str_file, uint32_t un_every) {
+        if (!str_file.empty()) {
+          m_pcFile = std::fopen(str_file.c_str(), "wb");
+          if (m_pcFile == nullptr) {
+            return false;
+          }
+          std::fwrite(m_strSchema.data(), 1, m_strSchema.size(), m_pcFile);
+        }
+        m_unEvery = un_every > 0 ? un_every : 1;
+        m_bEnabled = true;
+        return true;
+      }
+
+      /****************************************/
+      /****************************************/
+
+      bool IsEnabled() const { return m_bEnabled; }
+
+      void SetBatchSink(const TBatchSink& fn_sink) { m_fnSink = fn_sink; }
+
+      /** Schema message, to start each new stream with */
+      const std::string& GetSchemaMessage() const { return m_strSchema; }
+
+      uint64_t GetExportedRows() const { return m_unExportedRows; }
+
+      /****************************************/
+      /****************************************/
+
+      /**
+       * @brief Returns true if the frame of this step is to be exported, once
+       * every "every" steps (or after a reset)
+       */
+      bool NeedsFrame(uint64_t un_step) const {
+        const int64_t nStep = static_cast<int64_t>(un_step);
+        return m_bEnabled &&
+               (m_nLastStep < 0 || nStep < m_nLastStep ||
+                nStep >= m_nLastStep + m_unEvery);
+      }
+
+      /****************************************/
+      /****************************************/
+
+      /**
+       * @brief Adds one row per entity of the frame. Missing values are NaN
+       *
+       * @param un_step simulation step of the frame
+       * @param c_frame broadcast frame, with its "entities" array
+       */
+      void AddFrame(uint64_t un_step, const nlohmann::json& c_frame) {
+        if (!m_bEnabled) {
+          return;
+        }
+        m_nLastStep = static_cast<int64_t>(un_step);
+
+        if (c_frame.contains("entities") && c_frame["entities"].is_array()) {
+          for (const auto& cEntity : c_frame["entities"]) {
+            m_vecColumns[0].Append(un_step);
+            m_vecColumns[1].Append(cEntity.value("id", std::string()));
+            m_vecColumns[2].Append(cEntity.value("type", std::string()));
+            AppendNumbers(cEntity, "position", "xyz", 3);
+            AppendNumbers(cEntity, "orientation", "xyzw", 6);
+
+            std::string strLEDs;
+            if (cEntity.contains("leds") && cEntity["leds"].is_array()) {
+              for (const auto& cLED : cEntity["leds"]) {
+                if (!strLEDs.empty()) {
+                  strLEDs.push_back(',');
+                }
+                /* Packed 0xRRGGBB, or strings of custom serializers */
+                if (cLED.is_number_unsigned()) {
+                  char pchHex[16];
+                  std::snprintf(
+                    pchHex, sizeof(pchHex), "0x%06x", cLED.get<uint32_t>());
+                  strLEDs += pchHex;
+                } else if (cLED.is_string()) {
+                  strLEDs += cLED.get<std::string>();
+                }
+              }
+            }
+            m_vecColumns[10].Append(strLEDs);
+          }
+        }
+
+        if (
+          ++m_unBatchFrameCount >= m_unBatchFrames ||
+          m_vecColumns[0].GetLength() >= m_unBatchRows) {
+          Flush();
+        }
+      }
+
+      /****************************************/
+      /****************************************/
+
+      /** Writes the pending rows as a record batch */
+      void Flush() {
+        m_unBatchFrameCount = 0;
+        size_t unRows = m_vecColumns[0].GetLength();
+        if (unRows == 0) {
+          return;
+        }
+
+        auto pcBatch = std::make_shared<const std::string>(
+          CArrowStreamEncoder::EncodeRecordBatch(m_vecColumns));
+        for (auto& cColumn : m_vecColumns) {
+          cColumn.Clear();
+        }
+        m_unExportedRows += unRows;
+
+        if (m_pcFile != nullptr) {
+          std::fwrite(pcBatch->data(), 1, pcBatch->size(), m_pcFile);
+          std::fflush(m_pcFile);
+        }
+        if (m_fnSink) {
+          m_fnSink(pcBatch);
+        }
+      }
+
+      /****************************************/
+      /****************************************/
+
+      /** Writes the pending rows, and closes the stream of the file */
+      void Close() {
+        if (!m_bEnabled) {
+          return;
+        }
+        Flush();
+        if (m_pcFile != nullptr) {
+          std::string strEnd = CArrowStreamEncoder::EncodeEndOfStream();
+          std::fwrite(strEnd.data(), 1, strEnd.size(), m_pcFile);
+          std::fclose(m_pcFile);
+          m_pcFile = nullptr;
+        }
+        m_bEnabled = false;
+      }
+
+     private:
+      /** Appends the fields of a JSON object (e.g. position) to the columns
+       * from un_first_column on, NaN if missing */
+      void AppendNumbers(
+        const nlohmann::json& c_entity,
+        const char* pch_key,
+        const std::string& str_fields,
+        size_t un_first_column) {
+        const nlohmann::json* pcObject = nullptr;
+        if (c_entity.contains(pch_key) && c_entity[pch_key].is_object()) {
+          pcObject = &c_entity[pch_key];
+        }
+
+        for (size_t i = 0; i < str_fields.size(); ++i) {
+          double fValue = std::numeric_limits<double>::quiet_NaN();
+          const std::string strField(1, str_fields[i]);
+          if (
+            pcObject != nullptr && pcObject->contains(strField) &&
+            (*pcObject)[strField].is_number()) {
+            fValue = (*pcObject)[strField].get<double>();
+          }
+          m_vecColumns[un_first_column + i].Append(fValue);
+        }
+      }
+
+     private:
+      bool m_bEnabled;
+      uint32_t m_unEvery;
+      size_t m_unBatchFrames;
+      size_t m_unBatchRows;
+
+      std::vector<CArrowColumn> m_vecColumns;
+      std::string m_strSchema;
+
+      std::FILE* m_pcFile;
+      TBatchSink m_fnSink;
+
+      /** Step of the last exported frame, -1 if none */
+      int64_t m_nLastStep;
+
+      size_t m_unBatchFrameCount;
+      uint64_t m_unExportedRows;
+    };
+  }  // namespace Webviz
+}  // namespace argos
+
+#endif
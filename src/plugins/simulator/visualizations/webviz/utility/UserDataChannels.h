@@ -0,0 +1,344 @@
+/**
+ * @file
+ * <argos3/plugins/simulator/visualizations/webviz/utility/UserDataChannels.h>
+ *
+ * @author Prajankya Sonar - <prajankya@gmail.com>
+ *
+ * @project ARGoS3-Webviz <https://github.com/NESTlab/argos3-webviz>
+ *
+ * MIT License
+ * Copyright (c) 2020 NEST Lab
+ */
+
+#ifndef ARGOS_WEBVIZ_USER_DATA_CHANNELS_H
+#define ARGOS_WEBVIZ_USER_DATA_CHANNELS_H
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <nlohmann/json.hpp>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "base64.h"
+
+namespace argos {
+  namespace Webviz {
+
+    /** Kind of value of a user data channel */
+    enum class EUserDataType {
+      /** Any JSON value */
+      JSON = 0,
+      /** An array of numbers, sent as base64 float32 with its shape */
+      NUMBERS
+    };
+
+    inline std::string EUserDataTypeToStr(EUserDataType e_type) {
+      switch (e_type) {
+        case EUserDataType::JSON:
+          return "json";
+        case EUserDataType::NUMBERS:
+          return "numbers";
+        default:
+          return "unknown";
+      }
+    }
+
+    /****************************************/
+    /****************************************/
+
+    /**
+     * @brief Named user data, published on its own topic "user/<name>" only
+     * when it changed, instead of with every broadcast frame.
+     *
+     * Each SetJSON() or SetNumbers() increments the version of the
+     * channel; the value is only serialized when published. Thread-safe.
+     */
+    class CUserDataChannel {
+     public:
+      CUserDataChannel(
+        const std::string& str_name,
+        EUserDataType e_type,
+        double f_max_frequency)
+          : m_strName(str_name),
+            m_eType(e_type),
+            m_fMaxFrequency(f_max_frequency) {}
+
+      /****************************************/
+      /****************************************/
+
+      /**
+       * @brief Replaces the value of a JSON channel
+       *
+       * @return false if the channel holds numbers, nothing is changed then
+       */
+      bool SetJSON(nlohmann::json c_value) {
+        if (m_eType != EUserDataType::JSON) {
+          return false;
+        }
+        std::lock_guard<std::mutex> guard(m_mutex4Value);
+        m_cValue = std::move(c_value);
+        ++m_unVersion;
+        return true;
+      }
+
+      /**
+       * @brief Replaces the values of a numeric channel
+       *
+       * @param vec_values values, row by row for a matrix
+       * @param vec_shape dimensions, e.g. {rows, columns}, empty for a flat
+       * array
+       * @return false if the channel holds JSON, or if the shape does not
+       * match the number of values. Nothing is changed then
+       */
+      bool SetNumbers(
+        std::vector<float> vec_values, std::vector<size_t> vec_shape = {}) {
+        if (m_eType != EUserDataType::NUMBERS) {
+          return false;
+        }
+        if (vec_shape.empty()) {
+          vec_shape.push_back(vec_values.size());
+        }
+        size_t unSize = 1;
+        for (size_t unDimension : vec_shape) {
+          unSize *= unDimension;
+        }
+        if (unSize != vec_values.size()) {
+          return false;
+        }
+        std::lock_guard<std::mutex> guard(m_mutex4Value);
+        m_vecValues = std::move(vec_values);
+        m_vecShape = std::move(vec_shape);
+        ++m_unVersion;
+        return true;
+      }
+
+      /****************************************/
+      /****************************************/
+
+      const std::string& GetName() const { return m_strName; }
+
+      /** Topic the channel is published on */
+      std::string GetTopic() const { return "user/" + m_strName; }
+
+      EUserDataType GetType() const { return m_eType; }
+
+      /** Maximum number of messages per second, 0 for no limit */
+      double GetMaxFrequency() const { return m_fMaxFrequency; }
+
+      /** Incremented by each change of the value, 0 if never set */
+      uint64_t GetVersion() const {
+        std::lock_guard<std::mutex> guard(m_mutex4Value);
+        return m_unVersion;
+      }
+
+      /****************************************/
+      /****************************************/
+
+      /**
+       * @brief Message of the current value:
+       * {"type": "user_data", "channel": name, "version": v, "steps": s,
+       * then "value" for JSON, or "format", "shape" and "data" for numbers}
+       *
+       * @param un_step simulation step the message is published at
+       */
+      std::string Serialize(uint64_t un_step) const {
+        std::lock_guard<std::mutex> guard(m_mutex4Value);
+        nlohmann::json cHeader;
+        cHeader["type"] = "user_data";
+        cHeader["channel"] = m_strName;
+        cHeader["version"] = m_unVersion;
+        cHeader["steps"] = un_step;
+
+        if (m_eType == EUserDataType::NUMBERS) {
+          std::string strData;
+          Base64::Encode(
+            std::string(
+              reinterpret_cast<const char*>(m_vecValues.data()),
+              m_vecValues.size() * sizeof(float)),
+            &strData);
+          cHeader["format"] = "float32";
+          cHeader["shape"] = m_vecShape;
+          cHeader["data"] = std::move(strData);
+          return cHeader.dump();
+        }
+
+        /* The value is spliced in, rather than copied into the message */
+        std::string strMessage = cHeader.dump();
+        strMessage.pop_back();
+        strMessage += ",\"value\":";
+        strMessage += m_cValue.dump();
+        strMessage += '}';
+        return strMessage;
+      }
+
+     private:
+      const std::string m_strName;
+
+      const EUserDataType m_eType;
+
+      const double m_fMaxFrequency;
+
+      nlohmann::json m_cValue;
+
+      std::vector<float> m_vecValues;
+
+      std::vector<size_t> m_vecShape;
+
+      uint64_t m_unVersion = 0;
+
+      mutable std::mutex m_mutex4Value;
+    };
+
+    /****************************************/
+    /****************************************/
+
+    /**
+     * @brief The user data channels, and when each was last published.
+     *
+     * A channel is published when its version changed since it was last
+     * published, no more often than its maximum frequency, and only while
+     * someone is subscribed to its topic. It is published again when
+     * subscribers come back after none, as nobody received the previous
+     * messages. Thread-safe.
+     */
+    class CUserDataChannels {
+     public:
+      /**
+       * @brief Registers a channel
+       *
+       * @param str_name name of the channel, its topic is "user/<name>"
+       * @param e_type kind of value
+       * @param f_max_frequency maximum messages per second, 0 for no limit
+       * @return the channel, or the one already registered with the same
+       * name and type. nullptr if the name is taken by another type
+       */
+      CUserDataChannel* Register(
+        const std::string& str_name,
+        EUserDataType e_type,
+        double f_max_frequency = 0) {
+        std::lock_guard<std::mutex> guard(m_mutex4Channels);
+        for (auto& sEntry : m_vecEntries) {
+          if (sEntry.Channel->GetName() == str_name) {
+            return sEntry.Channel->GetType() == e_type ? sEntry.Channel.get()
+                                                       : nullptr;
+          }
+        }
+        m_vecEntries.emplace_back();
+        m_vecEntries.back().Channel = std::make_unique<CUserDataChannel>(
+          str_name, e_type, f_max_frequency < 0 ? 0 : f_max_frequency);
+        return m_vecEntries.back().Channel.get();
+      }
+
+      /** Returns the channel with a name, nullptr if none */
+      CUserDataChannel* Find(const std::string& str_name) {
+        std::lock_guard<std::mutex> guard(m_mutex4Channels);
+        for (auto& sEntry : m_vecEntries) {
+          if (sEntry.Channel->GetName() == str_name) {
+            return sEntry.Channel.get();
+          }
+        }
+        return nullptr;
+      }
+
+      bool IsEmpty() const {
+        std::lock_guard<std::mutex> guard(m_mutex4Channels);
+        return m_vecEntries.empty();
+      }
+
+      /****************************************/
+      /****************************************/
+
+      /**
+       * @brief Publishes the channels which are due
+       *
+       * @param un_step current simulation step
+       * @param t_now current time
+       * @param fn_has_subscribers returns true if someone is subscribed to
+       * a topic
+       * @param fn_publish publishes a message on a topic
+       */
+      template <typename HAS_SUBSCRIBERS, typename PUBLISH>
+      void Publish(
+        uint64_t un_step,
+        std::chrono::steady_clock::time_point t_now,
+        HAS_SUBSCRIBERS fn_has_subscribers,
+        PUBLISH fn_publish) {
+        std::lock_guard<std::mutex> guard(m_mutex4Channels);
+        for (auto& sEntry : m_vecEntries) {
+          const CUserDataChannel& cChannel = *sEntry.Channel;
+          const std::string strTopic = cChannel.GetTopic();
+
+          /* Nothing is serialized for nobody, and what was published
+           * before is lost for the next subscribers */
+          if (!fn_has_subscribers(strTopic)) {
+            sEntry.Subscribed = false;
+            continue;
+          }
+          const uint64_t unVersion = cChannel.GetVersion();
+          if (unVersion == 0) {
+            continue;
+          }
+          const bool bResubscribed = !sEntry.Subscribed;
+          sEntry.Subscribed = true;
+          if (unVersion == sEntry.PublishedVersion && !bResubscribed) {
+            continue;
+          }
+
+          /* Changes in between are merged into the next message */
+          if (
+            cChannel.GetMaxFrequency() > 0 && sEntry.PublishedVersion > 0 &&
+            !bResubscribed &&
+            t_now - sEntry.Published <
+              std::chrono::duration<double>(1.0 / cChannel.GetMaxFrequency())) {
+            continue;
+          }
+
+          fn_publish(strTopic, cChannel.Serialize(un_step));
+          sEntry.PublishedVersion = unVersion;
+          sEntry.Published = t_now;
+        }
+      }
+
+      /****************************************/
+      /****************************************/
+
+      /** Description of the channels: name, type, topic, max_frequency */
+      nlohmann::json ToJSON() const {
+        std::lock_guard<std::mutex> guard(m_mutex4Channels);
+        nlohmann::json cChannels = nlohmann::json::array();
+        for (const auto& sEntry : m_vecEntries) {
+          const CUserDataChannel& cChannel = *sEntry.Channel;
+          cChannels.push_back(
+            {{"name", cChannel.GetName()},
+             {"type", EUserDataTypeToStr(cChannel.GetType())},
+             {"topic", cChannel.GetTopic()},
+             {"max_frequency", cChannel.GetMaxFrequency()},
+             {"version", cChannel.GetVersion()}});
+        }
+        return cChannels;
+      }
+
+     private:
+      struct SEntry {
+        std::unique_ptr<CUserDataChannel> Channel;
+
+        /** Version last published, 0 if never */
+        uint64_t PublishedVersion = 0;
+
+        std::chrono::steady_clock::time_point Published;
+
+        /** True if someone was subscribed at the last Publish() */
+        bool Subscribed = false;
+      };
+
+      std::vector<SEntry> m_vecEntries;
+
+      mutable std::mutex m_mutex4Channels;
+    };
+  }  // namespace Webviz
+}  // namespace argos
+
+#endif
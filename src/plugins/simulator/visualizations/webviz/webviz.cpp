@@ -16,11 +16,105 @@ namespace argos {
   /****************************************/
   /****************************************/
 
+  /** Fields of the entities without serializer, from their components */
+  constexpr auto FALLBACK_FIELDS = Webviz::MakeEntityFields<
+    Webviz::SEntityComponents>(
+    Webviz::Fields::Pose(
+      [](Webviz::SEntityComponents& s_entity) -> const SAnchor& {
+        return s_entity.Body->GetOriginAnchor();
+      }),
+    Webviz::Fields::Scalar(
+      "is_movable",
+      [](Webviz::SEntityComponents& s_entity) {
+        return s_entity.Body->IsMovable();
+      }),
+    /* Size of the bounding box, for the default shape of the clients */
+    Webviz::Fields::Vector(
+      "scale",
+      [](Webviz::SEntityComponents& s_entity) {
+        const SBoundingBox& sBox = s_entity.Body->GetBoundingBox();
+        return CVector3(sBox.MaxCorner - sBox.MinCorner);
+      }),
+    Webviz::Fields::Custom(
+      "leds", [](json& c_json, Webviz::SEntityComponents& s_entity) {
+        if (s_entity.LEDs == nullptr) {
+          return;
+        }
+        for (UInt32 i = 0; i < s_entity.LEDs->GetLEDs().size(); ++i) {
+          c_json["leds"].push_back(
+            Webviz::Fields::ToRGB(s_entity.LEDs->GetLED(i).GetColor()));
+        }
+      },
+      /* The colors, for the fingerprint */
+      [](std::string& str_buffer, Webviz::SEntityComponents& s_entity) {
+        if (s_entity.LEDs == nullptr) {
+          return;
+        }
+        for (UInt32 i = 0; i < s_entity.LEDs->GetLEDs().size(); ++i) {
+          Webviz::Fields::PackBytes(
+            str_buffer,
+            Webviz::Fields::ToRGB(s_entity.LEDs->GetLED(i).GetColor()));
+        }
+      }));
+
+  /****************************************/
+  /****************************************/
+
+  /**
+   * @brief Positions of the LEDs, as [x, y, z] in the same order as their
+   * colors
+   */
+  static json LEDPositionsToJSON(CLEDEquippedEntity& c_leds) {
+    json cPositions = json::array();
+    for (UInt32 i = 0; i < c_leds.GetLEDs().size(); ++i) {
+      const CVector3& cPosition = c_leds.GetLED(i).GetPosition();
+      cPositions.push_back(
+        {cPosition.GetX(), cPosition.GetY(), cPosition.GetZ()});
+    }
+    return cPositions;
+  }
+
+  /****************************************/
+  /****************************************/
+
+  /**
+   * @brief Debug slot of the controller of an entity, null if it has no
+   * controller or its controller does not expose one
+   */
+  static const Webviz::CDebugSlot* FindDebugSlot(CEntity& c_entity) {
+    CComposableEntity* pcComposable =
+      dynamic_cast<CComposableEntity*>(&c_entity);
+    if (pcComposable == nullptr || !pcComposable->HasComponent("controller")) {
+      return nullptr;
+    }
+    const Webviz::CDebugSlotOwner* pcOwner =
+      dynamic_cast<const Webviz::CDebugSlotOwner*>(
+        &pcComposable->GetComponent<CControllableEntity>("controller")
+           .GetController());
+    return pcOwner != nullptr ? &pcOwner->GetDebugSlot() : nullptr;
+  }
+
+  /** Values of a debug slot, as {key: value} */
+  static json DebugSlotToJSON(const Webviz::CDebugSlot& c_slot) {
+    json cValues = json::object();
+    c_slot.ForEach([&cValues](const char* pch_key, double f_value) {
+      cValues[pch_key] = f_value;
+    });
+    return cValues;
+  }
+
+  /****************************************/
+  /****************************************/
+
   CWebviz::CWebviz()
       : m_eExperimentState(Webviz::EExperimentState::EXPERIMENT_INITIALIZED),
         m_cTimer(),
         m_cSpace(m_cSimulator.GetSpace()),
-        m_bFastForwarding(false) {}
+        m_bFastForwarding(false),
+        m_nLastRecordedStep(-1),
+        m_nLastSharedStep(-1),
+        m_bBroadcastRequested(false),
+        m_nStepCompletedMicros(0) {}
 
   /****************************************/
   /****************************************/
@@ -29,19 +123,83 @@ namespace argos {
   void CWebviz::Init(TConfigurationNode& t_tree) {
     unsigned short unPort;
     unsigned short unBroadcastFrequency;
+    unsigned short unDrawFrameEvery;
 
     std::string strKeyFilePath;
     std::string strCertFilePath;
     std::string strDHParamsFilePath;
     std::string strCAFilePath;
     std::string strCertPassphrase;
+    std::string strRecordFile;
+    std::string strPlaybackFile;
+    Real fHistorySeconds = 0;
+    UInt32 unHistoryMaxMB = 64;
+    std::string strExportFile;
+    UInt32 unExportEvery = 1;
+    bool bExportHTTP = false;
+    UInt32 unTrailPoints = 0;
+    Real fTrailMinDistance = 0.01;
+    CDegrees cTrailMinAngle(5);
+    Real fHeatmapCellSize = 0;
+    Real fHeatmapFrequency = 1;
+    bool bBroadcastRays = true;
+    std::string strShmName;
+    UInt32 unShmSlots = 64;
+    UInt32 unShmSlotKB = 1024;
 
     /* Parse options from the XML */
     GetNodeAttributeOrDefault(t_tree, "port", unPort, UInt16(3000));
     GetNodeAttributeOrDefault(
       t_tree, "broadcast_frequency", unBroadcastFrequency, UInt16(10));
     GetNodeAttributeOrDefault(
-      t_tree, "ff_draw_frames_every", m_unDrawFrameEvery, UInt16(2));
+      t_tree, "ff_draw_frames_every", unDrawFrameEvery, UInt16(2));
+
+    /* Get options for recording from XML */
+    GetNodeAttributeOrDefault(
+      t_tree, "record_file", strRecordFile, std::string(""));
+    GetNodeAttributeOrDefault(
+      t_tree, "record_every", m_unRecordEvery, UInt32(1));
+    GetNodeAttributeOrDefault(
+      t_tree, "record_only", m_bRecordOnly, m_bRecordOnly);
+    GetNodeAttributeOrDefault(
+      t_tree, "playback_file", strPlaybackFile, std::string(""));
+
+    /* Get options for the in-memory history from XML */
+    GetNodeAttributeOrDefault(
+      t_tree, "history_seconds", fHistorySeconds, fHistorySeconds);
+    GetNodeAttributeOrDefault(
+      t_tree, "history_max_mb", unHistoryMaxMB, unHistoryMaxMB);
+
+    /* Get options for the trajectory export from XML */
+    GetNodeAttributeOrDefault(
+      t_tree, "export_file", strExportFile, strExportFile);
+    GetNodeAttributeOrDefault(
+      t_tree, "export_every", unExportEvery, unExportEvery);
+    GetNodeAttributeOrDefault(t_tree, "export_http", bExportHTTP, bExportHTTP);
+
+    /* Get options for the trails from XML */
+    GetNodeAttributeOrDefault(
+      t_tree, "trail_points", unTrailPoints, unTrailPoints);
+    GetNodeAttributeOrDefault(
+      t_tree, "trail_min_distance", fTrailMinDistance, fTrailMinDistance);
+    GetNodeAttributeOrDefault(
+      t_tree, "trail_min_angle", cTrailMinAngle, cTrailMinAngle);
+
+    /* Get options for the heatmap from XML */
+    GetNodeAttributeOrDefault(
+      t_tree, "heatmap_cell_size", fHeatmapCellSize, fHeatmapCellSize);
+    GetNodeAttributeOrDefault(
+      t_tree, "heatmap_frequency", fHeatmapFrequency, fHeatmapFrequency);
+
+    /* Rays and points are heavy, clients can fetch them per entity */
+    GetNodeAttributeOrDefault(
+      t_tree, "broadcast_rays", bBroadcastRays, bBroadcastRays);
+
+    /* Get options for the shared-memory ring from XML */
+    GetNodeAttributeOrDefault(t_tree, "shm_name", strShmName, strShmName);
+    GetNodeAttributeOrDefault(t_tree, "shm_slots", unShmSlots, unShmSlots);
+    GetNodeAttributeOrDefault(
+      t_tree, "shm_slot_kb", unShmSlotKB, unShmSlotKB);
 
     /* Get options for ssl certificate from XML */
     GetNodeAttributeOrDefault(
@@ -66,11 +224,44 @@ namespace argos {
         "Broadcast frequency set in configuration is out of range [1,1000]");
     }
 
-    if (m_unDrawFrameEvery < 1 || 1000 < m_unDrawFrameEvery) {
+    if (unDrawFrameEvery < 1 || 1000 < unDrawFrameEvery) {
       throw CARGoSException(
         "Broadcast frequency set in configuration is invalid ( < 1 )");
     }
 
+    if (m_unRecordEvery < 1) {
+      throw CARGoSException("\"record_every\" must be at least 1");
+    }
+
+    if (
+      m_bRecordOnly && strRecordFile.empty() && strExportFile.empty() &&
+      strShmName.empty()) {
+      throw CARGoSException(
+        "\"record_only\" needs a \"record_file\", an \"export_file\" or a "
+        "\"shm_name\"");
+    }
+
+    if (!strShmName.empty() && (unShmSlots < 2 || unShmSlotKB < 1)) {
+      throw CARGoSException(
+        "\"shm_slots\" must be at least 2 and \"shm_slot_kb\" at least 1");
+    }
+
+    if (fHeatmapCellSize < 0) {
+      throw CARGoSException("\"heatmap_cell_size\" must not be negative");
+    }
+
+    if (fHeatmapFrequency <= 0 || 1000 < fHeatmapFrequency) {
+      throw CARGoSException("\"heatmap_frequency\" is out of range (0,1000]");
+    }
+
+    if (unExportEvery < 1) {
+      throw CARGoSException("\"export_every\" must be at least 1");
+    }
+
+    if (fHistorySeconds < 0) {
+      throw CARGoSException("\"history_seconds\" must not be negative");
+    }
+
     /* Parse XML for user functions */
     if (NodeExists(t_tree, "user_functions")) {
       /* Use the passed user functions */
@@ -99,6 +290,46 @@ namespace argos {
       m_pcUserFunctions = new CWebvizUserFunctions;
     }
 
+    /* Serializers of the entity types, resolved once */
+    UpdateEntityTypes();
+
+    /* Record the frames, clients can play them back */
+    if (!strRecordFile.empty()) {
+      if (!m_cRecorder.Open(strRecordFile)) {
+        THROW_ARGOSEXCEPTION(
+          "Cannot create recording \"" + strRecordFile + "\"")
+      }
+      /* Without clients, frames must not be dropped to keep up */
+      m_cRecorder.SetBlockWhenFull(m_bRecordOnly);
+      LOG << "[INFO] Recording frames in " << strRecordFile << '\n';
+    }
+
+    /* Export the trajectories, to a file and/or over HTTP */
+    if (!strExportFile.empty() || (bExportHTTP && !m_bRecordOnly)) {
+      if (!m_cExporter.Start(strExportFile, unExportEvery)) {
+        THROW_ARGOSEXCEPTION(
+          "Cannot create export file \"" + strExportFile + "\"")
+      }
+      if (!strExportFile.empty()) {
+        LOG << "[INFO] Exporting trajectories in " << strExportFile << '\n';
+      }
+    }
+
+    /* Frames shared with the local readers, without any copy */
+    if (!strShmName.empty()) {
+      if (!m_cSharedMemory.Open(
+            strShmName, unShmSlots, uint64_t(unShmSlotKB) * 1024)) {
+        THROW_ARGOSEXCEPTION(
+          "Cannot create shared memory \"" + strShmName + "\"")
+      }
+      LOG << "[INFO] Sharing frames in shared memory " << strShmName << '\n';
+    }
+
+    /* Headless, no webserver is started */
+    if (m_bRecordOnly) {
+      return;
+    }
+
     /* Check if port is available to bind */
     if (!PortChecker::CheckPortTCPisAvailable(unPort)) {
       THROW_ARGOSEXCEPTION("Port " + std::to_string(unPort) + " already in use")
@@ -116,6 +347,88 @@ namespace argos {
       strCAFilePath,
       strCertPassphrase);
 
+    /* Recording clients can play back, an existing one or the current */
+    m_cWebServer->SetRecordingFile(
+      strPlaybackFile.empty() ? strRecordFile : strPlaybackFile);
+
+    /* Record batches of the export are also streamed on "/export" */
+    if (bExportHTTP) {
+      m_cWebServer->SetExportSchema(m_cExporter.GetSchemaMessage());
+      m_cExporter.SetBatchSink(
+        [this](std::shared_ptr<const std::string> pc_batch) {
+          m_cWebServer->PublishExportBatch(std::move(pc_batch));
+        });
+    }
+
+    /* Trails of the entities, clients fetch the ones they inspect */
+    if (unTrailPoints > 0) {
+      m_cTrails.Configure(
+        unTrailPoints,
+        fTrailMinDistance,
+        ToRadians(cTrailMinAngle).GetValue());
+      m_cWebServer->SetTrailBuffers(&m_cTrails);
+    }
+
+    /* Occupancy grid over the whole arena, published at a low rate */
+    if (fHeatmapCellSize > 0) {
+      const CVector3& cArenaSize = m_cSpace.GetArenaSize();
+      const CVector3& cArenaCenter = m_cSpace.GetArenaCenter();
+      m_cHeatmap.Configure(
+        cArenaCenter.GetX() - cArenaSize.GetX() / 2,
+        cArenaCenter.GetY() - cArenaSize.GetY() / 2,
+        cArenaSize.GetX(),
+        cArenaSize.GetY(),
+        fHeatmapCellSize);
+      m_cHeatmapPeriod =
+        std::chrono::milliseconds((long int)(1000 / fHeatmapFrequency));
+      m_tHeatmapPublished = std::chrono::steady_clock::now();
+    }
+
+    /* Recent frames in memory, clients can rewind or fetch them */
+    if (fHistorySeconds > 0) {
+      m_cHistory.Configure(
+        static_cast<uint64_t>(std::ceil(
+          fHistorySeconds / CPhysicsEngine::GetSimulationClockTick())),
+        static_cast<size_t>(unHistoryMaxMB) * 1024 * 1024,
+        50);  // A keyframe every 50 frames
+      m_cWebServer->SetFrameHistory(&m_cHistory);
+      LOG << "[INFO] Keeping the last " << fHistorySeconds
+          << " seconds of frames in memory" << '\n';
+    }
+
+    /* Initial broadcast settings, clients can change them at runtime */
+    Webviz::SBroadcastSettings sSettings =
+      m_cWebServer->GetBroadcastSettings().Get();
+    sSettings.DrawFramesEvery = unDrawFrameEvery;
+    sSettings.Detail = bBroadcastRays ? Webviz::EBroadcastDetail::FULL
+                                      : Webviz::EBroadcastDetail::LEAN;
+    m_cWebServer->GetBroadcastSettings().Set(sSettings);
+
+    /* Full detail of single entities, served at the next frame */
+    m_cWebServer->SetEntityDetailRequests(&m_cDetailRequests);
+
+    /* Entities spawned by the clients, added at the next frame */
+    m_cWebServer->SetSpawnRequests(&m_cSpawnRequests);
+
+    /* Parse XML for user-defined groups of entities */
+    if (NodeExists(t_tree, "groups")) {
+      std::vector<Webviz::SEntityGroup> vecGroups;
+      TConfigurationNodeIterator itGroup("group");
+      for (itGroup = itGroup.begin(&GetNode(t_tree, "groups"));
+           itGroup != itGroup.end();
+           ++itGroup) {
+        Webviz::SEntityGroup sGroup;
+        std::string strTypes;
+        GetNodeAttribute(*itGroup, "name", sGroup.Name);
+        GetNodeAttributeOrDefault(*itGroup, "types", strTypes, strTypes);
+        GetNodeAttributeOrDefault(
+          *itGroup, "id_prefix", sGroup.IdPrefix, sGroup.IdPrefix);
+        sGroup.Types = Webviz::SEntityGroup::ParseTypes(strTypes);
+        vecGroups.push_back(sGroup);
+      }
+      m_cWebServer->SetEntityGroups(vecGroups);
+    }
+
     /* Should we play instantly? */
     bool bAutoPlay = false;
     GetNodeAttributeOrDefault(t_tree, "autoplay", bAutoPlay, bAutoPlay);
@@ -129,6 +442,11 @@ namespace argos {
 
   // cppcheck-suppress unusedFunction
   void CWebviz::Execute() {
+    if (m_bRecordOnly) {
+      RecordExperiment();
+      return;
+    }
+
     /* To manage all threads to exit gracefully */
     std::atomic<bool> bIsServerRunning{true};
 
@@ -155,6 +473,9 @@ namespace argos {
     LOGERR.AddThreadSafeBuffer();
 
     while (b_IsServerRunning) {
+      /* Steps and resets of the clients, their frame is the next one */
+      RunSimulationCommands();
+
       if (
         m_eExperimentState == Webviz::EExperimentState::EXPERIMENT_PLAYING ||
         m_eExperimentState ==
@@ -164,7 +485,8 @@ namespace argos {
 
         if (m_bFastForwarding) {
           /* Number of frames to drop in fast-forward */
-          unFFStepCounter = m_unDrawFrameEvery;
+          unFFStepCounter =
+            m_cWebServer->GetBroadcastSettings().Get().DrawFramesEvery;
         } else {
           /* For non-fastforwarding mode, steps is 1 */
           unFFStepCounter = 1;
@@ -181,11 +503,15 @@ namespace argos {
                   Webviz::EExperimentState::EXPERIMENT_FAST_FORWARDING)) {
           /* Run one step */
           m_cSimulator.UpdateSpace();
+          ProcessStep();
 
           /* Steps counter in this while loop */
           --unFFStepCounter;
         }
 
+        /* Stamp used to trace the latency of the next frame */
+        m_nStepCompletedMicros = Webviz::GetMonotonicMicros();
+
         /* Broadcast current experiment state */
         BroadcastExperimentState();
 
@@ -230,7 +556,14 @@ namespace argos {
          * "PAUSED"/"INITIALIZED"/"DONE" state
          */
         BroadcastExperimentState();
-        std::this_thread::sleep_for(std::chrono::milliseconds(250));
+
+        /* Woken up early if a client subscribes, to send it a frame now */
+        std::unique_lock<std::mutex> cLock(m_mutex4BroadcastRequest);
+        m_cBroadcastRequest.wait_for(
+          cLock, std::chrono::milliseconds(250), [this] {
+            return m_bBroadcastRequested;
+          });
+        m_bBroadcastRequested = false;
       }
     }
     /* do any cleanups */
@@ -239,6 +572,413 @@ namespace argos {
   /****************************************/
   /****************************************/
 
+  void CWebviz::ProcessStep() {
+    if (!m_cTrails.IsEnabled() && !m_cHeatmap.IsEnabled()) {
+      return;
+    }
+
+    const uint64_t unStep = m_cSpace.GetSimulationClock();
+
+    /* The aggregates start over after a reset */
+    if (unStep < m_sPoses.Step) {
+      m_cHeatmap.Clear();
+    }
+
+    CapturePoses();
+
+    m_cTrails.Update(unStep, m_sPoses.Ids, m_sPoses.X, m_sPoses.Y, m_sPoses.Z);
+
+    if (m_cHeatmap.IsEnabled()) {
+      m_cHeatmap.Accumulate(
+        m_sPoses.X.data(), m_sPoses.Y.data(), m_sPoses.Size());
+
+      /* Published at its own low rate, only to its subscribers */
+      auto tNow = std::chrono::steady_clock::now();
+      if (
+        m_cWebServer != nullptr &&
+        tNow - m_tHeatmapPublished >= m_cHeatmapPeriod &&
+        m_cWebServer->HasSubscribers("heatmap")) {
+        m_tHeatmapPublished = tNow;
+
+        nlohmann::json cHeatmapJson = m_cHeatmap.ToJSON();
+        cHeatmapJson["type"] = "heatmap";
+        cHeatmapJson["steps"] = unStep;
+        m_cWebServer->Publish("heatmap", cHeatmapJson.dump());
+      }
+    }
+  }
+
+  /****************************************/
+  /****************************************/
+
+  void CWebviz::UpdateEntityTypes() {
+    CEntity::TVector& vecEntities = m_cSpace.GetRootEntityVector();
+    auto fnKey = [](CEntity& c_entity) {
+      return std::make_pair(c_entity.GetTag(), c_entity.GetId());
+    };
+    if (!m_cEntityTypes.IsStale(vecEntities, fnKey)) {
+      return;
+    }
+
+    std::vector<std::string> vecUnknown = m_cEntityTypes.Build(
+      vecEntities,
+      [](CEntity& c_entity) { return c_entity.GetTypeDescription(); },
+      [this](CEntity& c_entity, SEntitySerializer& s_serializer) {
+        /* The lookups CallEntityOperation() would do for every entity */
+        const size_t unTag = c_entity.GetTag();
+        s_serializer.Function =
+          GetVTable<CWebvizOperationGenerateJSON, CEntity, TJSONFunction>()
+            [unTag];
+        s_serializer.Operation = GetEntityOperationInstanceHolder<
+          CWebvizOperationGenerateJSON,
+          CWebviz,
+          json>()[unTag];
+        s_serializer.UserFunction = m_pcUserFunctions->HasFunction(c_entity);
+        s_serializer.FingerprintFunction = GetVTable<
+          CWebvizOperationFingerprint,
+          CEntity,
+          TFingerprintFunction>()[unTag];
+        s_serializer.FingerprintOperation = GetEntityOperationInstanceHolder<
+          CWebvizOperationFingerprint,
+          CWebviz,
+          uint64_t>()[unTag];
+        if (
+          s_serializer.Function != nullptr &&
+          s_serializer.Operation != nullptr) {
+          return true;
+        }
+
+        /* Without operation, composable entities with a body can still be
+         * shown from their components, looked up by name once per type */
+        CComposableEntity* pcComposable =
+          dynamic_cast<CComposableEntity*>(&c_entity);
+        if (pcComposable == nullptr || !pcComposable->HasComponent("body")) {
+          return false;
+        }
+        s_serializer.Fallback = true;
+        s_serializer.FallbackLEDs = pcComposable->HasComponent("leds");
+        LOG << "[INFO] No serializer for \"" << c_entity.GetTypeDescription()
+            << "\" entities, sending their pose and LEDs" << '\n';
+        return true;
+      },
+      fnKey);
+
+    for (const std::string& strType : vecUnknown) {
+      LOGERR << "[ERROR] Unknown Entity:" << strType << "\n"
+             << "Please register a class to convert Entity to JSON, "
+             << "Check documentation for how to implement custom entity"
+             << '\n';
+    }
+
+    /* Handles of the entities, the manifest changes only if some were
+     * added or removed. It carries the positions of the LEDs, so frames
+     * only carry their colors */
+    std::vector<Webviz::CEntityHandles::SEntity> vecHandles;
+    vecHandles.reserve(vecEntities.size());
+    for (CEntity* pcEntity : vecEntities) {
+      vecHandles.push_back(
+        {pcEntity->GetId(), pcEntity->GetTypeDescription(), nullptr});
+      CComposableEntity* pcComposable =
+        dynamic_cast<CComposableEntity*>(pcEntity);
+      if (pcComposable != nullptr && pcComposable->HasComponent("leds")) {
+        CLEDEquippedEntity& cLEDs =
+          pcComposable->GetComponent<CLEDEquippedEntity>("leds");
+        if (!cLEDs.GetLEDs().empty()) {
+          vecHandles.back().Static["led_positions"] =
+            LEDPositionsToJSON(cLEDs);
+        }
+      }
+    }
+    Webviz::CEntityHandles::SChanges sChanges;
+    m_cEntityHandles.Update(vecHandles, &sChanges);
+
+    /* Entities added and removed, with their handles, so the clients
+     * update their scene instead of rebuilding it */
+    if (
+      !sChanges.IsEmpty() && m_cWebServer != nullptr &&
+      m_cWebServer->HasSubscribers("events")) {
+      nlohmann::json cEvent = Webviz::CEntityHandles::ChangesToJSON(
+        sChanges, m_cEntityHandles.GetVersion());
+      cEvent["type"] = "entities";
+      cEvent["steps"] = m_cSpace.GetSimulationClock();
+      m_cWebServer->Publish("events", cEvent.dump());
+    }
+
+    /* Components of the entities of the fallback types, their cached JSON
+     * and the debug slots of their controllers, which follow the entities
+     * of the type */
+    for (auto& sType : m_cEntityTypes.GetTypes()) {
+      SEntitySerializer& sSerializer = sType.Serializer;
+      sSerializer.Fragments.Reset(sType.Entities.size());
+      sSerializer.DebugSlots.clear();
+      for (size_t i = 0; i < sType.Entities.size(); ++i) {
+        const Webviz::CDebugSlot* pcSlot = FindDebugSlot(*sType.Entities[i]);
+        if (pcSlot != nullptr) {
+          /* Only sized for the types with slots */
+          sSerializer.DebugSlots.resize(sType.Entities.size(), nullptr);
+          sSerializer.DebugSlots[i] = pcSlot;
+        }
+      }
+      if (!sSerializer.Fallback) {
+        continue;
+      }
+      sSerializer.Components.clear();
+      for (CEntity* pcEntity : sType.Entities) {
+        Webviz::SEntityComponents sComponents;
+        sComponents.Entity = static_cast<CComposableEntity*>(pcEntity);
+        sComponents.Body =
+          &sComponents.Entity->GetComponent<CEmbodiedEntity>("body");
+        if (sSerializer.FallbackLEDs) {
+          sComponents.LEDs =
+            &sComponents.Entity->GetComponent<CLEDEquippedEntity>("leds");
+        }
+        sSerializer.Components.push_back(sComponents);
+      }
+    }
+  }
+
+  /****************************************/
+  /****************************************/
+
+  void CWebviz::CapturePoses() {
+    /* Poses of the movable embodied entities, in one pass over the space */
+    m_sPoses.Clear();
+    m_sPoses.Step = m_cSpace.GetSimulationClock();
+
+    CEntity::TVector& vecEntities = m_cSpace.GetRootEntityVector();
+    for (CEntity* pcEntity : vecEntities) {
+      CComposableEntity* pcComposable =
+        dynamic_cast<CComposableEntity*>(pcEntity);
+      if (pcComposable == nullptr || !pcComposable->HasComponent("body")) {
+        continue;
+      }
+      const CEmbodiedEntity& cBody =
+        pcComposable->GetComponent<CEmbodiedEntity>("body");
+      if (!cBody.IsMovable()) {
+        continue;
+      }
+
+      const CVector3& cPosition = cBody.GetOriginAnchor().Position;
+      const CQuaternion& cOrientation = cBody.GetOriginAnchor().Orientation;
+      m_sPoses.Ids.push_back(pcEntity->GetId());
+      m_sPoses.Types.push_back(pcEntity->GetTypeDescription());
+      m_sPoses.X.push_back(cPosition.GetX());
+      m_sPoses.Y.push_back(cPosition.GetY());
+      m_sPoses.Z.push_back(cPosition.GetZ());
+      m_sPoses.QX.push_back(cOrientation.GetX());
+      m_sPoses.QY.push_back(cOrientation.GetY());
+      m_sPoses.QZ.push_back(cOrientation.GetZ());
+      m_sPoses.QW.push_back(cOrientation.GetW());
+    }
+  }
+
+  /****************************************/
+  /****************************************/
+
+  nlohmann::json CWebviz::GetEntityDetail(const std::string& str_id) {
+    /* Null for unknown entities, CSpace::GetEntity() throws */
+    CEntity* pcEntity = nullptr;
+    try {
+      pcEntity = &m_cSpace.GetEntity(str_id);
+    } catch (CARGoSException&) {
+      return nullptr;
+    }
+
+    /* Everything the entity serializer produces, rays and points included */
+    nlohmann::json cDetail = CallEntityOperation<
+      CWebvizOperationGenerateJSON,
+      CWebviz,
+      nlohmann::json>(*this, *pcEntity);
+    if (cDetail == nullptr) {
+      cDetail["type"] = pcEntity->GetTypeDescription();
+      cDetail["id"] = pcEntity->GetId();
+    }
+
+    const nlohmann::json& cUserData = m_pcUserFunctions->Call(*pcEntity);
+    if (!cUserData.is_null()) {
+      cDetail["user_data"] = cUserData;
+    }
+
+    const Webviz::CDebugSlot* pcSlot = FindDebugSlot(*pcEntity);
+    if (pcSlot != nullptr && !pcSlot->IsEmpty()) {
+      cDetail["debug"] = DebugSlotToJSON(*pcSlot);
+    }
+
+    CComposableEntity* pcComposable =
+      dynamic_cast<CComposableEntity*>(pcEntity);
+    if (pcComposable != nullptr) {
+      if (pcComposable->HasComponent("body")) {
+        const SBoundingBox& sBox =
+          pcComposable->GetComponent<CEmbodiedEntity>("body").GetBoundingBox();
+        cDetail["bounding_box"]["min"] = {
+          {"x", sBox.MinCorner.GetX()},
+          {"y", sBox.MinCorner.GetY()},
+          {"z", sBox.MinCorner.GetZ()}};
+        cDetail["bounding_box"]["max"] = {
+          {"x", sBox.MaxCorner.GetX()},
+          {"y", sBox.MaxCorner.GetY()},
+          {"z", sBox.MaxCorner.GetZ()}};
+      }
+
+      /* Positions of the LEDs, in the same order as their colors */
+      if (pcComposable->HasComponent("leds")) {
+        cDetail["led_positions"] = LEDPositionsToJSON(
+          pcComposable->GetComponent<CLEDEquippedEntity>("leds"));
+      }
+
+      if (pcComposable->HasComponent("controller")) {
+        cDetail["controller_id"] = pcComposable
+                                     ->GetComponent<CControllableEntity>(
+                                       "controller")
+                                     .GetController()
+                                     .GetId();
+      }
+    }
+
+    cDetail["steps"] = m_cSpace.GetSimulationClock();
+    return cDetail;
+  }
+
+  /****************************************/
+  /****************************************/
+
+  size_t CWebviz::SpawnEntities(const Webviz::SSpawnRequest& s_request) {
+    if (m_pcSpawnRNG == nullptr) {
+      m_pcSpawnRNG = CRandom::CreateRNG("argos");
+    }
+    const CRange<Real> cRangeX(s_request.Min[0], s_request.Max[0]);
+    const CRange<Real> cRangeY(s_request.Min[1], s_request.Max[1]);
+    const CRange<Real> cRangeZ(s_request.Min[2], s_request.Max[2]);
+    auto fnRandomPosition = [&]() {
+      return CVector3(
+        m_pcSpawnRNG->Uniform(cRangeX),
+        m_pcSpawnRNG->Uniform(cRangeY),
+        m_pcSpawnRNG->Uniform(cRangeZ));
+    };
+
+    /* Ids are numbered on from the last one given with this prefix */
+    size_t& unNextId = m_mapSpawnIds[s_request.IdPrefix];
+    const CEntity::TMap& mapEntities = m_cSpace.GetEntityMap();
+
+    size_t unSpawned = 0;
+    size_t unNotPlaced = 0;
+    for (size_t i = 0; i < s_request.Count; ++i) {
+      std::string strId;
+      do {
+        strId = s_request.IdPrefix + std::to_string(unNextId++);
+      } while (mapEntities.find(strId) != mapEntities.end());
+
+      /* Created as from the configuration file, at a first random pose */
+      const CRadians cYaw = m_pcSpawnRNG->Uniform(CRadians::UNSIGNED_RANGE);
+      TConfigurationNode tEntityNode(s_request.Type);
+      tEntityNode.SetAttribute("id", strId);
+      for (const auto& cAttribute : s_request.Attributes) {
+        tEntityNode.SetAttribute(cAttribute.first, cAttribute.second);
+      }
+      TConfigurationNode tBodyNode("body");
+      tBodyNode.SetAttribute("position", ToString(fnRandomPosition()));
+      tBodyNode.SetAttribute(
+        "orientation", ToString(ToDegrees(cYaw).GetValue()) + ",0,0");
+      tEntityNode.InsertEndChild(tBodyNode);
+      if (!s_request.Controller.empty()) {
+        TConfigurationNode tControllerNode("controller");
+        tControllerNode.SetAttribute("config", s_request.Controller);
+        tEntityNode.InsertEndChild(tControllerNode);
+      }
+
+      CEntity* pcEntity = nullptr;
+      try {
+        pcEntity = CFactory<CEntity>::New(s_request.Type);
+        pcEntity->Init(tEntityNode);
+        CallEntityOperation<CSpaceOperationAddEntity, CSpace, void>(
+          m_cSpace, *pcEntity);
+      } catch (CARGoSException& ex) {
+        /* The next ones would fail the same way */
+        delete pcEntity;
+        LOGERR << "[ERROR] Cannot spawn \"" << s_request.Type
+               << "\" entities: " << ex.what() << '\n';
+        break;
+      }
+
+      /* Other poses are tried while it collides, it is removed if none
+       * fits */
+      CComposableEntity* pcComposable =
+        dynamic_cast<CComposableEntity*>(pcEntity);
+      if (pcComposable != nullptr && pcComposable->HasComponent("body")) {
+        CEmbodiedEntity& cBody =
+          pcComposable->GetComponent<CEmbodiedEntity>("body");
+        bool bPlaced = !cBody.IsCollidingWithSomething();
+        for (size_t unTrial = 1; !bPlaced && unTrial < s_request.MaxTrials;
+             ++unTrial) {
+          CQuaternion cOrientation;
+          cOrientation.FromEulerAngles(
+            m_pcSpawnRNG->Uniform(CRadians::UNSIGNED_RANGE),
+            CRadians::ZERO,
+            CRadians::ZERO);
+          bPlaced = cBody.MoveTo(fnRandomPosition(), cOrientation);
+        }
+        if (!bPlaced) {
+          CallEntityOperation<CSpaceOperationRemoveEntity, CSpace, void>(
+            m_cSpace, *pcEntity);
+          ++unNotPlaced;
+          continue;
+        }
+      }
+      ++unSpawned;
+    }
+
+    /* Regrouped on the next frame, whatever the addresses of the new
+     * entities */
+    m_cEntityTypes.Invalidate();
+
+    LOG << "[INFO] Spawned " << unSpawned << " \"" << s_request.Type
+        << "\" entities";
+    if (unNotPlaced > 0) {
+      LOG << ", " << unNotPlaced << " did not fit in the region";
+    }
+    LOG << '\n';
+    if (m_cWebServer != nullptr) {
+      m_cWebServer->EmitEvent(
+        "Spawned " + std::to_string(unSpawned) + " " + s_request.Type +
+          " entities",
+        m_eExperimentState);
+    }
+    return unSpawned;
+  }
+
+  /****************************************/
+  /****************************************/
+
+  void CWebviz::RecordExperiment() {
+    LOG << "[INFO] Recording the experiment, without webserver" << '\n';
+
+    m_eExperimentState = Webviz::EExperimentState::EXPERIMENT_PLAYING;
+
+    /* Initial state */
+    BroadcastExperimentState();
+
+    /* As fast as possible */
+    while (!m_cSimulator.IsExperimentFinished()) {
+      m_cSimulator.UpdateSpace();
+      ProcessStep();
+
+      /* Only recorded every "record_every" steps */
+      BroadcastExperimentState();
+    }
+
+    m_cSimulator.GetLoopFunctions().PostExperiment();
+    m_eExperimentState = Webviz::EExperimentState::EXPERIMENT_DONE;
+
+    /* Always record the final state */
+    m_nLastRecordedStep = -1;
+    BroadcastExperimentState();
+
+    LOG << "[INFO] Experiment done" << '\n';
+  }
+
+  /****************************************/
+  /****************************************/
+
   void CWebviz::HandleCommandFromClient(
     const std::string& str_ip, nlohmann::json c_json_command) {
     if (c_json_command.contains("command")) {
@@ -299,10 +1039,20 @@ namespace argos {
           cNewOrientation.SetW(
             c_json_command["orientation"]["w"].get<float_t>());
 
-          MoveEntity(
-            c_json_command["entity_id"].get<std::string>(),
-            cNewPos,
-            cNewOrientation);
+          /* The entity is given by its id, or by its handle */
+          std::string strEntityId;
+          const nlohmann::json& cEntityId = c_json_command["entity_id"];
+          if (cEntityId.is_number_integer()) {
+            if (!m_cEntityHandles.Resolve(
+                  cEntityId.get<int64_t>(), strEntityId)) {
+              THROW_ARGOSEXCEPTION(
+                "No entity found with handle: " + cEntityId.dump())
+            }
+          } else {
+            strEntityId = cEntityId.get<std::string>();
+          }
+
+          MoveEntity(strEntityId, cNewPos, cNewOrientation);
 
         } catch (const std::exception& e) {
           LOGERR << "[ERROR] In function MoveEntity: " << e.what() << '\n';
@@ -336,6 +1086,24 @@ namespace argos {
   /****************************************/
   /****************************************/
 
+  void CWebviz::RequestBroadcast() {
+    {
+      std::lock_guard<std::mutex> guard(m_mutex4BroadcastRequest);
+      m_bBroadcastRequested = true;
+    }
+    m_cBroadcastRequest.notify_one();
+  }
+
+  /****************************************/
+  /****************************************/
+
+  nlohmann::json CWebviz::GetUserDataChannels() const {
+    return m_pcUserFunctions->GetUserDataChannels().ToJSON();
+  }
+
+  /****************************************/
+  /****************************************/
+
   void CWebviz::PlayExperiment() {
     /* Make sure we are in the right state */
     if (
@@ -383,7 +1151,8 @@ namespace argos {
     /* If Steps are passed, and valid else to use existing steps */
     if (1 <= un_steps && un_steps <= 1000) {
       /* Update FF steps variable */
-      m_unDrawFrameEvery = un_steps;
+      m_cWebServer->GetBroadcastSettings().Update(
+        {{"ff_draw_frames_every", un_steps}});
     }
 
     m_bFastForwarding = true;
@@ -428,6 +1197,46 @@ namespace argos {
   /****************************************/
 
   void CWebviz::StepExperiment() {
+    {
+      std::lock_guard<std::mutex> guard(m_mutex4SimulationCommands);
+      m_vecSimulationCommands.push_back(ESimulationCommand::STEP);
+    }
+    RequestBroadcast();
+  }
+
+  /****************************************/
+  /****************************************/
+
+  void CWebviz::ResetExperiment() {
+    {
+      std::lock_guard<std::mutex> guard(m_mutex4SimulationCommands);
+      m_vecSimulationCommands.push_back(ESimulationCommand::RESET);
+    }
+    RequestBroadcast();
+  }
+
+  /****************************************/
+  /****************************************/
+
+  void CWebviz::RunSimulationCommands() {
+    std::vector<ESimulationCommand> vecCommands;
+    {
+      std::lock_guard<std::mutex> guard(m_mutex4SimulationCommands);
+      vecCommands.swap(m_vecSimulationCommands);
+    }
+    for (ESimulationCommand eCommand : vecCommands) {
+      if (eCommand == ESimulationCommand::STEP) {
+        RunStep();
+      } else {
+        RunReset();
+      }
+    }
+  }
+
+  /****************************************/
+  /****************************************/
+
+  void CWebviz::RunStep() {
     /* Make sure we are in the right state */
     if (
       m_eExperimentState == Webviz::EExperimentState::EXPERIMENT_PLAYING ||
@@ -437,11 +1246,8 @@ namespace argos {
              << Webviz::EExperimentStateToStr(m_eExperimentState)
              << " pausing the experiment to run a step" << '\n';
 
-      /* Make experiment pause */
+      /* Make experiment pause, the step is not run */
       m_eExperimentState = Webviz::EExperimentState::EXPERIMENT_PAUSED;
-
-      /* Do not go further, as the while loop in SimulationThreadFunction might
-       * be halfway into execution */
       return;
     }
 
@@ -451,6 +1257,10 @@ namespace argos {
     if (!m_cSimulator.IsExperimentFinished()) {
       /* Run one step */
       m_cSimulator.UpdateSpace();
+      ProcessStep();
+
+      /* Stamp used to trace the latency of the next frame */
+      m_nStepCompletedMicros = Webviz::GetMonotonicMicros();
 
       /* Make experiment pause */
       m_eExperimentState = Webviz::EExperimentState::EXPERIMENT_PAUSED;
@@ -470,14 +1280,13 @@ namespace argos {
       m_cWebServer->EmitEvent("Experiment done", m_eExperimentState);
     }
 
-    /* Broadcast current experiment state */
-    BroadcastExperimentState();
+    /* The frame is broadcast by the simulation thread once idle */
   }
 
   /****************************************/
   /****************************************/
 
-  void CWebviz::ResetExperiment() {
+  void CWebviz::RunReset() {
     /* Reset Simulator */
     m_cSimulator.Reset();
 
@@ -492,11 +1301,16 @@ namespace argos {
 
     m_eExperimentState = Webviz::EExperimentState::EXPERIMENT_INITIALIZED;
 
-    /* Change state and emit signals */
-    m_cWebServer->EmitEvent("Experiment reset", m_eExperimentState);
+    /* Entities added while running are gone */
+    m_cEntityTypes.Invalidate();
+    UpdateEntityTypes();
 
-    /* Broadcast current experiment state */
-    BroadcastExperimentState();
+    /* Aggregates start over from the initial state */
+    ProcessStep();
+
+    /* Change state and emit signals, the frame is broadcast by the
+     * simulation thread once idle */
+    m_cWebServer->EmitEvent("Experiment reset", m_eExperimentState);
 
     LOG << "[INFO] Experiment reset" << '\n';
   }
@@ -536,38 +1350,186 @@ namespace argos {
   /****************************************/
 
   void CWebviz::BroadcastExperimentState() {
+    /* Time the step of this frame completed, 0 if no step ran since the
+     * previous frame (e.g. while paused) */
+    const int64_t nStepCompletedMicros = m_nStepCompletedMicros.exchange(0);
+
+    /* Entities spawned by clients, each request in one batch between two
+     * steps, so they are part of this frame */
+    if (m_cSpawnRequests.HasPending()) {
+      for (const Webviz::SSpawnRequest& sRequest : m_cSpawnRequests.Take()) {
+        SpawnEntities(sRequest);
+      }
+    }
+
+    /* Detail requested by clients inspecting single entities */
+    m_cDetailRequests.Serve(
+      [this](const std::string& str_id) { return GetEntityDetail(str_id); });
+
+    /* Entities requested by the subscribed broadcast topics, none if
+     * headless */
+    const Webviz::CBroadcastFilter cFilter =
+      m_cWebServer != nullptr ? m_cWebServer->GetBroadcastFilter()
+                              : Webviz::CBroadcastFilter();
+
+    /* Recording needs the frame with all the entities, once every
+     * "record_every" steps (or after a reset) */
+    const int64_t nStep = m_cSpace.GetSimulationClock();
+    const bool bRecording =
+      m_cRecorder.IsOpen() &&
+      (m_nLastRecordedStep < 0 || nStep < m_nLastRecordedStep ||
+       nStep >= m_nLastRecordedStep + m_unRecordEvery);
+
+    /* The history needs the frame with all the entities, once per step */
+    const bool bHistory = m_cHistory.NeedsFrame(nStep);
+
+    /* Exported trajectories, once every "export_every" steps */
+    const bool bExporting = m_cExporter.NeedsFrame(nStep);
+
+    /* Local readers of the shared-memory ring, once per step */
+    const bool bSharedMemory =
+      m_cSharedMemory.IsOpen() &&
+      (m_nLastSharedStep < 0 || nStep != m_nLastSharedStep);
+
+    /* These need all the entities, whatever the subscriptions */
+    const bool bAllEntities =
+      bRecording || bHistory || bExporting || bSharedMemory;
+
+    /* Swarm statistics, with each frame, only to their subscribers */
+    if (m_cWebServer != nullptr && m_cWebServer->HasSubscribers("stats")) {
+      /* Poses are already up to date if the aggregates are enabled */
+      if (
+        (!m_cTrails.IsEnabled() && !m_cHeatmap.IsEnabled()) ||
+        m_sPoses.Step != static_cast<uint64_t>(nStep)) {
+        CapturePoses();
+      }
+
+      nlohmann::json cStatsJson;
+      cStatsJson["type"] = "stats";
+      cStatsJson["steps"] = nStep;
+      cStatsJson["stats"] = m_cStatistics.Compute(
+        m_sPoses, CPhysicsEngine::GetSimulationClockTick());
+      m_cWebServer->Publish("stats", cStatsJson.dump());
+    }
+
+    /* User data channels which changed, each on its own topic and at its
+     * own rate, kept for the clients subscribing later */
+    if (m_cWebServer != nullptr) {
+      m_pcUserFunctions->GetUserDataChannels().Publish(
+        nStep,
+        std::chrono::steady_clock::now(),
+        [this](const std::string& str_topic) {
+          return m_cWebServer->HasSubscribers(str_topic);
+        },
+        [this](const std::string& str_topic, std::string str_message) {
+          m_cWebServer->Publish(str_topic, std::move(str_message), true);
+        });
+    }
+
+    /* Nobody is watching, skip all the serialization work */
+    if (!cFilter.IsAnyRequested() && !bAllEntities) {
+      return;
+    }
+
     /************* Build a JSON object to be sent to all clients *************/
     nlohmann::json cStateJson;
 
+    /* Entities reused from the caches, handed to the webserver without a
+     * copy when nothing else needs the whole frame */
+    Webviz::TSharedFragments vecShared;
+
     /************* Convert Entities info to JSON *************/
 
-    /* Get all entities in the experiment */
-    CEntity::TVector& vecEntities = m_cSpace.GetRootEntityVector();
+    /* Entities grouped by type, regrouped if some were added or removed */
+    UpdateEntityTypes();
 
-    for (auto itEntities = vecEntities.begin();  //
-         itEntities != vecEntities.end();        //
-         ++itEntities) {
-      /************* Generate JSON from Entities *************/
+    for (auto& sType : m_cEntityTypes.GetTypes()) {
+      /* Unknown types were reported once, and are not serialized */
+      if (!sType.Known) {
+        continue;
+      }
 
-      auto cEntityJSON = CallEntityOperation<
-        CWebvizOperationGenerateJSON,
-        CWebviz,
-        nlohmann::json>(*this, **itEntities);
+      /* Do not serialize entities nobody subscribed to */
+      if (!bAllEntities && !cFilter.IsTypeRequested(sType.Name)) {
+        continue;
+      }
+      const bool bWholeType =
+        bAllEntities || cFilter.IsWholeTypeRequested(sType.Name);
+
+      SEntitySerializer& sSerializer = sType.Serializer;
+      for (size_t i = 0; i < sType.Entities.size(); ++i) {
+        CEntity* pcEntity = sType.Entities[i];
+        if (
+          !bWholeType &&
+          !cFilter.IsEntityRequested(sType.Name, pcEntity->GetId())) {
+          continue;
+        }
+
+        /************* Generate JSON from Entities *************/
+
+        /* Entities in the same state as at the previous frames (walls,
+         * lights, idle robots) reuse their JSON */
+        const bool bFingerprint =
+          sSerializer.Fallback || sSerializer.FingerprintFunction != nullptr;
+        Webviz::CFragmentCache::TFragment pcCached;
+        uint64_t unFingerprint = 0;
+        if (bFingerprint) {
+          unFingerprint =
+            sSerializer.Fallback
+              ? FALLBACK_FIELDS.Fingerprint(sSerializer.Components[i])
+              : (sSerializer.FingerprintOperation->*
+                 sSerializer.FingerprintFunction)(*this, *pcEntity);
+          pcCached = sSerializer.Fragments.Find(i, unFingerprint);
+        }
+
+        /* Debug values of the controller, after the cached JSON as they
+         * change at every step */
+        const Webviz::CDebugSlot* pcSlot =
+          sSerializer.DebugSlots.empty() ? nullptr : sSerializer.DebugSlots[i];
+        const bool bDebug = pcSlot != nullptr && !pcSlot->IsEmpty();
+
+        /* Nothing to add, the webserver gets the cached JSON as is */
+        if (
+          pcCached != nullptr && !pcCached->is_null() && !bAllEntities &&
+          !bDebug && !sSerializer.UserFunction) {
+          nlohmann::json& cEntities = cStateJson["entities"];
+          vecShared.push_back(
+            {cEntities.size(), unFingerprint, std::move(pcCached)});
+          cEntities.push_back(nullptr);
+          continue;
+        }
+
+        nlohmann::json cEntityJSON;
+        if (pcCached != nullptr) {
+          cEntityJSON = *pcCached;
+        } else {
+          cEntityJSON =
+            sSerializer.Fallback
+              ? FALLBACK_FIELDS.ToJSON(sSerializer.Components[i])
+              : (sSerializer.Operation->*sSerializer.Function)(
+                  *this, *pcEntity);
+          if (bFingerprint) {
+            sSerializer.Fragments.Store(i, cEntityJSON);
+          }
+        }
+        if (cEntityJSON.is_null()) {
+          continue;
+        }
+
+        if (bDebug) {
+          cEntityJSON["debug"] = DebugSlotToJSON(*pcSlot);
+        }
 
-      if (cEntityJSON != nullptr) {
         /************* get data from User functions for entity *************/
-        const nlohmann::json& user_data = m_pcUserFunctions->Call(**itEntities);
+        if (sSerializer.UserFunction) {
+          const nlohmann::json& user_data = m_pcUserFunctions->Call(*pcEntity);
 
-        if (!user_data.is_null()) {
-          cEntityJSON["user_data"] = user_data;
+          if (!user_data.is_null()) {
+            cEntityJSON["user_data"] = user_data;
+          }
         }
 
-        cStateJson["entities"].push_back(cEntityJSON);
-      } else {
-        LOGERR << "[ERROR] Unknown Entity:"
-               << (**itEntities).GetTypeDescription() << "\n"
-               << "Please register a class to convert Entity to JSON, "
-               << "Check documentation for how to implement custom entity";
+        cStateJson["entities"].push_back(std::move(cEntityJSON));
       }
     }
 
@@ -610,8 +1572,46 @@ namespace argos {
     /* Type of message */
     cStateJson["type"] = "broadcast";
 
+    /* Record, without the latency stamps which are meaningless later */
+    std::string strFrame;
+    if (bRecording || bSharedMemory) {
+      strFrame = cStateJson.dump();
+    }
+    if (bSharedMemory) {
+      m_nLastSharedStep = nStep;
+      m_cSharedMemory.Write(nStep, strFrame);
+    }
+    if (bRecording) {
+      m_nLastRecordedStep = nStep;
+      m_cRecorder.Write(nStep, std::move(strFrame));
+    }
+    if (bHistory) {
+      m_cHistory.Push(nStep, cStateJson);
+    }
+    if (bExporting) {
+      m_cExporter.AddFrame(nStep, cStateJson);
+    }
+
+    if (!cFilter.IsAnyRequested()) {
+      return;
+    }
+
+    /* Monotonic stamps (in microseconds) to trace the latency of the frame,
+     * "handed" and "published" are added by the webserver */
+    if (nStepCompletedMicros > 0) {
+      cStateJson["stamps"]["step"] = nStepCompletedMicros;
+    }
+    cStateJson["stamps"]["serialized"] = Webviz::GetMonotonicMicros();
+
+    /* The manifest of the handles, only when entities were added or
+     * removed since the last frame handed over */
+    if (m_cEntityHandles.GetVersion() != m_unManifestVersionSent) {
+      cStateJson["manifest"] = m_cEntityHandles.ToJSON();
+      m_unManifestVersionSent = m_cEntityHandles.GetVersion();
+    }
+
     /* Send to webserver to broadcast */
-    m_cWebServer->Broadcast(cStateJson);
+    m_cWebServer->Broadcast(std::move(cStateJson), std::move(vecShared));
   }
 
   /****************************************/
@@ -657,6 +1657,34 @@ namespace argos {
   /****************************************/
 
   void CWebviz::Destroy() {
+    /* Write the pending frames */
+    if (m_cRecorder.IsOpen()) {
+      m_cRecorder.Close();
+      LOG << "[INFO] Recorded " << m_cRecorder.GetWrittenFrames() << " frames";
+      if (m_cRecorder.GetDroppedFrames() > 0) {
+        LOG << ", dropped " << m_cRecorder.GetDroppedFrames()
+            << " frames as the disk was too slow";
+      }
+      LOG << '\n';
+    }
+
+    /* Readers keep their mapping, new ones can not open it anymore */
+    if (m_cSharedMemory.IsOpen()) {
+      m_cSharedMemory.Close();
+      if (m_cSharedMemory.GetSkipped() > 0) {
+        LOGERR << "[WARNING] " << m_cSharedMemory.GetSkipped()
+               << " frames were too large for the shared memory, please "
+                  "increase \"shm_slot_kb\"\n";
+      }
+    }
+
+    /* Write the pending rows and end the stream */
+    if (m_cExporter.IsEnabled()) {
+      m_cExporter.Close();
+      LOG << "[INFO] Exported " << m_cExporter.GetExportedRows()
+          << " trajectory rows" << '\n';
+    }
+
     /* Get rid of the factory */
 
     CFactory<CWebvizUserFunctions>::Destroy();
@@ -682,12 +1710,33 @@ namespace argos {
     "         broadcast_frequency=10\n"
     "         ff_draw_frames_every=2\n"
     "         autoplay=\"true\"\n"
+    "         record_file=\"\"\n"
+    "         record_every=1\n"
+    "         record_only=\"false\"\n"
+    "         playback_file=\"\"\n"
+    "         history_seconds=0\n"
+    "         history_max_mb=64\n"
+    "         export_file=\"\"\n"
+    "         export_every=1\n"
+    "         export_http=\"false\"\n"
+    "         trail_points=0\n"
+    "         trail_min_distance=0.01\n"
+    "         trail_min_angle=5\n"
+    "         heatmap_cell_size=0\n"
+    "         heatmap_frequency=1\n"
+    "         broadcast_rays=\"true\"\n"
+    "         shm_name=\"\"\n"
+    "         shm_slots=64\n"
+    "         shm_slot_kb=1024\n"
     "         ssl_key_file=\"NULL\"\n"
     "         ssl_cert_file=\"NULL\"\n"
     "         ssl_ca_file=\"NULL\"\n"
     "         ssl_dh_params_file=\"NULL\"\n"
-    "         ssl_cert_passphrase=\"NULL\"\n"
-    "    />\n"
+    "         ssl_cert_passphrase=\"NULL\">\n"
+    "      <groups>\n"
+    "        <group name=\"leaders\" types=\"foot-bot\" id_prefix=\"fbl\" />\n"
+    "      </groups>\n"
+    "    </webviz>\n"
     "  </visualization>\n\n"
     "\n"
     "Where:\n"
@@ -708,6 +1757,69 @@ namespace argos {
 
     "autoplay(bool): Allows user to auto-play the simulation at startup\n"
     "    Default: false\n\n"
+    "record_file(string): Records every frame (compressed, with a\n"
+    "\tstep index in record_file + \".idx\"). Clients can play it back\n"
+    "\tand seek in it, during or after the run, with the \"playback\",\n"
+    "\t\"seek\" and \"live\" commands\n"
+    "    Default: \"\" (disabled)\n\n"
+    "record_every(unsigned int): Number of steps between recorded frames\n"
+    "    Default: 1\n\n"
+    "record_only(bool): Runs the experiment as fast as possible, only\n"
+    "\trecording it in record_file (and/or export_file, shm_name).\n"
+    "\tNo webserver is started.\n"
+    "    Default: false\n\n"
+    "playback_file(string): Recording clients play back, instead of\n"
+    "\trecord_file (e.g. one made with record_only)\n"
+    "    Default: \"\" (record_file)\n\n"
+    "history_seconds(real): Seconds of simulated time of which the\n"
+    "\tframes are kept in memory (delta-compressed). Clients can go back\n"
+    "\tto them with the \"rewind\" command, or fetch them with the\n"
+    "\t\"history\" command, e.g. when joining late\n"
+    "    Default: 0 (disabled)\n\n"
+    "history_max_mb(unsigned int): Memory limit of the history, the\n"
+    "\toldest frames are dropped first\n"
+    "    Default: 64\n\n"
+    "export_file(string): Exports the trajectories (step, id, type,\n"
+    "\tposition, orientation and LED colors of every entity) as an\n"
+    "\tApache Arrow IPC stream, e.g. for pandas or polars\n"
+    "    Default: \"\" (disabled)\n\n"
+    "export_every(unsigned int): Number of steps between exported rows\n"
+    "    Default: 1\n\n"
+    "export_http(bool): Streams the export over HTTP (chunked), on the\n"
+    "\t\"/export\" endpoint\n"
+    "    Default: false\n\n"
+    "trail_points(unsigned int): Number of past positions kept for each\n"
+    "\tentity, fetched by clients with the \"trails\" command\n"
+    "    Default: 0 (disabled)\n\n"
+    "trail_min_distance(real): Minimum distance (in meters) between two\n"
+    "\tpoints of a trail\n"
+    "    Default: 0.01\n\n"
+    "trail_min_angle(real): Minimum change of direction (in degrees) to\n"
+    "\tstart a new segment, straight motion extends the last one\n"
+    "    Default: 5\n\n"
+    "heatmap_cell_size(real): Size (in meters) of the cells of a grid\n"
+    "\tover the arena, counting the steps spent by the movable entities\n"
+    "\tin each cell. Published on the \"heatmap\" topic\n"
+    "    Default: 0 (disabled)\n\n"
+    "heatmap_frequency(real): Frequency (in Hertz) of the heatmap\n"
+    "    Default: 1\n\n"
+    "broadcast_rays(bool): Includes the rays and intersection points in\n"
+    "\tthe broadcasts. Clients can fetch them for one entity with the\n"
+    "\t\"entity\" command, or on \"/entity/<id>\"\n"
+    "    Default: true\n\n"
+    "shm_name(string): Writes every frame in a POSIX shared-memory ring\n"
+    "\tof this name (e.g. \"/webviz\"), read without copies by local\n"
+    "\tprocesses. See testing/shmreader for an example reader\n"
+    "    Default: \"\" (disabled)\n\n"
+    "shm_slots(unsigned int): Number of frames kept in the ring\n"
+    "    Default: 64\n\n"
+    "shm_slot_kb(unsigned int): Maximum size (in KiB) of a frame in the\n"
+    "\tring, larger frames are skipped\n"
+    "    Default: 1024\n\n"
+    "groups: user-defined groups of entities, each published on the\n"
+    "\t\"broadcasts/groups/<name>\" topic. Entities of a group match all\n"
+    "\tof the optional comma separated \"types\" and the \"id_prefix\".\n"
+    "\tEvery entity type is published on \"broadcasts/<type>\" too.\n\n"
     "--\n\n"
     "SSL CONFIGURATION\n"
     "SSL can be used to host the server over \"wss\"(analogous to \n"
@@ -26,6 +26,7 @@ namespace argos {
 
 #include <argos3/core/simulator/entity/entity.h>
 
+#include <cstdint>
 #include <nlohmann/json.hpp>
 
 namespace argos {
@@ -43,27 +44,94 @@ namespace argos {
 #define REGISTER_WEBVIZ_ENTITY_OPERATION(ACTION, OPERATION, ENTITY) \
   REGISTER_ENTITY_OPERATION(ACTION, CWebviz, OPERATION, json, ENTITY);
 
+  /****************************************/
+  /****************************************/
+
+  /**
+   * @brief Fingerprint of the state the JSON of an entity is written from.
+   * Entities of the types which register one reuse their previous JSON
+   * while it does not change, see CEntityFields::Fingerprint()
+   */
+  class CWebvizOperationFingerprint : public CEntityOperation<
+                                        CWebvizOperationFingerprint,
+                                        CWebviz,
+                                        uint64_t> {
+   public:
+    virtual ~CWebvizOperationFingerprint() {}
+  };
+
+#define REGISTER_WEBVIZ_ENTITY_FINGERPRINT(OPERATION, ENTITY) \
+  REGISTER_ENTITY_OPERATION(                                  \
+    CWebvizOperationFingerprint, CWebviz, OPERATION, uint64_t, ENTITY);
+
 }  // namespace argos
 
 #include <argos3/core/simulator/entity/composable_entity.h>
+#include <argos3/core/simulator/entity/controllable_entity.h>
+#include <argos3/core/simulator/entity/embodied_entity.h>
 #include <argos3/core/simulator/loop_functions.h>
 #include <argos3/core/simulator/space/space.h>
 #include <argos3/core/simulator/visualization/visualization.h>
 #include <argos3/core/utility/configuration/argos_exception.h>
+#include <argos3/core/utility/math/rng.h>
 #include <argos3/core/utility/math/vector3.h>
 #include <argos3/core/utility/plugins/dynamic_loading.h>
+#include <argos3/core/utility/plugins/factory.h>
+#include <argos3/core/utility/string_utilities.h>
+#include <argos3/plugins/simulator/entities/led_equipped_entity.h>
 
 #include <atomic>
+#include <condition_variable>
+#include <map>
+#include <mutex>
 #include <thread>
+#include <utility>
 
 #include "utility/CTimer.h"
+#include "utility/DebugSlot.h"
 #include "utility/EExperimentState.h"
+#include "utility/EntityDetails.h"
+#include "utility/EntityFields.h"
+#include "utility/EntityHandles.h"
+#include "utility/EntityTypeTable.h"
+#include "utility/FragmentCache.h"
+#include "utility/FrameHistory.h"
+#include "utility/FrameRecording.h"
+#include "utility/LatencyHistogram.h"
 #include "utility/LogStream.h"
+#include "utility/OccupancyGrid.h"
 #include "utility/PortCheck.h"
+#include "utility/PoseSnapshot.h"
+#include "utility/SharedMemoryRing.h"
+#include "utility/SpawnRequests.h"
+#include "utility/SwarmStatistics.h"
+#include "utility/TrailBuffer.h"
+#include "utility/TrajectoryExport.h"
 #include "webviz_user_functions.h"
 #include "webviz_webserver.h"
 
 namespace argos {
+  namespace Webviz {
+    /**
+     * @brief Components of an entity without registered serializer, looked
+     * up once so its pose and LEDs are sent without any string lookup
+     */
+    struct SEntityComponents {
+      CComposableEntity* Entity = nullptr;
+
+      CEmbodiedEntity* Body = nullptr;
+
+      /** Null if the entity has no LEDs */
+      CLEDEquippedEntity* LEDs = nullptr;
+
+      std::string GetTypeDescription() const {
+        return Entity->GetTypeDescription();
+      }
+
+      const std::string& GetId() const { return Entity->GetId(); }
+    };
+  }  // namespace Webviz
+
   /****************************************/
   /****************************************/
 
@@ -90,6 +158,20 @@ namespace argos {
     void HandleCommandFromClient(
       const std::string& str_ip, nlohmann::json c_json_command);
 
+    /**
+     * @brief Requests a fresh frame of the experiment state, without waiting
+     * for the next step or idle cycle. Called when a client subscribes to a
+     * broadcast topic, as no frames are produced without subscribers
+     */
+    void RequestBroadcast();
+
+    /**
+     * @brief Returns the user data channels registered by the user
+     * functions, with their topic, see
+     * CWebvizUserFunctions::RegisterUserDataChannel()
+     */
+    nlohmann::json GetUserDataChannels() const;
+
    protected:
     /**
      * @brief Plays the experiment.
@@ -109,6 +191,7 @@ namespace argos {
     /**
      * @brief Executes one experiment time step.
      *
+     * The step is run by the simulation thread, before its next frame.
      */
     void StepExperiment();
 
@@ -123,6 +206,7 @@ namespace argos {
      * @brief Resets the state of the experiment to its state right after
      * initialization
      *
+     * The reset is run by the simulation thread, before its next frame.
      */
     void ResetExperiment();
 
@@ -146,6 +230,53 @@ namespace argos {
       std::string str_entity_id, CVector3 c_pos, CQuaternion c_orientation);
 
    private:
+    /** Commands run by the simulation thread, in the order received */
+    enum class ESimulationCommand { STEP, RESET };
+
+    typedef CEntityOperation<CWebvizOperationGenerateJSON, CWebviz, json>
+      TJSONOperation;
+
+    typedef json (TJSONOperation::*TJSONFunction)(CWebviz&, CEntity&);
+
+    typedef CEntityOperation<CWebvizOperationFingerprint, CWebviz, uint64_t>
+      TFingerprintOperation;
+
+    typedef uint64_t (TFingerprintOperation::*TFingerprintFunction)(
+      CWebviz&, CEntity&);
+
+    /** What serializes an entity type, resolved once per type */
+    struct SEntitySerializer {
+      /** Registered operation instance and its function for the type */
+      TJSONOperation* Operation = nullptr;
+      TJSONFunction Function = nullptr;
+
+      /** True if a user function is registered for the type */
+      bool UserFunction = false;
+
+      /** True if the type has no operation, but has a body, so the pose
+       * and LEDs of its entities are sent from their components */
+      bool Fallback = false;
+
+      /** True if the entities of a fallback type have LEDs */
+      bool FallbackLEDs = false;
+
+      /** Components of each entity of a fallback type, in their order */
+      std::vector<Webviz::SEntityComponents> Components;
+
+      /** Registered fingerprint operation and its function for the type,
+       * null if it has none: its entities are serialized at every frame */
+      TFingerprintOperation* FingerprintOperation = nullptr;
+      TFingerprintFunction FingerprintFunction = nullptr;
+
+      /** Last JSON of each entity, reused while its fingerprint is the
+       * same. Only used by the simulation thread, as the whole table */
+      Webviz::CFragmentCache Fragments;
+
+      /** Debug slot of the controller of each entity, null for the ones
+       * without. Empty if no entity of the type has one */
+      std::vector<const Webviz::CDebugSlot*> DebugSlots;
+    };
+
     /** Experiment State, declared atomic as it is used by many threads */
     std::atomic<Webviz::EExperimentState> m_eExperimentState;
 
@@ -164,12 +295,101 @@ namespace argos {
     /** Webserver */
     Webviz::CWebServer* m_cWebServer = nullptr;
 
-    /** number of frames to drop in Fast-forwarding */
-    unsigned short m_unDrawFrameEvery = 2;
-
     /** User functions */
     CWebvizUserFunctions* m_pcUserFunctions = nullptr;
 
+    /** Background writer of the recording, if "record_file" is set */
+    Webviz::CFrameRecordWriter m_cRecorder;
+
+    /** Step of the last recorded frame, to skip unchanged idle frames */
+    int64_t m_nLastRecordedStep;
+
+    /** Frames shared with local readers, if "shm_name" is set */
+    Webviz::CSharedMemoryRingWriter m_cSharedMemory;
+
+    /** Step of the last frame in shared memory, -1 if none */
+    int64_t m_nLastSharedStep;
+
+    /** Number of steps between recorded frames */
+    UInt32 m_unRecordEvery = 1;
+
+    /** Headless mode, only recording, without webserver */
+    bool m_bRecordOnly = false;
+
+    /** Recent frames kept in memory, for the "rewind" and "history"
+     * commands */
+    Webviz::CFrameHistory m_cHistory;
+
+    /** Columnar export of the trajectories, if "export_file" or
+     * "export_http" is set */
+    Webviz::CTrajectoryExporter m_cExporter;
+
+    /** Decimated past positions of each entity, for the "trails" command */
+    Webviz::CTrailBuffers m_cTrails;
+
+    /** Poses of the movable entities at the last step, for the aggregates,
+     * only used by the simulation thread */
+    Webviz::SPoseSnapshot m_sPoses;
+
+    /** Occupancy of the arena, published on the "heatmap" topic */
+    Webviz::COccupancyGrid m_cHeatmap;
+
+    /** Period of the "heatmap" topic */
+    std::chrono::milliseconds m_cHeatmapPeriod;
+
+    /** Time the heatmap was last published */
+    std::chrono::steady_clock::time_point m_tHeatmapPublished;
+
+    /** Per-type statistics of the swarm, published on the "stats" topic */
+    Webviz::CSwarmStatistics m_cStatistics;
+
+    /**
+     * Root entities grouped by type, with their serializers. They are told
+     * apart by tag and id, addresses can be reused once removed
+     */
+    Webviz::CEntityTypeTable<
+      CEntity,
+      SEntitySerializer,
+      std::pair<size_t, std::string>>
+      m_cEntityTypes;
+
+    /** Numeric handles of the root entities, sent in the manifest */
+    Webviz::CEntityHandles m_cEntityHandles;
+
+    /** Version of the manifest last handed to the webserver */
+    uint64_t m_unManifestVersionSent = 0;
+
+    /** Requests for the full detail of single entities */
+    Webviz::CEntityDetailRequests m_cDetailRequests;
+
+    /** Entities to spawn, from the "spawnEntities" command */
+    Webviz::CSpawnRequests m_cSpawnRequests;
+
+    /** Random poses of the spawned entities, created on first use */
+    CRandom::CRNG* m_pcSpawnRNG = nullptr;
+
+    /** Next number of the ids of the spawned entities, per prefix */
+    std::map<std::string, size_t> m_mapSpawnIds;
+
+    /** Step and reset commands waiting for the simulation thread */
+    std::vector<ESimulationCommand> m_vecSimulationCommands;
+
+    /** Mutex to protect access to m_vecSimulationCommands */
+    std::mutex m_mutex4SimulationCommands;
+
+    /** True if a frame was requested through RequestBroadcast() */
+    bool m_bBroadcastRequested;
+
+    /** Mutex to protect access to m_bBroadcastRequested */
+    std::mutex m_mutex4BroadcastRequest;
+
+    /** Wakes up the simulation thread while idle on RequestBroadcast() */
+    std::condition_variable m_cBroadcastRequest;
+
+    /** Monotonic time (in microseconds) at which the last step completed,
+     * 0 once taken by a frame */
+    std::atomic<int64_t> m_nStepCompletedMicros;
+
     /**
      * @brief Function which run in Simulation thread
      *
@@ -182,6 +402,65 @@ namespace argos {
      *
      */
     void BroadcastExperimentState();
+
+    /**
+     * @brief Updates the server-side aggregates (trails, heatmap) from the
+     * poses of the entities, after each simulation step. Only called from
+     * the simulation thread, which owns m_sPoses
+     */
+    void ProcessStep();
+
+    /**
+     * @brief Runs the commands received since the last call, from the
+     * simulation thread, so they never change the simulation while a
+     * frame is built
+     */
+    void RunSimulationCommands();
+
+    /** Runs one step, from the simulation thread */
+    void RunStep();
+
+    /** Resets the experiment, from the simulation thread */
+    void RunReset();
+
+    /**
+     * @brief Groups the root entities by type and resolves the serializer
+     * of each new type, if the entities changed since the last call.
+     * Composable types with a body but without serializer fall back to
+     * their pose and LEDs. Types without serializer are reported once.
+     * The entities added get a handle, the removed ones free theirs
+     */
+    void UpdateEntityTypes();
+
+    /**
+     * @brief Takes the poses of the movable entities into m_sPoses
+     */
+    void CapturePoses();
+
+    /**
+     * @brief Builds the full detail of one entity: its serialized state
+     * with rays and points, user data, bounding box, LED positions and
+     * controller
+     *
+     * @param str_id id of the entity
+     * @return nlohmann::json the detail, null if there is no such entity
+     */
+    nlohmann::json GetEntityDetail(const std::string& str_id);
+
+    /**
+     * @brief Adds the entities of a spawn request, at random poses in its
+     * region where they do not collide. Called between two steps
+     *
+     * @param s_request entities to add
+     * @return size_t number of entities added
+     */
+    size_t SpawnEntities(const Webviz::SSpawnRequest& s_request);
+
+    /**
+     * @brief Runs the whole experiment as fast as possible in the calling
+     * thread, only recording it ("record_only" mode)
+     */
+    void RecordExperiment();
   };
 
 };  // namespace argos
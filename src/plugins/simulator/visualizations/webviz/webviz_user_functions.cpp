@@ -12,6 +12,8 @@
 
 #include "webviz_user_functions.h"
 
+#include <argos3/core/utility/configuration/argos_exception.h>
+
 namespace argos {
 
   CWebvizUserFunctions::CWebvizUserFunctions() : m_vecFunctionHolders(1) {
@@ -40,4 +42,28 @@ namespace argos {
     }
   }
 
+  /****************************************/
+  /****************************************/
+
+  bool CWebvizUserFunctions::HasFunction(CEntity& c_entity) {
+    return m_cThunks[c_entity.GetTag()] != NULL;
+  }
+
+  /****************************************/
+  /****************************************/
+
+  Webviz::CUserDataChannel& CWebvizUserFunctions::RegisterUserDataChannel(
+    const std::string& str_name,
+    Webviz::EUserDataType e_type,
+    double f_max_frequency) {
+    Webviz::CUserDataChannel* pcChannel =
+      m_cUserDataChannels.Register(str_name, e_type, f_max_frequency);
+    if (pcChannel == nullptr) {
+      THROW_ARGOSEXCEPTION(
+        "User data channel \"" << str_name
+                                << "\" is registered with another type");
+    }
+    return *pcChannel;
+  }
+
 }  // namespace argos
\ No newline at end of file
@@ -24,6 +24,8 @@ namespace argos {
 #include <functional>
 #include <nlohmann/json.hpp>
 
+#include "utility/UserDataChannels.h"
+
 namespace argos {
   class CWebvizUserFunctions : public CBaseConfigurableResource {
    public:
@@ -59,6 +61,31 @@ namespace argos {
      */
     virtual const nlohmann::json sendUserData() { return nullptr; }
 
+    /**
+     * @brief Registers a user data channel, usually in Init(). Unlike
+     * sendUserData(), which is attached to every frame, a channel is only
+     * serialized and published on its topic "user/<name>" when its value
+     * changed, e.g. for heavy data such as a pheromone matrix
+     *
+     * @param str_name name of the channel
+     * @param e_type JSON value or array of numbers
+     * @param f_max_frequency maximum messages per second, 0 for no limit
+     * @return Webviz::CUserDataChannel& the channel, whose value is changed
+     * with SetJSON() or SetNumbers()
+     *
+     * @throw CARGoSException if the name is taken by a channel of another
+     * type
+     */
+    Webviz::CUserDataChannel& RegisterUserDataChannel(
+      const std::string& str_name,
+      Webviz::EUserDataType e_type,
+      double f_max_frequency = 0);
+
+    /** The registered user data channels */
+    Webviz::CUserDataChannels& GetUserDataChannels() {
+      return m_cUserDataChannels;
+    }
+
     /**
      * Registers a user method.
      * @param USER_IMPL A user-defined subclass of CWebvizUserFunctions.
@@ -76,6 +103,15 @@ namespace argos {
      */
     virtual const nlohmann::json Call(CEntity& c_entity);
 
+    /**
+     * Returns true if a user method is registered for the type of the
+     * entity. Checked once per entity type, Call() is not called for the
+     * entities of types without user method.
+     * Override it along with Call().
+     * @param c_entity An entity of the type.
+     */
+    virtual bool HasFunction(CEntity& c_entity);
+
    protected:
     /**
      * Pointer-to-thunk type definition.
@@ -130,6 +166,9 @@ namespace argos {
      * @see CFunctionHolder
      */
     std::vector<CFunctionHolder*> m_vecFunctionHolders;
+
+    /** Channels registered with RegisterUserDataChannel() */
+    Webviz::CUserDataChannels m_cUserDataChannels;
   };
 
   /****************************************/
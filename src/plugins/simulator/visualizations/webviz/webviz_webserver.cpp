@@ -30,16 +30,26 @@ namespace argos {
           /* Port to host the application on */
           m_unPort(un_port),
           /* Initialize broadcast Timer */
-          m_cBroadcastTimer(argos::Webviz::CTimer()) {
+          m_cBroadcastTimer(argos::Webviz::CTimer()),
+          /* No history until SetFrameHistory() */
+          m_pcFrameHistory(nullptr),
+          /* No trails until SetTrailBuffers() */
+          m_pcTrails(nullptr),
+          /* No entity detail until SetEntityDetailRequests() */
+          m_pcEntityDetails(nullptr),
+          /* No spawning until SetSpawnRequests() */
+          m_pcSpawnRequests(nullptr) {
       /* We dont want to divide by zero or negative frequency */
       if (un_freq <= 0) {
         un_freq = 10;  // Defaults to 10 Hz
       }
 
-      /* max allowed time for one broadcast cycle */
-      m_cBroadcastDuration = std::chrono::milliseconds(1000 / un_freq);
+      /* Broadcast cycles per second, can be changed with "configure" */
+      SBroadcastSettings sSettings;
+      sSettings.Frequency = un_freq;
+      m_cSettings.Set(sSettings);
 
-      m_strBroadcastString = "";
+      m_bHasNewBroadcast = false;
 
       /* SSL parameters */
       m_strKeyFile = str_key_file;
@@ -102,6 +112,9 @@ namespace argos {
       /* Mutex to protect access to vecWebSocketClients */
       std::mutex mutex4VecWebClients;
 
+      /* Responses streaming the export, only used in the loop thread */
+      std::vector<uWS::HttpResponse<SSL> *> vecExportClients;
+
       try {
         /* Set up thread-safe buffers for this new thread */
         LOG.AddThreadSafeBuffer();
@@ -156,21 +169,29 @@ namespace argos {
              /* new client is connected */
              .open =
                [&](uWS::WebSocket<SSL, true> *pc_ws, uWS::HttpRequest *pc_req) {
-                 /* Selectivly subscribe to different channels */
+                 m_sPerSocketData *psData =
+                   static_cast<m_sPerSocketData *>(pc_ws->getUserData());
+
+                 /* Selectivly subscribe to different channels, including
+                  * per entity type ("broadcasts/foot-bot") and per group
+                  * ("broadcasts/groups/<name>") broadcasts */
                  if (pc_req->getQuery().size() > 0) {
                    std::stringstream strStream(std::string(pc_req->getQuery()));
                    std::string str_token;
                    while (std::getline(strStream, str_token, ',')) {
-                     pc_ws->subscribe(str_token);
+                     psData->m_vecTopics.push_back(str_token);
                    }
                  } else {
                    /* making every connection subscribe to the "broadcast",
                     * "events" and "logs" topics */
-                   pc_ws->subscribe("broadcasts");
-                   pc_ws->subscribe("events");
-                   pc_ws->subscribe("logs");
+                   psData->m_vecTopics = {BROADCAST_TOPIC, "events", "logs"};
                  }
 
+                 SubscribeTopics<SSL>(pc_ws, psData->m_vecTopics);
+                 psData->m_pcOpen = std::make_shared<bool>(true);
+                 psData->m_pcPlaybackRequest =
+                   std::make_shared<std::atomic<uint64_t>>(0);
+
                  /* Guard the mutex which locks vecWebSocketClients */
                  std::lock_guard<std::mutex> guard(mutex4VecWebClients);
 
@@ -205,9 +226,60 @@ namespace argos {
                      strIP = strStream.str();
                    }
 
-                   /* Try to parse the message as JSON and handle the command */
+                   /* Try to parse the message as JSON */
+                   nlohmann::json cCommand = nlohmann::json::parse(strv_message);
+
+                   /* Latency probes, playback and history are handled
+                    * directly by the webserver, as they only concern this
+                    * client */
+                   if (
+                     cCommand.contains("command") &&
+                     cCommand["command"].is_string()) {
+                     const std::string strCmd = cCommand["command"];
+
+                     if (strCmd == "ping") {
+                       HandlePing<SSL>(pc_ws, cCommand);
+                       return;
+                     } else if (
+                       strCmd == "playback" || strCmd == "seek" ||
+                       strCmd == "live") {
+                       HandlePlayback<SSL>(pc_ws, cCommand);
+                       return;
+                     } else if (strCmd == "rewind" || strCmd == "history") {
+                       HandleHistory<SSL>(pc_ws, cCommand);
+                       return;
+                     } else if (strCmd == "trails") {
+                       HandleTrails<SSL>(pc_ws, cCommand);
+                       return;
+                     } else if (strCmd == "entity") {
+                       HandleEntityDetail<SSL>(pc_ws, cCommand);
+                       return;
+                     } else if (strCmd == "manifest") {
+                       nlohmann::json cReply;
+                       cReply["type"] = "manifest";
+                       cReply["manifest"] = m_cEntityHandles.ToJSON();
+                       pc_ws->send(cReply.dump(), uWS::OpCode::TEXT);
+                       return;
+                     } else if (strCmd == "user_channels") {
+                       nlohmann::json cReply;
+                       cReply["type"] = "user_channels";
+                       cReply["channels"] = m_pcMyWebviz->GetUserDataChannels();
+                       pc_ws->send(cReply.dump(), uWS::OpCode::TEXT);
+                       return;
+                     } else if (strCmd == "configure") {
+                       nlohmann::json cReply = Configure(cCommand);
+                       pc_ws->send(cReply.dump(), uWS::OpCode::TEXT);
+                       return;
+                     } else if (strCmd == "spawnEntities") {
+                       nlohmann::json cReply = SpawnEntities(cCommand);
+                       pc_ws->send(cReply.dump(), uWS::OpCode::TEXT);
+                       return;
+                     }
+                   }
+
+                   /* Handle the command */
                    m_pcMyWebviz->HandleCommandFromClient(
-                     strIP, nlohmann::json::parse(strv_message));
+                     strIP, std::move(cCommand));
 
                  } catch (nlohmann::json::exception &ignored) {
                    /* Error is ignored as we can not guarantee client to send
@@ -219,16 +291,29 @@ namespace argos {
                [](uWS::WebSocket<SSL, true> *ws) {
                  //  LOG << "Drain: " << ws->getBufferedAmount() << '\n';
                },
-             .ping =
-               [](uWS::WebSocket<SSL, true> *ws) { LOG << "Ping" << '\n'; },
-             .pong =
-               [](uWS::WebSocket<SSL, true> *ws) { LOG << "Pong" << '\n'; },
+             /* Pings keep connections alive, not logged as every client of a
+              * large audience sends them periodically */
+             .ping = [](uWS::WebSocket<SSL, true> *ws) {},
+             .pong = [](uWS::WebSocket<SSL, true> *ws) {},
              .close =
                [&](
                  uWS::WebSocket<SSL, true> *pc_ws,
                  int n_code,
                  std::string_view strv_message) {
                  /* client automatically unsubscribe from any topic here */
+                 m_sPerSocketData *psData =
+                   static_cast<m_sPerSocketData *>(pc_ws->getUserData());
+
+                 /* Broadcast topics are already released while paused */
+                 std::vector<std::string> vecTopics;
+                 for (const auto &strTopic : psData->m_vecTopics) {
+                   if (!psData->m_bPaused || !IsBroadcastTopic(strTopic)) {
+                     vecTopics.push_back(strTopic);
+                   }
+                 }
+                 ReleaseTopics(vecTopics);
+                 psData->m_pcPlayback.reset();
+                 *psData->m_pcOpen = false;
 
                  /* Guard the mutex which locks vecWebSocketClients */
                  std::lock_guard<std::mutex> guard(mutex4VecWebClients);
@@ -262,6 +347,104 @@ namespace argos {
                 res->end(strStream.str());
               });
             })
+          /* Latency histograms collected from "ping" commands */
+          .get(
+            "/latency",
+            [&](auto *res, auto *req) { SendJSON<SSL>(res, GetLatencyJSON()); })
+          /* Broadcast settings, changed with a POST of the new values */
+          .get(
+            "/configure",
+            [&](auto *pc_res, auto *pc_req) {
+              SendJSON<SSL>(pc_res, m_cSettings.ToJSON());
+            })
+          .post(
+            "/configure",
+            [&](auto *pc_res, auto *pc_req) {
+              /* The body comes in chunks */
+              auto pcBody = std::make_shared<std::string>();
+              auto pcAborted = std::make_shared<bool>(false);
+              pc_res->onAborted([pcAborted]() { *pcAborted = true; });
+              pc_res->onData(
+                [this, pc_res, pcBody, pcAborted](
+                  std::string_view strv_chunk, bool b_last) {
+                  pcBody->append(strv_chunk.data(), strv_chunk.size());
+                  if (!b_last || *pcAborted) {
+                    return;
+                  }
+
+                  nlohmann::json cChanges =
+                    nlohmann::json::parse(*pcBody, nullptr, false);
+                  if (cChanges.is_discarded()) {
+                    SendJSONError<SSL>(pc_res, {{"error", "Invalid JSON"}});
+                    return;
+                  }
+                  nlohmann::json cReply = Configure({{"settings", cChanges}});
+                  if (cReply.contains("error")) {
+                    SendJSONError<SSL>(pc_res, cReply);
+                  } else {
+                    SendJSON<SSL>(pc_res, cReply);
+                  }
+                });
+            })
+          /* Full detail of one entity, answered at the next frame */
+          .get(
+            "/entity/:id",
+            [&](auto *pc_res, auto *pc_req) {
+              SendEntityDetail<SSL>(
+                pc_res, std::string(pc_req->getParameter(0)));
+            })
+          /* Same, for the entity with a handle of the manifest */
+          .get(
+            "/entity/handle/:handle",
+            [&](auto *pc_res, auto *pc_req) {
+              std::string strId;
+              const std::string strHandle(pc_req->getParameter(0));
+              if (
+                strHandle.empty() ||
+                strHandle.find_first_not_of("0123456789") !=
+                  std::string::npos ||
+                strHandle.size() > 18 ||
+                !m_cEntityHandles.Resolve(std::stoll(strHandle), strId)) {
+                SendJSONError<SSL>(
+                  pc_res,
+                  {{"error", "No entity found with handle: " + strHandle}},
+                  "404 Not Found");
+                return;
+              }
+              SendEntityDetail<SSL>(pc_res, strId);
+            })
+          /* Handles of the entities, as in the "manifest" of the frames */
+          .get(
+            "/manifest",
+            [&](auto *pc_res, auto *pc_req) {
+              SendJSON<SSL>(pc_res, m_cEntityHandles.ToJSON());
+            })
+          /* Trajectories as an Arrow IPC stream, chunked as they come */
+          .get(
+            "/export",
+            [&](auto *pc_res, auto *pc_req) {
+              if (m_strExportSchema.empty()) {
+                SendJSONError<SSL>(
+                  pc_res,
+                  {{"error", "Export is not enabled"}},
+                  "404 Not Found");
+                return;
+              }
+
+              pc_res->onAborted([&vecExportClients, pc_res]() {
+                vecExportClients.erase(
+                  std::remove(
+                    vecExportClients.begin(), vecExportClients.end(), pc_res),
+                  vecExportClients.end());
+              });
+
+              pc_res
+                ->writeHeader(
+                  "Content-Type", "application/vnd.apache.arrow.stream")
+                ->writeHeader("Access-Control-Allow-Origin", "*")
+                ->write(m_strExportSchema);
+              vecExportClients.push_back(pc_res);
+            })
           /* Start listening to Port */
           .listen(m_unPort, [&](auto *pc_token) {
             if (pc_token) {
@@ -276,6 +459,9 @@ namespace argos {
             }
           });
 
+        /* Loop of this thread, which runs all the sockets */
+        struct uWS::Loop *pcLoop = uWS::Loop::get();
+
         std::thread *tBroadcasterThread = new std::thread([&]() {
           /* Set up thread-safe buffers for this new thread */
           LOG.AddThreadSafeBuffer();
@@ -285,41 +471,206 @@ namespace argos {
           m_cBroadcastTimer.Start();
 
           /* copy strings to free up the locks */
-          /* Declaring local static here to help with lambda catching inside
-           */
-          static std::string strBroadcastString;
-          static std::string strEventString;
-          static std::string strLogString;
+          std::string strEventString;
+          std::string strLogString;
+
+          /* Warned once per series of overrunning cycles */
+          bool bOverrunWarned = false;
+
+          /* Version of the manifest last sent */
+          uint64_t unManifestVersionSent = 0;
 
           while (b_IsServerRunning) {
             /* stop the timer now to get total time spent */
             m_cBroadcastTimer.Stop();
 
+            /* Settings of this cycle, they may change at any time */
+            const SBroadcastSettings sSettings = m_cSettings.Get();
+
+            /* max allowed time for one broadcast cycle */
+            const std::chrono::milliseconds cBroadcastDuration(
+              1000 / sSettings.Frequency);
+
             /* If the elapsed time is lower than the tick length, wait */
-            if (m_cBroadcastTimer.Elapsed() < m_cBroadcastDuration) {
+            if (m_cBroadcastTimer.Elapsed() < cBroadcastDuration) {
               /* Sleep for the difference duration */
               std::this_thread::sleep_for(
-                m_cBroadcastDuration - m_cBroadcastTimer.Elapsed());
-            } else {
+                cBroadcastDuration - m_cBroadcastTimer.Elapsed());
+              bOverrunWarned = false;
+            } else if (!bOverrunWarned) {
+              /* Late cycles are not skipped, the next one starts now */
               LOGERR << "[WARNING] Broadcast tick took " << m_cBroadcastTimer
                      << " milli-secs, more than the expected "
-                     << m_cBroadcastDuration.count() << " milli-secs. "
+                     << cBroadcastDuration.count() << " milli-secs. "
                      << "Not able to reach all clients, Please reduce "
-                        "the \'broadcast_frequency\' in "
-                        "configuration file.\n";
-              break;
+                        "the \'broadcast_frequency\' with the "
+                        "\'configure\' command.\n";
+              bOverrunWarned = true;
             }
 
             /* Restart Timer */
             m_cBroadcastTimer.Start();
 
-            /* Decouple the strings so a new broadcast message can be accepted
+            /* Decouple the JSON so a new broadcast message can be accepted
              * while old are sending */
-            /* Mutex block for m_mutex4BroadcastString */
+            nlohmann::json cBroadcastJSON;
+            TSharedFragments vecShared;
+            bool bHasNewBroadcast = false;
+
+            /* Mutex block for m_mutex4BroadcastJSON */
             {
-              std::lock_guard<std::mutex> guard(m_mutex4BroadcastString);
-              strBroadcastString = m_strBroadcastString;
-            }  // End of mutex block: m_mutex4BroadcastString
+              std::lock_guard<std::mutex> guard(m_mutex4BroadcastJSON);
+              if (m_bHasNewBroadcast) {
+                cBroadcastJSON = std::move(m_cBroadcastJSON);
+                vecShared = std::move(m_vecBroadcastFragments);
+                m_bHasNewBroadcast = false;
+                bHasNewBroadcast = true;
+              }
+            }  // End of mutex block: m_mutex4BroadcastJSON
+
+            /* Frames of the broadcast topics, as (topic, frame) */
+            std::vector<std::pair<std::string, std::string>> vecFrames;
+
+            /* Only new frames are sent, stale ones are not repeated */
+            if (bHasNewBroadcast) {
+              cBroadcastJSON["stamps"]["dequeued"] = GetMonotonicMicros();
+
+              /* Handles of the entities, kept to resolve the handles the
+               * clients send back */
+              if (cBroadcastJSON.contains("manifest")) {
+                m_cEntityHandles.FromJSON(cBroadcastJSON["manifest"]);
+                cBroadcastJSON.erase("manifest");
+              }
+
+              /* Serialize now, the frame can not be replaced anymore. Each
+               * topic gets its own frame with only the entities it carries */
+              const CBroadcastFilter cFilter = GetBroadcastFilter();
+              nlohmann::json cEntities = std::move(cBroadcastJSON["entities"]);
+              cBroadcastJSON.erase("entities");
+              if (!cEntities.is_array()) {
+                cEntities = nlohmann::json::array();
+              }
+
+              /* Entities reused from the fragment caches, null in the frame */
+              std::vector<const SSharedFragment *> vecFragments(
+                cEntities.size(), nullptr);
+              for (const SSharedFragment &sShared : vecShared) {
+                if (sShared.Index < vecFragments.size()) {
+                  vecFragments[sShared.Index] = &sShared;
+                }
+              }
+
+              /* Cached entities carry the handles of the previous manifest */
+              const uint64_t unVersion = m_cEntityHandles.GetVersion();
+              if (unVersion != unManifestVersionSent) {
+                m_cBroadcastFragments.Clear();
+              }
+
+              /* Fewer fields and digits, to lighten the uplink. LED colors
+               * are left out while they do not change, with all of them in
+               * a keyframe about once a second */
+              auto fnProcess = [&sSettings, this](nlohmann::json &c_entity) {
+                ApplyBroadcastDetail(c_entity, sSettings.Detail);
+                if (sSettings.HalfRays) {
+                  Rays::QuantizeToHalf(c_entity);
+                }
+                RoundNumbers(c_entity, sSettings.Precision);
+              };
+              m_cLEDChanges.BeginFrame(sSettings.Frequency);
+
+              /* (type, id) of each entity, for the topics, taken before
+               * they are replaced by the handles, and its text. Entities
+               * which did not change since they were last sent reuse it */
+              std::vector<std::pair<std::string, std::string>> vecKeys;
+              vecKeys.reserve(cEntities.size());
+              std::vector<std::string> vecDumped(cEntities.size());
+              std::vector<const std::string *> vecTexts(cEntities.size());
+              for (size_t i = 0; i < cEntities.size(); ++i) {
+                const SSharedFragment *psShared = vecFragments[i];
+                nlohmann::json &cEntity = cEntities[i];
+                const nlohmann::json &cSource =
+                  psShared != nullptr ? *psShared->JSON : cEntity;
+                vecKeys.emplace_back(
+                  cSource.value("type", ""), cSource.value("id", ""));
+
+                if (psShared != nullptr) {
+                  const CBroadcastFragments::SFragment &sFragment =
+                    m_cBroadcastFragments.Get(
+                      vecKeys.back().second,
+                      psShared->Fingerprint,
+                      sSettings,
+                      cSource,
+                      [&](nlohmann::json &c_entity) {
+                        fnProcess(c_entity);
+                        if (sSettings.Handles) {
+                          m_cEntityHandles.Compact(c_entity);
+                        }
+                      });
+                  vecTexts[i] = sFragment.HasLEDs &&
+                                    !m_cLEDChanges.IsToSend(
+                                      vecKeys.back().second, sFragment.LEDHash)
+                                  ? &sFragment.WithoutLEDs
+                                  : &sFragment.WithLEDs;
+                  continue;
+                }
+
+                fnProcess(cEntity);
+                m_cLEDChanges.Filter(cEntity);
+                if (sSettings.Handles) {
+                  m_cEntityHandles.Compact(cEntity);
+                }
+                vecDumped[i] = cEntity.dump();
+                vecTexts[i] = &vecDumped[i];
+              }
+
+              /* The manifest goes with the first frame after a change, with
+               * or without handles, as it carries the static data of the
+               * entities (e.g. the positions of their LEDs) */
+              if (sSettings.Handles) {
+                cBroadcastJSON["handles"] = unVersion;
+              }
+              if (unVersion != unManifestVersionSent) {
+                cBroadcastJSON["manifest"] = m_cEntityHandles.ToJSON();
+                unManifestVersionSent = unVersion;
+              }
+
+              /* The frame without its entities, they are spliced in as
+               * serialized above. It is never empty, it has its stamps */
+              const std::string strFrame = cBroadcastJSON.dump();
+              auto fnFrame = [&](const auto &fn_contains) {
+                std::string strEntities = ",\"entities\":[";
+                bool bFirst = true;
+                for (size_t i = 0; i < vecTexts.size(); ++i) {
+                  if (fn_contains(i)) {
+                    if (!bFirst) {
+                      strEntities.push_back(',');
+                    }
+                    strEntities.append(*vecTexts[i]);
+                    bFirst = false;
+                  }
+                }
+                strEntities.push_back(']');
+                std::string strTopicFrame;
+                strTopicFrame.reserve(strFrame.size() + strEntities.size());
+                strTopicFrame.append(strFrame, 0, strFrame.size() - 1);
+                strTopicFrame.append(strEntities);
+                strTopicFrame.push_back('}');
+                return strTopicFrame;
+              };
+
+              for (const auto &cTopic : cFilter.GetTopics()) {
+                vecFrames.emplace_back(cTopic.first, fnFrame([&](size_t i) {
+                  return cTopic.second.Contains(
+                    vecKeys[i].first, vecKeys[i].second);
+                }));
+              }
+
+              if (cFilter.IsAllRequested()) {
+                vecFrames.emplace_back(
+                  BROADCAST_TOPIC, fnFrame([](size_t) { return true; }));
+              }
+              cBroadcastJSON = nullptr;
+            }
 
             /* Mutex block for m_mutex4EventQueue */
             {
@@ -360,46 +711,158 @@ namespace argos {
               }
             }  // End of mutex block: m_mutex4LogQueue
 
-            std::lock_guard<std::mutex> guard(mutex4VecWebClients);
-
-            /* Send the string to each client */
-            std::for_each(
-              vecWebSocketClients.begin(),
-              vecWebSocketClients.end(),
-              [](SWebSocketClient<SSL> wsStruct) {
-                wsStruct.m_pcLoop->defer([wsStruct]() {
-                  if (!strBroadcastString.empty()) {
-                    wsStruct.m_pcWS->publish(
-                      "broadcasts",
-                      strBroadcastString,
-                      uWS::OpCode::TEXT,
-                      true);  // Compress = true
-                  }
+            /* Stamp the frames just before they are handed to the sockets.
+             * The stamp is spliced in to avoid serializing the frames twice */
+            std::string strPublished =
+              ",\"published\":" + std::to_string(GetMonotonicMicros());
+
+            /* Messages to publish in this cycle, shared with the cache */
+            auto pcMessages = std::make_shared<TTopicMessages>();
+
+            for (auto &cFrame : vecFrames) {
+              cFrame.second.insert(cFrame.second.size() - 1, strPublished);
+              pcMessages->emplace_back(
+                cFrame.first,
+                std::make_shared<const std::string>(std::move(cFrame.second)));
+            }
 
-                  if (!strEventString.empty()) {
-                    wsStruct.m_pcWS->publish(
-                      "events",
-                      strEventString,
-                      uWS::OpCode::TEXT,
-                      true);  // Compress = true
+            /* Keep the new frames for clients connecting before the next
+             * ones. Only the topics still subscribed are kept */
+            if (bHasNewBroadcast) {
+              std::lock_guard<std::mutex> guard(m_mutex4CachedFrames);
+              for (auto it = m_mapCachedFrames.begin();
+                   it != m_mapCachedFrames.end();) {
+                it = IsBroadcastTopic(it->first) ? m_mapCachedFrames.erase(it)
+                                                 : std::next(it);
+              }
+              for (const auto &cMessage : *pcMessages) {
+                m_mapCachedFrames[cMessage.first] = cMessage.second;
+              }
+            }
+
+            if (!strEventString.empty()) {
+              pcMessages->emplace_back(
+                "events",
+                std::make_shared<const std::string>(std::move(strEventString)));
+            }
+
+            if (!strLogString.empty()) {
+              pcMessages->emplace_back(
+                "logs",
+                std::make_shared<const std::string>(std::move(strLogString)));
+            }
+
+            /* Messages of the other topics, the kept ones replace the
+             * previous ones of their topic for the next subscribers */
+            {
+              std::lock_guard<std::mutex> guard(m_mutex4TopicMessages);
+              while (!m_queTopicMessages.empty()) {
+                STopicMessage &sMessage = m_queTopicMessages.front();
+                auto pcMessage = std::make_shared<const std::string>(
+                  std::move(sMessage.Message));
+                if (sMessage.Keep) {
+                  std::lock_guard<std::mutex> guardCached(m_mutex4CachedFrames);
+                  m_mapCachedFrames[sMessage.Topic] = pcMessage;
+                }
+                pcMessages->emplace_back(sMessage.Topic, std::move(pcMessage));
+                m_queTopicMessages.pop();
+              }
+            }
+
+            /* Record batches of the export, written to the HTTP clients */
+            std::vector<std::shared_ptr<const std::string>> vecExportBatches;
+            {
+              std::lock_guard<std::mutex> guard(m_mutex4ExportBatches);
+              while (!m_queExportBatches.empty()) {
+                vecExportBatches.push_back(
+                  std::move(m_queExportBatches.front()));
+                m_queExportBatches.pop();
+              }
+            }
+
+            if (!vecExportBatches.empty()) {
+              pcLoop->defer([vecExportBatches, &vecExportClients]() {
+                for (auto it = vecExportClients.begin();
+                     it != vecExportClients.end();) {
+                  auto *pcRes = *it;
+                  /* write() buffers what the socket does not take */
+                  for (const auto &pcBatch : vecExportBatches) {
+                    if (
+                      !pcRes->write(*pcBatch) &&
+                      pcRes->getBufferedAmount() > MAX_EXPORT_BUFFERED) {
+                      break;
+                    }
                   }
 
-                  if (!strLogString.empty()) {
-                    wsStruct.m_pcWS->publish(
-                      "logs",
-                      strLogString,
-                      uWS::OpCode::TEXT,
-                      true);  // Compress = true
+                  /* A client which does not keep up is dropped, rather
+                   * than buffering the whole export for it */
+                  if (pcRes->getBufferedAmount() > MAX_EXPORT_BUFFERED) {
+                    LOGERR << "[WARNING] Export client too slow, "
+                           << pcRes->getBufferedAmount()
+                           << " bytes buffered, closing its stream" << '\n';
+                    pcRes->end();
+                    it = vecExportClients.erase(it);
+                  } else {
+                    ++it;
                   }
-                });
+                }
+              });
+            }
+
+            if (pcMessages->empty()) {
+              continue;
+            }
+
+            /* Publish once, through any socket, as the topics reach all the
+             * subscribers. Runs in the loop thread, which owns the sockets */
+            pcLoop->defer(
+              [pcMessages,
+               &vecWebSocketClients,
+               &mutex4VecWebClients,
+               bCompress = sSettings.Compress]() {
+                std::lock_guard<std::mutex> guard(mutex4VecWebClients);
+
+                if (vecWebSocketClients.empty()) {
+                  return;
+                }
+
+                for (const auto &cMessage : *pcMessages) {
+                  vecWebSocketClients.front().m_pcWS->publish(
+                    cMessage.first,
+                    *cMessage.second,
+                    uWS::OpCode::TEXT,
+                    bCompress);
+                }
               });
           }
         });
 
+        /* Reads the recording for the "playback" and "seek" commands, so
+         * the disk and zlib never hold up the sockets */
+        std::thread tPlaybackThread([&]() {
+          while (b_IsServerRunning) {
+            std::function<void()> fnJob;
+            {
+              std::unique_lock<std::mutex> cLock(m_mutex4PlaybackJobs);
+              m_cPlaybackJobAdded.wait_for(
+                cLock, std::chrono::milliseconds(250), [this]() {
+                  return !m_deqPlaybackJobs.empty();
+                });
+              if (m_deqPlaybackJobs.empty()) {
+                continue;
+              }
+              fnJob = std::move(m_deqPlaybackJobs.front());
+              m_deqPlaybackJobs.pop_front();
+            }
+            fnJob();
+          }
+        });
+
         cMyApp.run();  // Blocking the thread
 
         /* Join all the threads */
         tBroadcasterThread->join();
+        tPlaybackThread.join();
       } catch (CARGoSException &ex) {
         THROW_ARGOSEXCEPTION_NESTED("[ERROR] Error in the webserver:", ex);
       }
@@ -410,6 +873,11 @@ namespace argos {
 
     void CWebServer::EmitEvent(
       std::string str_event_name, argos::Webviz::EExperimentState e_state) {
+      /* Nobody would receive it */
+      if (m_cTopicSubscriptions.GetSubscribers("events") == 0) {
+        return;
+      }
+
       nlohmann::json cMyJson;
       cMyJson["type"] = "event";
       cMyJson["event"] = str_event_name;
@@ -427,8 +895,10 @@ namespace argos {
 
     void CWebServer::EmitLog(
       const std::string &str_log_name, const std::string &str_log_data) {
-      /* if message is not empty */
-      if (!str_log_data.empty()) {
+      /* if message is not empty, and somebody would receive it */
+      if (
+        !str_log_data.empty() &&
+        m_cTopicSubscriptions.GetSubscribers("logs") > 0) {
         /* Build json object */
         nlohmann::json cMyJson;
         cMyJson["log_type"] = str_log_name;
@@ -447,13 +917,748 @@ namespace argos {
     /****************************************/
     /****************************************/
 
-    void CWebServer::Broadcast(nlohmann::json cMyJson) {
-      /* Guard the mutex which locks m_mutex4BroadcastString */
-      std::lock_guard<std::mutex> guard(m_mutex4BroadcastString);
+    void CWebServer::Broadcast(
+      nlohmann::json cMyJson, TSharedFragments vec_shared) {
+      cMyJson["stamps"]["handed"] = GetMonotonicMicros();
+
+      /* Guard the mutex which locks m_mutex4BroadcastJSON */
+      std::lock_guard<std::mutex> guard(m_mutex4BroadcastJSON);
+      /* A manifest is only sent once, it must outlive its stale frame */
+      if (
+        m_bHasNewBroadcast && m_cBroadcastJSON.contains("manifest") &&
+        !cMyJson.contains("manifest")) {
+        cMyJson["manifest"] = std::move(m_cBroadcastJSON["manifest"]);
+      }
       /* Replaces the existing state, even if it was not sent
        * This enables us to discard stale experiment state
        */
-      m_strBroadcastString = cMyJson.dump();
+      m_cBroadcastJSON = std::move(cMyJson);
+      m_vecBroadcastFragments = std::move(vec_shared);
+      m_bHasNewBroadcast = true;
+    }
+
+    /****************************************/
+    /****************************************/
+
+    template <bool SSL>
+    void CWebServer::SubscribeTopics(
+      uWS::WebSocket<SSL, true> *pc_ws,
+      const std::vector<std::string> &vec_topics) {
+      bool bBroadcastSubscribed = false;
+      bool bUserDataSubscribed = false;
+      for (const auto &strTopic : vec_topics) {
+        pc_ws->subscribe(strTopic);
+        m_cTopicSubscriptions.Subscribe(strTopic);
+        bBroadcastSubscribed |= IsBroadcastTopic(strTopic);
+        bUserDataSubscribed |= strTopic.compare(0, 5, "user/") == 0;
+      }
+
+      const SBroadcastSettings sSettings = m_cSettings.Get();
+
+      /* The manifest only goes with the first frame after a change, so a
+       * client arriving later gets it first, before the frames using its
+       * handles and static data */
+      if (bBroadcastSubscribed && m_cEntityHandles.GetVersion() > 0) {
+        nlohmann::json cManifest;
+        cManifest["type"] = "manifest";
+        cManifest["manifest"] = m_cEntityHandles.ToJSON();
+        pc_ws->send(cManifest.dump(), uWS::OpCode::TEXT, sSettings.Compress);
+      }
+
+      /* Send the latest frames right away, instead of waiting for the next
+       * broadcast cycle */
+      {
+        std::lock_guard<std::mutex> guard(m_mutex4CachedFrames);
+        for (const auto &strTopic : vec_topics) {
+          auto itFrame = m_mapCachedFrames.find(strTopic);
+          if (itFrame != m_mapCachedFrames.end()) {
+            pc_ws->send(
+              *itFrame->second, uWS::OpCode::TEXT, sSettings.Compress);
+          }
+        }
+      }
+
+      /* No frames are built without subscribers, build one now rather than
+       * waiting for the next step. It carries all the LED colors, which the
+       * cached frames may have left out */
+      if (bBroadcastSubscribed) {
+        m_cLEDChanges.RequestKeyframe();
+        m_pcMyWebviz->RequestBroadcast();
+      } else if (bUserDataSubscribed) {
+        /* User data channels are published again for new subscribers */
+        m_pcMyWebviz->RequestBroadcast();
+      }
+    }
+
+    /****************************************/
+    /****************************************/
+
+    void CWebServer::ReleaseTopics(const std::vector<std::string> &vec_topics) {
+      for (const auto &strTopic : vec_topics) {
+        m_cTopicSubscriptions.Unsubscribe(strTopic);
+
+        /* Frames are not updated without subscribers, the cached one would
+         * be stale for the next client */
+        if (m_cTopicSubscriptions.GetSubscribers(strTopic) == 0) {
+          std::lock_guard<std::mutex> guard(m_mutex4CachedFrames);
+          m_mapCachedFrames.erase(strTopic);
+        }
+      }
+    }
+
+    /****************************************/
+    /****************************************/
+
+    void CWebServer::SetRecordingFile(const std::string &str_file) {
+      m_strRecordingFile = str_file;
+    }
+
+    /****************************************/
+    /****************************************/
+
+    template <bool SSL>
+    void CWebServer::HandlePlayback(
+      uWS::WebSocket<SSL, true> *pc_ws, const nlohmann::json &c_json_command) {
+      m_sPerSocketData *psData =
+        static_cast<m_sPerSocketData *>(pc_ws->getUserData());
+      const std::string strCmd = c_json_command["command"];
+
+      nlohmann::json cReply;
+      cReply["type"] = "playback";
+
+      auto fnReplyError = [&](const std::string &str_error) {
+        cReply["error"] = str_error;
+        pc_ws->send(cReply.dump(), uWS::OpCode::TEXT);
+      };
+
+      if (strCmd == "live") {
+        psData->m_pcPlayback.reset();
+        ResumeBroadcasts<SSL>(pc_ws);
+        cReply["mode"] = "live";
+        pc_ws->send(cReply.dump(), uWS::OpCode::TEXT);
+        return;
+      }
+
+      /* Switch the client to playback, the recording is opened by the
+       * playback thread */
+      if (strCmd == "playback" && !psData->m_pcPlayback) {
+        if (m_strRecordingFile.empty()) {
+          fnReplyError("No recording configured");
+          return;
+        }
+
+        PauseBroadcasts<SSL>(pc_ws);
+        psData->m_pcPlayback = std::make_shared<CFrameRecordReader>();
+      }
+
+      if (!psData->m_pcPlayback) {
+        fnReplyError("Not in playback, send the \"playback\" command first");
+        return;
+      }
+
+      /* Seek by frame index, by step (in the latest run), or first frame */
+      const bool bByFrame = c_json_command.contains("frame") &&
+                            c_json_command["frame"].is_number_unsigned();
+      const bool bByStep = !bByFrame && c_json_command.contains("step") &&
+                           c_json_command["step"].is_number_unsigned();
+      const size_t unRequestedFrame =
+        bByFrame ? c_json_command["frame"].get<size_t>() : 0;
+      const uint64_t unRequestedStep =
+        bByStep ? c_json_command["step"].get<uint64_t>() : 0;
+
+      /* Read by the playback thread, replied from the loop thread if the
+       * client is still in this playback */
+      std::shared_ptr<CFrameRecordReader> pcReader = psData->m_pcPlayback;
+      std::shared_ptr<bool> pcOpen = psData->m_pcOpen;
+      std::shared_ptr<std::atomic<uint64_t>> pcRequest =
+        psData->m_pcPlaybackRequest;
+      const uint64_t unRequest = ++*pcRequest;
+      struct uWS::Loop *pcLoop = uWS::Loop::get();
+
+      auto fnJob = [this,
+                    pc_ws,
+                    pcLoop,
+                    pcOpen,
+                    pcReader,
+                    pcRequest,
+                    unRequest,
+                    bByFrame,
+                    bByStep,
+                    unRequestedFrame,
+                    unRequestedStep]() {
+        /* A later command of the client is waiting, only that one is read */
+        if (*pcRequest != unRequest) {
+          return;
+        }
+
+        nlohmann::json cReply;
+        cReply["type"] = "playback";
+        std::string strFrame;
+
+        /* The recording can still be growing */
+        CFrameRecordReader &cReader = *pcReader;
+        size_t unFrames = 0;
+        if (!cReader.IsOpen() && !cReader.Open(m_strRecordingFile)) {
+          cReply["error"] = "Cannot open recording " + m_strRecordingFile;
+        } else if ((unFrames = cReader.Refresh()) == 0) {
+          cReply["error"] = "The recording is empty";
+        } else {
+          size_t unFrame = cReader.GetLatestRunStart();
+          if (bByFrame) {
+            unFrame = std::min(unRequestedFrame, unFrames - 1);
+          } else if (bByStep) {
+            unFrame = cReader.FindFrame(unRequestedStep);
+          }
+
+          if (!cReader.ReadFrame(unFrame, strFrame)) {
+            cReply["error"] = "Cannot read frame " + std::to_string(unFrame);
+            strFrame.clear();
+          } else {
+            cReply["mode"] = "playback";
+            cReply["frame"] = unFrame;
+            cReply["frames"] = unFrames;
+            cReply["step"] = cReader.GetEntry(unFrame).Step;
+            cReply["first_step"] =
+              cReader.GetEntry(cReader.GetLatestRunStart()).Step;
+            cReply["last_step"] = cReader.GetEntry(unFrames - 1).Step;
+          }
+        }
+
+        const bool bOpenFailed = !cReader.IsOpen();
+        pcLoop->defer([this,
+                       pc_ws,
+                       pcOpen,
+                       pcReader,
+                       bOpenFailed,
+                       strReply = cReply.dump(),
+                       strFrame = std::move(strFrame)]() {
+          if (!*pcOpen) {
+            return;
+          }
+          m_sPerSocketData *psData =
+            static_cast<m_sPerSocketData *>(pc_ws->getUserData());
+          /* The client went live or started another playback meanwhile */
+          if (psData->m_pcPlayback != pcReader) {
+            return;
+          }
+          /* Back to live if the recording cannot be played */
+          if (bOpenFailed) {
+            psData->m_pcPlayback.reset();
+            ResumeBroadcasts<SSL>(pc_ws);
+          }
+          pc_ws->send(strReply, uWS::OpCode::TEXT);
+          if (!strFrame.empty()) {
+            pc_ws->send(strFrame, uWS::OpCode::TEXT, true);  // Compress
+          }
+        });
+      };
+
+      {
+        std::lock_guard<std::mutex> guard(m_mutex4PlaybackJobs);
+        if (m_deqPlaybackJobs.size() >= MAX_PLAYBACK_JOBS) {
+          fnReplyError("Too many pending requests");
+          return;
+        }
+        m_deqPlaybackJobs.push_back(std::move(fnJob));
+      }
+      m_cPlaybackJobAdded.notify_one();
+    }
+
+    /****************************************/
+    /****************************************/
+
+    void CWebServer::SetFrameHistory(const CFrameHistory *pc_history) {
+      m_pcFrameHistory = pc_history;
+    }
+
+    /****************************************/
+    /****************************************/
+
+    template <bool SSL>
+    void CWebServer::PauseBroadcasts(uWS::WebSocket<SSL, true> *pc_ws) {
+      m_sPerSocketData *psData =
+        static_cast<m_sPerSocketData *>(pc_ws->getUserData());
+      if (psData->m_bPaused) {
+        return;
+      }
+
+      std::vector<std::string> vecBroadcastTopics;
+      for (const auto &strTopic : psData->m_vecTopics) {
+        if (IsBroadcastTopic(strTopic)) {
+          pc_ws->unsubscribe(strTopic);
+          vecBroadcastTopics.push_back(strTopic);
+        }
+      }
+      ReleaseTopics(vecBroadcastTopics);
+      psData->m_bPaused = true;
+    }
+
+    /****************************************/
+    /****************************************/
+
+    template <bool SSL>
+    void CWebServer::ResumeBroadcasts(uWS::WebSocket<SSL, true> *pc_ws) {
+      m_sPerSocketData *psData =
+        static_cast<m_sPerSocketData *>(pc_ws->getUserData());
+      if (!psData->m_bPaused) {
+        return;
+      }
+
+      std::vector<std::string> vecBroadcastTopics;
+      for (const auto &strTopic : psData->m_vecTopics) {
+        if (IsBroadcastTopic(strTopic)) {
+          vecBroadcastTopics.push_back(strTopic);
+        }
+      }
+      psData->m_bPaused = false;
+      SubscribeTopics<SSL>(pc_ws, vecBroadcastTopics);
+    }
+
+    /****************************************/
+    /****************************************/
+
+    template <bool SSL>
+    void CWebServer::HandleHistory(
+      uWS::WebSocket<SSL, true> *pc_ws, const nlohmann::json &c_json_command) {
+      m_sPerSocketData *psData =
+        static_cast<m_sPerSocketData *>(pc_ws->getUserData());
+      const std::string strCmd = c_json_command["command"];
+
+      nlohmann::json cReply;
+      cReply["type"] = "history";
+
+      uint64_t unFirst, unLast;
+      if (!m_pcFrameHistory || !m_pcFrameHistory->GetRange(unFirst, unLast)) {
+        cReply["error"] = m_pcFrameHistory ? "The history is empty"
+                                           : "No history configured";
+        pc_ws->send(cReply.dump(), uWS::OpCode::TEXT);
+        return;
+      }
+      cReply["first_step"] = unFirst;
+      cReply["last_step"] = unLast;
+
+      if (strCmd == "rewind") {
+        /* Frame a number of steps before the latest one, live broadcasts
+         * are paused so they do not replace it, until "live" */
+        uint64_t unSteps = 0;
+        if (
+          c_json_command.contains("steps") &&
+          c_json_command["steps"].is_number_unsigned()) {
+          unSteps = c_json_command["steps"].get<uint64_t>();
+        }
+        uint64_t unStep = unSteps < unLast - unFirst ? unLast - unSteps
+                                                     : unFirst;
+
+        nlohmann::json cFrame;
+        if (!m_pcFrameHistory->GetFrame(unStep, cFrame)) {
+          cReply["error"] = "Step " + std::to_string(unStep) + " not found";
+          pc_ws->send(cReply.dump(), uWS::OpCode::TEXT);
+          return;
+        }
+
+        psData->m_pcPlayback.reset();
+        PauseBroadcasts<SSL>(pc_ws);
+
+        cReply["mode"] = "rewind";
+        cReply["step"] = unStep;
+        pc_ws->send(cReply.dump(), uWS::OpCode::TEXT);
+        pc_ws->send(cFrame.dump(), uWS::OpCode::TEXT, true);  // Compress
+        return;
+      }
+
+      /* Range of frames, the whole history by default. Live broadcasts go
+       * on, so a client joining late can fill in the recent past */
+      uint64_t unFrom = unFirst;
+      uint64_t unTo = unLast;
+      if (
+        c_json_command.contains("from") &&
+        c_json_command["from"].is_number_unsigned()) {
+        unFrom = c_json_command["from"].get<uint64_t>();
+      }
+      if (
+        c_json_command.contains("to") &&
+        c_json_command["to"].is_number_unsigned()) {
+        unTo = c_json_command["to"].get<uint64_t>();
+      }
+
+      /* Only the oldest frames fit, the client asks again for the rest */
+      nlohmann::json cFrames =
+        m_pcFrameHistory->GetFrames(unFrom, unTo, MAX_HISTORY_FRAMES + 1);
+      cReply["truncated"] = cFrames.size() > MAX_HISTORY_FRAMES;
+      if (cFrames.size() > MAX_HISTORY_FRAMES) {
+        cFrames.erase(MAX_HISTORY_FRAMES);
+      }
+      cReply["from"] = unFrom;
+      cReply["to"] = unTo;
+      cReply["frames"] = std::move(cFrames);
+      pc_ws->send(cReply.dump(), uWS::OpCode::TEXT, true);  // Compress
+    }
+
+    /****************************************/
+    /****************************************/
+
+    void CWebServer::Publish(
+      const std::string &str_topic, std::string str_message, bool b_keep) {
+      std::lock_guard<std::mutex> guard(m_mutex4TopicMessages);
+      m_queTopicMessages.push({str_topic, std::move(str_message), b_keep});
+    }
+
+    /****************************************/
+    /****************************************/
+
+    bool CWebServer::HasSubscribers(const std::string &str_topic) const {
+      return m_cTopicSubscriptions.GetSubscribers(str_topic) > 0;
+    }
+
+    /****************************************/
+    /****************************************/
+
+    void CWebServer::SetTrailBuffers(const CTrailBuffers *pc_trails) {
+      m_pcTrails = pc_trails;
+    }
+
+    /****************************************/
+    /****************************************/
+
+    template <bool SSL>
+    void CWebServer::HandleTrails(
+      uWS::WebSocket<SSL, true> *pc_ws, const nlohmann::json &c_json_command) {
+      nlohmann::json cReply;
+      cReply["type"] = "trails";
+
+      if (!m_pcTrails) {
+        cReply["error"] = "No trails configured";
+        pc_ws->send(cReply.dump(), uWS::OpCode::TEXT);
+        return;
+      }
+
+      /* All the entities and the whole trails by default */
+      std::vector<std::string> vecIds;
+      if (c_json_command.contains("ids") && c_json_command["ids"].is_array()) {
+        for (const auto &cId : c_json_command["ids"]) {
+          if (cId.is_string()) {
+            vecIds.push_back(cId.get<std::string>());
+          }
+        }
+      }
+
+      uint64_t unFrom = 0;
+      uint64_t unTo = std::numeric_limits<uint64_t>::max();
+      if (
+        c_json_command.contains("from") &&
+        c_json_command["from"].is_number_unsigned()) {
+        unFrom = c_json_command["from"].get<uint64_t>();
+      }
+      if (
+        c_json_command.contains("to") &&
+        c_json_command["to"].is_number_unsigned()) {
+        unTo = c_json_command["to"].get<uint64_t>();
+      }
+
+      cReply["trails"] = m_pcTrails->GetTrails(vecIds, unFrom, unTo);
+      pc_ws->send(cReply.dump(), uWS::OpCode::TEXT, true);  // Compress
+    }
+
+    /****************************************/
+    /****************************************/
+
+    template <bool SSL>
+    void CWebServer::HandleEntityDetail(
+      uWS::WebSocket<SSL, true> *pc_ws, const nlohmann::json &c_json_command) {
+      nlohmann::json cReply;
+      cReply["type"] = "entity";
+
+      /* The entity is given by its id, or by its handle */
+      std::string strId;
+      if (c_json_command.contains("id") && c_json_command["id"].is_string()) {
+        strId = c_json_command["id"];
+      } else if (
+        c_json_command.contains("id") &&
+        c_json_command["id"].is_number_integer()) {
+        if (!m_cEntityHandles.Resolve(
+              c_json_command["id"].get<int64_t>(), strId)) {
+          cReply["id"] = c_json_command["id"];
+          cReply["error"] = "No entity found with this handle";
+          pc_ws->send(cReply.dump(), uWS::OpCode::TEXT);
+          return;
+        }
+      } else {
+        cReply["error"] = "Missing entity \"id\"";
+        pc_ws->send(cReply.dump(), uWS::OpCode::TEXT);
+        return;
+      }
+      cReply["id"] = c_json_command["id"];
+
+      if (!m_pcEntityDetails) {
+        cReply["error"] = "Entity detail is not enabled";
+        pc_ws->send(cReply.dump(), uWS::OpCode::TEXT);
+        return;
+      }
+
+      /* Replied from the loop thread, if the client is still there */
+      m_sPerSocketData *psData =
+        static_cast<m_sPerSocketData *>(pc_ws->getUserData());
+      std::shared_ptr<bool> pcOpen = psData->m_pcOpen;
+      struct uWS::Loop *pcLoop = uWS::Loop::get();
+
+      bool bAdded = m_pcEntityDetails->Add(
+        strId,
+        [pc_ws, pcOpen, pcLoop, cReply](const nlohmann::json &c_detail) {
+          nlohmann::json cFullReply = cReply;
+          if (c_detail.is_null()) {
+            cFullReply["error"] = "No entity found";
+          } else {
+            cFullReply["entity"] = c_detail;
+          }
+          std::string strReply = cFullReply.dump();
+          pcLoop->defer([pc_ws, pcOpen, strReply]() {
+            if (*pcOpen) {
+              pc_ws->send(strReply, uWS::OpCode::TEXT, true);  // Compress
+            }
+          });
+        });
+
+      if (!bAdded) {
+        cReply["error"] = "Too many pending requests";
+        pc_ws->send(cReply.dump(), uWS::OpCode::TEXT);
+        return;
+      }
+
+      /* Served right away if the simulation is idle */
+      m_pcMyWebviz->RequestBroadcast();
+    }
+
+    /****************************************/
+    /****************************************/
+
+    template <bool SSL>
+    void CWebServer::SendEntityDetail(
+      uWS::HttpResponse<SSL> *pc_res, const std::string &str_id) {
+      if (!m_pcEntityDetails) {
+        SendJSONError<SSL>(
+          pc_res, {{"error", "Entity detail is not enabled"}}, "404 Not Found");
+        return;
+      }
+
+      /* The response must not be used once aborted */
+      auto pcAborted = std::make_shared<bool>(false);
+      pc_res->onAborted([pcAborted]() { *pcAborted = true; });
+
+      struct uWS::Loop *pcLoop = uWS::Loop::get();
+      bool bAdded = m_pcEntityDetails->Add(
+        str_id,
+        [this, pc_res, pcAborted, pcLoop, str_id](
+          const nlohmann::json &c_detail) {
+          pcLoop->defer([this, pc_res, pcAborted, str_id, c_detail]() {
+            if (*pcAborted) {
+              return;
+            } else if (c_detail.is_null()) {
+              SendJSONError<SSL>(
+                pc_res,
+                {{"error", "No entity found with id: " + str_id}},
+                "404 Not Found");
+            } else {
+              SendJSON<SSL>(pc_res, c_detail);
+            }
+          });
+        });
+
+      if (!bAdded) {
+        SendJSONError<SSL>(
+          pc_res,
+          {{"error", "Too many pending requests"}},
+          "503 Service Unavailable");
+        return;
+      }
+      m_pcMyWebviz->RequestBroadcast();
+    }
+
+    /****************************************/
+    /****************************************/
+
+    nlohmann::json CWebServer::Configure(const nlohmann::json &c_json_command) {
+      nlohmann::json cReply;
+      cReply["type"] = "configure";
+
+      /* Without "settings", only returns the current ones */
+      if (c_json_command.contains("settings")) {
+        const std::string strError =
+          m_cSettings.Update(c_json_command["settings"]);
+        if (!strError.empty()) {
+          cReply["error"] = strError;
+        } else {
+          LOG << "[INFO] Broadcast settings changed: "
+              << c_json_command["settings"].dump() << '\n';
+        }
+      }
+
+      cReply["settings"] = m_cSettings.ToJSON();
+      return cReply;
+    }
+
+    /****************************************/
+    /****************************************/
+
+    nlohmann::json CWebServer::SpawnEntities(
+      const nlohmann::json &c_json_command) {
+      nlohmann::json cReply;
+      cReply["type"] = "spawnEntities";
+
+      if (!m_pcSpawnRequests) {
+        cReply["error"] = "Spawning entities is not enabled";
+        return cReply;
+      }
+
+      SSpawnRequest sRequest;
+      const std::string strError = sRequest.FromJSON(c_json_command);
+      if (!strError.empty()) {
+        cReply["error"] = strError;
+        return cReply;
+      }
+      cReply["entity_type"] = sRequest.Type;
+      cReply["count"] = sRequest.Count;
+
+      if (!m_pcSpawnRequests->Add(std::move(sRequest))) {
+        cReply["error"] = "Too many pending requests";
+        return cReply;
+      }
+      cReply["queued"] = true;
+
+      /* Served right away if the simulation is idle */
+      m_pcMyWebviz->RequestBroadcast();
+      return cReply;
+    }
+
+    /****************************************/
+    /****************************************/
+
+    void CWebServer::SetEntityDetailRequests(
+      CEntityDetailRequests *pc_requests) {
+      m_pcEntityDetails = pc_requests;
+    }
+
+    /****************************************/
+    /****************************************/
+
+    void CWebServer::SetSpawnRequests(CSpawnRequests *pc_requests) {
+      m_pcSpawnRequests = pc_requests;
+    }
+
+    /****************************************/
+    /****************************************/
+
+    void CWebServer::SetExportSchema(const std::string &str_schema) {
+      m_strExportSchema = str_schema;
+    }
+
+    /****************************************/
+    /****************************************/
+
+    void CWebServer::PublishExportBatch(
+      std::shared_ptr<const std::string> pc_batch) {
+      std::lock_guard<std::mutex> guard(m_mutex4ExportBatches);
+      m_queExportBatches.push(std::move(pc_batch));
+    }
+
+    /****************************************/
+    /****************************************/
+
+    void CWebServer::SetEntityGroups(
+      const std::vector<SEntityGroup> &vec_groups) {
+      m_vecEntityGroups = vec_groups;
+    }
+
+    /****************************************/
+    /****************************************/
+
+    CBroadcastFilter CWebServer::GetBroadcastFilter() const {
+      return CBroadcastFilter(
+        m_cTopicSubscriptions.GetSnapshot(), m_vecEntityGroups);
+    }
+
+    /****************************************/
+    /****************************************/
+
+    template <bool SSL>
+    void CWebServer::HandlePing(
+      uWS::WebSocket<SSL, true> *pc_ws, const nlohmann::json &c_json_command) {
+      int64_t nNow = GetMonotonicMicros();
+
+      nlohmann::json cPong;
+      cPong["type"] = "pong";
+      cPong["received"] = nNow;
+
+      /* Clients echo back the "stamps" and "published" of a broadcast */
+      if (c_json_command.contains("stamps")) {
+        const nlohmann::json &cStamps = c_json_command["stamps"];
+        cPong["stamps"] = cStamps;
+
+        if (cStamps.contains("step") && cStamps["step"].is_number()) {
+          m_cStepToClientLatency.Record(nNow - cStamps["step"].get<int64_t>());
+        }
+      }
+
+      if (
+        c_json_command.contains("published") &&
+        c_json_command["published"].is_number()) {
+        cPong["published"] = c_json_command["published"];
+        m_cPublishToClientLatency.Record(
+          nNow - c_json_command["published"].get<int64_t>());
+      }
+
+      pc_ws->send(cPong.dump(), uWS::OpCode::TEXT);
+    }
+
+    /****************************************/
+    /****************************************/
+
+    nlohmann::json CWebServer::GetLatencyJSON() const {
+      nlohmann::json cJson;
+
+      auto fnHistogramToJSON = [](const CLatencyHistogram &c_histogram) {
+        nlohmann::json cHistogramJson;
+        cHistogramJson["count"] = c_histogram.GetCount();
+        cHistogramJson["p50"] = c_histogram.GetPercentile(50);
+        cHistogramJson["p90"] = c_histogram.GetPercentile(90);
+        cHistogramJson["p99"] = c_histogram.GetPercentile(99);
+        cHistogramJson["max"] = c_histogram.GetMax();
+        return cHistogramJson;
+      };
+
+      /* All values in microseconds, measured at the time the echo arrives */
+      cJson["step_to_client"] = fnHistogramToJSON(m_cStepToClientLatency);
+      cJson["publish_to_client"] = fnHistogramToJSON(m_cPublishToClientLatency);
+
+      return cJson;
+    }
+
+    /****************************************/
+    /****************************************/
+
+    template <bool SSL>
+    void CWebServer::SendJSON(
+      uWS::HttpResponse<SSL> *pc_res, nlohmann::json c_json) {
+      pc_res->cork([pc_res, &c_json]() {
+        pc_res->writeHeader("Content-Type", "application/json")
+          ->writeHeader("Access-Control-Allow-Origin", "*")
+          ->end(c_json.dump());
+      });
+    }
+
+    /****************************************/
+    /****************************************/
+
+    template <bool SSL>
+    void CWebServer::SendJSONError(
+      uWS::HttpResponse<SSL> *pc_res,
+      nlohmann::json c_json,
+      std::string str_status) {
+      pc_res->cork([pc_res, &c_json, &str_status]() {
+        pc_res->writeStatus(str_status)
+          ->writeHeader("Content-Type", "application/json")
+          ->writeHeader("Access-Control-Allow-Origin", "*")
+          ->end(c_json.dump());
+      });
     }
   }  // namespace Webviz
 }  // namespace argos
\ No newline at end of file
@@ -22,7 +22,13 @@ namespace argos {
   }  // namespace Webviz
 }  // namespace argos
 
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <functional>
 #include <future>
+#include <map>
+#include <memory>
 #include <mutex>
 #include <nlohmann/json.hpp>
 #include <queue>
@@ -30,8 +36,20 @@ namespace argos {
 
 #include "App.h"  // uWebSockets
 #include "config.h"
+#include "utility/BroadcastFragments.h"
+#include "utility/BroadcastSettings.h"
+#include "utility/BroadcastTopics.h"
 #include "utility/CTimer.h"
 #include "utility/EExperimentState.h"
+#include "utility/EntityDetails.h"
+#include "utility/EntityHandles.h"
+#include "utility/FrameHistory.h"
+#include "utility/FrameRecording.h"
+#include "utility/LEDChanges.h"
+#include "utility/LatencyHistogram.h"
+#include "utility/RayEncoding.h"
+#include "utility/SpawnRequests.h"
+#include "utility/TrailBuffer.h"
 #include "webviz.h"
 
 namespace argos {
@@ -76,8 +94,137 @@ namespace argos {
        */
       void EmitLog(const std::string& log_type, const std::string& message);
 
-      /** Broadcasts JSON to all the connected clients */
-      void Broadcast(nlohmann::json);
+      /**
+       * @brief Broadcasts JSON to all the connected clients
+       *
+       * The JSON is only serialized in the broadcaster thread, so frames
+       * replaced before the next broadcast cycle are never dumped.
+       * Entities reused from the fragment caches come aside, with null at
+       * their place in the frame, and are spliced in as serialized before.
+       */
+      void Broadcast(nlohmann::json, TSharedFragments vec_shared = {});
+
+      /**
+       * @brief Publishes a message on a topic in the next broadcast cycle,
+       * e.g. for the server-side aggregates
+       *
+       * @param str_topic topic to publish on
+       * @param str_message serialized message
+       * @param b_keep true if the message is also sent to the clients
+       * subscribing later, until the next message of the topic
+       */
+      void Publish(
+        const std::string& str_topic,
+        std::string str_message,
+        bool b_keep = false);
+
+      /**
+       * @brief Returns true if at least one client subscribed to the topic,
+       * so messages nobody receives are not even built
+       */
+      bool HasSubscribers(const std::string& str_topic) const;
+
+      /**
+       * @brief Returns the settings of the broadcasts, which clients can
+       * change at any time with the "configure" command
+       */
+      CBroadcastSettings& GetBroadcastSettings() { return m_cSettings; }
+
+      /**
+       * @brief Handles the "configure" command (WebSocket or HTTP), which
+       * validates and applies new broadcast settings
+       *
+       * @param c_json_command JSON object with the optional "settings"
+       * @return nlohmann::json reply, with the current settings and an
+       * "error" if the new ones were rejected
+       */
+      nlohmann::json Configure(const nlohmann::json& c_json_command);
+
+      /**
+       * @brief Handles the "spawnEntities" command, which queues entities to
+       * add in one batch at the next frame of the simulation
+       *
+       * @param c_json_command JSON object with the spawn request
+       * @return nlohmann::json reply, with "queued" or an "error"
+       */
+      nlohmann::json SpawnEntities(const nlohmann::json& c_json_command);
+
+      /**
+       * @brief Sets the user-defined groups of entities, published on the
+       * "broadcasts/groups/<name>" topics. Must be called before Start()
+       *
+       * @param vec_groups groups parsed from the configuration file
+       */
+      void SetEntityGroups(const std::vector<SEntityGroup>& vec_groups);
+
+      /**
+       * @brief Returns which entities are requested by the connected clients,
+       * based on the broadcast topics they subscribed to
+       *
+       * @return CBroadcastFilter snapshot of the subscriptions
+       */
+      CBroadcastFilter GetBroadcastFilter() const;
+
+      /**
+       * @brief Sets the recording clients can switch to with the "playback"
+       * command. Must be called before Start()
+       *
+       * @param str_file path of the recording, empty to disable playback
+       */
+      void SetRecordingFile(const std::string& str_file);
+
+      /**
+       * @brief Sets the in-memory history served with the "rewind" and
+       * "history" commands. Must be called before Start()
+       *
+       * @param pc_history history filled by the simulation, owned by the
+       * caller, nullptr to disable the commands
+       */
+      void SetFrameHistory(const CFrameHistory* pc_history);
+
+      /**
+       * @brief Sets the trails served with the "trails" command. Must be
+       * called before Start()
+       *
+       * @param pc_trails trails filled by the simulation, owned by the
+       * caller, nullptr to disable the command
+       */
+      void SetTrailBuffers(const CTrailBuffers* pc_trails);
+
+      /**
+       * @brief Enables the "entity" command and the "/entity/..." endpoints,
+       * which return the full detail of one entity. Must be called before
+       * Start()
+       *
+       * @param pc_requests requests served by the simulation, owned by the
+       * caller, nullptr to disable them
+       */
+      void SetEntityDetailRequests(CEntityDetailRequests* pc_requests);
+
+      /**
+       * @brief Enables the "spawnEntities" command. Must be called before
+       * Start()
+       *
+       * @param pc_requests requests served by the simulation, owned by the
+       * caller, nullptr to disable them
+       */
+      void SetSpawnRequests(CSpawnRequests* pc_requests);
+
+      /**
+       * @brief Enables the "/export" endpoint, streaming the trajectories as
+       * Arrow IPC. Must be called before Start()
+       *
+       * @param str_schema schema message, sent first to each HTTP client
+       */
+      void SetExportSchema(const std::string& str_schema);
+
+      /**
+       * @brief Sends an Arrow record batch message to the clients of the
+       * "/export" endpoint, in the next broadcast cycle
+       *
+       * @param pc_batch encoded record batch
+       */
+      void PublishExportBatch(std::shared_ptr<const std::string> pc_batch);
 
      private:
       /** Reference to CWebviz object to call function over it */
@@ -89,11 +236,99 @@ namespace argos {
       /** broadcast cycle timer */
       CTimer m_cBroadcastTimer;
 
-      /** max time for one broadcast cycle */
-      std::chrono::milliseconds m_cBroadcastDuration;
+      /** Broadcast rate, compression and detail, changed at runtime with
+       * the "configure" command */
+      CBroadcastSettings m_cSettings;
+
+      /** mutexed JSON using m_mutex4BroadcastJSON to broadcast */
+      nlohmann::json m_cBroadcastJSON;
+
+      /** Entities of m_cBroadcastJSON reused from the fragment caches */
+      TSharedFragments m_vecBroadcastFragments;
+
+      /** True if m_cBroadcastJSON was not yet picked by the broadcaster */
+      bool m_bHasNewBroadcast;
+
+      /** Latency from the step to the client echoing a frame with "ping" */
+      CLatencyHistogram m_cStepToClientLatency;
+
+      /** Latency from publishing to the client echoing a frame with "ping" */
+      CLatencyHistogram m_cPublishToClientLatency;
+
+      /** Live subscribers of each topic */
+      CTopicSubscriptions m_cTopicSubscriptions;
+
+      /** User-defined groups of entities, read-only once started */
+      std::vector<SEntityGroup> m_vecEntityGroups;
+
+      /** Recording available for playback, read-only once started */
+      std::string m_strRecordingFile;
+
+      /** Reads of the recording waiting for the playback thread */
+      std::deque<std::function<void()>> m_deqPlaybackJobs;
+
+      /** Mutex to protect access to m_deqPlaybackJobs */
+      std::mutex m_mutex4PlaybackJobs;
+
+      /** Notified when a job is added to m_deqPlaybackJobs */
+      std::condition_variable m_cPlaybackJobAdded;
+
+      /** Maximum number of reads waiting, further commands are refused */
+      static constexpr size_t MAX_PLAYBACK_JOBS = 64;
+
+      /** In-memory history of the recent frames, nullptr if disabled */
+      const CFrameHistory* m_pcFrameHistory;
+
+      /** Trails of the entities, nullptr if disabled */
+      const CTrailBuffers* m_pcTrails;
+
+      /** Requests for the detail of single entities, nullptr if disabled */
+      CEntityDetailRequests* m_pcEntityDetails;
 
-      /** mutexed string using m_mutex4BroadcastString to broadcast */
-      std::string m_strBroadcastString;
+      /** Entities to spawn, nullptr if disabled */
+      CSpawnRequests* m_pcSpawnRequests;
+
+      /** Handles of the manifest last received with a frame, the ones the
+       * clients know, used by the broadcaster and loop threads */
+      CEntityHandles m_cEntityHandles;
+
+      /** LED colors sent last, to leave the unchanged ones out */
+      CLEDChanges m_cLEDChanges;
+
+      /** Entities as last sent, reused while they do not change */
+      CBroadcastFragments m_cBroadcastFragments;
+
+      /** Maximum number of frames in one reply to the "history" command */
+      static constexpr size_t MAX_HISTORY_FRAMES = 500;
+
+      /** Schema of the "/export" stream, empty if export is disabled */
+      std::string m_strExportSchema;
+
+      /** Bytes buffered for an "/export" client before it is dropped, as
+       * the maxBackpressure of the WebSocket clients */
+      static constexpr size_t MAX_EXPORT_BUFFERED = 100 * 1024 * 1024;
+
+      /** Arrow record batches waiting to be sent to the "/export" clients */
+      std::queue<std::shared_ptr<const std::string>> m_queExportBatches;
+
+      /** Mutex to protect access to m_queExportBatches */
+      std::mutex m_mutex4ExportBatches;
+
+      /** Message of a topic other than the broadcasts */
+      struct STopicMessage {
+        std::string Topic;
+
+        std::string Message;
+
+        /** True if kept for the clients subscribing later */
+        bool Keep;
+      };
+
+      /** Messages of the other topics */
+      std::queue<STopicMessage> m_queTopicMessages;
+
+      /** Mutex to protect access to m_queTopicMessages */
+      std::mutex m_mutex4TopicMessages;
 
       /** A Queue to push events to client */
       std::queue<std::string> m_cEventQueue;
@@ -101,6 +336,19 @@ namespace argos {
       /** A Queue to push logs to client */
       std::queue<nlohmann::json> m_cLogQueue;
 
+      /** Messages published in one broadcast cycle, as (topic, message) */
+      typedef std::vector<
+        std::pair<std::string, std::shared_ptr<const std::string>>>
+        TTopicMessages;
+
+      /** Latest frame published on each broadcast topic, and kept messages
+       * of the other topics, sent to the clients as soon as they connect */
+      std::map<std::string, std::shared_ptr<const std::string>>
+        m_mapCachedFrames;
+
+      /** Mutex to protect access to m_mapCachedFrames */
+      std::mutex m_mutex4CachedFrames;
+
       /** Struct to hold websocket with its loop thread */
       template <bool SSL>
       struct SWebSocketClient {
@@ -108,8 +356,8 @@ namespace argos {
         struct uWS::Loop* m_pcLoop;
       };
 
-      /** Mutex to protect access to m_mutex4BroadcastString */
-      std::mutex m_mutex4BroadcastString;
+      /** Mutex to protect access to m_cBroadcastJSON */
+      std::mutex m_mutex4BroadcastJSON;
 
       /** Mutex to protect access to m_cEventQueue */
       std::mutex m_mutex4EventQueue;
@@ -125,7 +373,24 @@ namespace argos {
       std::string m_strPassphrase;
 
       /** Data attached to each socket, ws->getUserData returns one of these */
-      struct m_sPerSocketData {};
+      struct m_sPerSocketData {
+        /** Topics subscribed on open, to count them down on close */
+        std::vector<std::string> m_vecTopics;
+
+        /** Recording being played back, if any */
+        std::shared_ptr<CFrameRecordReader> m_pcPlayback;
+
+        /** True while the live broadcasts are paused, in playback or after a
+         * rewind, until the "live" command */
+        bool m_bPaused = false;
+
+        /** False once closed, checked by the replies sent later */
+        std::shared_ptr<bool> m_pcOpen;
+
+        /** Number of the latest "playback" or "seek" command, the older ones
+         * still waiting for the playback thread are skipped */
+        std::shared_ptr<std::atomic<uint64_t>> m_pcPlaybackRequest;
+      };
 
       /**
        * @brief Function to run server depending on SSL
@@ -136,6 +401,119 @@ namespace argos {
       template <bool SSL>
       void RunServer(std::atomic<bool>& b_IsServerRunning);
 
+      /**
+       * @brief Handles the "ping" command, which echoes back the stamps of
+       * a received broadcast to measure end-to-end latency
+       *
+       * @param pc_ws WebSocket of the client which sent the ping
+       * @param c_json_command JSON object from client
+       */
+      template <bool SSL>
+      void HandlePing(
+        uWS::WebSocket<SSL, true>* pc_ws,
+        const nlohmann::json& c_json_command);
+
+      /**
+       * @brief Subscribes the client to the topics, and sends it the latest
+       * frames of the broadcast topics
+       *
+       * @param pc_ws WebSocket of the client
+       * @param vec_topics topics to subscribe to
+       */
+      template <bool SSL>
+      void SubscribeTopics(
+        uWS::WebSocket<SSL, true>* pc_ws,
+        const std::vector<std::string>& vec_topics);
+
+      /**
+       * @brief Counts down the subscribers of the topics, the socket must be
+       * unsubscribed by the caller (or closing)
+       *
+       * @param vec_topics topics the client is not subscribed to anymore
+       */
+      void ReleaseTopics(const std::vector<std::string>& vec_topics);
+
+      /**
+       * @brief Handles the "playback", "seek" and "live" commands, which
+       * switch one client between the live broadcasts and the recording
+       *
+       * @param pc_ws WebSocket of the client which sent the command
+       * @param c_json_command JSON object from client
+       */
+      template <bool SSL>
+      void HandlePlayback(
+        uWS::WebSocket<SSL, true>* pc_ws,
+        const nlohmann::json& c_json_command);
+
+      /**
+       * @brief Unsubscribes the client from its broadcast topics, until the
+       * "live" command. Does nothing if already paused
+       *
+       * @param pc_ws WebSocket of the client
+       */
+      template <bool SSL>
+      void PauseBroadcasts(uWS::WebSocket<SSL, true>* pc_ws);
+
+      /**
+       * @brief Subscribes the client to its broadcast topics again, after
+       * PauseBroadcasts(). Does nothing if not paused
+       *
+       * @param pc_ws WebSocket of the client
+       */
+      template <bool SSL>
+      void ResumeBroadcasts(uWS::WebSocket<SSL, true>* pc_ws);
+
+      /**
+       * @brief Handles the "rewind" and "history" commands, served from the
+       * in-memory history of the recent frames
+       *
+       * @param pc_ws WebSocket of the client which sent the command
+       * @param c_json_command JSON object from client
+       */
+      template <bool SSL>
+      void HandleHistory(
+        uWS::WebSocket<SSL, true>* pc_ws,
+        const nlohmann::json& c_json_command);
+
+      /**
+       * @brief Handles the "trails" command, which returns the trails of a
+       * set of entities within a time window
+       *
+       * @param pc_ws WebSocket of the client which sent the command
+       * @param c_json_command JSON object from client
+       */
+      template <bool SSL>
+      void HandleTrails(
+        uWS::WebSocket<SSL, true>* pc_ws,
+        const nlohmann::json& c_json_command);
+
+      /**
+       * @brief Handles the "entity" command, which returns the full detail
+       * of one entity (by id or handle), built by the simulation at its
+       * next frame
+       *
+       * @param pc_ws WebSocket of the client which sent the command
+       * @param c_json_command JSON object from client
+       */
+      template <bool SSL>
+      void HandleEntityDetail(
+        uWS::WebSocket<SSL, true>* pc_ws,
+        const nlohmann::json& c_json_command);
+
+      /**
+       * @brief Sends the full detail of one entity over HttpResponse, once
+       * built by the simulation at its next frame
+       *
+       * @param pc_res response of the "/entity" endpoints
+       * @param str_id id of the entity
+       */
+      template <bool SSL>
+      void SendEntityDetail(
+        uWS::HttpResponse<SSL>* pc_res, const std::string& str_id);
+
+      /** Returns latency histograms as JSON */
+      nlohmann::json GetLatencyJSON() const;
+
       /** Function to send JSON over HttpResponse */
       template <bool SSL>
       void SendJSON(uWS::HttpResponse<SSL>*, nlohmann::json);
@@ -79,19 +79,26 @@ void CFootBotDiffusion::ControlStep() {
    * is far enough, continue going straight, otherwise curve a little
    */
   CRadians cAngle = cAccumulator.Angle();
-  if (
+  Real fLeftSpeed = m_fWheelVelocity;
+  Real fRightSpeed = m_fWheelVelocity;
+  const bool bStraight =
     m_cGoStraightAngleRange.WithinMinBoundIncludedMaxBoundIncluded(cAngle) &&
-    cAccumulator.Length() < m_fDelta) {
-    /* Go straight */
-    m_pcWheels->SetLinearVelocity(m_fWheelVelocity, m_fWheelVelocity);
-  } else {
+    cAccumulator.Length() < m_fDelta;
+  if (!bStraight) {
     /* Turn, depending on the sign of the angle */
     if (cAngle.GetValue() > 0.0f) {
-      m_pcWheels->SetLinearVelocity(m_fWheelVelocity, 0.0f);
+      fRightSpeed = 0.0f;
     } else {
-      m_pcWheels->SetLinearVelocity(0.0f, m_fWheelVelocity);
+      fLeftSpeed = 0.0f;
     }
   }
+  m_pcWheels->SetLinearVelocity(fLeftSpeed, fRightSpeed);
+
+  /* Shown by webviz with the robot, no allocation nor lock */
+  m_cDebugSlot.Set("turning", bStraight ? 0.0 : 1.0);
+  m_cDebugSlot.Set("obstacle_proximity", cAccumulator.Length());
+  m_cDebugSlot.Set("left_speed", fLeftSpeed);
+  m_cDebugSlot.Set("right_speed", fRightSpeed);
 }
 
 /****************************************/
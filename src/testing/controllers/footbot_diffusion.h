@@ -31,6 +31,8 @@
 #include <argos3/plugins/robots/generic/control_interface/ci_differential_steering_actuator.h>
 /* Definition of the foot-bot proximity sensor */
 #include <argos3/plugins/robots/foot-bot/control_interface/ci_footbot_proximity_sensor.h>
+/* Debug values shown by webviz */
+#include <argos3/plugins/simulator/visualizations/webviz/utility/DebugSlot.h>
 
 /*
  * All the ARGoS stuff in the 'argos' namespace.
@@ -40,8 +42,10 @@ using namespace argos;
 
 /*
  * A controller is simply an implementation of the CCI_Controller class.
+ * It also owns a webviz debug slot, to show its internal state.
  */
-class CFootBotDiffusion : public CCI_Controller {
+class CFootBotDiffusion : public CCI_Controller,
+                          public Webviz::CDebugSlotOwner {
  public:
   /* Class constructor. */
   CFootBotDiffusion();
@@ -66,11 +70,9 @@ class CFootBotDiffusion : public CCI_Controller {
    * This function resets the controller to its state right after the
    * Init().
    * It is called when you press the reset button in the GUI.
-   * In this example controller there is no need for resetting anything,
-   * so the function could have been omitted. It's here just for
-   * completeness.
+   * The debug values of the previous run are forgotten.
    */
-  virtual void Reset() {}
+  virtual void Reset() { m_cDebugSlot.Clear(); }
 
   /*
    * Called to cleanup what done by Init() when the experiment finishes.
@@ -0,0 +1,1164 @@
+/**
+ * @file <argos3/testing/loadgen/webviz_loadgen.cpp>
+ *
+ * @author Prajankya Sonar - <prajankya@gmail.com>
+ *
+ * @project ARGoS3-Webviz <https://github.com/NESTlab/argos3-webviz>
+ *
+ * MIT License
+ * Copyright (c) 2020 NEST Lab
+ *
+ * Standalone WebSocket load generator for ARGoS3-Webviz.
+ *
+ * Opens a large number of WebSocket connections to a (local) webviz server,
+ * subscribes them to the configured topics, parses every incoming frame and
+ * optionally sends synthetic "step" and "moveEntity" commands. At the end of
+ * the run it reports per-client receive rates, frame gaps and
+ * step-to-receive latency percentiles.
+ *
+ * Run with --help for the list of options.
+ */
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <nlohmann/json.hpp>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "plugins/simulator/visualizations/webviz/utility/base64.h"
+
+#ifdef WEBVIZ_LOADGEN_WITH_OPENSSL
+#include <openssl/err.h>
+#include <openssl/ssl.h>
+#endif
+
+namespace argos {
+  namespace Webviz {
+    namespace LoadGen {
+
+      typedef std::chrono::steady_clock TClock;
+
+      /****************************************/
+      /****************************************/
+
+      /** Monotonic time in microseconds */
+      inline int64_t NowMicros() {
+        return std::chrono::duration_cast<std::chrono::microseconds>(
+                 TClock::now().time_since_epoch())
+          .count();
+      }
+
+      /****************************************/
+      /****************************************/
+
+      /** All the options parsed from the command line */
+      struct SOptions {
+        std::string Host = "127.0.0.1";
+        unsigned short Port = 3000;
+        unsigned int Clients = 100;
+        unsigned int Threads = 1;
+        /* Connections opened per second (0 = all at once) */
+        unsigned int ConnectRate = 500;
+        /* Comma separated topics, empty means server defaults */
+        std::string Topics = "broadcasts";
+        bool UseSSL = false;
+        double Duration = 10.0;
+        /* Command rates (in Hz, for the whole run, not per client) */
+        double StepRate = 0.0;
+        double MoveRate = 0.0;
+        std::string MoveEntityId = "";
+        double MoveRadius = 1.0;
+        /* Interval between WebSocket pings sent by every client */
+        double KeepAlive = 5.0;
+        /* Parse each message completely with nlohmann::json */
+        bool FullParse = false;
+        bool PerClient = false;
+      };
+
+      /****************************************/
+      /****************************************/
+
+      /** Statistics collected for one client */
+      struct SClientStats {
+        uint64_t Messages = 0;
+        uint64_t Broadcasts = 0;
+        uint64_t Bytes = 0;
+        /* Largest time between two consecutive broadcasts */
+        int64_t MaxGapMicros = 0;
+        /* Number of times the "steps" counter jumped more than expected */
+        uint64_t StepJumps = 0;
+        int64_t FirstBroadcastMicros = 0;
+        int64_t LastBroadcastMicros = 0;
+        int64_t ConnectedMicros = 0;
+        int64_t LastStep = -1;
+        bool Connected = false;
+        bool Failed = false;
+        std::string Error;
+      };
+
+      /****************************************/
+      /****************************************/
+
+      /**
+       * @brief Probe shared between all the clients to measure
+       * step-to-receive latency.
+       *
+       * When a "step" command is sent, the send time and the last step seen
+       * are recorded. Every client then records one sample when it receives
+       * the first broadcast with a larger step counter.
+       */
+      struct SStepProbe {
+        std::atomic<uint64_t> Id{0};
+        std::atomic<int64_t> SentMicros{0};
+        std::atomic<int64_t> BaseStep{-1};
+      };
+
+      /****************************************/
+      /****************************************/
+
+      class CLoadGenClient {
+       public:
+        enum class EState {
+          DISCONNECTED = 0,
+          CONNECTING,
+          TLS_HANDSHAKE,
+          UPGRADING,
+          OPEN,
+          CLOSED
+        };
+
+        CLoadGenClient(unsigned int un_index, const SOptions& s_options)
+            : m_unIndex(un_index), m_sOptions(s_options) {}
+
+        ~CLoadGenClient() { Close(); }
+
+        /****************************************/
+        /****************************************/
+
+        bool Connect(
+          const sockaddr_in& s_addr, int n_epoll_fd
+#ifdef WEBVIZ_LOADGEN_WITH_OPENSSL
+          ,
+          SSL_CTX* pc_ssl_ctx
+#endif
+        ) {
+          m_nFd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
+          if (m_nFd < 0) {
+            return Fail("socket() failed: " + std::string(strerror(errno)));
+          }
+
+          int nEnable = 1;
+          setsockopt(m_nFd, IPPROTO_TCP, TCP_NODELAY, &nEnable, sizeof(int));
+
+          if (
+            connect(m_nFd, (const sockaddr*)&s_addr, sizeof(s_addr)) < 0 &&
+            errno != EINPROGRESS) {
+            return Fail("connect() failed: " + std::string(strerror(errno)));
+          }
+
+#ifdef WEBVIZ_LOADGEN_WITH_OPENSSL
+          if (m_sOptions.UseSSL) {
+            m_pcSSL = SSL_new(pc_ssl_ctx);
+            SSL_set_fd(m_pcSSL, m_nFd);
+            SSL_set_tlsext_host_name(m_pcSSL, m_sOptions.Host.c_str());
+          }
+#endif
+
+          m_eState = EState::CONNECTING;
+
+          epoll_event sEvent;
+          sEvent.events = EPOLLIN | EPOLLOUT;
+          sEvent.data.ptr = this;
+          if (epoll_ctl(n_epoll_fd, EPOLL_CTL_ADD, m_nFd, &sEvent) < 0) {
+            return Fail("epoll_ctl() failed: " + std::string(strerror(errno)));
+          }
+          m_nEpollFd = n_epoll_fd;
+          return true;
+        }
+
+        /****************************************/
+        /****************************************/
+
+        void OnEvent(uint32_t un_events, SStepProbe& s_probe) {
+          if (un_events & (EPOLLERR | EPOLLHUP)) {
+            int nError = 0;
+            socklen_t unLen = sizeof(nError);
+            getsockopt(m_nFd, SOL_SOCKET, SO_ERROR, &nError, &unLen);
+            Fail(
+              "socket error: " +
+              std::string(nError ? strerror(nError) : "hang up"));
+            return;
+          }
+
+          if (m_eState == EState::CONNECTING && (un_events & EPOLLOUT)) {
+            int nError = 0;
+            socklen_t unLen = sizeof(nError);
+            getsockopt(m_nFd, SOL_SOCKET, SO_ERROR, &nError, &unLen);
+            if (nError != 0) {
+              Fail("connect failed: " + std::string(strerror(nError)));
+              return;
+            }
+            m_eState = m_sOptions.UseSSL ? EState::TLS_HANDSHAKE
+                                         : EState::UPGRADING;
+            if (m_eState == EState::UPGRADING) {
+              SendUpgradeRequest();
+            }
+          }
+
+#ifdef WEBVIZ_LOADGEN_WITH_OPENSSL
+          if (m_eState == EState::TLS_HANDSHAKE) {
+            int nRet = SSL_connect(m_pcSSL);
+            if (nRet == 1) {
+              m_eState = EState::UPGRADING;
+              SendUpgradeRequest();
+            } else {
+              int nErr = SSL_get_error(m_pcSSL, nRet);
+              if (nErr != SSL_ERROR_WANT_READ && nErr != SSL_ERROR_WANT_WRITE) {
+                Fail("TLS handshake failed");
+              }
+              return;
+            }
+          }
+#endif
+
+          if (un_events & EPOLLOUT) {
+            FlushOutput();
+          }
+
+          if (un_events & EPOLLIN) {
+            ReadInput(s_probe);
+          }
+
+          UpdateEpollInterest();
+        }
+
+        /****************************************/
+        /****************************************/
+
+        /** Sends a text message, masked as required for clients */
+        void SendText(const std::string& str_payload) {
+          QueueFrame(0x1, str_payload);
+        }
+
+        /****************************************/
+        /****************************************/
+
+        void SendPing() { QueueFrame(0x9, ""); }
+
+        /****************************************/
+        /****************************************/
+
+        void Close() {
+          if (m_nFd >= 0) {
+#ifdef WEBVIZ_LOADGEN_WITH_OPENSSL
+            if (m_pcSSL != nullptr) {
+              SSL_free(m_pcSSL);
+              m_pcSSL = nullptr;
+            }
+#endif
+            close(m_nFd);
+            m_nFd = -1;
+          }
+          if (m_eState != EState::DISCONNECTED) {
+            m_eState = EState::CLOSED;
+          }
+          m_sStats.Connected = false;
+        }
+
+        /****************************************/
+        /****************************************/
+
+        bool IsOpen() const { return m_eState == EState::OPEN; }
+
+        const SClientStats& GetStats() const { return m_sStats; }
+
+        std::vector<int64_t>& GetLatencySamples() { return m_vecLatencies; }
+
+        int64_t GetLastStep() const { return m_sStats.LastStep; }
+
+        unsigned int GetIndex() const { return m_unIndex; }
+
+       private:
+        /****************************************/
+        /****************************************/
+
+        bool Fail(const std::string& str_error) {
+          if (!m_sStats.Failed) {
+            m_sStats.Failed = true;
+            m_sStats.Error = str_error;
+          }
+          Close();
+          return false;
+        }
+
+        /****************************************/
+        /****************************************/
+
+        void SendUpgradeRequest() {
+          /* Random 16 bytes key, as required by RFC 6455 */
+          std::string strKey(16, '\0');
+          for (auto& c : strKey) {
+            c = static_cast<char>(m_cRandom() & 0xff);
+          }
+          std::string strEncodedKey;
+          Base64::Encode(strKey, &strEncodedKey);
+
+          std::stringstream strRequest;
+          strRequest << "GET /";
+          if (!m_sOptions.Topics.empty()) {
+            strRequest << "?" << m_sOptions.Topics;
+          }
+          strRequest << " HTTP/1.1\r\n"
+                     << "Host: " << m_sOptions.Host << ":" << m_sOptions.Port
+                     << "\r\n"
+                     << "Upgrade: websocket\r\n"
+                     << "Connection: Upgrade\r\n"
+                     << "Sec-WebSocket-Key: " << strEncodedKey << "\r\n"
+                     << "Sec-WebSocket-Version: 13\r\n"
+                     << "\r\n";
+          m_strOutput += strRequest.str();
+          FlushOutput();
+        }
+
+        /****************************************/
+        /****************************************/
+
+        void QueueFrame(uint8_t un_opcode, const std::string& str_payload) {
+          if (m_eState != EState::OPEN) {
+            return;
+          }
+          std::string strFrame;
+          strFrame.reserve(str_payload.size() + 14);
+          /* FIN + opcode */
+          strFrame.push_back(static_cast<char>(0x80 | un_opcode));
+
+          size_t unLength = str_payload.size();
+          if (unLength < 126) {
+            strFrame.push_back(static_cast<char>(0x80 | unLength));
+          } else if (unLength <= 0xffff) {
+            strFrame.push_back(static_cast<char>(0x80 | 126));
+            strFrame.push_back(static_cast<char>((unLength >> 8) & 0xff));
+            strFrame.push_back(static_cast<char>(unLength & 0xff));
+          } else {
+            strFrame.push_back(static_cast<char>(0x80 | 127));
+            for (int i = 7; i >= 0; --i) {
+              strFrame.push_back(static_cast<char>((unLength >> (8 * i)) & 0xff));
+            }
+          }
+
+          /* Client to server frames must be masked */
+          uint32_t unMask = static_cast<uint32_t>(m_cRandom());
+          char pchMask[4];
+          memcpy(pchMask, &unMask, 4);
+          strFrame.append(pchMask, 4);
+          for (size_t i = 0; i < unLength; ++i) {
+            strFrame.push_back(str_payload[i] ^ pchMask[i & 3]);
+          }
+
+          m_strOutput += strFrame;
+          FlushOutput();
+        }
+
+        /****************************************/
+        /****************************************/
+
+        ssize_t RawWrite(const char* pch_data, size_t un_size) {
+#ifdef WEBVIZ_LOADGEN_WITH_OPENSSL
+          if (m_pcSSL != nullptr) {
+            int nRet = SSL_write(m_pcSSL, pch_data, (int)un_size);
+            if (nRet <= 0) {
+              int nErr = SSL_get_error(m_pcSSL, nRet);
+              if (nErr == SSL_ERROR_WANT_READ || nErr == SSL_ERROR_WANT_WRITE) {
+                errno = EAGAIN;
+              }
+              return -1;
+            }
+            return nRet;
+          }
+#endif
+          return send(m_nFd, pch_data, un_size, MSG_NOSIGNAL);
+        }
+
+        /****************************************/
+        /****************************************/
+
+        ssize_t RawRead(char* pch_data, size_t un_size) {
+#ifdef WEBVIZ_LOADGEN_WITH_OPENSSL
+          if (m_pcSSL != nullptr) {
+            int nRet = SSL_read(m_pcSSL, pch_data, (int)un_size);
+            if (nRet <= 0) {
+              int nErr = SSL_get_error(m_pcSSL, nRet);
+              if (nErr == SSL_ERROR_WANT_READ || nErr == SSL_ERROR_WANT_WRITE) {
+                errno = EAGAIN;
+                return -1;
+              }
+              return 0;
+            }
+            return nRet;
+          }
+#endif
+          return recv(m_nFd, pch_data, un_size, 0);
+        }
+
+        /****************************************/
+        /****************************************/
+
+        void FlushOutput() {
+          while (!m_strOutput.empty() && m_nFd >= 0) {
+            ssize_t nSent = RawWrite(m_strOutput.data(), m_strOutput.size());
+            if (nSent < 0) {
+              if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                Fail("write failed: " + std::string(strerror(errno)));
+              }
+              return;
+            }
+            m_strOutput.erase(0, nSent);
+          }
+        }
+
+        /****************************************/
+        /****************************************/
+
+        void UpdateEpollInterest() {
+          if (m_nFd < 0) {
+            return;
+          }
+          bool bWantWrite =
+            !m_strOutput.empty() || m_eState == EState::CONNECTING;
+          if (bWantWrite == m_bWantWrite) {
+            return;
+          }
+          m_bWantWrite = bWantWrite;
+          epoll_event sEvent;
+          sEvent.events = bWantWrite ? (EPOLLIN | EPOLLOUT) : EPOLLIN;
+          sEvent.data.ptr = this;
+          epoll_ctl(m_nEpollFd, EPOLL_CTL_MOD, m_nFd, &sEvent);
+        }
+
+        /****************************************/
+        /****************************************/
+
+        void ReadInput(SStepProbe& s_probe) {
+          char pchBuffer[64 * 1024];
+          while (m_nFd >= 0) {
+            ssize_t nRead = RawRead(pchBuffer, sizeof(pchBuffer));
+            if (nRead > 0) {
+              m_sStats.Bytes += nRead;
+              m_strInput.append(pchBuffer, nRead);
+            } else if (nRead == 0) {
+              Fail("connection closed by server");
+              return;
+            } else {
+              if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                Fail("read failed: " + std::string(strerror(errno)));
+              }
+              break;
+            }
+          }
+
+          if (m_eState == EState::UPGRADING) {
+            size_t unEnd = m_strInput.find("\r\n\r\n");
+            if (unEnd == std::string::npos) {
+              return;
+            }
+            if (m_strInput.compare(0, 12, "HTTP/1.1 101") != 0) {
+              Fail("upgrade rejected: " + m_strInput.substr(0, unEnd));
+              return;
+            }
+            m_strInput.erase(0, unEnd + 4);
+            m_eState = EState::OPEN;
+            m_sStats.Connected = true;
+            m_sStats.ConnectedMicros = NowMicros();
+          }
+
+          if (m_eState == EState::OPEN) {
+            ParseFrames(s_probe);
+          }
+        }
+
+        /****************************************/
+        /****************************************/
+
+        void ParseFrames(SStepProbe& s_probe) {
+          size_t unPos = 0;
+          while (m_nFd >= 0) {
+            size_t unAvailable = m_strInput.size() - unPos;
+            if (unAvailable < 2) {
+              break;
+            }
+            const uint8_t* punData =
+              reinterpret_cast<const uint8_t*>(m_strInput.data() + unPos);
+            bool bFin = punData[0] & 0x80;
+            uint8_t unOpcode = punData[0] & 0x0f;
+            bool bMasked = punData[1] & 0x80;
+            uint64_t unLength = punData[1] & 0x7f;
+            size_t unHeader = 2;
+
+            if (unLength == 126) {
+              if (unAvailable < 4) break;
+              unLength = (uint64_t(punData[2]) << 8) | punData[3];
+              unHeader = 4;
+            } else if (unLength == 127) {
+              if (unAvailable < 10) break;
+              unLength = 0;
+              for (int i = 0; i < 8; ++i) {
+                unLength = (unLength << 8) | punData[2 + i];
+              }
+              unHeader = 10;
+            }
+            if (bMasked) {
+              /* Servers never mask, but be lenient */
+              unHeader += 4;
+            }
+            if (unAvailable < unHeader + unLength) {
+              break;
+            }
+
+            std::string strPayload(
+              m_strInput.data() + unPos + unHeader, unLength);
+            if (bMasked) {
+              const char* pchMask = m_strInput.data() + unPos + unHeader - 4;
+              for (size_t i = 0; i < strPayload.size(); ++i) {
+                strPayload[i] ^= pchMask[i & 3];
+              }
+            }
+            unPos += unHeader + unLength;
+
+            switch (unOpcode) {
+              case 0x0: /* Continuation */
+                m_strFragments += strPayload;
+                if (bFin) {
+                  OnMessage(m_strFragments, s_probe);
+                  m_strFragments.clear();
+                }
+                break;
+              case 0x1: /* Text */
+              case 0x2: /* Binary */
+                if (bFin) {
+                  OnMessage(strPayload, s_probe);
+                } else {
+                  m_strFragments = strPayload;
+                }
+                break;
+              case 0x8: /* Close */
+                Fail("closed by server");
+                break;
+              case 0x9: /* Ping */
+                QueueFrame(0xA, strPayload);
+                break;
+              default: /* Pong and others are ignored */
+                break;
+            }
+          }
+          if (m_nFd >= 0) {
+            m_strInput.erase(0, unPos);
+          }
+        }
+
+        /****************************************/
+        /****************************************/
+
+        /**
+         * @brief Extracts an integer value for a top level key without
+         * parsing the whole message.
+         *
+         * Keys are searched from the end, as nlohmann::json dumps the keys of
+         * the broadcast in alphabetical order ("steps" and "type" come after
+         * the large "entities" array).
+         */
+        static bool FindValue(
+          const std::string& str_message,
+          const std::string& str_key,
+          std::string& str_value) {
+          size_t unPos = str_message.rfind("\"" + str_key + "\":");
+          if (unPos == std::string::npos) {
+            return false;
+          }
+          unPos += str_key.size() + 3;
+          while (unPos < str_message.size() && str_message[unPos] == ' ') {
+            ++unPos;
+          }
+          size_t unEnd = unPos;
+          if (unEnd < str_message.size() && str_message[unEnd] == '"') {
+            unEnd = str_message.find('"', unPos + 1);
+            if (unEnd == std::string::npos) return false;
+            str_value = str_message.substr(unPos + 1, unEnd - unPos - 1);
+            return true;
+          }
+          while (unEnd < str_message.size() &&
+                 (isdigit(str_message[unEnd]) || str_message[unEnd] == '-')) {
+            ++unEnd;
+          }
+          str_value = str_message.substr(unPos, unEnd - unPos);
+          return true;
+        }
+
+        /****************************************/
+        /****************************************/
+
+        void OnMessage(const std::string& str_message, SStepProbe& s_probe) {
+          int64_t nNow = NowMicros();
+          ++m_sStats.Messages;
+
+          std::string strType;
+          int64_t nStep = -1;
+
+          if (m_sOptions.FullParse) {
+            try {
+              nlohmann::json cJson = nlohmann::json::parse(str_message);
+              strType = cJson.value("type", "");
+              if (cJson.contains("steps")) {
+                nStep = cJson["steps"].get<int64_t>();
+              }
+            } catch (const std::exception& e) {
+              return;
+            }
+          } else {
+            std::string strSteps;
+            FindValue(str_message, "type", strType);
+            if (FindValue(str_message, "steps", strSteps) && !strSteps.empty()) {
+              nStep = std::stoll(strSteps);
+            }
+          }
+
+          if (strType != "broadcast") {
+            return;
+          }
+
+          ++m_sStats.Broadcasts;
+          if (m_sStats.LastBroadcastMicros > 0) {
+            m_sStats.MaxGapMicros = std::max(
+              m_sStats.MaxGapMicros, nNow - m_sStats.LastBroadcastMicros);
+          } else {
+            m_sStats.FirstBroadcastMicros = nNow;
+          }
+          m_sStats.LastBroadcastMicros = nNow;
+
+          if (nStep >= 0) {
+            if (m_sStats.LastStep >= 0 && nStep > m_sStats.LastStep + 1) {
+              ++m_sStats.StepJumps;
+            }
+            m_sStats.LastStep = nStep;
+
+            /* Step-to-receive latency */
+            uint64_t unProbeId = s_probe.Id.load();
+            if (
+              unProbeId != 0 && unProbeId != m_unLastProbeId &&
+              nStep > s_probe.BaseStep.load()) {
+              m_unLastProbeId = unProbeId;
+              m_vecLatencies.push_back(nNow - s_probe.SentMicros.load());
+            }
+          }
+        }
+
+       private:
+        unsigned int m_unIndex;
+        const SOptions& m_sOptions;
+        int m_nFd = -1;
+        int m_nEpollFd = -1;
+        bool m_bWantWrite = true;
+        EState m_eState = EState::DISCONNECTED;
+        std::string m_strInput;
+        std::string m_strOutput;
+        std::string m_strFragments;
+        SClientStats m_sStats;
+        std::vector<int64_t> m_vecLatencies;
+        uint64_t m_unLastProbeId = 0;
+        std::minstd_rand m_cRandom{std::random_device{}()};
+#ifdef WEBVIZ_LOADGEN_WITH_OPENSSL
+        SSL* m_pcSSL = nullptr;
+#endif
+      };
+
+      /****************************************/
+      /****************************************/
+
+      /** One event loop thread driving a subset of the clients */
+      class CLoadGenWorker {
+       public:
+        CLoadGenWorker(
+          unsigned int un_worker,
+          const SOptions& s_options,
+          SStepProbe& s_probe,
+          std::atomic<bool>& b_running)
+            : m_unWorker(un_worker),
+              m_sOptions(s_options),
+              m_sProbe(s_probe),
+              m_bRunning(b_running) {}
+
+        /****************************************/
+        /****************************************/
+
+        void AddClient(unsigned int un_index) {
+          m_vecClients.emplace_back(new CLoadGenClient(un_index, m_sOptions));
+        }
+
+        /****************************************/
+        /****************************************/
+
+        void Run(const sockaddr_in& s_addr) {
+          m_nEpollFd = epoll_create1(0);
+
+#ifdef WEBVIZ_LOADGEN_WITH_OPENSSL
+          SSL_CTX* pcSSLCtx = nullptr;
+          if (m_sOptions.UseSSL) {
+            pcSSLCtx = SSL_CTX_new(TLS_client_method());
+            /* Loopback testing with self signed certificates */
+            SSL_CTX_set_verify(pcSSLCtx, SSL_VERIFY_NONE, nullptr);
+          }
+#endif
+
+          /* Open connections at the configured rate */
+          int64_t nStart = NowMicros();
+          int64_t nLastPing = nStart;
+          size_t unNextToConnect = 0;
+          double fRatePerWorker =
+            double(m_sOptions.ConnectRate) / m_sOptions.Threads;
+
+          epoll_event psEvents[256];
+
+          while (m_bRunning) {
+            int64_t nNow = NowMicros();
+
+            /* Ramp up */
+            size_t unAllowed = m_vecClients.size();
+            if (m_sOptions.ConnectRate > 0) {
+              unAllowed = std::min<size_t>(
+                m_vecClients.size(),
+                1 + size_t((nNow - nStart) * 1e-6 * fRatePerWorker));
+            }
+            while (unNextToConnect < unAllowed) {
+              m_vecClients[unNextToConnect]->Connect(
+                s_addr,
+                m_nEpollFd
+#ifdef WEBVIZ_LOADGEN_WITH_OPENSSL
+                ,
+                pcSSLCtx
+#endif
+              );
+              ++unNextToConnect;
+            }
+
+            /* Keep the connections alive (server has an idle timeout) */
+            if (
+              m_sOptions.KeepAlive > 0 &&
+              (nNow - nLastPing) > m_sOptions.KeepAlive * 1e6) {
+              nLastPing = nNow;
+              for (auto& pcClient : m_vecClients) {
+                pcClient->SendPing();
+              }
+            }
+
+            /* Synthetic commands are sent by the first worker only */
+            if (m_unWorker == 0) {
+              SendCommands(nNow);
+            }
+
+            int nEvents = epoll_wait(m_nEpollFd, psEvents, 256, 10);
+            for (int i = 0; i < nEvents; ++i) {
+              static_cast<CLoadGenClient*>(psEvents[i].data.ptr)
+                ->OnEvent(psEvents[i].events, m_sProbe);
+            }
+          }
+
+          for (auto& pcClient : m_vecClients) {
+            pcClient->Close();
+          }
+          close(m_nEpollFd);
+
+#ifdef WEBVIZ_LOADGEN_WITH_OPENSSL
+          if (pcSSLCtx != nullptr) {
+            SSL_CTX_free(pcSSLCtx);
+          }
+#endif
+        }
+
+        /****************************************/
+        /****************************************/
+
+        std::vector<std::unique_ptr<CLoadGenClient>>& GetClients() {
+          return m_vecClients;
+        }
+
+       private:
+        /****************************************/
+        /****************************************/
+
+        /** Returns the first open client, used to send commands */
+        CLoadGenClient* GetCommander() {
+          for (auto& pcClient : m_vecClients) {
+            if (pcClient->IsOpen()) {
+              return pcClient.get();
+            }
+          }
+          return nullptr;
+        }
+
+        /****************************************/
+        /****************************************/
+
+        void SendCommands(int64_t n_now) {
+          CLoadGenClient* pcCommander = GetCommander();
+          if (pcCommander == nullptr) {
+            return;
+          }
+
+          if (
+            m_sOptions.StepRate > 0 &&
+            (n_now - m_nLastStepSent) > 1e6 / m_sOptions.StepRate) {
+            m_nLastStepSent = n_now;
+
+            /* Arm the latency probe before sending the command */
+            m_sProbe.BaseStep = pcCommander->GetLastStep();
+            m_sProbe.SentMicros = n_now;
+            m_sProbe.Id.fetch_add(1);
+
+            pcCommander->SendText("{\"command\":\"step\"}");
+          }
+
+          if (
+            m_sOptions.MoveRate > 0 && !m_sOptions.MoveEntityId.empty() &&
+            (n_now - m_nLastMoveSent) > 1e6 / m_sOptions.MoveRate) {
+            m_nLastMoveSent = n_now;
+
+            /* Move the entity around a circle */
+            double fAngle = (m_unMoveCounter++) * 0.1;
+            nlohmann::json cCommand;
+            cCommand["command"] = "moveEntity";
+            cCommand["entity_id"] = m_sOptions.MoveEntityId;
+            cCommand["position"]["x"] = m_sOptions.MoveRadius * cos(fAngle);
+            cCommand["position"]["y"] = m_sOptions.MoveRadius * sin(fAngle);
+            cCommand["position"]["z"] = 0;
+            cCommand["orientation"]["x"] = 0;
+            cCommand["orientation"]["y"] = 0;
+            cCommand["orientation"]["z"] = sin(fAngle / 2);
+            cCommand["orientation"]["w"] = cos(fAngle / 2);
+
+            pcCommander->SendText(cCommand.dump());
+          }
+        }
+
+       private:
+        unsigned int m_unWorker;
+        const SOptions& m_sOptions;
+        SStepProbe& m_sProbe;
+        std::atomic<bool>& m_bRunning;
+        int m_nEpollFd = -1;
+        std::vector<std::unique_ptr<CLoadGenClient>> m_vecClients;
+        int64_t m_nLastStepSent = 0;
+        int64_t m_nLastMoveSent = 0;
+        uint64_t m_unMoveCounter = 0;
+      };
+
+      /****************************************/
+      /****************************************/
+
+      inline double Percentile(std::vector<int64_t>& vec_values, double f_p) {
+        if (vec_values.empty()) {
+          return 0;
+        }
+        size_t unIdx = std::min(
+          vec_values.size() - 1, size_t(f_p / 100.0 * vec_values.size()));
+        std::nth_element(
+          vec_values.begin(), vec_values.begin() + unIdx, vec_values.end());
+        return vec_values[unIdx] / 1000.0;
+      }
+
+      /****************************************/
+      /****************************************/
+
+      void PrintUsage(const char* pch_name) {
+        std::cout
+          << "Usage: " << pch_name << " [options]\n\n"
+          << "Opens many WebSocket connections to an ARGoS3-Webviz server\n"
+          << "and reports receive rates, frame gaps and latencies.\n\n"
+          << "Options:\n"
+          << "  --host <ip>           Server address (default: 127.0.0.1)\n"
+          << "  --port <port>         Server port (default: 3000)\n"
+          << "  --clients <n>         Number of connections (default: 100)\n"
+          << "  --threads <n>         Event loop threads (default: 1)\n"
+          << "  --connect-rate <n>    New connections per second, 0 for all\n"
+          << "                        at once (default: 500)\n"
+          << "  --topics <list>       Comma separated topics, empty for the\n"
+          << "                        server defaults (default: broadcasts)\n"
+          << "  --ssl                 Use wss:// (needs OpenSSL)\n"
+          << "  --duration <s>        Length of the run (default: 10)\n"
+          << "  --step-rate <hz>      Rate of \"step\" commands (default: 0)\n"
+          << "  --move-rate <hz>      Rate of \"moveEntity\" commands\n"
+          << "                        (default: 0)\n"
+          << "  --move-entity <id>    Entity moved by \"moveEntity\"\n"
+          << "  --move-radius <m>     Radius of the circle the entity is\n"
+          << "                        moved on (default: 1)\n"
+          << "  --keepalive <s>       Interval between pings sent by each\n"
+          << "                        client, 0 to disable (default: 5)\n"
+          << "  --full-parse          Parse every message with nlohmann::json\n"
+          << "  --per-client          Print statistics of every client\n"
+          << "  --help                Show this message\n";
+      }
+
+      /****************************************/
+      /****************************************/
+
+      bool ParseOptions(int argc, char** argv, SOptions& s_options) {
+        for (int i = 1; i < argc; ++i) {
+          std::string strArg = argv[i];
+          auto NextArg = [&]() -> std::string {
+            if (i + 1 >= argc) {
+              throw std::invalid_argument("Missing value for " + strArg);
+            }
+            return argv[++i];
+          };
+
+          if (strArg == "--host") {
+            s_options.Host = NextArg();
+          } else if (strArg == "--port") {
+            s_options.Port = std::stoi(NextArg());
+          } else if (strArg == "--clients") {
+            s_options.Clients = std::stoul(NextArg());
+          } else if (strArg == "--threads") {
+            s_options.Threads = std::max(1ul, std::stoul(NextArg()));
+          } else if (strArg == "--connect-rate") {
+            s_options.ConnectRate = std::stoul(NextArg());
+          } else if (strArg == "--topics") {
+            s_options.Topics = NextArg();
+          } else if (strArg == "--ssl") {
+            s_options.UseSSL = true;
+          } else if (strArg == "--duration") {
+            s_options.Duration = std::stod(NextArg());
+          } else if (strArg == "--step-rate") {
+            s_options.StepRate = std::stod(NextArg());
+          } else if (strArg == "--move-rate") {
+            s_options.MoveRate = std::stod(NextArg());
+          } else if (strArg == "--move-entity") {
+            s_options.MoveEntityId = NextArg();
+          } else if (strArg == "--move-radius") {
+            s_options.MoveRadius = std::stod(NextArg());
+          } else if (strArg == "--keepalive") {
+            s_options.KeepAlive = std::stod(NextArg());
+          } else if (strArg == "--full-parse") {
+            s_options.FullParse = true;
+          } else if (strArg == "--per-client") {
+            s_options.PerClient = true;
+          } else if (strArg == "--help" || strArg == "-h") {
+            return false;
+          } else {
+            throw std::invalid_argument("Unknown option " + strArg);
+          }
+        }
+        return true;
+      }
+
+      /****************************************/
+      /****************************************/
+
+      int Main(int argc, char** argv) {
+        SOptions sOptions;
+        try {
+          if (!ParseOptions(argc, argv, sOptions)) {
+            PrintUsage(argv[0]);
+            return 0;
+          }
+        } catch (const std::exception& e) {
+          std::cerr << "[ERROR] " << e.what() << "\n\n";
+          PrintUsage(argv[0]);
+          return 1;
+        }
+
+#ifndef WEBVIZ_LOADGEN_WITH_OPENSSL
+        if (sOptions.UseSSL) {
+          std::cerr << "[ERROR] Compiled without OpenSSL, --ssl unavailable\n";
+          return 1;
+        }
+#endif
+
+        /* Thousands of sockets need a high file descriptor limit */
+        rlimit sLimit;
+        if (getrlimit(RLIMIT_NOFILE, &sLimit) == 0) {
+          sLimit.rlim_cur = sLimit.rlim_max;
+          setrlimit(RLIMIT_NOFILE, &sLimit);
+          if (sLimit.rlim_cur < sOptions.Clients + 16) {
+            std::cerr << "[WARNING] File descriptor limit (" << sLimit.rlim_cur
+                      << ") is lower than the number of clients\n";
+          }
+        }
+
+        /* Resolve the server address */
+        sockaddr_in sAddr;
+        memset(&sAddr, 0, sizeof(sAddr));
+        sAddr.sin_family = AF_INET;
+        sAddr.sin_port = htons(sOptions.Port);
+        if (inet_pton(AF_INET, sOptions.Host.c_str(), &sAddr.sin_addr) != 1) {
+          addrinfo sHints;
+          memset(&sHints, 0, sizeof(sHints));
+          sHints.ai_family = AF_INET;
+          addrinfo* psResult = nullptr;
+          if (
+            getaddrinfo(sOptions.Host.c_str(), nullptr, &sHints, &psResult) !=
+              0 ||
+            psResult == nullptr) {
+            std::cerr << "[ERROR] Cannot resolve " << sOptions.Host << '\n';
+            return 1;
+          }
+          sAddr.sin_addr = ((sockaddr_in*)psResult->ai_addr)->sin_addr;
+          freeaddrinfo(psResult);
+        }
+
+#ifdef WEBVIZ_LOADGEN_WITH_OPENSSL
+        if (sOptions.UseSSL) {
+          SSL_library_init();
+          SSL_load_error_strings();
+        }
+#endif
+
+        std::atomic<bool> bRunning{true};
+        SStepProbe sProbe;
+
+        /* Distribute clients over the workers */
+        std::vector<std::unique_ptr<CLoadGenWorker>> vecWorkers;
+        for (unsigned int i = 0; i < sOptions.Threads; ++i) {
+          vecWorkers.emplace_back(
+            new CLoadGenWorker(i, sOptions, sProbe, bRunning));
+        }
+        for (unsigned int i = 0; i < sOptions.Clients; ++i) {
+          vecWorkers[i % sOptions.Threads]->AddClient(i);
+        }
+
+        std::cout << "Connecting " << sOptions.Clients << " clients to "
+                  << (sOptions.UseSSL ? "wss://" : "ws://") << sOptions.Host
+                  << ":" << sOptions.Port << "/?" << sOptions.Topics << " with "
+                  << sOptions.Threads << " thread(s) for " << sOptions.Duration
+                  << "s\n";
+
+        std::vector<std::thread> vecThreads;
+        for (auto& pcWorker : vecWorkers) {
+          CLoadGenWorker* pcRaw = pcWorker.get();
+          vecThreads.emplace_back([pcRaw, &sAddr]() { pcRaw->Run(sAddr); });
+        }
+
+        int64_t nStart = NowMicros();
+        std::this_thread::sleep_for(
+          std::chrono::milliseconds(int64_t(sOptions.Duration * 1000)));
+        bRunning = false;
+        for (auto& tThread : vecThreads) {
+          tThread.join();
+        }
+        double fElapsed = (NowMicros() - nStart) * 1e-6;
+
+        /************* Aggregate the results *************/
+
+        std::vector<int64_t> vecLatencies;
+        std::vector<int64_t> vecGaps;
+        std::vector<double> vecRates;
+        uint64_t unTotalBytes = 0;
+        uint64_t unTotalBroadcasts = 0;
+        uint64_t unTotalJumps = 0;
+        unsigned int unConnected = 0;
+        unsigned int unFailed = 0;
+
+        if (sOptions.PerClient) {
+          std::cout << "\nclient  broadcasts  rate(Hz)  max_gap(ms)  "
+                       "step_jumps  KiB  error\n";
+        }
+
+        for (auto& pcWorker : vecWorkers) {
+          for (auto& pcClient : pcWorker->GetClients()) {
+            const SClientStats& sStats = pcClient->GetStats();
+            unTotalBytes += sStats.Bytes;
+            unTotalBroadcasts += sStats.Broadcasts;
+            unTotalJumps += sStats.StepJumps;
+            if (sStats.ConnectedMicros > 0) {
+              ++unConnected;
+            }
+            if (sStats.Failed) {
+              ++unFailed;
+            }
+
+            double fRate = 0;
+            if (sStats.Broadcasts > 1) {
+              fRate = (sStats.Broadcasts - 1) /
+                      ((sStats.LastBroadcastMicros -
+                        sStats.FirstBroadcastMicros) *
+                       1e-6);
+              vecRates.push_back(fRate);
+              vecGaps.push_back(sStats.MaxGapMicros);
+            }
+
+            auto& vecSamples = pcClient->GetLatencySamples();
+            vecLatencies.insert(
+              vecLatencies.end(), vecSamples.begin(), vecSamples.end());
+
+            if (sOptions.PerClient) {
+              std::cout << std::setw(6) << pcClient->GetIndex() << "  "
+                        << std::setw(10) << sStats.Broadcasts << "  "
+                        << std::setw(8) << std::fixed << std::setprecision(2)
+                        << fRate << "  " << std::setw(11)
+                        << sStats.MaxGapMicros / 1000.0 << "  " << std::setw(10)
+                        << sStats.StepJumps << "  " << std::setw(3)
+                        << sStats.Bytes / 1024 << "  " << sStats.Error << '\n';
+            }
+          }
+        }
+
+        std::sort(vecRates.begin(), vecRates.end());
+
+        std::cout << std::fixed << std::setprecision(2);
+        std::cout << "\n==== ARGoS3-Webviz load test results ====\n";
+        std::cout << "Duration:            " << fElapsed << " s\n";
+        std::cout << "Clients connected:   " << unConnected << "/"
+                  << sOptions.Clients << " (" << unFailed << " failed)\n";
+        std::cout << "Broadcasts received: " << unTotalBroadcasts << '\n';
+        std::cout << "Throughput:          "
+                  << unTotalBytes / fElapsed / (1024 * 1024) << " MiB/s\n";
+        std::cout << "Step jumps:          " << unTotalJumps << '\n';
+
+        if (!vecRates.empty()) {
+          std::cout << "Receive rate (Hz):   min " << vecRates.front()
+                    << "  median " << vecRates[vecRates.size() / 2] << "  max "
+                    << vecRates.back() << '\n';
+          std::cout << "Max frame gap (ms):  p50 " << Percentile(vecGaps, 50)
+                    << "  p99 " << Percentile(vecGaps, 99) << "  max "
+                    << Percentile(vecGaps, 100) << '\n';
+        }
+
+        if (!vecLatencies.empty()) {
+          std::cout << "Step-to-receive latency (ms), " << vecLatencies.size()
+                    << " samples:\n"
+                    << "                     p50 " << Percentile(vecLatencies, 50)
+                    << "  p90 " << Percentile(vecLatencies, 90) << "  p99 "
+                    << Percentile(vecLatencies, 99) << "  max "
+                    << Percentile(vecLatencies, 100) << '\n';
+        }
+
+        return unConnected > 0 ? 0 : 1;
+      }
+
+    }  // namespace LoadGen
+  }    // namespace Webviz
+}  // namespace argos
+
+/****************************************/
+/****************************************/
+
+int main(int argc, char** argv) {
+  return argos::Webviz::LoadGen::Main(argc, argv);
+}
@@ -0,0 +1,174 @@
+/**
+ * @file <argos3/testing/shmreader/webviz_shmreader.cpp>
+ *
+ * @author Prajankya Sonar - <prajankya@gmail.com>
+ *
+ * @project ARGoS3-Webviz <https://github.com/NESTlab/argos3-webviz>
+ *
+ * MIT License
+ * Copyright (c) 2020 NEST Lab
+ *
+ * Example reader of the shared-memory frame ring of ARGoS3-Webviz.
+ *
+ * Attaches to the ring opened by a webviz server started with the
+ * "shm_name" attribute, parses every frame and reports once per second the
+ * step, the number of entities, the frame rate and the frames lost because
+ * the reader fell behind.
+ *
+ * Run with --help for the list of options.
+ */
+
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <nlohmann/json.hpp>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#include "plugins/simulator/visualizations/webviz/utility/SharedMemoryRing.h"
+
+namespace argos {
+  namespace Webviz {
+    namespace ShmReader {
+
+      struct SOptions {
+        std::string Name = "/webviz";
+        double Duration = 10;
+      };
+
+      /****************************************/
+      /****************************************/
+
+      void PrintUsage(const char* pch_name) {
+        std::cout
+          << "Usage: " << pch_name << " [options]\n\n"
+          << "Reads the frames of an ARGoS3-Webviz server from its\n"
+          << "shared-memory ring and reports rates and lost frames.\n\n"
+          << "Options:\n"
+          << "  --name <name>         Name of the ring, as \"shm_name\"\n"
+          << "                        (default: /webviz)\n"
+          << "  --duration <s>        Length of the run, 0 to run until\n"
+          << "                        interrupted (default: 10)\n"
+          << "  --help                Show this message\n";
+      }
+
+      /****************************************/
+      /****************************************/
+
+      bool ParseOptions(int argc, char** argv, SOptions& s_options) {
+        for (int i = 1; i < argc; ++i) {
+          std::string strArg = argv[i];
+          auto NextArg = [&]() -> std::string {
+            if (i + 1 >= argc) {
+              throw std::invalid_argument("Missing value for " + strArg);
+            }
+            return argv[++i];
+          };
+
+          if (strArg == "--name") {
+            s_options.Name = NextArg();
+          } else if (strArg == "--duration") {
+            s_options.Duration = std::stod(NextArg());
+          } else if (strArg == "--help") {
+            return false;
+          } else {
+            throw std::invalid_argument("Unknown option " + strArg);
+          }
+        }
+        return true;
+      }
+
+      /****************************************/
+      /****************************************/
+
+      int Main(int argc, char** argv) {
+        SOptions sOptions;
+        try {
+          if (!ParseOptions(argc, argv, sOptions)) {
+            PrintUsage(argv[0]);
+            return 0;
+          }
+        } catch (const std::exception& e) {
+          std::cerr << "[ERROR] " << e.what() << "\n\n";
+          PrintUsage(argv[0]);
+          return 1;
+        }
+
+        CSharedMemoryRingReader cReader;
+        if (!cReader.Open(sOptions.Name)) {
+          std::cerr << "[ERROR] Can not open the ring \"" << sOptions.Name
+                    << "\", is the server running with shm_name set?\n";
+          return 1;
+        }
+        std::cout << "Attached to \"" << sOptions.Name << "\" ("
+                  << cReader.GetSlotCount() << " slots)\n";
+
+        typedef std::chrono::steady_clock TClock;
+        const TClock::time_point cStart = TClock::now();
+        TClock::time_point cLastReport = cStart;
+
+        std::string strFrame;
+        uint64_t unStep = 0;
+        uint64_t unLost = 0;
+        uint64_t unFrames = 0;
+        uint64_t unTotalFrames = 0;
+        uint64_t unTotalLost = 0;
+        size_t unEntities = 0;
+
+        while (true) {
+          uint64_t unLostNow = 0;
+          if (
+            cReader.Next(strFrame, unStep, unLostNow) ==
+            CSharedMemoryRingReader::EStatus::OK) {
+            /* Parsing is the work a real consumer would do */
+            nlohmann::json cFrame =
+              nlohmann::json::parse(strFrame, nullptr, false);
+            if (!cFrame.is_discarded() && cFrame.contains("entities")) {
+              unEntities = cFrame["entities"].size();
+            }
+            ++unFrames;
+          } else {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+          }
+          unLost += unLostNow;
+
+          const TClock::time_point cNow = TClock::now();
+          const double fSinceReport =
+            std::chrono::duration<double>(cNow - cLastReport).count();
+          if (fSinceReport >= 1) {
+            std::cout << "step " << unStep << ", " << unEntities
+                      << " entities, " << unFrames / fSinceReport
+                      << " frames/s, " << unLost << " lost\n";
+            unTotalFrames += unFrames;
+            unTotalLost += unLost;
+            unFrames = 0;
+            unLost = 0;
+            cLastReport = cNow;
+          }
+
+          if (
+            sOptions.Duration > 0 &&
+            std::chrono::duration<double>(cNow - cStart).count() >=
+              sOptions.Duration) {
+            break;
+          }
+        }
+
+        unTotalFrames += unFrames;
+        unTotalLost += unLost;
+        std::cout << "Read " << unTotalFrames << " frames, lost "
+                  << unTotalLost << "\n";
+        cReader.Close();
+        return 0;
+      }
+    }  // namespace ShmReader
+  }  // namespace Webviz
+}  // namespace argos
+
+/****************************************/
+/****************************************/
+
+int main(int argc, char** argv) {
+  return argos::Webviz::ShmReader::Main(argc, argv);
+}
@@ -0,0 +1,52 @@
+#include <cstring>
+#include <string>
+
+#include "gtest/gtest.h"
+#include "plugins/simulator/visualizations/webviz/utility/ArrowIPC.h"
+
+using argos::Webviz::CArrowColumn;
+using argos::Webviz::CArrowStreamEncoder;
+using argos::Webviz::EArrowType;
+
+static uint32_t ReadU32(const std::string& str_buffer, size_t un_pos) {
+  uint32_t unValue;
+  std::memcpy(&unValue, &str_buffer[un_pos], sizeof(unValue));
+  return unValue;
+}
+
+TEST(UtilityArrowIPC, MessageFraming) {
+  std::vector<CArrowColumn> vecColumns = {
+    CArrowColumn("step", EArrowType::UINT64),
+    CArrowColumn("id", EArrowType::UTF8),
+    CArrowColumn("x", EArrowType::FLOAT64)};
+
+  /* Continuation marker, then metadata padded to 8 bytes */
+  std::string strSchema = CArrowStreamEncoder::EncodeSchema(vecColumns);
+  EXPECT_EQ(0xFFFFFFFFu, ReadU32(strSchema, 0));
+  EXPECT_EQ(0u, ReadU32(strSchema, 4) % 8);
+  EXPECT_EQ(strSchema.size(), 8u + ReadU32(strSchema, 4));
+  EXPECT_NE(std::string::npos, strSchema.find("step"));
+
+  for (uint64_t i = 0; i < 3; ++i) {
+    vecColumns[0].Append(i);
+    vecColumns[1].Append("fb" + std::to_string(i));
+    vecColumns[2].Append(0.5 * i);
+  }
+  EXPECT_EQ(3u, vecColumns[1].GetLength());
+  EXPECT_EQ(9u, vecColumns[1].GetData().size());
+
+  /* Body after the metadata, with each buffer padded to 8 bytes:
+   * 3 x 8 (step), 16 offsets + 9 characters (id), 3 x 8 (x) */
+  std::string strBatch = CArrowStreamEncoder::EncodeRecordBatch(vecColumns);
+  EXPECT_EQ(0xFFFFFFFFu, ReadU32(strBatch, 0));
+  uint32_t unMetadata = ReadU32(strBatch, 4);
+  EXPECT_EQ(0u, unMetadata % 8);
+  EXPECT_EQ(8u + unMetadata + 24u + 16u + 16u + 24u, strBatch.size());
+
+  vecColumns[1].Clear();
+  EXPECT_EQ(0u, vecColumns[1].GetLength());
+
+  std::string strEnd = CArrowStreamEncoder::EncodeEndOfStream();
+  ASSERT_EQ(8u, strEnd.size());
+  EXPECT_EQ(0u, ReadU32(strEnd, 4));
+};
@@ -0,0 +1,67 @@
+#include <string>
+
+#include "gtest/gtest.h"
+#include "plugins/simulator/visualizations/webviz/utility/BroadcastFragments.h"
+
+using argos::Webviz::CBroadcastFragments;
+using argos::Webviz::CLEDChanges;
+using argos::Webviz::SBroadcastSettings;
+
+namespace {
+  const nlohmann::json BOT = {
+    {"id", "fb1"}, {"type", "foot-bot"}, {"x", 1.23456}, {"leds", {1, 2}}};
+}  // namespace
+
+TEST(UtilityBroadcastFragments, ReusedWhileUnchanged) {
+  CBroadcastFragments cFragments;
+  SBroadcastSettings sSettings;
+  sSettings.Precision = 2;
+  size_t unProcessed = 0;
+  auto fnProcess = [&](nlohmann::json& c_entity) {
+    ++unProcessed;
+    argos::Webviz::RoundNumbers(c_entity, sSettings.Precision);
+  };
+
+  const CBroadcastFragments::SFragment& sFragment =
+    cFragments.Get("fb1", 42, sSettings, BOT, fnProcess);
+  EXPECT_EQ(1u, unProcessed);
+  EXPECT_TRUE(sFragment.HasLEDs);
+  EXPECT_EQ(CLEDChanges::Hash(BOT["leds"]), sFragment.LEDHash);
+  EXPECT_EQ(
+    nlohmann::json::parse(sFragment.WithLEDs),
+    nlohmann::json(
+      {{"id", "fb1"}, {"type", "foot-bot"}, {"x", 1.23}, {"leds", {1, 2}}}));
+  EXPECT_FALSE(nlohmann::json::parse(sFragment.WithoutLEDs).contains("leds"));
+
+  /* Same fingerprint and settings, not processed again */
+  EXPECT_EQ(
+    &sFragment, &cFragments.Get("fb1", 42, sSettings, BOT, fnProcess));
+  EXPECT_EQ(1u, unProcessed);
+  EXPECT_EQ(1u, cFragments.GetHits());
+
+  /* Other settings, or changed */
+  sSettings.Precision = 1;
+  cFragments.Get("fb1", 42, sSettings, BOT, fnProcess);
+  EXPECT_EQ(2u, unProcessed);
+  EXPECT_EQ(
+    1.2,
+    nlohmann::json::parse(sFragment.WithLEDs)["x"].get<double>());
+  cFragments.Get("fb1", 43, sSettings, BOT, fnProcess);
+  EXPECT_EQ(3u, unProcessed);
+
+  /* Forgotten, e.g. the handles changed */
+  cFragments.Clear();
+  cFragments.Get("fb1", 43, sSettings, BOT, fnProcess);
+  EXPECT_EQ(4u, unProcessed);
+  EXPECT_EQ(4u, cFragments.GetMisses());
+}
+
+TEST(UtilityBroadcastFragments, WithoutLEDs) {
+  CBroadcastFragments cFragments;
+  const nlohmann::json cBox = {{"id", "box1"}, {"type", "box"}};
+  const CBroadcastFragments::SFragment& sFragment = cFragments.Get(
+    "box1", 7, SBroadcastSettings(), cBox, [](nlohmann::json&) {});
+  EXPECT_FALSE(sFragment.HasLEDs);
+  EXPECT_TRUE(sFragment.WithoutLEDs.empty());
+  EXPECT_EQ(cBox, nlohmann::json::parse(sFragment.WithLEDs));
+}
@@ -0,0 +1,84 @@
+#include <string>
+
+#include "gtest/gtest.h"
+#include "plugins/simulator/visualizations/webviz/utility/BroadcastSettings.h"
+
+using argos::Webviz::CBroadcastSettings;
+using argos::Webviz::EBroadcastDetail;
+
+TEST(UtilityBroadcastSettings, Update) {
+  CBroadcastSettings cSettings;
+  EXPECT_EQ(10, cSettings.Get().Frequency);
+  EXPECT_EQ("full", cSettings.ToJSON()["detail"]);
+
+  EXPECT_EQ(
+    "",
+    cSettings.Update(
+      {{"broadcast_frequency", 5}, {"detail", "pose"}, {"precision", 2}}));
+  EXPECT_EQ(5, cSettings.Get().Frequency);
+  EXPECT_EQ(EBroadcastDetail::POSE, cSettings.Get().Detail);
+  EXPECT_EQ(2, cSettings.Get().Precision);
+  /* Untouched */
+  EXPECT_EQ(2, cSettings.Get().DrawFramesEvery);
+  EXPECT_TRUE(cSettings.Get().Compress);
+  EXPECT_FALSE(cSettings.Get().Handles);
+
+  EXPECT_EQ("", cSettings.Update({{"handles", true}}));
+  EXPECT_TRUE(cSettings.Get().Handles);
+  EXPECT_EQ(true, cSettings.ToJSON()["handles"]);
+
+  EXPECT_EQ("float32", cSettings.ToJSON()["ray_format"]);
+  EXPECT_EQ("", cSettings.Update({{"ray_format", "float16"}}));
+  EXPECT_TRUE(cSettings.Get().HalfRays);
+  EXPECT_EQ("float16", cSettings.ToJSON()["ray_format"]);
+};
+
+TEST(UtilityBroadcastSettings, Validation) {
+  CBroadcastSettings cSettings;
+
+  /* All or nothing */
+  EXPECT_NE(
+    "",
+    cSettings.Update({{"compression", false}, {"broadcast_frequency", 0}}));
+  EXPECT_TRUE(cSettings.Get().Compress);
+  EXPECT_EQ(10, cSettings.Get().Frequency);
+
+  EXPECT_NE("", cSettings.Update({{"ff_draw_frames_every", 1001}}));
+  EXPECT_NE("", cSettings.Update({{"detail", "everything"}}));
+  EXPECT_NE("", cSettings.Update({{"precision", 1.5}}));
+  EXPECT_NE("", cSettings.Update({{"handles", 1}}));
+  EXPECT_NE("", cSettings.Update({{"ray_format", "float8"}}));
+  EXPECT_NE("", cSettings.Update({{"port", 3001}}));
+  EXPECT_NE("", cSettings.Update({{"unknown", 1}}));
+  EXPECT_NE("", cSettings.Update(nlohmann::json::array()));
+  EXPECT_EQ("", cSettings.Update(nlohmann::json::object()));
+};
+
+TEST(UtilityBroadcastSettings, Shaping) {
+  nlohmann::json cEntity = {
+    {"type", "foot-bot"},
+    {"id", "fb0"},
+    {"position", {{"x", 0.123456}, {"y", -1.98765}, {"z", 0}}},
+    {"rays", {"true:0,0,0:1,0,0"}},
+    {"points", nlohmann::json::array()},
+    {"leds", {"0x000000"}},
+    {"debug", {{"state", 1}}}};
+
+  nlohmann::json cLean = cEntity;
+  argos::Webviz::ApplyBroadcastDetail(cLean, EBroadcastDetail::LEAN);
+  EXPECT_FALSE(cLean.contains("rays"));
+  EXPECT_FALSE(cLean.contains("points"));
+  EXPECT_FALSE(cLean.contains("debug"));
+  EXPECT_TRUE(cLean.contains("leds"));
+
+  nlohmann::json cPose = cEntity;
+  argos::Webviz::ApplyBroadcastDetail(cPose, EBroadcastDetail::POSE);
+  EXPECT_EQ(3u, cPose.size());
+  EXPECT_EQ("fb0", cPose["id"]);
+
+  argos::Webviz::RoundNumbers(cPose, 2);
+  EXPECT_EQ("0.12", cPose["position"]["x"].dump());
+  EXPECT_EQ("-1.99", cPose["position"]["y"].dump());
+  /* Integers are left as they are */
+  EXPECT_EQ("0", cPose["position"]["z"].dump());
+};
@@ -0,0 +1,96 @@
+#include "gtest/gtest.h"
+#include "plugins/simulator/visualizations/webviz/utility/BroadcastTopics.h"
+
+using argos::Webviz::CBroadcastFilter;
+using argos::Webviz::CTopicSubscriptions;
+using argos::Webviz::SEntityGroup;
+
+TEST(UtilityBroadcastTopics, CountSubscribers) {
+  CTopicSubscriptions cSubscriptions;
+
+  cSubscriptions.Subscribe("broadcasts");
+  cSubscriptions.Subscribe("broadcasts");
+  cSubscriptions.Subscribe("logs");
+  EXPECT_EQ(2u, cSubscriptions.GetSubscribers("broadcasts"));
+  EXPECT_EQ(1u, cSubscriptions.GetSubscribers("logs"));
+  EXPECT_EQ(0u, cSubscriptions.GetSubscribers("events"));
+
+  cSubscriptions.Unsubscribe("broadcasts");
+  cSubscriptions.Unsubscribe("logs");
+  /* Unknown topics are ignored */
+  cSubscriptions.Unsubscribe("events");
+
+  EXPECT_EQ(1u, cSubscriptions.GetSubscribers("broadcasts"));
+  EXPECT_EQ(0u, cSubscriptions.GetSubscribers("logs"));
+  EXPECT_EQ(1u, cSubscriptions.GetSnapshot().size());
+};
+
+/****************************************/
+/****************************************/
+
+TEST(UtilityBroadcastTopics, GroupMembership) {
+  SEntityGroup sGroup;
+  sGroup.Name = "leaders";
+  sGroup.Types = SEntityGroup::ParseTypes("foot-bot,,kheperaiv");
+  sGroup.IdPrefix = "fbl";
+
+  EXPECT_EQ(2u, sGroup.Types.size());
+  EXPECT_TRUE(sGroup.Contains("foot-bot", "fbl3"));
+  EXPECT_FALSE(sGroup.Contains("foot-bot", "fb3"));
+  EXPECT_FALSE(sGroup.Contains("box", "fbl3"));
+
+  /* No types and no prefix matches everything */
+  SEntityGroup sAll;
+  EXPECT_TRUE(sAll.Contains("box", "box_1"));
+};
+
+/****************************************/
+/****************************************/
+
+TEST(UtilityBroadcastTopics, FilterFromSubscriptions) {
+  SEntityGroup sGroup;
+  sGroup.Name = "leaders";
+  sGroup.IdPrefix = "fbl";
+
+  /* Nothing subscribed */
+  CBroadcastFilter cNone({{"logs", 1}}, {sGroup});
+  EXPECT_FALSE(cNone.IsAnyRequested());
+  EXPECT_FALSE(cNone.IsEntityRequested("foot-bot", "fb1"));
+
+  /* Full state */
+  CBroadcastFilter cAll({{"broadcasts", 1}}, {sGroup});
+  EXPECT_TRUE(cAll.IsAllRequested());
+  EXPECT_TRUE(cAll.IsEntityRequested("floor", "floor"));
+  EXPECT_EQ(0u, cAll.GetTopics().size());
+
+  /* One type, one group, and a group which was not configured */
+  CBroadcastFilter cSome(
+    {{"broadcasts/box", 1},
+     {"broadcasts/groups/leaders", 2},
+     {"broadcasts/groups/unknown", 1}},
+    {sGroup});
+  EXPECT_FALSE(cSome.IsAllRequested());
+  EXPECT_TRUE(cSome.IsAnyRequested());
+  EXPECT_EQ(2u, cSome.GetTopics().size());
+  EXPECT_TRUE(cSome.IsEntityRequested("box", "box_1"));
+  EXPECT_TRUE(cSome.IsEntityRequested("foot-bot", "fbl1"));
+  EXPECT_FALSE(cSome.IsEntityRequested("foot-bot", "fb1"));
+  EXPECT_FALSE(cSome.IsEntityRequested("floor", "floor"));
+
+  /* Whole types, or only some of their ids */
+  EXPECT_TRUE(cAll.IsWholeTypeRequested("floor"));
+  EXPECT_FALSE(cNone.IsTypeRequested("box"));
+  EXPECT_TRUE(cSome.IsTypeRequested("box"));
+  EXPECT_TRUE(cSome.IsWholeTypeRequested("box"));
+  EXPECT_TRUE(cSome.IsTypeRequested("foot-bot"));
+  EXPECT_FALSE(cSome.IsWholeTypeRequested("foot-bot"));
+
+  SEntityGroup sLights;
+  sLights.Name = "lights";
+  sLights.Types = {"light"};
+  sLights.IdPrefix = "l";
+  CBroadcastFilter cLights({{"broadcasts/groups/lights", 1}}, {sLights});
+  EXPECT_TRUE(cLights.IsTypeRequested("light"));
+  EXPECT_FALSE(cLights.IsWholeTypeRequested("light"));
+  EXPECT_FALSE(cLights.IsTypeRequested("box"));
+};
@@ -0,0 +1,81 @@
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "plugins/simulator/visualizations/webviz/utility/DebugSlot.h"
+
+using argos::Webviz::CDebugSlot;
+
+namespace {
+  std::vector<std::pair<std::string, double>> Values(
+    const CDebugSlot& c_slot) {
+    std::vector<std::pair<std::string, double>> vecValues;
+    c_slot.ForEach([&vecValues](const char* pch_key, double f_value) {
+      vecValues.emplace_back(pch_key, f_value);
+    });
+    return vecValues;
+  }
+}  // namespace
+
+TEST(UtilityDebugSlot, SetAndOverwrite) {
+  CDebugSlot cSlot;
+  EXPECT_TRUE(cSlot.IsEmpty());
+
+  EXPECT_TRUE(cSlot.Set("state", 1));
+  EXPECT_TRUE(cSlot.Set("left_speed", 2.5));
+  EXPECT_TRUE(cSlot.Set("state", 2));
+  /* Same key from another buffer */
+  std::string strKey = "left_speed";
+  EXPECT_TRUE(cSlot.Set(strKey.c_str(), 0));
+
+  auto vecValues = Values(cSlot);
+  ASSERT_EQ(2u, vecValues.size());
+  EXPECT_EQ("state", vecValues[0].first);
+  EXPECT_EQ(2, vecValues[0].second);
+  EXPECT_EQ("left_speed", vecValues[1].first);
+  EXPECT_EQ(0, vecValues[1].second);
+}
+
+TEST(UtilityDebugSlot, FullAndClear) {
+  static const char* KEYS[] = {"k0", "k1", "k2", "k3", "k4", "k5",
+                               "k6", "k7", "k8", "k9", "k10", "k11",
+                               "k12", "k13", "k14", "k15", "k16"};
+  CDebugSlot cSlot;
+  for (size_t i = 0; i < CDebugSlot::MAX_VALUES; ++i) {
+    EXPECT_TRUE(cSlot.Set(KEYS[i], i));
+  }
+  EXPECT_FALSE(cSlot.Set(KEYS[CDebugSlot::MAX_VALUES], 1));
+  /* Known keys can still be changed */
+  EXPECT_TRUE(cSlot.Set("k0", 10));
+  EXPECT_EQ(CDebugSlot::MAX_VALUES, cSlot.GetSize());
+  EXPECT_EQ(10, Values(cSlot)[0].second);
+
+  cSlot.Clear();
+  EXPECT_TRUE(cSlot.IsEmpty());
+  EXPECT_TRUE(cSlot.Set("k16", 1));
+  EXPECT_EQ(1u, cSlot.GetSize());
+}
+
+TEST(UtilityDebugSlot, ReadWhileWriting) {
+  CDebugSlot cSlot;
+  std::thread cWriter([&cSlot]() {
+    for (int i = 0; i < 10000; ++i) {
+      cSlot.Set("a", i);
+      cSlot.Set("b", -i);
+    }
+  });
+
+  /* Readers only see complete keys */
+  for (int i = 0; i < 1000; ++i) {
+    cSlot.ForEach([](const char* pch_key, double) {
+      EXPECT_NE(nullptr, pch_key);
+    });
+  }
+  cWriter.join();
+  auto vecValues = Values(cSlot);
+  ASSERT_EQ(2u, vecValues.size());
+  EXPECT_EQ(9999, vecValues[0].second);
+  EXPECT_EQ(-9999, vecValues[1].second);
+}
@@ -0,0 +1,53 @@
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "plugins/simulator/visualizations/webviz/utility/EntityDetails.h"
+
+using argos::Webviz::CEntityDetailRequests;
+
+TEST(UtilityEntityDetails, Serve) {
+  CEntityDetailRequests cRequests;
+  EXPECT_FALSE(cRequests.HasPending());
+
+  std::vector<std::string> vecReplies;
+  auto fnReply = [&vecReplies](const nlohmann::json& c_detail) {
+    vecReplies.push_back(c_detail.is_null() ? "null" : c_detail["id"]);
+  };
+  EXPECT_TRUE(cRequests.Add("fb0", fnReply));
+  EXPECT_TRUE(cRequests.Add("fb0", fnReply));
+  EXPECT_TRUE(cRequests.Add("unknown", fnReply));
+  EXPECT_TRUE(cRequests.HasPending());
+
+  /* One build per entity, one reply per request */
+  std::vector<std::string> vecBuilt;
+  auto fnBuilder = [&vecBuilt](const std::string& str_id) -> nlohmann::json {
+    vecBuilt.push_back(str_id);
+    if (str_id == "unknown") {
+      return nullptr;
+    }
+    return {{"id", str_id}};
+  };
+  EXPECT_EQ(2u, cRequests.Serve(fnBuilder));
+  EXPECT_EQ(2u, vecBuilt.size());
+  ASSERT_EQ(3u, vecReplies.size());
+  EXPECT_EQ(2, std::count(vecReplies.begin(), vecReplies.end(), "fb0"));
+  EXPECT_EQ(1, std::count(vecReplies.begin(), vecReplies.end(), "null"));
+
+  /* Nothing left */
+  EXPECT_FALSE(cRequests.HasPending());
+  EXPECT_EQ(0u, cRequests.Serve(fnBuilder));
+  EXPECT_EQ(2u, vecBuilt.size());
+};
+
+TEST(UtilityEntityDetails, Limit) {
+  CEntityDetailRequests cRequests(2);
+  auto fnReply = [](const nlohmann::json&) {};
+  EXPECT_TRUE(cRequests.Add("fb0", fnReply));
+  EXPECT_TRUE(cRequests.Add("fb1", fnReply));
+  EXPECT_FALSE(cRequests.Add("fb2", fnReply));
+
+  cRequests.Serve([](const std::string&) -> nlohmann::json { return {}; });
+  EXPECT_TRUE(cRequests.Add("fb2", fnReply));
+};
@@ -0,0 +1,154 @@
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "plugins/simulator/visualizations/webviz/utility/EntityFields.h"
+
+using argos::Webviz::MakeEntityFields;
+namespace Fields = argos::Webviz::Fields;
+
+namespace {
+  struct SFakeVector {
+    double X, Y, Z;
+    double GetX() const { return X; }
+    double GetY() const { return Y; }
+    double GetZ() const { return Z; }
+  };
+
+  struct SFakeQuaternion {
+    double X, Y, Z, W;
+    double GetX() const { return X; }
+    double GetY() const { return Y; }
+    double GetZ() const { return Z; }
+    double GetW() const { return W; }
+  };
+
+  struct SFakeAnchor {
+    SFakeVector Position;
+    SFakeQuaternion Orientation;
+  };
+
+  struct SFakeColor {
+    uint8_t R, G, B;
+    uint8_t GetRed() const { return R; }
+    uint8_t GetGreen() const { return G; }
+    uint8_t GetBlue() const { return B; }
+  };
+
+  struct SFakeLED {
+    SFakeColor Color;
+    SFakeVector Position;
+    const SFakeColor& GetColor() const { return Color; }
+    const SFakeVector& GetPosition() const { return Position; }
+  };
+
+  struct SFakeLEDs {
+    std::vector<SFakeLED> LEDs;
+    const std::vector<SFakeLED>& GetLEDs() const { return LEDs; }
+    const SFakeLED& GetLED(size_t i) const { return LEDs[i]; }
+  };
+
+  struct SFakeRobot {
+    std::string Id = "fb0";
+    SFakeAnchor Anchor = {{1, 2, 3}, {0, 0, 0, 1}};
+    SFakeLEDs LEDs;
+    bool Movable = true;
+    std::string GetTypeDescription() const { return "fake-bot"; }
+    const std::string& GetId() const { return Id; }
+  };
+
+  constexpr auto ROBOT_FIELDS = MakeEntityFields<SFakeRobot>(
+    Fields::Pose(
+      [](SFakeRobot& s_robot) -> const SFakeAnchor& { return s_robot.Anchor; }),
+    Fields::Scalar(
+      "is_movable", [](SFakeRobot& s_robot) { return s_robot.Movable; }),
+    Fields::LEDs(
+      "leds", [](SFakeRobot& s_robot) -> SFakeLEDs& { return s_robot.LEDs; }),
+    Fields::Custom("extra", [](nlohmann::json& c_json, SFakeRobot& s_robot) {
+      c_json["extra"] = s_robot.Id + "!";
+    }));
+
+  /* Same, with the state the custom field is written from */
+  constexpr auto STATEFUL_FIELDS = MakeEntityFields<SFakeRobot>(
+    Fields::Pose(
+      [](SFakeRobot& s_robot) -> const SFakeAnchor& { return s_robot.Anchor; }),
+    Fields::Custom(
+      "extra",
+      [](nlohmann::json& c_json, SFakeRobot& s_robot) {
+        c_json["extra"] = s_robot.Movable;
+      },
+      [](std::string& str_buffer, SFakeRobot& s_robot) {
+        Fields::PackBytes(str_buffer, s_robot.Movable);
+      }));
+}  // namespace
+
+TEST(UtilityEntityFields, ToJSON) {
+  SFakeRobot sRobot;
+  nlohmann::json cJson = ROBOT_FIELDS.ToJSON(sRobot);
+  EXPECT_EQ("fake-bot", cJson["type"]);
+  EXPECT_EQ("fb0", cJson["id"]);
+  EXPECT_EQ(2.0, cJson["position"]["y"]);
+  EXPECT_EQ(1.0, cJson["orientation"]["w"]);
+  EXPECT_EQ(true, cJson["is_movable"]);
+  EXPECT_EQ("fb0!", cJson["extra"]);
+
+  /* No LEDs, no key */
+  EXPECT_FALSE(cJson.contains("leds"));
+
+  sRobot.LEDs.LEDs = {{{255, 0, 16}, {0, 0, 0}}, {{0, 0, 0}, {0, 0, 0}}};
+  cJson = ROBOT_FIELDS.ToJSON(sRobot);
+  ASSERT_EQ(2u, cJson["leds"].size());
+  /* Packed as 0xRRGGBB, without their positions */
+  EXPECT_EQ(0xff0010, cJson["leds"][0]);
+  EXPECT_EQ(0, cJson["leds"][1]);
+}
+
+TEST(UtilityEntityFields, PackAndChanges) {
+  SFakeRobot sRobot;
+  std::string strPacked;
+  ROBOT_FIELDS.Pack(sRobot, strPacked);
+  /* Id, pose, bool, LED count */
+  EXPECT_EQ(4 + 3 + 7 * 8 + 1 + 4u, strPacked.size());
+
+  std::string strPrevious;
+  EXPECT_TRUE(ROBOT_FIELDS.HasChanged(sRobot, strPrevious));
+  EXPECT_EQ(strPacked, strPrevious);
+  EXPECT_FALSE(ROBOT_FIELDS.HasChanged(sRobot, strPrevious));
+
+  /* Custom fields are not part of the binary form */
+  sRobot.Anchor.Position.X = 1.5;
+  EXPECT_TRUE(ROBOT_FIELDS.HasChanged(sRobot, strPrevious));
+  sRobot.LEDs.LEDs = {{{1, 2, 3}, {0, 0, 0}}};
+  EXPECT_TRUE(ROBOT_FIELDS.HasChanged(sRobot, strPrevious));
+  EXPECT_FALSE(ROBOT_FIELDS.HasChanged(sRobot, strPrevious));
+}
+
+TEST(UtilityEntityFields, Fingerprint) {
+  static_assert(!decltype(ROBOT_FIELDS)::HAS_FINGERPRINT, "");
+  static_assert(decltype(STATEFUL_FIELDS)::HAS_FINGERPRINT, "");
+
+  SFakeRobot sRobot;
+  const uint64_t unFingerprint = STATEFUL_FIELDS.Fingerprint(sRobot);
+  EXPECT_EQ(unFingerprint, STATEFUL_FIELDS.Fingerprint(sRobot));
+
+  /* Custom fields are covered by their state */
+  sRobot.Movable = false;
+  const uint64_t unStill = STATEFUL_FIELDS.Fingerprint(sRobot);
+  EXPECT_NE(unFingerprint, unStill);
+
+  sRobot.Anchor.Orientation.Z = 0.5;
+  EXPECT_NE(unStill, STATEFUL_FIELDS.Fingerprint(sRobot));
+  sRobot.Anchor.Orientation.Z = 0;
+  EXPECT_EQ(unStill, STATEFUL_FIELDS.Fingerprint(sRobot));
+}
+
+TEST(UtilityEntityFields, Schema) {
+  nlohmann::json cSchema = ROBOT_FIELDS.Schema();
+  ASSERT_EQ(4u, cSchema.size());
+  EXPECT_EQ("pose", cSchema[0]["kind"]);
+  EXPECT_EQ("is_movable", cSchema[1]["key"]);
+  EXPECT_EQ("scalar", cSchema[1]["kind"]);
+  EXPECT_EQ("leds", cSchema[2]["kind"]);
+  EXPECT_EQ("custom", cSchema[3]["kind"]);
+}
@@ -0,0 +1,178 @@
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "plugins/simulator/visualizations/webviz/utility/EntityHandles.h"
+
+using argos::Webviz::CEntityHandles;
+
+namespace {
+  typedef std::vector<CEntityHandles::SEntity> TEntities;
+}  // namespace
+
+TEST(UtilityEntityHandles, DenseHandles) {
+  CEntityHandles cHandles;
+  EXPECT_EQ(0u, cHandles.GetVersion());
+
+  EXPECT_TRUE(cHandles.Update(TEntities{
+    {"fb1", "foot-bot", nullptr},
+    {"box1", "box", nullptr},
+    {"fb2", "foot-bot", nullptr}}));
+  EXPECT_EQ(1u, cHandles.GetVersion());
+  EXPECT_EQ(0, cHandles.Find("fb1"));
+  EXPECT_EQ(1, cHandles.Find("box1"));
+  EXPECT_EQ(2, cHandles.Find("fb2"));
+  EXPECT_EQ(CEntityHandles::NO_HANDLE, cHandles.Find("fb3"));
+
+  std::string strId;
+  ASSERT_TRUE(cHandles.Resolve(1, strId));
+  EXPECT_EQ("box1", strId);
+  EXPECT_FALSE(cHandles.Resolve(3, strId));
+  EXPECT_FALSE(cHandles.Resolve(-1, strId));
+
+  /* Same entities, in another order: nothing changes */
+  EXPECT_FALSE(cHandles.Update(TEntities{
+    {"fb2", "foot-bot", nullptr},
+    {"fb1", "foot-bot", nullptr},
+    {"box1", "box", nullptr}}));
+  EXPECT_EQ(1u, cHandles.GetVersion());
+  EXPECT_EQ(2, cHandles.Find("fb2"));
+}
+
+TEST(UtilityEntityHandles, ReuseFreedHandles) {
+  CEntityHandles cHandles;
+  cHandles.Update(TEntities{
+    {"fb1", "foot-bot", nullptr},
+    {"fb2", "foot-bot", nullptr},
+    {"fb3", "foot-bot", nullptr}});
+
+  /* Removed entities free their handle, survivors keep theirs */
+  EXPECT_TRUE(cHandles.Update(TEntities{
+    {"fb1", "foot-bot", nullptr},
+    {"fb3", "foot-bot", nullptr}}));
+  EXPECT_EQ(2u, cHandles.GetVersion());
+  EXPECT_EQ(2, cHandles.Find("fb3"));
+  EXPECT_EQ(CEntityHandles::NO_HANDLE, cHandles.Find("fb2"));
+
+  nlohmann::json cManifest = cHandles.ToJSON();
+  EXPECT_EQ(2u, cManifest["version"].get<uint64_t>());
+  ASSERT_EQ(3u, cManifest["entities"].size());
+  EXPECT_TRUE(cManifest["entities"][1].is_null());
+  EXPECT_EQ("fb3", cManifest["entities"][2][0]);
+  EXPECT_EQ("foot-bot", cManifest["entities"][2][1]);
+
+  /* New entities take the lowest free handles first */
+  EXPECT_TRUE(cHandles.Update(TEntities{
+    {"fb1", "foot-bot", nullptr},
+    {"fb3", "foot-bot", nullptr},
+    {"l1", "light", nullptr},
+    {"l2", "light", nullptr}}));
+  EXPECT_EQ(1, cHandles.Find("l1"));
+  EXPECT_EQ(3, cHandles.Find("l2"));
+
+  /* Free handles at the end are dropped */
+  cHandles.Update(TEntities{{"fb1", "foot-bot", nullptr}});
+  EXPECT_EQ(1u, cHandles.ToJSON()["entities"].size());
+}
+
+TEST(UtilityEntityHandles, Changes) {
+  CEntityHandles cHandles;
+  CEntityHandles::SChanges sChanges;
+  cHandles.Update(TEntities{
+    {"fb1", "foot-bot", nullptr},
+    {"fb2", "foot-bot", nullptr}}, &sChanges);
+  EXPECT_EQ(2u, sChanges.Added.size());
+  EXPECT_TRUE(sChanges.Removed.empty());
+
+  /* Nothing changed */
+  EXPECT_FALSE(cHandles.Update(TEntities{
+    {"fb1", "foot-bot", nullptr},
+    {"fb2", "foot-bot", nullptr}}, &sChanges));
+  EXPECT_TRUE(sChanges.IsEmpty());
+
+  /* fb1 removed, b1 takes its handle, fb2 replaced by a box */
+  EXPECT_TRUE(cHandles.Update(TEntities{
+    {"b1", "box", nullptr},
+    {"fb2", "box", nullptr}}, &sChanges));
+  nlohmann::json cChanges =
+    CEntityHandles::ChangesToJSON(sChanges, cHandles.GetVersion());
+  EXPECT_EQ(2u, cChanges["version"].get<uint64_t>());
+  EXPECT_EQ(
+    nlohmann::json::parse(R"([[0, "fb1"], [1, "fb2"]])"), cChanges["removed"]);
+  EXPECT_EQ(
+    nlohmann::json::parse(R"([[0, "b1", "box"], [1, "fb2", "box"]])"),
+    cChanges["added"]);
+}
+
+TEST(UtilityEntityHandles, Compact) {
+  CEntityHandles cHandles;
+  cHandles.Update(TEntities{
+    {"fb1", "foot-bot", nullptr},
+    {"box1", "box", nullptr}});
+
+  nlohmann::json cEntity = {
+    {"type", "box"}, {"id", "box1"}, {"position", {{"x", 1.0}}}};
+  cHandles.Compact(cEntity);
+  EXPECT_FALSE(cEntity.contains("id"));
+  EXPECT_FALSE(cEntity.contains("type"));
+  EXPECT_EQ(1, cEntity["h"]);
+  EXPECT_EQ(1.0, cEntity["position"]["x"]);
+
+  /* Entities without handle keep their id */
+  nlohmann::json cUnknown = {{"type", "box"}, {"id", "box2"}};
+  cHandles.Compact(cUnknown);
+  EXPECT_EQ("box2", cUnknown["id"]);
+  EXPECT_FALSE(cUnknown.contains("h"));
+}
+
+TEST(UtilityEntityHandles, StaticData) {
+  CEntityHandles cHandles;
+  const nlohmann::json cLEDs = {{"led_positions", {{0.1, 0.0, 0.2}}}};
+  cHandles.Update(TEntities{
+    {"fb1", "foot-bot", cLEDs},
+    {"box1", "box", nullptr}});
+
+  /* Only sent in the manifest, as a third element */
+  nlohmann::json cManifest = cHandles.ToJSON();
+  ASSERT_EQ(3u, cManifest["entities"][0].size());
+  EXPECT_EQ(cLEDs, cManifest["entities"][0][2]);
+  EXPECT_EQ(2u, cManifest["entities"][1].size());
+
+  /* Unchanged static data does not change the manifest */
+  EXPECT_FALSE(cHandles.Update(TEntities{
+    {"fb1", "foot-bot", cLEDs},
+    {"box1", "box", nullptr}}));
+  EXPECT_TRUE(cHandles.Update(TEntities{
+    {"fb1", "foot-bot", nullptr},
+    {"box1", "box", nullptr}}));
+  EXPECT_EQ(0, cHandles.Find("fb1"));
+
+  CEntityHandles cCopy;
+  cHandles.Update(TEntities{
+    {"fb1", "foot-bot", cLEDs},
+    {"box1", "box", nullptr}});
+  ASSERT_TRUE(cCopy.FromJSON(cHandles.ToJSON()));
+  EXPECT_EQ(cHandles.ToJSON(), cCopy.ToJSON());
+}
+
+TEST(UtilityEntityHandles, FromJSON) {
+  CEntityHandles cHandles;
+  cHandles.Update(TEntities{
+    {"fb1", "foot-bot", nullptr},
+    {"fb2", "foot-bot", nullptr},
+    {"fb3", "foot-bot", nullptr}});
+  cHandles.Update(TEntities{
+    {"fb1", "foot-bot", nullptr},
+    {"fb3", "foot-bot", nullptr}});
+
+  CEntityHandles cCopy;
+  ASSERT_TRUE(cCopy.FromJSON(cHandles.ToJSON()));
+  EXPECT_EQ(cHandles.GetVersion(), cCopy.GetVersion());
+  EXPECT_EQ(cHandles.ToJSON(), cCopy.ToJSON());
+  EXPECT_EQ(2, cCopy.Find("fb3"));
+
+  /* Invalid manifests change nothing */
+  EXPECT_FALSE(cCopy.FromJSON({{"version", 5}, {"entities", {{"fb1"}}}}));
+  EXPECT_FALSE(cCopy.FromJSON({{"entities", nlohmann::json::array()}}));
+  EXPECT_EQ(2, cCopy.Find("fb3"));
+}
@@ -0,0 +1,104 @@
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "plugins/simulator/visualizations/webviz/utility/EntityTypeTable.h"
+
+namespace {
+  struct SFakeEntity {
+    std::string Type;
+    std::string Id;
+  };
+
+  typedef argos::Webviz::CEntityTypeTable<SFakeEntity, int> TTable;
+
+  std::string GetKey(SFakeEntity& s_entity) { return s_entity.Id; }
+}  // namespace
+
+TEST(UtilityEntityTypeTable, GroupByType) {
+  SFakeEntity sBot1{"foot-bot", "fb1"}, sBot2{"foot-bot", "fb2"};
+  SFakeEntity sBox{"box", "box1"}, sOdd{"odd-bot", "ob1"};
+  std::vector<SFakeEntity*> vecEntities = {&sBot1, &sBox, &sOdd, &sBot2};
+
+  TTable cTable;
+  EXPECT_TRUE(cTable.IsStale(vecEntities, GetKey));
+
+  size_t unResolved = 0;
+  auto fnType = [](SFakeEntity& s_entity) { return s_entity.Type; };
+  auto fnResolve = [&](SFakeEntity& s_entity, int& n_serializer) {
+    ++unResolved;
+    n_serializer = s_entity.Type.size();
+    return s_entity.Type != "odd-bot";
+  };
+
+  std::vector<std::string> vecUnknown =
+    cTable.Build(vecEntities, fnType, fnResolve, GetKey);
+  ASSERT_EQ(1u, vecUnknown.size());
+  EXPECT_EQ("odd-bot", vecUnknown[0]);
+  EXPECT_EQ(3u, unResolved);
+  EXPECT_FALSE(cTable.IsStale(vecEntities, GetKey));
+
+  /* Types in order of first appearance, entities in their order */
+  const auto& vecTypes = cTable.GetTypes();
+  ASSERT_EQ(3u, vecTypes.size());
+  EXPECT_EQ("foot-bot", vecTypes[0].Name);
+  EXPECT_TRUE(vecTypes[0].Known);
+  EXPECT_EQ(8, vecTypes[0].Serializer);
+  ASSERT_EQ(2u, vecTypes[0].Entities.size());
+  EXPECT_EQ(&sBot1, vecTypes[0].Entities[0]);
+  EXPECT_EQ(&sBot2, vecTypes[0].Entities[1]);
+  EXPECT_EQ("box", vecTypes[1].Name);
+  EXPECT_FALSE(vecTypes[2].Known);
+}
+
+TEST(UtilityEntityTypeTable, Rebuild) {
+  SFakeEntity sBot{"foot-bot", "fb1"}, sOdd1{"odd-bot", "ob1"};
+  SFakeEntity sOdd2{"odd-bot", "ob2"}, sBox{"box", "box1"};
+  std::vector<SFakeEntity*> vecEntities = {&sBot, &sOdd1};
+
+  size_t unResolved = 0;
+  auto fnType = [](SFakeEntity& s_entity) { return s_entity.Type; };
+  auto fnResolve = [&](SFakeEntity& s_entity, int&) {
+    ++unResolved;
+    return s_entity.Type != "odd-bot";
+  };
+
+  TTable cTable;
+  EXPECT_EQ(1u, cTable.Build(vecEntities, fnType, fnResolve, GetKey).size());
+
+  /* Unknown types are reported once, known ones are not resolved again */
+  vecEntities.push_back(&sOdd2);
+  vecEntities.push_back(&sBox);
+  EXPECT_TRUE(cTable.IsStale(vecEntities, GetKey));
+  EXPECT_EQ(0u, cTable.Build(vecEntities, fnType, fnResolve, GetKey).size());
+  EXPECT_EQ(3u, unResolved);
+  EXPECT_EQ(2u, cTable.GetTypes()[1].Entities.size());
+
+  /* Types without entities are dropped */
+  vecEntities = {&sBox};
+  cTable.Build(vecEntities, fnType, fnResolve, GetKey);
+  ASSERT_EQ(1u, cTable.GetTypes().size());
+  EXPECT_EQ("box", cTable.GetTypes()[0].Name);
+
+  cTable.Invalidate();
+  EXPECT_TRUE(cTable.IsStale(vecEntities, GetKey));
+}
+
+TEST(UtilityEntityTypeTable, ReusedAddress) {
+  SFakeEntity sBot{"foot-bot", "fb1"}, sBox{"box", "box1"};
+  std::vector<SFakeEntity*> vecEntities = {&sBot, &sBox};
+
+  auto fnType = [](SFakeEntity& s_entity) { return s_entity.Type; };
+  auto fnResolve = [](SFakeEntity&, int&) { return true; };
+
+  TTable cTable;
+  cTable.Build(vecEntities, fnType, fnResolve, GetKey);
+  EXPECT_FALSE(cTable.IsStale(vecEntities, GetKey));
+
+  /* Another entity at the address of a removed one */
+  sBot = {"box", "box2"};
+  EXPECT_TRUE(cTable.IsStale(vecEntities, GetKey));
+  cTable.Build(vecEntities, fnType, fnResolve, GetKey);
+  ASSERT_EQ(1u, cTable.GetTypes().size());
+  EXPECT_EQ(2u, cTable.GetTypes()[0].Entities.size());
+}
@@ -0,0 +1,55 @@
+#include "gtest/gtest.h"
+#include "plugins/simulator/visualizations/webviz/utility/FragmentCache.h"
+
+using argos::Webviz::CFragmentCache;
+
+TEST(UtilityFragmentCache, CachedOnceUnchanged) {
+  CFragmentCache cCache;
+  cCache.Reset(2);
+  const nlohmann::json cWall = {{"id", "wall"}, {"position", {{"x", 1}}}};
+
+  /* First seen, serialized and not kept yet */
+  EXPECT_EQ(nullptr, cCache.Find(0, 42));
+  cCache.Store(0, cWall);
+  EXPECT_EQ(nullptr, cCache.Find(0, 42));
+  cCache.Store(0, cWall);
+
+  /* Unchanged since, reused */
+  CFragmentCache::TFragment pcCached = cCache.Find(0, 42);
+  ASSERT_NE(nullptr, pcCached);
+  EXPECT_EQ(cWall, *pcCached);
+
+  /* Shared, not copied */
+  EXPECT_EQ(pcCached, cCache.Find(0, 42));
+  EXPECT_EQ(2u, cCache.GetHits());
+  EXPECT_EQ(2u, cCache.GetMisses());
+
+  /* Changed, serialized again */
+  EXPECT_EQ(nullptr, cCache.Find(0, 43));
+  cCache.Store(0, cWall);
+  EXPECT_EQ(nullptr, cCache.Find(0, 44));
+  cCache.Store(0, cWall);
+  EXPECT_EQ(nullptr, cCache.Find(0, 45));
+
+  /* Still valid for the frames which carry it */
+  EXPECT_EQ(cWall, *pcCached);
+}
+
+TEST(UtilityFragmentCache, Reset) {
+  CFragmentCache cCache;
+  cCache.Reset(1);
+  cCache.Find(0, 7);
+  cCache.Find(0, 7);
+  cCache.Store(0, {{"id", "box"}});
+  ASSERT_NE(nullptr, cCache.Find(0, 7));
+
+  /* Entities were added or removed, the indices changed */
+  cCache.Reset(2);
+  EXPECT_EQ(nullptr, cCache.Find(0, 7));
+  EXPECT_EQ(nullptr, cCache.Find(1, 7));
+
+  /* Out of range, never cached */
+  EXPECT_EQ(nullptr, cCache.Find(2, 7));
+  cCache.Store(2, {{"id", "box"}});
+  EXPECT_EQ(nullptr, cCache.Find(2, 7));
+}
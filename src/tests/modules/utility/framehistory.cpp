@@ -0,0 +1,92 @@
+#include <string>
+
+#include "gtest/gtest.h"
+#include "plugins/simulator/visualizations/webviz/utility/FrameHistory.h"
+
+using argos::Webviz::CFrameHistory;
+
+static nlohmann::json MakeFrame(uint64_t un_step) {
+  nlohmann::json cFrame;
+  cFrame["type"] = "broadcast";
+  cFrame["steps"] = un_step;
+  cFrame["entities"] = nlohmann::json::array();
+  /* One moving entity, one static, and one appearing at step 5 */
+  cFrame["entities"].push_back({{"id", "fb0"}, {"x", un_step}});
+  cFrame["entities"].push_back({{"id", "box0"}, {"x", 1}});
+  if (un_step >= 5) {
+    cFrame["entities"].push_back({{"id", "fb1"}, {"x", 2 * un_step}});
+  }
+  return cFrame;
+}
+
+TEST(UtilityFrameHistory, RebuildsFramesFromDeltas) {
+  CFrameHistory cHistory(1000, 1024 * 1024, 4);
+  for (uint64_t i = 1; i <= 10; ++i) {
+    cHistory.Push(i, MakeFrame(i));
+  }
+  /* Same step again is ignored */
+  cHistory.Push(10, MakeFrame(10));
+  EXPECT_EQ(10u, cHistory.GetFrameCount());
+
+  nlohmann::json cFrame;
+  for (uint64_t i = 1; i <= 10; ++i) {
+    ASSERT_TRUE(cHistory.GetFrame(i, cFrame));
+    EXPECT_EQ(MakeFrame(i), cFrame);
+  }
+  EXPECT_FALSE(cHistory.GetFrame(0, cFrame));
+
+  nlohmann::json cFrames = cHistory.GetFrames(3, 7, 100);
+  ASSERT_EQ(5u, cFrames.size());
+  EXPECT_EQ(MakeFrame(3), cFrames[0]);
+  EXPECT_EQ(MakeFrame(7), cFrames[4]);
+
+  /* The limit keeps the oldest frames of the range */
+  cFrames = cHistory.GetFrames(3, 7, 2);
+  ASSERT_EQ(2u, cFrames.size());
+  EXPECT_EQ(MakeFrame(4), cFrames[1]);
+};
+
+/****************************************/
+/****************************************/
+
+TEST(UtilityFrameHistory, RemovedEntities) {
+  CFrameHistory cHistory(1000, 1024 * 1024, 10);
+  cHistory.Push(5, MakeFrame(5));
+  nlohmann::json cFrame = MakeFrame(6);
+  cFrame["entities"].erase(1);
+  cHistory.Push(6, cFrame);
+
+  nlohmann::json cRebuilt;
+  ASSERT_TRUE(cHistory.GetFrame(6, cRebuilt));
+  EXPECT_EQ(2u, cRebuilt["entities"].size());
+  EXPECT_EQ(cFrame, cRebuilt);
+};
+
+/****************************************/
+/****************************************/
+
+TEST(UtilityFrameHistory, TimeWindowAndMemoryLimit) {
+  CFrameHistory cHistory(20, 1024 * 1024, 5);
+  for (uint64_t i = 1; i <= 100; ++i) {
+    cHistory.Push(i, MakeFrame(i));
+  }
+  uint64_t unFirst, unLast;
+  ASSERT_TRUE(cHistory.GetRange(unFirst, unLast));
+  EXPECT_EQ(100u, unLast);
+  /* Whole groups are dropped, so at least the window is kept */
+  EXPECT_LE(unFirst, 81u);
+  EXPECT_GT(unFirst, 70u);
+
+  CFrameHistory cSmall(1000, 2000, 5);
+  for (uint64_t i = 1; i <= 100; ++i) {
+    cSmall.Push(i, MakeFrame(i));
+  }
+  EXPECT_LE(cSmall.GetBytes(), 2000u);
+  nlohmann::json cFrame;
+  ASSERT_TRUE(cSmall.GetFrame(100, cFrame));
+  EXPECT_EQ(MakeFrame(100), cFrame);
+
+  /* An earlier step (reset) clears the history */
+  cSmall.Push(1, MakeFrame(1));
+  EXPECT_EQ(1u, cSmall.GetFrameCount());
+};
@@ -0,0 +1,172 @@
+#include <cstdio>
+#include <string>
+
+#include "gtest/gtest.h"
+#include "plugins/simulator/visualizations/webviz/utility/FrameRecording.h"
+
+using argos::Webviz::CFrameRecordReader;
+using argos::Webviz::CFrameRecordWriter;
+
+static const std::string RECORDING_PATH = "/tmp/webviz_test_recording.wvz";
+
+static std::string MakeFrame(uint64_t un_step) {
+  return "{\"type\":\"broadcast\",\"steps\":" + std::to_string(un_step) +
+         ",\"entities\":[" + std::string(500, ' ') + "]}";
+}
+
+TEST(UtilityFrameRecording, WriteAndSeek) {
+  CFrameRecordWriter cWriter;
+  ASSERT_TRUE(cWriter.Open(RECORDING_PATH));
+
+  /* Every other step, as in fast-forward */
+  for (uint64_t i = 0; i < 1000; i += 2) {
+    cWriter.Write(i, MakeFrame(i));
+  }
+  cWriter.Close();
+  EXPECT_EQ(500u, cWriter.GetWrittenFrames());
+  EXPECT_EQ(0u, cWriter.GetDroppedFrames());
+
+  CFrameRecordReader cReader;
+  ASSERT_TRUE(cReader.Open(RECORDING_PATH));
+  ASSERT_EQ(500u, cReader.GetFrameCount());
+
+  /* Exact step, step in between, before the first and after the last */
+  EXPECT_EQ(200u, cReader.FindFrame(400));
+  EXPECT_EQ(200u, cReader.FindFrame(401));
+  EXPECT_EQ(0u, cReader.FindFrame(0));
+  EXPECT_EQ(499u, cReader.FindFrame(100000));
+
+  std::string strFrame;
+  ASSERT_TRUE(cReader.ReadFrame(cReader.FindFrame(401), strFrame));
+  EXPECT_EQ(MakeFrame(400), strFrame);
+
+  EXPECT_FALSE(cReader.ReadFrame(500, strFrame));
+
+  std::remove(RECORDING_PATH.c_str());
+  std::remove((RECORDING_PATH + ".idx").c_str());
+};
+
+/****************************************/
+/****************************************/
+
+TEST(UtilityFrameRecording, ReadWhileWriting) {
+  CFrameRecordWriter cWriter;
+  ASSERT_TRUE(cWriter.Open(RECORDING_PATH));
+
+  CFrameRecordReader cReader;
+  ASSERT_TRUE(cReader.Open(RECORDING_PATH));
+  EXPECT_EQ(0u, cReader.GetFrameCount());
+
+  cWriter.Write(1, MakeFrame(1));
+  cWriter.Write(2, MakeFrame(2));
+
+  /* Wait for the background writer */
+  for (int i = 0; i < 1000 && cWriter.GetWrittenFrames() < 2; ++i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  EXPECT_EQ(2u, cReader.Refresh());
+
+  /* Experiment reset, steps start over */
+  cWriter.Write(0, MakeFrame(0));
+  cWriter.Write(1, MakeFrame(1));
+  cWriter.Close();
+
+  EXPECT_EQ(4u, cReader.Refresh());
+  EXPECT_EQ(2u, cReader.GetLatestRunStart());
+  EXPECT_EQ(3u, cReader.FindFrame(1));
+
+  std::string strFrame;
+  ASSERT_TRUE(cReader.ReadFrame(0, strFrame));
+  EXPECT_EQ(MakeFrame(1), strFrame);
+
+  std::remove(RECORDING_PATH.c_str());
+  std::remove((RECORDING_PATH + ".idx").c_str());
+};
+
+/****************************************/
+/****************************************/
+
+TEST(UtilityFrameRecording, DropsWhenQueueIsFull) {
+  /* A queue which can not hold any frame */
+  CFrameRecordWriter cWriter(10);
+  ASSERT_TRUE(cWriter.Open(RECORDING_PATH));
+  cWriter.Write(1, MakeFrame(1));
+  cWriter.Close();
+
+  EXPECT_EQ(0u, cWriter.GetWrittenFrames());
+  EXPECT_EQ(1u, cWriter.GetDroppedFrames());
+
+  /* Missing recording */
+  CFrameRecordReader cReader;
+  EXPECT_FALSE(cReader.Open("/tmp/webviz_missing_recording.wvz"));
+
+  std::remove(RECORDING_PATH.c_str());
+  std::remove((RECORDING_PATH + ".idx").c_str());
+};
+
+/****************************************/
+/****************************************/
+
+TEST(UtilityFrameRecording, BlocksWhenQueueIsFull) {
+  /* A queue which can only hold one frame at a time */
+  CFrameRecordWriter cWriter(10);
+  cWriter.SetBlockWhenFull(true);
+  ASSERT_TRUE(cWriter.Open(RECORDING_PATH));
+  for (uint64_t i = 0; i < 20; ++i) {
+    cWriter.Write(i, MakeFrame(i));
+  }
+  cWriter.Close();
+
+  EXPECT_EQ(20u, cWriter.GetWrittenFrames());
+  EXPECT_EQ(0u, cWriter.GetDroppedFrames());
+
+  std::remove(RECORDING_PATH.c_str());
+  std::remove((RECORDING_PATH + ".idx").c_str());
+};
+
+/****************************************/
+/****************************************/
+
+TEST(UtilityFrameRecording, RejectsCorruptedHeader) {
+  CFrameRecordWriter cWriter;
+  ASSERT_TRUE(cWriter.Open(RECORDING_PATH));
+  cWriter.Write(1, MakeFrame(1));
+  cWriter.Close();
+
+  /* Sizes of the first frame, right after the magic */
+  argos::Webviz::SFrameRecordHeader sHeader;
+  FILE* pfData = std::fopen(RECORDING_PATH.c_str(), "r+b");
+  ASSERT_NE(nullptr, pfData);
+  std::fseek(pfData, sizeof(argos::Webviz::FRAME_RECORD_MAGIC), SEEK_SET);
+  ASSERT_EQ(1u, std::fread(&sHeader, sizeof(sHeader), 1, pfData));
+
+  CFrameRecordReader cReader;
+  std::string strFrame;
+
+  /* Compressed size past the end of the file */
+  argos::Webviz::SFrameRecordHeader sCorrupted = sHeader;
+  sCorrupted.CompressedSize = 0xFFFFFFFF;
+  std::fseek(pfData, sizeof(argos::Webviz::FRAME_RECORD_MAGIC), SEEK_SET);
+  std::fwrite(&sCorrupted, sizeof(sCorrupted), 1, pfData);
+  std::fflush(pfData);
+  ASSERT_TRUE(cReader.Open(RECORDING_PATH));
+  EXPECT_FALSE(cReader.ReadFrame(0, strFrame));
+
+  /* Size too big for the compressed size */
+  sCorrupted = sHeader;
+  sCorrupted.Size = 0xFFFFFFFF;
+  std::fseek(pfData, sizeof(argos::Webviz::FRAME_RECORD_MAGIC), SEEK_SET);
+  std::fwrite(&sCorrupted, sizeof(sCorrupted), 1, pfData);
+  std::fflush(pfData);
+  EXPECT_FALSE(cReader.ReadFrame(0, strFrame));
+
+  /* Intact again */
+  std::fseek(pfData, sizeof(argos::Webviz::FRAME_RECORD_MAGIC), SEEK_SET);
+  std::fwrite(&sHeader, sizeof(sHeader), 1, pfData);
+  std::fclose(pfData);
+  ASSERT_TRUE(cReader.ReadFrame(0, strFrame));
+  EXPECT_EQ(MakeFrame(1), strFrame);
+
+  std::remove(RECORDING_PATH.c_str());
+  std::remove((RECORDING_PATH + ".idx").c_str());
+};
@@ -0,0 +1,65 @@
+#include "gtest/gtest.h"
+#include "plugins/simulator/visualizations/webviz/utility/LatencyHistogram.h"
+
+using argos::Webviz::CLatencyHistogram;
+
+TEST(UtilityLatencyHistogram, EmptyHistogram) {
+  CLatencyHistogram cHistogram;
+
+  EXPECT_EQ(0u, cHistogram.GetCount());
+  EXPECT_EQ(0, cHistogram.GetPercentile(50));
+  EXPECT_EQ(0, cHistogram.GetMax());
+};
+
+/****************************************/
+/****************************************/
+
+TEST(UtilityLatencyHistogram, BucketsAreOrdered) {
+  /* Every value must fall in a bucket whose upper bound is >= value */
+  for (int64_t n = 0; n < 100000; n += 7) {
+    size_t unIdx = CLatencyHistogram::GetBucketIndex(n);
+    EXPECT_GE(CLatencyHistogram::GetBucketUpperBound(unIdx), n);
+    /* Error bounded to 25% */
+    EXPECT_LE(CLatencyHistogram::GetBucketUpperBound(unIdx), n * 1.25 + 1);
+  }
+
+  /* Huge values are clamped in the last bucket */
+  EXPECT_EQ(
+    CLatencyHistogram::BUCKETS - 1,
+    CLatencyHistogram::GetBucketIndex(INT64_C(1) << 60));
+};
+
+/****************************************/
+/****************************************/
+
+TEST(UtilityLatencyHistogram, Percentiles) {
+  CLatencyHistogram cHistogram;
+
+  for (int64_t n = 1; n <= 1000; ++n) {
+    cHistogram.Record(n * 1000);
+  }
+
+  EXPECT_EQ(1000u, cHistogram.GetCount());
+  EXPECT_EQ(1000000, cHistogram.GetMax());
+
+  /* 25% error allowed from bucketing */
+  EXPECT_NEAR(500000, cHistogram.GetPercentile(50), 125000);
+  EXPECT_NEAR(990000, cHistogram.GetPercentile(99), 250000);
+  EXPECT_EQ(1000000, cHistogram.GetPercentile(100));
+};
+
+/****************************************/
+/****************************************/
+
+TEST(UtilityLatencyHistogram, FunctionReset) {
+  CLatencyHistogram cHistogram;
+
+  cHistogram.Record(10);
+  cHistogram.Record(-5);  // Negative values are recorded as 0
+  EXPECT_EQ(2u, cHistogram.GetCount());
+
+  cHistogram.Reset();
+
+  EXPECT_EQ(0u, cHistogram.GetCount());
+  EXPECT_EQ(0, cHistogram.GetMax());
+};
@@ -0,0 +1,83 @@
+#include <string>
+
+#include "gtest/gtest.h"
+#include "plugins/simulator/visualizations/webviz/utility/LEDChanges.h"
+
+using argos::Webviz::CLEDChanges;
+
+namespace {
+  nlohmann::json MakeEntity(const std::string& str_id, uint32_t un_color) {
+    return {{"id", str_id}, {"leds", {un_color, 0x000000}}};
+  }
+}  // namespace
+
+TEST(UtilityLEDChanges, OmitUnchanged) {
+  CLEDChanges cChanges;
+
+  /* The first frame is a keyframe */
+  cChanges.BeginFrame(0);
+  EXPECT_TRUE(cChanges.IsKeyframe());
+  nlohmann::json cEntity = MakeEntity("fb1", 0xff0000);
+  cChanges.Filter(cEntity);
+  EXPECT_TRUE(cEntity.contains("leds"));
+
+  /* Unchanged colors are left out */
+  cChanges.BeginFrame(0);
+  EXPECT_FALSE(cChanges.IsKeyframe());
+  cEntity = MakeEntity("fb1", 0xff0000);
+  cChanges.Filter(cEntity);
+  EXPECT_FALSE(cEntity.contains("leds"));
+  EXPECT_EQ("fb1", cEntity["id"]);
+
+  /* Changed ones and new entities are sent */
+  cChanges.BeginFrame(0);
+  cEntity = MakeEntity("fb1", 0x00ff00);
+  cChanges.Filter(cEntity);
+  EXPECT_TRUE(cEntity.contains("leds"));
+  nlohmann::json cOther = MakeEntity("fb2", 0x00ff00);
+  cChanges.Filter(cOther);
+  EXPECT_TRUE(cOther.contains("leds"));
+
+  /* Entities without LEDs or id are left as they are */
+  nlohmann::json cBox = {{"id", "box1"}};
+  cChanges.Filter(cBox);
+  EXPECT_EQ(nlohmann::json({{"id", "box1"}}), cBox);
+}
+
+TEST(UtilityLEDChanges, Keyframes) {
+  CLEDChanges cChanges;
+  nlohmann::json cEntity;
+  for (size_t i = 0; i < 3; ++i) {
+    cChanges.BeginFrame(3);
+    cEntity = MakeEntity("fb1", 0xff0000);
+    cChanges.Filter(cEntity);
+  }
+  EXPECT_FALSE(cEntity.contains("leds"));
+
+  /* Every 3 frames, all the colors are sent */
+  cChanges.BeginFrame(3);
+  EXPECT_TRUE(cChanges.IsKeyframe());
+  cEntity = MakeEntity("fb1", 0xff0000);
+  cChanges.Filter(cEntity);
+  EXPECT_TRUE(cEntity.contains("leds"));
+
+  /* And on request */
+  cChanges.RequestKeyframe();
+  cChanges.BeginFrame(3);
+  cEntity = MakeEntity("fb1", 0xff0000);
+  cChanges.Filter(cEntity);
+  EXPECT_TRUE(cEntity.contains("leds"));
+  cChanges.BeginFrame(3);
+  cEntity = MakeEntity("fb1", 0xff0000);
+  cChanges.Filter(cEntity);
+  EXPECT_FALSE(cEntity.contains("leds"));
+}
+
+TEST(UtilityLEDChanges, Hash) {
+  EXPECT_EQ(
+    CLEDChanges::Hash({0xff0000, 0}), CLEDChanges::Hash({0xff0000, 0}));
+  EXPECT_NE(CLEDChanges::Hash({0xff0000, 0}), CLEDChanges::Hash({0, 0xff0000}));
+  EXPECT_NE(CLEDChanges::Hash({0xff0000}), CLEDChanges::Hash({0xff0000, 0}));
+  /* Strings of custom serializers */
+  EXPECT_NE(CLEDChanges::Hash({"0xff0000"}), CLEDChanges::Hash({"0x00ff00"}));
+}
@@ -0,0 +1,35 @@
+#include <string>
+
+#include "gtest/gtest.h"
+#include "plugins/simulator/visualizations/webviz/utility/OccupancyGrid.h"
+
+using argos::Webviz::COccupancyGrid;
+
+TEST(UtilityOccupancyGrid, Accumulate) {
+  COccupancyGrid cGrid;
+  EXPECT_FALSE(cGrid.IsEnabled());
+
+  /* 4 x 2 m arena centered on the origin, 0.5 m cells */
+  cGrid.Configure(-2, -1, 4, 2, 0.5);
+  ASSERT_TRUE(cGrid.IsEnabled());
+  EXPECT_EQ(8u, cGrid.GetWidth());
+  EXPECT_EQ(4u, cGrid.GetHeight());
+
+  /* Last one is out of the arena, counted in the corner */
+  const double pfX[] = {-1.9, -1.9, 0.1, 10.0};
+  const double pfY[] = {-0.9, -0.9, 0.6, 10.0};
+  cGrid.Accumulate(pfX, pfY, 4);
+  EXPECT_EQ(2u, cGrid.GetCount(0, 0));
+  EXPECT_EQ(1u, cGrid.GetCount(4, 3));
+  EXPECT_EQ(1u, cGrid.GetCount(7, 3));
+
+  nlohmann::json cJson = cGrid.ToJSON();
+  EXPECT_EQ(2u, cJson["max"].get<uint32_t>());
+  EXPECT_EQ(4u, cJson["samples"].get<uint64_t>());
+  /* 32 bytes, base64 encoded */
+  EXPECT_EQ(44u, cJson["data"].get<std::string>().size());
+  EXPECT_EQ("/w", cJson["data"].get<std::string>().substr(0, 2));
+
+  cGrid.Clear();
+  EXPECT_EQ(0u, cGrid.GetCount(0, 0));
+};
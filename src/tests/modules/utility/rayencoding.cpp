@@ -0,0 +1,161 @@
+#include <cmath>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "plugins/simulator/visualizations/webviz/utility/RayEncoding.h"
+
+namespace Rays = argos::Webviz::Rays;
+
+namespace {
+  struct SFakeVector {
+    double X, Y, Z;
+    double GetX() const { return X; }
+    double GetY() const { return Y; }
+    double GetZ() const { return Z; }
+  };
+
+  struct SFakeQuaternion {
+    double W, X, Y, Z;
+    double GetW() const { return W; }
+    double GetX() const { return X; }
+    double GetY() const { return Y; }
+    double GetZ() const { return Z; }
+  };
+
+  struct SFakeRay {
+    SFakeVector Start, End;
+    const SFakeVector& GetStart() const { return Start; }
+    const SFakeVector& GetEnd() const { return End; }
+  };
+
+  /* Rotation of 90 degrees around Z, at (1, 1, 0) */
+  Rays::STransform MakeYawTransform() {
+    const double fHalf = std::sqrt(0.5);
+    return Rays::MakeTransform(
+      SFakeVector{1, 1, 0}, SFakeQuaternion{fHalf, 0, 0, fHalf});
+  }
+}  // namespace
+
+TEST(UtilityRayEncoding, Transform) {
+  float pfX[] = {2, 1}, pfY[] = {1, 1}, pfZ[] = {0, 0.5};
+  Rays::TransformPoints(MakeYawTransform(), pfX, pfY, pfZ, 2);
+  EXPECT_NEAR(0.0, pfX[0], 1e-6);
+  EXPECT_NEAR(1.0, pfY[0], 1e-6);
+  EXPECT_NEAR(0.0, pfZ[0], 1e-6);
+  EXPECT_NEAR(0.0, pfX[1], 1e-6);
+  EXPECT_NEAR(0.5, pfZ[1], 1e-6);
+}
+
+TEST(UtilityRayEncoding, Half) {
+  for (float fValue : {0.0f, 1.0f, -2.5f, 0.125f, 65504.0f}) {
+    EXPECT_NEAR(
+      fValue, Rays::HalfToFloat(Rays::FloatToHalf(fValue)),
+      std::abs(fValue) * 1e-3);
+  }
+  /* Subnormal, with less precision */
+  EXPECT_NEAR(1e-5f, Rays::HalfToFloat(Rays::FloatToHalf(1e-5f)), 1e-7);
+  EXPECT_EQ(0x3c00, Rays::FloatToHalf(1.0f));
+  EXPECT_EQ(0xc000, Rays::FloatToHalf(-2.0f));
+  EXPECT_TRUE(std::isinf(Rays::HalfToFloat(Rays::FloatToHalf(1e6f))));
+  /* Millimeters at a few meters */
+  EXPECT_NEAR(3.1416f, Rays::HalfToFloat(Rays::FloatToHalf(3.1416f)), 2e-3);
+}
+
+TEST(UtilityRayEncoding, Rays) {
+  std::vector<std::pair<bool, SFakeRay>> vecRays;
+  for (size_t i = 0; i < 10; ++i) {
+    vecRays.push_back({i == 1 || i == 9, {{2, 1, 0}, {1, 1 + 0.1 * i, 0}}});
+  }
+  nlohmann::json cRays = Rays::EncodeRays(vecRays, MakeYawTransform());
+  EXPECT_EQ(10u, cRays["count"]);
+  EXPECT_EQ("float32", cRays["format"]);
+
+  std::string strChecked;
+  ASSERT_TRUE(Base64::Decode(cRays["checked"].get<std::string>(), &strChecked));
+  ASSERT_EQ(2u, strChecked.size());
+  EXPECT_EQ(0x02, strChecked[0]);
+  EXPECT_EQ(0x02, strChecked[1]);
+
+  std::vector<float> vecData;
+  ASSERT_TRUE(Rays::DecodeFloats(cRays["data"], false, vecData));
+  ASSERT_EQ(60u, vecData.size());
+  /* Start of ray 0, then end of ray 9, in the body frame */
+  EXPECT_NEAR(0.0, vecData[0], 1e-6);
+  EXPECT_NEAR(1.0, vecData[1], 1e-6);
+  EXPECT_NEAR(-0.9, vecData[54 + 3], 1e-6);
+  EXPECT_NEAR(0.0, vecData[54 + 4], 1e-6);
+
+  /* Half the size, nearly the same values */
+  nlohmann::json cEntity = {{"rays", cRays}};
+  Rays::QuantizeToHalf(cEntity);
+  EXPECT_EQ("float16", cEntity["rays"]["format"]);
+  std::vector<float> vecHalf;
+  ASSERT_TRUE(Rays::DecodeFloats(cEntity["rays"]["data"], true, vecHalf));
+  ASSERT_EQ(vecData.size(), vecHalf.size());
+  for (size_t i = 0; i < vecData.size(); ++i) {
+    EXPECT_NEAR(vecData[i], vecHalf[i], 1e-3);
+  }
+
+  /* Already quantized, left as is */
+  nlohmann::json cQuantized = cEntity;
+  Rays::QuantizeToHalf(cQuantized);
+  EXPECT_EQ(cEntity, cQuantized);
+}
+
+TEST(UtilityRayEncoding, Points) {
+  std::vector<SFakeVector> vecPoints = {{2, 1, 0}, {1, 0, 3}};
+  nlohmann::json cPoints = Rays::EncodePoints(vecPoints, MakeYawTransform());
+  EXPECT_EQ(2u, cPoints["count"]);
+  EXPECT_FALSE(cPoints.contains("checked"));
+
+  std::vector<float> vecData;
+  ASSERT_TRUE(Rays::DecodeFloats(cPoints["data"], false, vecData));
+  ASSERT_EQ(6u, vecData.size());
+  EXPECT_NEAR(1.0, vecData[1], 1e-6);
+  EXPECT_NEAR(1.0, vecData[3], 1e-6);
+  EXPECT_NEAR(0.0, vecData[4], 1e-6);
+  EXPECT_NEAR(3.0, vecData[5], 1e-6);
+
+  /* No points */
+  nlohmann::json cNone =
+    Rays::EncodePoints(std::vector<SFakeVector>(), MakeYawTransform());
+  EXPECT_EQ(0u, cNone["count"]);
+  EXPECT_EQ("", cNone["data"]);
+}
+
+TEST(UtilityRayEncoding, State) {
+  std::vector<std::pair<bool, SFakeRay>> vecRays = {
+    {false, {{0, 0, 0}, {1, 0, 0}}}};
+  std::vector<SFakeVector> vecPoints;
+
+  std::string strState, strSame;
+  Rays::PackState(strState, vecRays, vecPoints);
+  Rays::PackState(strSame, vecRays, vecPoints);
+  EXPECT_EQ(strState, strSame);
+  EXPECT_EQ(16u, strState.size());
+
+  /* Checked, moved or with a new point, the state differs */
+  vecRays[0].first = true;
+  std::string strChecked;
+  Rays::PackState(strChecked, vecRays, vecPoints);
+  EXPECT_NE(strState, strChecked);
+
+  vecRays[0].second.End.Y = 0.5;
+  std::string strMoved;
+  Rays::PackState(strMoved, vecRays, vecPoints);
+  EXPECT_NE(strChecked, strMoved);
+
+  vecPoints.push_back({1, 0.5, 0});
+  std::string strPoint;
+  Rays::PackState(strPoint, vecRays, vecPoints);
+  EXPECT_NE(strMoved, strPoint);
+
+  /* The size does not depend on the number of rays */
+  vecRays.resize(24, vecRays[0]);
+  std::string strMany;
+  Rays::PackState(strMany, vecRays, vecPoints);
+  EXPECT_EQ(16u, strMany.size());
+  EXPECT_NE(strPoint, strMany);
+}
@@ -0,0 +1,84 @@
+#include <unistd.h>
+
+#include <string>
+
+#include "gtest/gtest.h"
+#include "plugins/simulator/visualizations/webviz/utility/SharedMemoryRing.h"
+
+using argos::Webviz::CSharedMemoryRingReader;
+using argos::Webviz::CSharedMemoryRingWriter;
+
+static std::string RingName() {
+  return "/webviz_test_" + std::to_string(getpid());
+}
+
+TEST(UtilitySharedMemoryRing, WriteRead) {
+  CSharedMemoryRingReader cReader;
+  EXPECT_FALSE(cReader.Open(RingName()));
+
+  CSharedMemoryRingWriter cWriter;
+  ASSERT_TRUE(cWriter.Open(RingName(), 4, 64));
+  ASSERT_TRUE(cReader.Open(RingName()));
+  EXPECT_EQ(4u, cReader.GetSlotCount());
+
+  std::string strFrame;
+  uint64_t unStep = 0, unLost = 0;
+  EXPECT_EQ(
+    CSharedMemoryRingReader::EStatus::NOT_YET,
+    cReader.Next(strFrame, unStep, unLost));
+
+  EXPECT_TRUE(cWriter.Write(10, "{\"steps\":10}"));
+  EXPECT_TRUE(cWriter.Write(11, "{\"steps\":11}"));
+  EXPECT_EQ(2u, cReader.GetWritten());
+
+  ASSERT_EQ(
+    CSharedMemoryRingReader::EStatus::OK,
+    cReader.Next(strFrame, unStep, unLost));
+  EXPECT_EQ(10u, unStep);
+  EXPECT_EQ("{\"steps\":10}", strFrame);
+
+  /* In place */
+  CSharedMemoryRingReader::SFrame sFrame;
+  ASSERT_EQ(
+    CSharedMemoryRingReader::EStatus::OK, cReader.Next(sFrame, unLost));
+  EXPECT_EQ(11u, sFrame.Step);
+  EXPECT_EQ("{\"steps\":11}", std::string(sFrame.Data, sFrame.Size));
+  EXPECT_TRUE(cReader.IsValid(sFrame));
+  EXPECT_EQ(0u, unLost);
+
+  /* Too large for a slot, even rounded up */
+  EXPECT_FALSE(cWriter.Write(12, std::string(200, 'x')));
+  EXPECT_EQ(1u, cWriter.GetSkipped());
+};
+
+TEST(UtilitySharedMemoryRing, Lapped) {
+  CSharedMemoryRingWriter cWriter;
+  ASSERT_TRUE(cWriter.Open(RingName(), 4, 64));
+  CSharedMemoryRingReader cReader;
+  ASSERT_TRUE(cReader.Open(RingName()));
+
+  CSharedMemoryRingReader::SFrame sFrame;
+  uint64_t unLost = 0;
+  ASSERT_TRUE(cWriter.Write(0, "0"));
+  ASSERT_EQ(
+    CSharedMemoryRingReader::EStatus::OK, cReader.Next(sFrame, unLost));
+  EXPECT_FALSE(cReader.IsValid({1, 0, nullptr, 0}));
+
+  /* The frame read in place is overwritten */
+  for (uint64_t i = 1; i <= 10; ++i) {
+    cWriter.Write(i, std::to_string(i));
+  }
+  EXPECT_FALSE(cReader.IsValid(sFrame));
+
+  /* Frames 1 to 7 are lost, 8 is the oldest one kept that can not be
+   * overwritten by the next write */
+  ASSERT_EQ(
+    CSharedMemoryRingReader::EStatus::OK, cReader.Next(sFrame, unLost));
+  EXPECT_EQ(8u, sFrame.Step);
+  EXPECT_EQ(7u, unLost);
+
+  /* The writer removes the ring when closed */
+  cWriter.Close();
+  CSharedMemoryRingReader cLateReader;
+  EXPECT_FALSE(cLateReader.Open(RingName()));
+};
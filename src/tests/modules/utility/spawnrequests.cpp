@@ -0,0 +1,96 @@
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "plugins/simulator/visualizations/webviz/utility/SpawnRequests.h"
+
+using argos::Webviz::CSpawnRequests;
+using argos::Webviz::SSpawnRequest;
+
+TEST(UtilitySpawnRequests, FromJSON) {
+  SSpawnRequest sRequest;
+  EXPECT_EQ("", sRequest.FromJSON(nlohmann::json::parse(R"({
+    "command": "spawnEntities",
+    "type": "foot-bot",
+    "count": 500,
+    "controller": "fdc",
+    "region": {"min": {"x": -2, "y": -1.5}, "max": {"x": 2, "y": 1.5}}
+  })")));
+  EXPECT_EQ("foot-bot", sRequest.Type);
+  EXPECT_EQ(500u, sRequest.Count);
+  EXPECT_EQ("fdc", sRequest.Controller);
+  EXPECT_EQ("spawn_foot-bot_", sRequest.IdPrefix);
+  EXPECT_EQ(100u, sRequest.MaxTrials);
+  EXPECT_EQ(-1.5, sRequest.Min[1]);
+  EXPECT_EQ(2, sRequest.Max[0]);
+  /* z is optional */
+  EXPECT_EQ(0, sRequest.Min[2]);
+  EXPECT_EQ(0, sRequest.Max[2]);
+
+  EXPECT_EQ("", sRequest.FromJSON(nlohmann::json::parse(R"({
+    "type": "box",
+    "count": 3,
+    "id_prefix": "obstacle_",
+    "max_trials": 10,
+    "attributes": {"size": "0.1,0.1,0.2", "movable": "false"},
+    "region": {"min": {"x": 0, "y": 0}, "max": {"x": 1, "y": 1, "z": 0}}
+  })")));
+  EXPECT_EQ("", sRequest.Controller);
+  EXPECT_EQ("obstacle_", sRequest.IdPrefix);
+  EXPECT_EQ(10u, sRequest.MaxTrials);
+  EXPECT_EQ("0.1,0.1,0.2", sRequest.Attributes["size"]);
+}
+
+TEST(UtilitySpawnRequests, Invalid) {
+  const nlohmann::json cValid = nlohmann::json::parse(R"({
+    "type": "foot-bot",
+    "count": 5,
+    "region": {"min": {"x": 0, "y": 0}, "max": {"x": 1, "y": 1}}
+  })");
+
+  std::vector<nlohmann::json> vecInvalid;
+  for (const char* pchKey : {"type", "count", "region"}) {
+    vecInvalid.push_back(cValid);
+    vecInvalid.back().erase(pchKey);
+  }
+  vecInvalid.push_back(cValid);
+  vecInvalid.back()["count"] = 0;
+  vecInvalid.push_back(cValid);
+  vecInvalid.back()["count"] = 100001;
+  vecInvalid.push_back(cValid);
+  vecInvalid.back()["region"]["min"]["x"] = 2;
+  vecInvalid.push_back(cValid);
+  vecInvalid.back()["region"]["max"].erase("y");
+  vecInvalid.push_back(cValid);
+  vecInvalid.back()["attributes"] = {{"id", "fb"}};
+  vecInvalid.push_back(cValid);
+  vecInvalid.back()["max_trials"] = 0;
+
+  for (const auto& cCommand : vecInvalid) {
+    SSpawnRequest sRequest;
+    EXPECT_NE("", sRequest.FromJSON(cCommand)) << cCommand.dump();
+    /* Nothing is changed */
+    EXPECT_EQ(0u, sRequest.Count);
+  }
+}
+
+TEST(UtilitySpawnRequests, Queue) {
+  CSpawnRequests cRequests(2);
+  EXPECT_FALSE(cRequests.HasPending());
+  EXPECT_TRUE(cRequests.Take().empty());
+
+  SSpawnRequest sRequest;
+  sRequest.Type = "foot-bot";
+  EXPECT_TRUE(cRequests.Add(sRequest));
+  sRequest.Type = "box";
+  EXPECT_TRUE(cRequests.Add(sRequest));
+  EXPECT_FALSE(cRequests.Add(sRequest));
+  EXPECT_TRUE(cRequests.HasPending());
+
+  std::vector<SSpawnRequest> vecRequests = cRequests.Take();
+  ASSERT_EQ(2u, vecRequests.size());
+  EXPECT_EQ("foot-bot", vecRequests[0].Type);
+  EXPECT_EQ("box", vecRequests[1].Type);
+  EXPECT_FALSE(cRequests.HasPending());
+  EXPECT_TRUE(cRequests.Add(sRequest));
+}
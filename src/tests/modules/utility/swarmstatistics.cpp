@@ -0,0 +1,81 @@
+#include <cmath>
+#include <string>
+
+#include "gtest/gtest.h"
+#include "plugins/simulator/visualizations/webviz/utility/SwarmStatistics.h"
+
+using argos::Webviz::CSwarmStatistics;
+using argos::Webviz::SPoseSnapshot;
+
+static void AddPose(
+  SPoseSnapshot& s_poses,
+  const std::string& str_id,
+  const std::string& str_type,
+  double f_x,
+  double f_y,
+  double f_yaw) {
+  s_poses.Ids.push_back(str_id);
+  s_poses.Types.push_back(str_type);
+  s_poses.X.push_back(f_x);
+  s_poses.Y.push_back(f_y);
+  s_poses.Z.push_back(0);
+  s_poses.QX.push_back(0);
+  s_poses.QY.push_back(0);
+  s_poses.QZ.push_back(std::sin(f_yaw / 2));
+  s_poses.QW.push_back(std::cos(f_yaw / 2));
+}
+
+TEST(UtilitySwarmStatistics, PerType) {
+  CSwarmStatistics cStatistics;
+  SPoseSnapshot sPoses;
+  sPoses.Step = 10;
+  AddPose(sPoses, "fb0", "foot-bot", -1, 0, 0.5);
+  AddPose(sPoses, "fb1", "foot-bot", 1, 0, 0.5);
+  AddPose(sPoses, "box0", "box", 3, 4, 0);
+
+  nlohmann::json cStats = cStatistics.Compute(sPoses, 0.1);
+  ASSERT_EQ(2u, cStats.size());
+
+  const nlohmann::json& cFootBots = cStats["foot-bot"];
+  EXPECT_EQ(2u, cFootBots["count"].get<size_t>());
+  EXPECT_NEAR(0, cFootBots["centroid"]["x"].get<double>(), 1e-9);
+  EXPECT_NEAR(-1, cFootBots["bounding_box"]["min"]["x"].get<double>(), 1e-9);
+  EXPECT_NEAR(1, cFootBots["bounding_box"]["max"]["x"].get<double>(), 1e-9);
+  EXPECT_NEAR(1, cFootBots["dispersion"].get<double>(), 1e-9);
+  /* Same heading */
+  EXPECT_NEAR(1, cFootBots["polarization"].get<double>(), 1e-9);
+  /* No previous snapshot */
+  EXPECT_TRUE(cFootBots["mean_speed"].is_null());
+
+  EXPECT_EQ(1u, cStats["box"]["count"].get<size_t>());
+  EXPECT_NEAR(0, cStats["box"]["dispersion"].get<double>(), 1e-9);
+};
+
+TEST(UtilitySwarmStatistics, SpeedAndPolarization) {
+  CSwarmStatistics cStatistics;
+  SPoseSnapshot sPoses;
+  sPoses.Step = 10;
+  AddPose(sPoses, "fb0", "foot-bot", 0, 0, 0);
+  AddPose(sPoses, "fb1", "foot-bot", 1, 0, M_PI);
+  cStatistics.Compute(sPoses, 0.1);
+
+  /* 5 steps later, fb0 moved by 0.1 m and fb1 did not move, fb2 is new */
+  sPoses.Clear();
+  sPoses.Step = 15;
+  AddPose(sPoses, "fb0", "foot-bot", 0.1, 0, 0);
+  AddPose(sPoses, "fb1", "foot-bot", 1, 0, M_PI);
+  AddPose(sPoses, "fb2", "foot-bot", 5, 5, M_PI / 2);
+  nlohmann::json cStats = cStatistics.Compute(sPoses, 0.1);
+  /* (0.1 + 0) / 2 entities / 0.5 s */
+  EXPECT_NEAR(0.1, cStats["foot-bot"]["mean_speed"].get<double>(), 1e-9);
+  /* Opposite headings cancel out, the third one remains */
+  EXPECT_NEAR(1.0 / 3, cStats["foot-bot"]["polarization"].get<double>(), 1e-9);
+
+  /* Reset: no speed, and no stale types */
+  sPoses.Clear();
+  sPoses.Step = 0;
+  AddPose(sPoses, "box0", "box", 0, 0, 0);
+  cStats = cStatistics.Compute(sPoses, 0.1);
+  EXPECT_TRUE(cStats["box"]["mean_speed"].is_null());
+  EXPECT_FALSE(cStats.contains("foot-bot"));
+};
@@ -0,0 +1,76 @@
+#include <cmath>
+#include <string>
+
+#include "gtest/gtest.h"
+#include "plugins/simulator/visualizations/webviz/utility/TrailBuffer.h"
+
+using argos::Webviz::CTrail;
+using argos::Webviz::CTrailBuffers;
+
+TEST(UtilityTrailBuffer, StraightMotionIsOneSegment) {
+  CTrail cTrail(10);
+  /* Straight line along x, then a turn along y */
+  for (uint64_t i = 0; i <= 100; ++i) {
+    cTrail.Add({i, 0.01 * i, 0, 0}, 0.005, 0.1);
+  }
+  EXPECT_EQ(2u, cTrail.GetCount());
+  EXPECT_EQ(100u, cTrail.At(1).Step);
+
+  for (uint64_t i = 1; i <= 50; ++i) {
+    cTrail.Add({100 + i, 1.0, 0.01 * i, 0}, 0.005, 0.1);
+  }
+  ASSERT_EQ(3u, cTrail.GetCount());
+  EXPECT_DOUBLE_EQ(1.0, cTrail.At(1).X);
+  EXPECT_DOUBLE_EQ(0.5, cTrail.At(2).Y);
+
+  /* Standing still adds nothing */
+  cTrail.Add({200, 1.0, 0.5, 0}, 0.005, 0.1);
+  EXPECT_EQ(3u, cTrail.GetCount());
+  EXPECT_EQ(150u, cTrail.At(2).Step);
+};
+
+/****************************************/
+/****************************************/
+
+TEST(UtilityTrailBuffer, RingIsBounded) {
+  CTrail cTrail(4);
+  /* Zig-zag, every point is kept */
+  for (uint64_t i = 0; i < 10; ++i) {
+    cTrail.Add({i, 0.1 * i, (i % 2) * 0.1, 0}, 0.001, 0.1);
+  }
+  ASSERT_EQ(4u, cTrail.GetCount());
+  EXPECT_EQ(6u, cTrail.At(0).Step);
+  EXPECT_EQ(9u, cTrail.At(3).Step);
+};
+
+/****************************************/
+/****************************************/
+
+TEST(UtilityTrailBuffer, QueryAndReset) {
+  CTrailBuffers cTrails;
+  EXPECT_FALSE(cTrails.IsEnabled());
+  cTrails.Configure(100, 0.001, 0.1);
+  EXPECT_TRUE(cTrails.IsEnabled());
+
+  for (uint64_t i = 0; i < 10; ++i) {
+    double fY = (i % 2) * 0.1;
+    cTrails.Update(
+      i, {"fb0", "fb1"}, {0.1 * i, 0.0}, {fY, 0.0}, {0.0, 0.0});
+  }
+
+  nlohmann::json cTrailsJSON = cTrails.GetTrails({"fb0", "unknown"}, 2, 5);
+  ASSERT_EQ(1u, cTrailsJSON.size());
+  ASSERT_EQ(4u, cTrailsJSON["fb0"].size());
+  EXPECT_EQ(2u, cTrailsJSON["fb0"][0][0].get<uint64_t>());
+
+  /* All the entities, fb1 never moved */
+  cTrailsJSON = cTrails.GetTrails({}, 0, 100);
+  ASSERT_EQ(2u, cTrailsJSON.size());
+  EXPECT_EQ(1u, cTrailsJSON["fb1"].size());
+
+  /* Reset */
+  cTrails.Update(0, {"fb0"}, {5.0}, {5.0}, {0.0});
+  cTrailsJSON = cTrails.GetTrails({}, 0, 100);
+  ASSERT_EQ(1u, cTrailsJSON.size());
+  EXPECT_EQ(1u, cTrailsJSON["fb0"].size());
+};
@@ -0,0 +1,101 @@
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include "gtest/gtest.h"
+#include "plugins/simulator/visualizations/webviz/utility/TrajectoryExport.h"
+
+using argos::Webviz::CArrowStreamEncoder;
+using argos::Webviz::CTrajectoryExporter;
+
+static const std::string EXPORT_PATH = "/tmp/webviz_test_export.arrows";
+
+static nlohmann::json MakeFrame(uint64_t un_step) {
+  nlohmann::json cFrame;
+  cFrame["steps"] = un_step;
+  cFrame["entities"].push_back(
+    {{"id", "fb0"},
+     {"type", "foot-bot"},
+     {"position", {{"x", 1.0}, {"y", 2.0}, {"z", 0.0}}},
+     {"orientation", {{"x", 0.0}, {"y", 0.0}, {"z", 0.0}, {"w", 1.0}}},
+     {"leds", {0xff0000, 0x000000}}});
+  cFrame["entities"].push_back({{"id", "floor"}, {"type", "floor"}});
+  return cFrame;
+}
+
+TEST(UtilityTrajectoryExport, DecimationAndBatches) {
+  CTrajectoryExporter cExporter(10);
+  size_t unBatches = 0;
+  cExporter.SetBatchSink(
+    [&](std::shared_ptr<const std::string>) { ++unBatches; });
+  ASSERT_TRUE(cExporter.Start(EXPORT_PATH, 5));
+
+  for (uint64_t i = 0; i < 100; ++i) {
+    if (cExporter.NeedsFrame(i)) {
+      cExporter.AddFrame(i, MakeFrame(i));
+    }
+  }
+  /* 20 frames of 2 entities, a batch every 10 frames */
+  EXPECT_EQ(40u, cExporter.GetExportedRows());
+  EXPECT_EQ(2u, unBatches);
+
+  /* A reset exports again from the first step */
+  EXPECT_TRUE(cExporter.NeedsFrame(0));
+  cExporter.AddFrame(0, MakeFrame(0));
+  cExporter.Close();
+  EXPECT_EQ(42u, cExporter.GetExportedRows());
+  EXPECT_EQ(3u, unBatches);
+  EXPECT_FALSE(cExporter.NeedsFrame(1000));
+
+  /* Schema first, end-of-stream marker last */
+  std::ifstream cFile(EXPORT_PATH, std::ios::binary);
+  std::stringstream cContent;
+  cContent << cFile.rdbuf();
+  std::string strContent = cContent.str();
+  const std::string& strSchema = cExporter.GetSchemaMessage();
+  EXPECT_EQ(0, strContent.compare(0, strSchema.size(), strSchema));
+  EXPECT_EQ(
+    CArrowStreamEncoder::EncodeEndOfStream(),
+    strContent.substr(strContent.size() - 8));
+
+  std::remove(EXPORT_PATH.c_str());
+};
+
+/****************************************/
+/****************************************/
+
+TEST(UtilityTrajectoryExport, ReadBackWithPyArrow) {
+  /* Only with the pyarrow of the system, nothing is installed for it */
+  if (std::system("python3 -c 'import pyarrow' > /dev/null 2>&1") != 0) {
+    GTEST_SKIP() << "pyarrow is not available";
+  }
+
+  CTrajectoryExporter cExporter(10);
+  ASSERT_TRUE(cExporter.Start(EXPORT_PATH, 5));
+  for (uint64_t i = 0; i < 100; ++i) {
+    if (cExporter.NeedsFrame(i)) {
+      cExporter.AddFrame(i, MakeFrame(i));
+    }
+  }
+  cExporter.Close();
+
+  const std::string strScript =
+    "import math, pyarrow as pa\n"
+    "t = pa.ipc.open_stream('" + EXPORT_PATH + "').read_all()\n"
+    "assert t.column_names == ['step', 'id', 'type', 'x', 'y', 'z',\n"
+    "  'qx', 'qy', 'qz', 'qw', 'leds'], t.column_names\n"
+    "assert t.num_rows == 40, t.num_rows\n"
+    "r = t.slice(2, 2).to_pylist()\n"
+    "assert r[0]['step'] == 5 and r[0]['id'] == 'fb0', r[0]\n"
+    "assert r[0]['x'] == 1.0 and r[0]['qw'] == 1.0, r[0]\n"
+    "assert r[1]['id'] == 'floor' and math.isnan(r[1]['x']), r[1]\n";
+  const std::string strScriptPath = "/tmp/webviz_test_export.py";
+  std::ofstream(strScriptPath) << strScript;
+  EXPECT_EQ(0, std::system(("python3 " + strScriptPath).c_str()));
+
+  std::remove(strScriptPath.c_str());
+  std::remove(EXPORT_PATH.c_str());
+};
@@ -0,0 +1,140 @@
+#include <chrono>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "plugins/simulator/visualizations/webviz/utility/UserDataChannels.h"
+
+using argos::Webviz::CUserDataChannel;
+using argos::Webviz::CUserDataChannels;
+using argos::Webviz::EUserDataType;
+
+namespace {
+  /** Publishes the due channels, returns the (topic, message) published */
+  std::vector<std::pair<std::string, nlohmann::json>> Publish(
+    CUserDataChannels& c_channels,
+    std::chrono::steady_clock::time_point t_now,
+    const std::set<std::string>& set_subscribed = {"user/pheromone"}) {
+    std::vector<std::pair<std::string, nlohmann::json>> vecPublished;
+    c_channels.Publish(
+      7,
+      t_now,
+      [&](const std::string& str_topic) {
+        return set_subscribed.count(str_topic) > 0;
+      },
+      [&](const std::string& str_topic, std::string str_message) {
+        vecPublished.emplace_back(
+          str_topic, nlohmann::json::parse(str_message));
+      });
+    return vecPublished;
+  }
+}  // namespace
+
+TEST(UtilityUserDataChannels, OnlyWhenChanged) {
+  CUserDataChannels cChannels;
+  CUserDataChannel* pcChannel =
+    cChannels.Register("pheromone", EUserDataType::JSON);
+  ASSERT_NE(nullptr, pcChannel);
+  EXPECT_EQ("user/pheromone", pcChannel->GetTopic());
+  auto tNow = std::chrono::steady_clock::now();
+
+  /* Never set, nothing to publish */
+  EXPECT_TRUE(Publish(cChannels, tNow).empty());
+
+  EXPECT_TRUE(pcChannel->SetJSON({{"level", 3}}));
+  auto vecPublished = Publish(cChannels, tNow);
+  ASSERT_EQ(1u, vecPublished.size());
+  EXPECT_EQ("user/pheromone", vecPublished[0].first);
+  const nlohmann::json& cMessage = vecPublished[0].second;
+  EXPECT_EQ("user_data", cMessage["type"]);
+  EXPECT_EQ("pheromone", cMessage["channel"]);
+  EXPECT_EQ(1u, cMessage["version"]);
+  EXPECT_EQ(7u, cMessage["steps"]);
+  EXPECT_EQ(3, cMessage["value"]["level"]);
+
+  /* Unchanged */
+  EXPECT_TRUE(Publish(cChannels, tNow).empty());
+
+  /* Without subscribers, not published even if changed */
+  pcChannel->SetJSON({{"level", 4}});
+  EXPECT_TRUE(Publish(cChannels, tNow, {}).empty());
+
+  /* Back to subscribed, published again even if unchanged */
+  EXPECT_EQ(1u, Publish(cChannels, tNow).size());
+  EXPECT_TRUE(Publish(cChannels, tNow).empty());
+}
+
+TEST(UtilityUserDataChannels, MaxFrequency) {
+  CUserDataChannels cChannels;
+  CUserDataChannel* pcChannel =
+    cChannels.Register("pheromone", EUserDataType::JSON, 2);
+  auto tNow = std::chrono::steady_clock::now();
+
+  pcChannel->SetJSON(1);
+  EXPECT_EQ(1u, Publish(cChannels, tNow).size());
+
+  /* Changed twice within half a second, merged into one message */
+  pcChannel->SetJSON(2);
+  EXPECT_TRUE(
+    Publish(cChannels, tNow + std::chrono::milliseconds(200)).empty());
+  pcChannel->SetJSON(3);
+  auto vecPublished =
+    Publish(cChannels, tNow + std::chrono::milliseconds(500));
+  ASSERT_EQ(1u, vecPublished.size());
+  EXPECT_EQ(3, vecPublished[0].second["value"]);
+  EXPECT_EQ(3u, vecPublished[0].second["version"]);
+}
+
+TEST(UtilityUserDataChannels, Numbers) {
+  CUserDataChannels cChannels;
+  CUserDataChannel* pcChannel =
+    cChannels.Register("pheromone", EUserDataType::NUMBERS);
+
+  /* Typed */
+  EXPECT_FALSE(pcChannel->SetJSON(1));
+  EXPECT_FALSE(pcChannel->SetNumbers({1.0f, 2.0f, 3.0f}, {2, 2}));
+  EXPECT_EQ(0u, pcChannel->GetVersion());
+  EXPECT_TRUE(pcChannel->SetNumbers({1.0f, 2.0f, 3.0f, 4.5f}, {2, 2}));
+
+  auto vecPublished = Publish(cChannels, std::chrono::steady_clock::now());
+  ASSERT_EQ(1u, vecPublished.size());
+  const nlohmann::json& cMessage = vecPublished[0].second;
+  EXPECT_EQ("float32", cMessage["format"]);
+  EXPECT_EQ(nlohmann::json({2, 2}), cMessage["shape"]);
+  EXPECT_FALSE(cMessage.contains("value"));
+
+  std::string strBytes;
+  ASSERT_TRUE(
+    Base64::Decode(cMessage["data"].get<std::string>(), &strBytes));
+  ASSERT_EQ(4 * sizeof(float), strBytes.size());
+  const float* pfValues = reinterpret_cast<const float*>(strBytes.data());
+  EXPECT_EQ(4.5f, pfValues[3]);
+
+  /* Flat array */
+  EXPECT_TRUE(pcChannel->SetNumbers({1.0f, 2.0f}));
+  EXPECT_EQ(
+    nlohmann::json({2}), Publish(cChannels, std::chrono::steady_clock::now())
+                           [0]
+                             .second["shape"]);
+}
+
+TEST(UtilityUserDataChannels, Register) {
+  CUserDataChannels cChannels;
+  EXPECT_TRUE(cChannels.IsEmpty());
+  CUserDataChannel* pcChannel =
+    cChannels.Register("pheromone", EUserDataType::NUMBERS, 5);
+
+  /* Same name and type, same channel; another type is refused */
+  EXPECT_EQ(pcChannel, cChannels.Register("pheromone", EUserDataType::NUMBERS));
+  EXPECT_EQ(nullptr, cChannels.Register("pheromone", EUserDataType::JSON));
+  EXPECT_EQ(pcChannel, cChannels.Find("pheromone"));
+  EXPECT_EQ(nullptr, cChannels.Find("food"));
+
+  nlohmann::json cDescription = cChannels.ToJSON();
+  ASSERT_EQ(1u, cDescription.size());
+  EXPECT_EQ("numbers", cDescription[0]["type"]);
+  EXPECT_EQ("user/pheromone", cDescription[0]["topic"]);
+  EXPECT_EQ(5.0, cDescription[0]["max_frequency"]);
+}